@@ -522,7 +522,7 @@ namespace Plugin {
             }
 
             ASSERT(impl != nullptr);
-            _devices.push_back(impl);
+            Index(impl);
 
             TRACE(Trace::Information, (_T("Added %s Bluetooth device: %s, name: '%s', class: 0x%06X"),
                                        (lowEnergy? "LowEnergy" : "classic"), address.ToString().c_str(),
@@ -545,16 +545,49 @@ namespace Plugin {
     {
         _adminLock.Lock();
 
-        for (std::list<DeviceImpl*>::iterator index = _devices.begin(), end = _devices.end(); index != end; ++index) {
+        std::list<DeviceImpl*>::iterator index(_devices.begin());
+
+        while (index != _devices.end()) {
             // call the function passed into findMatchingAddresses and see if it matches
             if (filter(*index) == true) {
+                _addresses.erase(Key((*index)->Address(), (*index)->LowEnergy()));
+                if ((*index)->IsConnected() == true) {
+                    _handles.erase((*index)->ConnectionId());
+                }
                 (*index)->Release();
                 index = _devices.erase(index);
+            } else {
+                index++;
             }
         }
 
         _adminLock.Unlock();
     }
+    void BluetoothControl::Index(DeviceImpl* device)
+    {
+        _adminLock.Lock();
+
+        _devices.push_back(device);
+        _addresses[Key(device->Address(), device->LowEnergy())] = device;
+
+        _adminLock.Unlock();
+    }
+    void BluetoothControl::Reindex(DeviceImpl* device, const uint16_t previous, const uint16_t handle)
+    {
+        _adminLock.Lock();
+
+        if (previous != static_cast<uint16_t>(~0)) {
+            std::unordered_map<uint16_t, DeviceImpl*>::iterator index(_handles.find(previous));
+            if ((index != _handles.end()) && (index->second == device)) {
+                _handles.erase(index);
+            }
+        }
+        if (handle != static_cast<uint16_t>(~0)) {
+            _handles[handle] = device;
+        }
+
+        _adminLock.Unlock();
+    }
     void BluetoothControl::Capabilities(const Bluetooth::Address& device, const uint8_t capability, const uint8_t authentication, const uint8_t oob_data)
     {
         DeviceImpl* entry = Find(device);
@@ -568,34 +601,40 @@ namespace Plugin {
     }
     BluetoothControl::DeviceImpl* BluetoothControl::Find(const Bluetooth::Address& search) const
     {
-        std::list<DeviceImpl*>::const_iterator index = _devices.begin();
-
-        while ((index != _devices.end()) && ((*index)->operator==(search) == false)) {
-            index++;
-        }
+        DeviceImpl* result = Find(search, false);
 
-        return (index != _devices.end() ? (*index) : nullptr);
+        return (result != nullptr ? result : Find(search, true));
     }
     BluetoothControl::DeviceImpl* BluetoothControl::Find(const Bluetooth::Address& search, bool lowEnergy) const
     {
-        std::list<DeviceImpl*>::const_iterator index = _devices.begin();
+        DeviceImpl* result = nullptr;
+
+        _adminLock.Lock();
 
-        while ((index != _devices.end()) && ((*index)->operator==(std::make_pair(search, lowEnergy)) == false)) {
-            index++;
+        std::unordered_map<uint64_t, DeviceImpl*>::const_iterator index = _addresses.find(Key(search, lowEnergy));
+        if (index != _addresses.end()) {
+            result = index->second;
         }
 
-        return (index != _devices.end() ? (*index) : nullptr);
+        _adminLock.Unlock();
+
+        return (result);
     }
     template<typename DEVICE=BluetoothControl::DeviceImpl>
     DEVICE* BluetoothControl::Find(const uint16_t handle) const
     {
-        std::list<DeviceImpl*>::const_iterator index = _devices.begin();
+        DeviceImpl* result = nullptr;
+
+        _adminLock.Lock();
 
-        while ((index != _devices.end()) && ((*index)->ConnectionId() != handle)) {
-            index++;
+        std::unordered_map<uint16_t, DeviceImpl*>::const_iterator index = _handles.find(handle);
+        if (index != _handles.end()) {
+            result = index->second;
         }
 
-        return (index != _devices.end() ? (*index) : nullptr);
+        _adminLock.Unlock();
+
+        return (result);
     }
 
     uint32_t BluetoothControl::LoadDevices(const string& devicePath, Bluetooth::ManagementSocket& administrator)
@@ -697,7 +736,7 @@ namespace Plugin {
 
                         if (device != nullptr) {
 
-                            _devices.push_back(device);
+                            Index(device);
 
                             result = Core::ERROR_NONE;
                         }
@@ -25,6 +25,8 @@
 
 #include "Tracing.h"
 
+#include <unordered_map>
+
 namespace WPEFramework {
 
 namespace Plugin {
@@ -254,12 +256,102 @@ class BluetoothControl : public PluginHost::IPlugin
                 ControlSocket& _parent;
             }; // class ManagementSocket
 
+            // During an LE scan every device advertises several times a second. Reports that carry the same
+            // data as the previous one of that device, with an RSSI in the same bucket, are dropped here for
+            // a while, before the EIR is parsed and the device registry is consulted.
+            class Discovery {
+            private:
+                // Keep reports with identical content out for this long (ms).
+                static constexpr uint32_t Window = 1000;
+                // Width of an RSSI bucket (dBm), smaller changes are considered noise.
+                static constexpr int8_t RssiBucket = 8;
+                // Upper limit on the number of advertisers remembered during a single scan.
+                static constexpr uint16_t MaxEntries = 1024;
+
+                struct Report {
+                    uint64_t Forwarded;
+                    uint32_t Digest;
+                    int8_t Bucket;
+                };
+
+            public:
+                Discovery(const Discovery&) = delete;
+                Discovery& operator=(const Discovery&) = delete;
+
+                Discovery()
+                    : _lock()
+                    , _reports()
+                {
+                }
+                ~Discovery()
+                {
+                }
+
+            public:
+                void Clear()
+                {
+                    _lock.Lock();
+                    _reports.clear();
+                    _lock.Unlock();
+                }
+                // Returns true if the report tells something new about the advertiser.
+                bool Changed(const le_advertising_info& info, const int8_t rssi)
+                {
+                    const uint64_t key = ((BluetoothControl::Key(info.bdaddr) << 3) | (info.evt_type & 0x07));
+                    const uint64_t now = Core::Time::Now().Ticks();
+                    const uint32_t digest = Digest(info.data, info.length);
+                    const int8_t bucket = BluetoothControl::Bucket(rssi, RssiBucket);
+                    bool changed = true;
+
+                    _lock.Lock();
+
+                    std::unordered_map<uint64_t, Report>::iterator index(_reports.find(key));
+
+                    if (index == _reports.end()) {
+                        if (_reports.size() >= MaxEntries) {
+                            _reports.clear();
+                        }
+                        Report& entry(_reports[key]);
+                        entry.Forwarded = now;
+                        entry.Digest = digest;
+                        entry.Bucket = bucket;
+                    } else if ((index->second.Digest == digest) && (index->second.Bucket == bucket)
+                            && ((now - index->second.Forwarded) < (Window * Core::Time::TicksPerMillisecond))) {
+                        changed = false;
+                    } else {
+                        index->second.Forwarded = now;
+                        index->second.Digest = digest;
+                        index->second.Bucket = bucket;
+                    }
+
+                    _lock.Unlock();
+
+                    return (changed);
+                }
+
+            private:
+                static uint32_t Digest(const uint8_t data[], const uint8_t length)
+                {
+                    // FNV-1a, good enough to tell advertising payloads apart.
+                    uint32_t result = 2166136261;
+                    for (uint8_t index = 0; index < length; index++) {
+                        result = (result ^ data[index]) * 16777619;
+                    }
+                    return (result);
+                }
+
+            private:
+                Core::CriticalSection _lock;
+                std::unordered_map<uint64_t, Report> _reports;
+            }; // class Discovery
+
         public:
             ControlSocket(const ControlSocket&) = delete;
             ControlSocket& operator=(const ControlSocket&) = delete;
             ControlSocket()
                 : Bluetooth::HCISocket()
                 , _parent(nullptr)
+                , _discovery()
                 , _administrator(*this)
             {
             }
@@ -292,6 +384,7 @@ class BluetoothControl : public PluginHost::IPlugin
             void Scan(const uint16_t scanTime, const uint32_t type, const uint8_t flags)
             {
                 if (IsOpen() == true) {
+                    _discovery.Clear();
                     _scanJob.Submit([this, scanTime, type, flags]() {
                         TRACE(ControlFlow, (_T("Start BT classic scan: %s"), Core::Time::Now().ToRFC1123().c_str()));
                         Bluetooth::HCISocket::Scan(scanTime, type, flags);
@@ -302,6 +395,7 @@ class BluetoothControl : public PluginHost::IPlugin
             void Scan(const uint16_t scanTime, const bool limited, const bool passive)
             {
                 if (IsOpen() == true) {
+                    _discovery.Clear();
                     _scanJob.Submit([this, scanTime, limited, passive]() {
                         TRACE(ControlFlow, (_T("Start BT LowEnergy scan: %s"), Core::Time::Now().ToRFC1123().c_str()));
                         Bluetooth::HCISocket::Scan(scanTime, limited, passive);
@@ -414,15 +508,24 @@ class BluetoothControl : public PluginHost::IPlugin
                 BT_TRACE(ControlFlow, info);
                 if ((Application() != nullptr) && (info.bdaddr_type == 0 /* public */)
                         && ((info.evt_type == 0 /* undirected connectable advertisement */) || (info.evt_type == 4 /* scan response */))) {
-                    Bluetooth::EIR eir(info.data, info.length);
+                    // The RSSI trails the advertising data.
+                    const int8_t rssi = static_cast<int8_t>(info.data[info.length]);
 
-                    DeviceImpl* device = Application()->Discovered(true, info.bdaddr, eir);
-                    if (device != nullptr) {
-                        if (eir.Class() != 0) {
-                            device->Class(eir.Class());
-                        }
-                        if (eir.CompleteName().empty() == false) {
-                            device->Name(eir.CompleteName());
+                    if (_discovery.Changed(info, rssi) == true) {
+                        Bluetooth::EIR eir(info.data, info.length);
+
+                        DeviceImpl* device = Application()->Discovered(true, info.bdaddr, eir);
+                        if (device != nullptr) {
+                            device->Rssi(rssi);
+                            if (eir.Class() != 0) {
+                                device->Class(eir.Class());
+                            }
+                            if (eir.CompleteName().empty() == false) {
+                                device->Name(eir.CompleteName());
+                            }
+                            if (eir.UUIDs().empty() == false) {
+                                device->UUIDs(eir.UUIDs());
+                            }
                         }
                     }
                 }
@@ -665,6 +768,7 @@ class BluetoothControl : public PluginHost::IPlugin
         private:
             BluetoothControl* _parent;
             DecoupledJob _scanJob;
+            Discovery _discovery;
             ManagementSocket _administrator;
         }; // class ControlSocket
 
@@ -803,6 +907,7 @@ class BluetoothControl : public PluginHost::IPlugin
                     , Connected(false)
                     , Bonded(false)
                     , Reason(0)
+                    , Rssi(0)
                 {
                     Add(_T("local"), &LocalId);
                     Add(_T("remote"), &RemoteId);
@@ -811,6 +916,7 @@ class BluetoothControl : public PluginHost::IPlugin
                     Add(_T("connected"), &Connected);
                     Add(_T("bonded"), &Bonded);
                     Add(_T("reason"), &Reason);
+                    Add(_T("rssi"), &Rssi);
                 }
                 Data(const Data& copy)
                     : Core::JSON::Container()
@@ -821,6 +927,7 @@ class BluetoothControl : public PluginHost::IPlugin
                     , Connected(false)
                     , Bonded(false)
                     , Reason(0)
+                    , Rssi(0)
                 {
                     Add(_T("local"), &LocalId);
                     Add(_T("remote"), &RemoteId);
@@ -829,6 +936,7 @@ class BluetoothControl : public PluginHost::IPlugin
                     Add(_T("connected"), &Connected);
                     Add(_T("bonded"), &Bonded);
                     Add(_T("reason"), &Reason);
+                    Add(_T("rssi"), &Rssi);
                     LocalId = copy.LocalId;
                     RemoteId = copy.RemoteId;
                     Name = copy.Name;
@@ -836,6 +944,7 @@ class BluetoothControl : public PluginHost::IPlugin
                     Connected = copy.Connected;
                     Bonded = copy.Bonded;
                     Reason = copy.Reason;
+                    Rssi = copy.Rssi;
                 }
                 ~Data()
                 {
@@ -851,6 +960,11 @@ class BluetoothControl : public PluginHost::IPlugin
                         LowEnergy = source->LowEnergy();
                         Connected = source->IsConnected();
                         Bonded = source->IsBonded();
+                        if (source->Rssi() != DeviceImpl::NoRssi) {
+                            Rssi = source->Rssi();
+                        } else {
+                            Rssi.Clear();
+                        }
                     } else {
                         LocalId.Clear();
                         RemoteId.Clear();
@@ -858,6 +972,7 @@ class BluetoothControl : public PluginHost::IPlugin
                         LowEnergy.Clear();
                         Bonded.Clear();
                         Connected.Clear();
+                        Rssi.Clear();
                     }
                     return (*this);
                 }
@@ -870,6 +985,7 @@ class BluetoothControl : public PluginHost::IPlugin
                 Core::JSON::Boolean Connected;
                 Core::JSON::Boolean Bonded;
                 Core::JSON::DecUInt16 Reason;
+                Core::JSON::DecSInt8 Rssi;
             }; // class Data
 
         public:
@@ -937,6 +1053,11 @@ class BluetoothControl : public PluginHost::IPlugin
                 std::list<IBluetooth::IDevice*>::iterator _iterator;
             }; // class IteratorImpl
 
+        public:
+            // HCI reports 127 when the RSSI is not available.
+            static constexpr int8_t NoRssi = 127;
+            static constexpr int8_t RssiBucket = 8;
+
         public:
             DeviceImpl() = delete;
             DeviceImpl(const DeviceImpl&) = delete;
@@ -954,6 +1075,7 @@ class BluetoothControl : public PluginHost::IPlugin
                 , _handle(~0)
                 , _remote(remote)
                 , _uuids()
+                , _rssi(NoRssi)
                 , _capabilities(~0)
                 , _authentication(~0)
                 , _oob_data(~0)
@@ -1033,6 +1155,10 @@ class BluetoothControl : public PluginHost::IPlugin
             {
                 return (_uuids);
             }
+            int8_t Rssi() const
+            {
+                return (_rssi);
+            }
             bool IsConnected() const override
             {
                 return (_handle != static_cast<uint16_t>(~0));
@@ -1363,6 +1489,8 @@ class BluetoothControl : public PluginHost::IPlugin
 
                 _state.Lock();
 
+                const uint16_t previous = _handle;
+
                 if ( (_handle == static_cast<uint16_t>(~0)) ^ (handle == static_cast<uint16_t>(~0)) ) {
 
                     TRACE(DeviceFlow, (_T("The connection state changed to: %d"), handle));
@@ -1378,6 +1506,8 @@ class BluetoothControl : public PluginHost::IPlugin
 
                 _state.Unlock();
 
+                _parent->Reindex(this, previous, handle);
+
                 if (updated == true) {
                     UpdateListener();
                     _parent->event_devicestatechange(Address().ToString(), JsonData::BluetoothControl::DevicestatechangeParamsData::DevicestateType::CONNECTED);
@@ -1389,6 +1519,8 @@ class BluetoothControl : public PluginHost::IPlugin
 
                 _state.Lock();
 
+                const uint16_t previous = _handle;
+
                 ClearState(CONNECTING);
                 ClearState(DISCONNECTING);
                 _handle = ~0;
@@ -1404,6 +1536,8 @@ class BluetoothControl : public PluginHost::IPlugin
 
                 _state.Unlock();
 
+                _parent->Reindex(this, previous, static_cast<uint16_t>(~0));
+
                 JsonData::BluetoothControl::DevicestatechangeParamsData::DisconnectreasonType disconnReason;
                 if (reason == HCI_CONNECTION_TIMEOUT) {
                     disconnReason = JsonData::BluetoothControl::DevicestatechangeParamsData::DisconnectreasonType::CONNECTIONTIMEOUT;
@@ -1458,6 +1592,43 @@ class BluetoothControl : public PluginHost::IPlugin
                     UpdateListener();
                 }
             }
+            void UUIDs(const std::list<Bluetooth::UUID>& uuids)
+            {
+                bool updated = false;
+
+                _state.Lock();
+
+                if (uuids != _uuids) {
+                    _uuids = uuids;
+                    updated = true;
+                }
+
+                _state.Unlock();
+
+                if (updated == true) {
+                    TRACE(DeviceFlow, (_T("Device UUIDs updated, %d services"), static_cast<uint32_t>(uuids.size())));
+                    UpdateListener();
+                }
+            }
+            void Rssi(const int8_t rssi)
+            {
+                bool updated = false;
+
+                _state.Lock();
+
+                // Only a move to another bucket is worth reporting, the signal strength is never stable.
+                if ((_rssi == NoRssi) || (Bucket(_rssi, RssiBucket) != Bucket(rssi, RssiBucket))) {
+                    updated = (_rssi != NoRssi);
+                    _rssi = rssi;
+                }
+
+                _state.Unlock();
+
+                if (updated == true) {
+                    TRACE(DeviceFlow, (_T("Device RSSI updated to: %d dBm"), rssi));
+                    UpdateListener();
+                }
+            }
             void Features(const uint8_t length, const uint8_t feature[])
             {
                 bool updated = false;
@@ -1558,6 +1729,7 @@ class BluetoothControl : public PluginHost::IPlugin
             uint16_t _handle;
             Bluetooth::Address _remote;
             std::list<Bluetooth::UUID> _uuids;
+            int8_t _rssi;
             uint8_t _features[8];
             uint8_t _capabilities;
             uint8_t _authentication;
@@ -2058,6 +2230,8 @@ class BluetoothControl : public PluginHost::IPlugin
             , _btInterface(0)
             , _btAddress()
             , _devices()
+            , _addresses()
+            , _handles()
             , _observers()
         {
             RegisterAll();
@@ -2135,6 +2309,25 @@ class BluetoothControl : public PluginHost::IPlugin
         template<typename DEVICE>
         DEVICE* Find(const Bluetooth::Address& address) const;
         void RemoveDevices(std::function<bool(DeviceImpl*)> filter);
+        void Index(DeviceImpl* device);
+        void Reindex(DeviceImpl* device, const uint16_t previous, const uint16_t handle);
+        static uint64_t Key(const bdaddr_t& address)
+        {
+            uint64_t result = 0;
+            for (uint8_t index = 0; index < sizeof(address.b); index++) {
+                result = (result << 8) | address.b[index];
+            }
+            return (result);
+        }
+        static uint64_t Key(const Bluetooth::Address& address, const bool lowEnergy)
+        {
+            return (address.IsValid() == false ? 0 : ((Key(*address.Data()) << 1) | (lowEnergy ? 1 : 0)));
+        }
+        // Floor division, RSSI values are negative and truncating would make the bucket around 0 twice as wide.
+        static int8_t Bucket(const int8_t rssi, const int8_t width)
+        {
+            return (static_cast<int8_t>(rssi >= 0 ? (rssi / width) : (((rssi + 1) / width) - 1)));
+        }
         DeviceImpl* Discovered(const bool lowEnergy, const Bluetooth::Address& address, const Bluetooth::EIR& info);
         void Notification(const uint8_t subEvent, const uint16_t length, const uint8_t* dataFrame);
         void Capabilities(const Bluetooth::Address& device, const uint8_t capability, const uint8_t authentication, const uint8_t oob_data);
@@ -2183,12 +2376,15 @@ class BluetoothControl : public PluginHost::IPlugin
 
     private:
         uint8_t _skipURL;
-        Core::CriticalSection _adminLock;
+        mutable Core::CriticalSection _adminLock;
         PluginHost::IShell* _service;
         std::list<uint16_t> _adapters;
         uint16_t _btInterface;
         Bluetooth::Address _btAddress;
         std::list<DeviceImpl*> _devices;
+        // Lookup tables on the devices above, by address (+ LE flag, see Key()) and by connection handle.
+        std::unordered_map<uint64_t, DeviceImpl*> _addresses;
+        std::unordered_map<uint16_t, DeviceImpl*> _handles;
         std::list<IBluetooth::INotification*> _observers;
         Config _config;
         ControlSocket _application;
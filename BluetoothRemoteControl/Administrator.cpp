@@ -23,13 +23,20 @@ namespace WPEFramework {
 
 namespace Decoders {
 
-static std::map<Exchange::IVoiceProducer::IProfile::codec, IDecoder::IFactory*> _factories;
+// The decoders announce themselves from static initializers in other translation units, so the map is
+// constructed on first use, whatever the order the objects got linked in.
+static std::map<Exchange::IVoiceProducer::IProfile::codec, IDecoder::IFactory*>& Factories()
+{
+    static std::map<Exchange::IVoiceProducer::IProfile::codec, IDecoder::IFactory*> factories;
+    return (factories);
+}
 
 /* static */ IDecoder* IDecoder::Instance(Exchange::IVoiceProducer::IProfile::codec codec, const string& configuration)
 {
     IDecoder* result = nullptr;
-    std::map<Exchange::IVoiceProducer::IProfile::codec, IDecoder::IFactory*>::iterator index = _factories.find(codec);
-    if (index != _factories.end()) {
+    std::map<Exchange::IVoiceProducer::IProfile::codec, IDecoder::IFactory*>& factories(Factories());
+    std::map<Exchange::IVoiceProducer::IProfile::codec, IDecoder::IFactory*>::iterator index = factories.find(codec);
+    if (index != factories.end()) {
         result = index->second->Factory(configuration);
     }
     return (result);
@@ -37,7 +44,7 @@ static std::map<Exchange::IVoiceProducer::IProfile::codec, IDecoder::IFactory*>
 
 /* static */ void IDecoder::Announce(Exchange::IVoiceProducer::IProfile::codec codec, IDecoder::IFactory* factory)
 {
-    _factories.insert(std::pair<Exchange::IVoiceProducer::IProfile::codec, IDecoder::IFactory*>(codec, factory));
+    Factories().insert(std::pair<Exchange::IVoiceProducer::IProfile::codec, IDecoder::IFactory*>(codec, factory));
 }
 
 } } // namespace
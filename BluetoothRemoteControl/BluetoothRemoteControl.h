@@ -30,6 +30,8 @@
 #include <interfaces/IVoiceHandler.h>
 #include <interfaces/json/JsonData_BluetoothRemoteControl.h>
 
+#include <atomic>
+
 namespace WPEFramework {
 
 namespace Plugin {
@@ -142,34 +144,13 @@ namespace Plugin {
 
             class Decoupling : public Core::Thread {
             private:
-                class Slot {
-                public:
-                    Slot() = delete;
-                    Slot& operator= (const Slot&) = delete;
-                    Slot(const uint16_t handle, const uint8_t length, const uint8_t data[])
-                        : _handle(handle)
-                        , _data(reinterpret_cast<const char*>(data), length) {
-                    }
-                    Slot(const Slot& copy)
-                        : _handle(copy._handle)
-                        , _data(copy._data) {
-                    }
-                    ~Slot() {
-                    }
-                public:
-                    uint16_t Handle() const {
-                        return (_handle);
-                    }
-                    uint8_t Length() const {
-                        return (static_cast<uint8_t>(_data.length()));
-                    }
-                    const uint8_t* Data() const {
-                        return (reinterpret_cast<const uint8_t*>(_data.c_str()));
-                    }
+                // Number of notifications that can be pending, must be a power of 2.
+                static constexpr uint16_t Slots = 64;
 
-                private:
-                    uint16_t _handle;
-                    std::string _data;
+                struct Slot {
+                    uint16_t Handle;
+                    uint8_t Length;
+                    uint8_t Data[255];
                 };
 
             public:
@@ -177,9 +158,11 @@ namespace Plugin {
                 Decoupling& operator=(const Decoupling&) = delete;
                 Decoupling(GATTRemote* parent)
                     : _parent(*parent)
-                    , _adminLock()
-                    , _queue()
+                    , _head(0)
+                    , _tail(0)
+                    , _overflows(0)
                 {
+                    static_assert((Slots & (Slots - 1)) == 0, "Slots must be a power of 2");
                     ASSERT(parent != nullptr);
                 }
                 ~Decoupling() override
@@ -187,13 +170,25 @@ namespace Plugin {
                 }
 
             public:
+                // Single producer (the communicator thread) and single consumer (this thread), so the ring
+                // of preallocated slots needs no lock and no allocation per notification.
                 void Submit(const uint16_t handle, const uint8_t length, const uint8_t buffer[])
                 {
                     ASSERT (length > 0);
 
-                    _adminLock.Lock();
-                    _queue.emplace_back(Slot(handle, length, buffer));
-                    _adminLock.Unlock();
+                    uint32_t head = _head.load(std::memory_order_relaxed);
+
+                    if ((head - _tail.load(std::memory_order_acquire)) < Slots) {
+                        Slot& entry(_slots[head & (Slots - 1)]);
+                        entry.Handle = handle;
+                        entry.Length = length;
+                        ::memcpy(entry.Data, buffer, length);
+                        _head.store(head + 1, std::memory_order_release);
+                    }
+                    else {
+                        _overflows++;
+                        TRACE(Flow, (_T("Notification dropped, the handling does not keep up [%d]"), _overflows));
+                    }
 
                     Run();
                 }
@@ -201,13 +196,15 @@ namespace Plugin {
                 {
                     Block();
 
-                    while (_queue.size() > 0) {
+                    uint32_t tail = _tail.load(std::memory_order_relaxed);
+
+                    while (_head.load(std::memory_order_acquire) != tail) {
+                        const Slot& entry(_slots[tail & (Slots - 1)]);
+
+                        _parent.Message(entry.Handle, entry.Length, entry.Data);
 
-                        _adminLock.Lock();
-                        Slot entry (_queue.front());
-                        _queue.pop_front();
-                        _adminLock.Unlock();
-                        _parent.Message(entry.Handle(), entry.Length(), entry.Data());
+                        tail++;
+                        _tail.store(tail, std::memory_order_release);
                     }
 
                     return (Core::infinite);
@@ -215,8 +212,10 @@ namespace Plugin {
 
             private:
                 GATTRemote& _parent;
-                Core::CriticalSection _adminLock;
-                std::list<Slot> _queue;
+                std::atomic<uint32_t> _head;
+                std::atomic<uint32_t> _tail;
+                uint32_t _overflows;
+                Slot _slots[Slots];
             };
 
             class AudioProfile : public Exchange::IVoiceProducer::IProfile {
@@ -23,6 +23,87 @@ namespace WPEFramework {
 
 namespace Decoders {
 
+// IMA ADPCM, fully table driven. For every step index and every nibble the difference to apply and the
+// next step index are calculated once, so decoding a nibble is two lookups, an add and a clamp.
+class IMA {
+public:
+    static constexpr uint8_t Steps = 89;
+
+private:
+    IMA()
+    {
+        static const int8_t IndexLUT[] = {
+            -1, -1, -1, -1, 2, 4, 6, 8,
+            -1, -1, -1, -1, 2, 4, 6, 8
+        };
+
+        static const uint16_t StepSizeLUT[] = {
+            7,     8,     9,     10,    11,    12,    13,    14,
+            16,    17,    19,    21,    23,    25,    28,    31,
+            34,    37,    41,    45,    50,    55,    60,    66,
+            73,    80,    88,    97,    107,   118,   130,   143,
+            157,   173,   190,   209,   230,   253,   279,   307,
+            337,   371,   408,   449,   494,   544,   598,   658,
+            724,   796,   876,   963,   1060,  1166,  1282,  1411,
+            1552,  1707,  1878,  2066,  2272,  2499,  2749,  3024,
+            3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,
+            7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+            15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+            32767
+        };
+
+        for (uint8_t index = 0; index < Steps; index++) {
+            const int32_t step = StepSizeLUT[index];
+
+            for (uint8_t nibble = 0; nibble < 16; nibble++) {
+                int32_t difference = (step >> 3);
+                int32_t next = index + IndexLUT[nibble];
+
+                if ((nibble & 4) != 0) {
+                    difference += step;
+                }
+                if ((nibble & 2) != 0) {
+                    difference += (step >> 1);
+                }
+                if ((nibble & 1) != 0) {
+                    difference += (step >> 2);
+                }
+
+                _difference[index][nibble] = ((nibble & 8) != 0 ? -difference : difference);
+                _next[index][nibble] = static_cast<uint8_t>(next < 0 ? 0 : (next >= Steps ? (Steps - 1) : next));
+            }
+        }
+    }
+
+public:
+    IMA(const IMA&) = delete;
+    IMA& operator= (const IMA&) = delete;
+
+    static const IMA& Instance()
+    {
+        static IMA singleton;
+        return (singleton);
+    }
+
+public:
+    inline int16_t Decode(const uint8_t nibble, int32_t& predictor, uint8_t& index) const
+    {
+        int32_t value = predictor + _difference[index][nibble];
+
+        // Saturate to the range of the output sample.
+        value = std::max(static_cast<int32_t>(-32768), std::min(value, static_cast<int32_t>(32767)));
+
+        predictor = value;
+        index = _next[index][nibble];
+
+        return (static_cast<int16_t>(value));
+    }
+
+private:
+    int32_t _difference[Steps][16];
+    uint8_t _next[Steps][16];
+};
+
 class EXTERNAL ADPCM : public IDecoder {
 private:
     const uint8_t  WindowSize = 32;
@@ -112,7 +193,7 @@ public:
             // Add the incoming buffer with the preamble built from the header notification
             ::memcpy(&(dataOut[sizeof(Preamble)]), dataIn, result);
 
-            result = sizeof(Preamble) + lengthIn;
+            result += sizeof(Preamble);
         }
 
         return (result);
@@ -129,10 +210,17 @@ public:
 
 static DecoderFactory<ADPCM> _adpcmFactory;
 
+// Decodes the IMA ADPCM stream of the remote into 16 bits PCM samples. Frames that got lost on the
+// air are concealed by repeating the last decoded frame with a decaying amplitude.
 class EXTERNAL PCM : public IDecoder {
 private:
     const uint8_t  WindowSize = 32;
 
+    // Maximum number of samples kept of the last frame, for concealment of lost frames.
+    static constexpr uint16_t MaxFrameSamples = 256;
+    // Lost frames beyond this are not concealed anymore, there is nothing left to hear.
+    static constexpr uint8_t MaxConcealedFrames = 4;
+
 public:
     static constexpr Exchange::IVoiceProducer::IProfile::codec DecoderType = Exchange::IVoiceProducer::IProfile::codec::PCM;
 
@@ -141,7 +229,15 @@ public:
     PCM(const PCM&) = delete;
     PCM& operator= (const PCM&) = delete;
 
-    PCM(const string&) {
+    PCM(const string&)
+        : _ima(IMA::Instance())
+        , _PV_dec(0)
+        , _SI_dec(0)
+        , _nextFrame(0)
+        , _frames(~0)
+        , _dropped(~0)
+        , _lost(0)
+        , _lastSamples(0) {
     }
     ~PCM() {
     }
@@ -158,33 +254,39 @@ public:
         _SI_dec = 0;
         _frames = ~0;
         _dropped = ~0;
+        _lost = 0;
+        _lastSamples = 0;
     }
     uint16_t Decode (const uint16_t lengthIn, const uint8_t dataIn[], const uint16_t lengthOut, uint8_t dataOut[]) override {
 
         uint16_t result = 0;
 
 	if (lengthIn == 5) {
-            unsigned char seqNum = (unsigned char)dataIn[0];
+            uint8_t seqNum = dataIn[0];
 
-            // Always use received PV and SI
+            // Always use received PV and SI, this resynchronizes the decoder after a lost frame.
             _PV_dec = static_cast<int16_t>((dataIn[3] << 8) | dataIn[2]);
-            _SI_dec = dataIn[1];
+            _SI_dec = (dataIn[1] < IMA::Steps ? dataIn[1] : (IMA::Steps - 1));
 
             // Is this the first frame we encounter ?
             if (_dropped != static_cast<uint32_t>(~0)) {
+                uint8_t lost = 0;
+
                 // Is it a next frame, see if we dropped frames..
-                if (dataIn[0] > _nextFrame) {
-                    _dropped += dataIn[0] - _nextFrame;
+                if (seqNum > _nextFrame) {
+                    lost = seqNum - _nextFrame;
                 }
                 else if (seqNum < _nextFrame) {
-                    _dropped += dataIn[0] + (WindowSize - _nextFrame);
+                    lost = seqNum + (WindowSize - _nextFrame);
                 }
+                _dropped += lost;
+                _lost += lost;
                 _frames++;
             }
             else {
                 _frames = 0;
             }
-            _nextFrame = (dataIn[0] + 1) % WindowSize;
+            _nextFrame = (seqNum + 1) % WindowSize;
         }
         else if (lengthIn == 1) {
             // This is a footer, so what :-)
@@ -195,107 +297,74 @@ public:
                 _dropped = 0;
             }
 
-            result = DecodeStream(lengthIn, dataIn, lengthOut, dataOut);
+            int16_t* output = reinterpret_cast<int16_t*>(dataOut);
+            uint16_t samples = (lengthOut / sizeof(int16_t));
+            uint16_t concealed = 0;
+
+            if (_lost > 0) {
+                concealed = Conceal(samples, output);
+                _lost = 0;
+            }
+
+            result = (concealed + DecodeStream(lengthIn, dataIn, samples - concealed, &(output[concealed]))) * sizeof(int16_t);
         }
         return (result);
     }
 
 private:
-    int16_t DecodeNibble (const uint8_t nibble) {
-
-        static const int8_t IndexLUT[] = {
-            -1, -1, -1, -1, 2, 4, 6, 8,
-            -1, -1, -1, -1, 2, 4, 6, 8
-        };
-
-        static const uint16_t StepSizeLUT[] = {
-            7,     8,     9,     10,    11,    12,    13,    14,
-            16,    17,    19,    21,    23,    25,    28,    31,
-            34,    37,    41,    45,    50,    55,    60,    66,
-            73,    80,    88,    97,    107,   118,   130,   143,
-            157,   173,   190,   209,   230,   253,   279,   307,
-            337,   371,   408,   449,   494,   544,   598,   658,
-            724,   796,   876,   963,   1060,  1166,  1282,  1411,
-            1552,  1707,  1878,  2066,  2272,  2499,  2749,  3024,
-            3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,
-            7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
-            15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
-            32767
-        };
-
-        uint16_t step = StepSizeLUT[_SI_dec];
-        uint16_t cum_diff = step >> 3;
-
-        _SI_dec += IndexLUT[nibble];
-
-        if (_SI_dec < 0) {
-            _SI_dec = 0;
-        }
-        else if (_SI_dec > 88) {
-            _SI_dec = 88;
-        }
+    // Fills the gap of the lost frames with the last frame, halving the amplitude on every repetition.
+    uint16_t Conceal(const uint16_t maxSamples, int16_t output[])
+    {
+        uint16_t result = 0;
+        uint8_t frames = (_lost > MaxConcealedFrames ? MaxConcealedFrames : _lost);
 
-        if ((nibble & 4) != 0) {
-            cum_diff += step;
-        }
-        if ((nibble & 2) != 0) {
-            cum_diff += step >> 1;
-        }
-        if ((nibble & 1) != 0) {
-            cum_diff += step >> 2;
-        }
-        if ((nibble & 8) != 0) {
-            if (_PV_dec < (-32767 + cum_diff)) {
-                _PV_dec = -32767;
-            }
-            else {
-                _PV_dec -= cum_diff;
+        for (uint8_t frame = 1; (frame <= frames) && ((result + _lastSamples) <= maxSamples); frame++) {
+            for (uint16_t index = 0; index < _lastSamples; index++) {
+                output[result++] = static_cast<int16_t>(_lastFrame[index] >> frame);
             }
         }
-        else {
-            if (_PV_dec > (0x7fff - cum_diff)) {
-                _PV_dec = 0x7fff;
-            }
-            else {
-                _PV_dec += cum_diff;
-	    }
-        }
-        return (_PV_dec);
+
+        return (result);
     }
-    uint16_t DecodeStream(const uint16_t lengthIn, const uint8_t dataIn[], const uint16_t lengthOut, uint8_t dataOut[])
+    uint16_t DecodeStream(const uint16_t lengthIn, const uint8_t dataIn[], const uint16_t maxSamples, int16_t output[])
     {
-        // TODO: check lengthOut
-        uint16_t maxStorage = (lengthOut / 4);
-        int16_t* output = reinterpret_cast<int16_t*>(dataOut);
+        int32_t predictor = _PV_dec;
+        uint8_t index = _SI_dec;
+        uint16_t length = std::min(lengthIn, static_cast<uint16_t>(maxSamples / 2));
+        uint16_t result = 0;
+
+        for (uint16_t loop = 0; loop < length; loop++) {
+            const uint8_t byte = dataIn[loop];
+
+            output[result++] = _ima.Decode(byte & 0xF, predictor, index);
+            output[result++] = _ima.Decode(byte >> 4, predictor, index);
+   	}
 
-        for (uint16_t index = 0; index < lengthIn; index++)
-        {
-            uint8_t byte = dataIn[index];
+        if ((length < lengthIn) && (result < maxSamples)) {
+            // Room for one more sample only.
+            output[result++] = _ima.Decode(dataIn[length] & 0xF, predictor, index);
+        }
 
-            int16_t dec1 = DecodeNibble(byte & 0xF);
-            int16_t dec2 = DecodeNibble((byte >> 4) & 0xF);
+        _PV_dec = static_cast<int16_t>(predictor);
+        _SI_dec = index;
 
-            if (maxStorage >= 2) {
+        // Remember this frame, in case the next one(s) get lost.
+        _lastSamples = (result > MaxFrameSamples ? MaxFrameSamples : result);
+        ::memcpy(_lastFrame, &(output[result - _lastSamples]), _lastSamples * sizeof(int16_t));
 
-                // Add the new bytes
-                *output++ = dec1;
-                *output++ = dec2;
-                maxStorage -= 2;
-            }
-            else if (maxStorage >= 1) {
-                *output++ = dec1;
-                maxStorage -= 1;
-            }
-   	}
-        return (lengthIn * 4);
+        return (result);
     }
 
 private:
+    const IMA& _ima;
     int16_t  _PV_dec;
-    int8_t   _SI_dec;
+    uint8_t  _SI_dec;
     uint8_t  _nextFrame;
     uint32_t _frames;
     uint32_t _dropped;
+    uint8_t  _lost;
+    uint16_t _lastSamples;
+    int16_t  _lastFrame[MaxFrameSamples];
 };
 
 static DecoderFactory<PCM> _pcmFactory;
@@ -48,13 +48,15 @@ namespace Plugin {
     {
 
         Register<Plugin::Command::PluginControl>();
-        Register<Plugin::Command::PluginObserver>();
+        RegisterWaitable<Plugin::Command::PluginObserver>();
+        RegisterWaitable<Plugin::Command::Delay>();
     }
 
     /* virtual */ Commander::~Commander()
     {
         Unregister<Plugin::Command::PluginControl>();
-        Unregister<Plugin::Command::PluginObserver>();
+        UnregisterWaitable<Plugin::Command::PluginObserver>();
+        UnregisterWaitable<Plugin::Command::Delay>();
     }
 
     /* virtual */ const string Commander::Initialize(PluginHost::IShell* service)
@@ -93,10 +95,9 @@ namespace Plugin {
 
         while (index != _sequencers.end()) {
 
-            Core::ProxyType<Core::IDispatchType<void>> job(Core::proxy_cast<Core::IDispatchType<void>>(index->second));
-
+            // The sequencer needs to run once more to wind down, steps might still be reporting back.
             index->second->Abort();
-            Core::IWorkerPool::Instance().Revoke(job);
+            index->second->Wait(Core::infinite);
 
             index++;
         }
@@ -203,12 +204,11 @@ namespace Plugin {
             } else {
                 // Current name, is the name of the sequencer
                 Core::ProxyType<Sequencer> sequencer(_sequencers[index.Current().Text()]);
-                Core::ProxyType<Core::IDispatchType<void>> job(Core::proxy_cast<Core::IDispatchType<void>>(sequencer));
 
                 if (sequencer->Abort() != Core::ERROR_NONE) {
                     response->ErrorCode = Web::STATUS_NO_CONTENT;
                     response->Message = _T("Sequencer was not in a running state");
-                } else if (Core::IWorkerPool::Instance().Revoke(job, 2000) == Core::ERROR_NONE) {
+                } else if (sequencer->Wait(2000) == Core::ERROR_NONE) {
                     response->ErrorCode = Web::STATUS_OK;
                     response->Message = _T("Sequencer available for next sequence");
                 } else {
@@ -260,6 +260,8 @@ namespace Plugin {
             data.Index = sequencer.Index();
         }
 
+        sequencer.Timings(data.Steps);
+
         return (data);
     }
 
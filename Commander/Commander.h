@@ -21,6 +21,7 @@
 #define __COMMANDER_H
 
 #include "Module.h"
+#include "Commands.h"
 #include <interfaces/ICommand.h>
 
 namespace WPEFramework {
@@ -41,20 +42,24 @@ namespace Plugin {
                 , Item()
                 , Label()
                 , Parameters(false)
+                , Group()
             {
                 Add(_T("command"), &Item);
                 Add(_T("label"), &Label);
                 Add(_T("parameters"), &Parameters);
+                Add(_T("group"), &Group);
             }
             Command(const Command& copy)
                 : Core::JSON::Container()
                 , Item(copy.Item)
                 , Label(copy.Label)
                 , Parameters(copy.Parameters)
+                , Group(copy.Group)
             {
                 Add(_T("command"), &Item);
                 Add(_T("label"), &Label);
                 Add(_T("parameters"), &Parameters);
+                Add(_T("group"), &Group);
             }
             ~Command()
             {
@@ -65,6 +70,7 @@ namespace Plugin {
                 Item = RHS.Item;
                 Label = RHS.Label;
                 Parameters = RHS.Parameters;
+                Group = RHS.Group;
 
                 return (*this);
             }
@@ -73,6 +79,82 @@ namespace Plugin {
             Core::JSON::String Item;
             Core::JSON::String Label;
             Core::JSON::String Parameters;
+            Core::JSON::String Group; // Consecutive commands of the same group run in parallel
+        };
+
+        class Timing : public Core::JSON::Container {
+        public:
+            Timing()
+                : Core::JSON::Container()
+            {
+                Add(_T("label"), &Label);
+                Add(_T("command"), &Command);
+                Add(_T("group"), &Group);
+                Add(_T("start"), &Start);
+                Add(_T("duration"), &Duration);
+                Add(_T("result"), &Result);
+                Add(_T("critical"), &Critical);
+            }
+            Timing(const string& label, const string& command, const string& group)
+                : Core::JSON::Container()
+            {
+                Add(_T("label"), &Label);
+                Add(_T("command"), &Command);
+                Add(_T("group"), &Group);
+                Add(_T("start"), &Start);
+                Add(_T("duration"), &Duration);
+                Add(_T("result"), &Result);
+                Add(_T("critical"), &Critical);
+
+                Label = label;
+                Command = command;
+                if (group.empty() == false) {
+                    Group = group;
+                }
+            }
+            Timing(const Timing& copy)
+                : Core::JSON::Container()
+                , Label(copy.Label)
+                , Command(copy.Command)
+                , Group(copy.Group)
+                , Start(copy.Start)
+                , Duration(copy.Duration)
+                , Result(copy.Result)
+                , Critical(copy.Critical)
+            {
+                Add(_T("label"), &Label);
+                Add(_T("command"), &Command);
+                Add(_T("group"), &Group);
+                Add(_T("start"), &Start);
+                Add(_T("duration"), &Duration);
+                Add(_T("result"), &Result);
+                Add(_T("critical"), &Critical);
+            }
+            ~Timing()
+            {
+            }
+
+            Timing& operator=(const Timing& RHS)
+            {
+                Label = RHS.Label;
+                Command = RHS.Command;
+                Group = RHS.Group;
+                Start = RHS.Start;
+                Duration = RHS.Duration;
+                Result = RHS.Result;
+                Critical = RHS.Critical;
+
+                return (*this);
+            }
+
+        public:
+            Core::JSON::String Label;
+            Core::JSON::String Command;
+            Core::JSON::String Group;
+            Core::JSON::DecUInt32 Start; // ms since the start of the sequence
+            Core::JSON::DecUInt32 Duration; // ms, not set while the step is running
+            Core::JSON::String Result;
+            Core::JSON::Boolean Critical; // This step kept the next stage waiting
         };
 
         class Data : public Core::JSON::Container {
@@ -85,6 +167,7 @@ namespace Plugin {
                 Add(_T("index"), &Index);
                 Add(_T("label"), &Label);
                 Add(_T("command"), &Command);
+                Add(_T("steps"), &Steps);
             }
             Data(const string& name, const state actualState, const uint32_t index, const string& label)
                 : Core::JSON::Container()
@@ -94,6 +177,7 @@ namespace Plugin {
                 Add(_T("index"), &Index);
                 Add(_T("label"), &Label);
                 Add(_T("command"), &Command);
+                Add(_T("steps"), &Steps);
 
                 Sequencer = name;
                 State = actualState;
@@ -107,12 +191,14 @@ namespace Plugin {
                 , Index(copy.Index)
                 , Label(copy.Label)
                 , Command(copy.Command)
+                , Steps(copy.Steps)
             {
                 Add(_T("sequencer"), &Sequencer);
                 Add(_T("state"), &State);
                 Add(_T("index"), &Index);
                 Add(_T("label"), &Label);
                 Add(_T("Command"), &Command);
+                Add(_T("steps"), &Steps);
             }
             ~Data()
             {
@@ -125,6 +211,7 @@ namespace Plugin {
                 Index = RHS.Index;
                 Label = RHS.Label;
                 Command = RHS.Command;
+                Steps = RHS.Steps;
 
                 return (*this);
             }
@@ -135,6 +222,7 @@ namespace Plugin {
             Core::JSON::DecUInt32 Index;
             Core::JSON::String Label;
             Core::JSON::String Command;
+            Core::JSON::ArrayType<Timing> Steps;
         };
 
     private:
@@ -163,11 +251,13 @@ namespace Plugin {
 
         public:
             typedef Core::IteratorMapType<std::map<const string, Exchange::ICommand::IFactory*>, Exchange::ICommand::IFactory*, const string, std::map<const string, Exchange::ICommand::IFactory*>::iterator> Iterator;
+            typedef Plugin::Command::IWaitable* (*WaitableFactory)(const string& parameters);
 
         public:
             Administrator()
                 : _adminLock()
                 , _factory()
+                , _waitables()
             {
             }
             ~Administrator()
@@ -209,6 +299,25 @@ namespace Plugin {
 
                 return (result);
             }
+            // Commands that can also be armed, next to their registration as a blocking command.
+            inline void Register(const string& className, WaitableFactory factory)
+            {
+                _adminLock.Lock();
+
+                ASSERT(_waitables.find(className) == _waitables.end());
+
+                _waitables.insert(std::pair<const string, WaitableFactory>(className, factory));
+
+                _adminLock.Unlock();
+            }
+            inline void Revoke(const string& className)
+            {
+                _adminLock.Lock();
+
+                _waitables.erase(className);
+
+                _adminLock.Unlock();
+            }
             Core::ProxyType<Exchange::ICommand> Create(const string& label, const string& className, const string& parameters)
             {
                 Core::ProxyType<Exchange::ICommand> result;
@@ -227,6 +336,23 @@ namespace Plugin {
 
                 return (result);
             }
+            // Returns nullptr if the class can only be executed as a blocking command.
+            Plugin::Command::IWaitable* Arm(const string& className, const string& parameters)
+            {
+                Plugin::Command::IWaitable* result = nullptr;
+
+                _adminLock.Lock();
+
+                std::map<const string, WaitableFactory>::iterator index(_waitables.find(className));
+
+                if (index != _waitables.end()) {
+                    result = index->second(parameters);
+                }
+
+                _adminLock.Unlock();
+
+                return (result);
+            }
 
             Iterator Commands()
             {
@@ -236,22 +362,93 @@ namespace Plugin {
         private:
             Core::CriticalSection _adminLock;
             std::map<const string, Exchange::ICommand::IFactory*> _factory;
+            std::map<const string, WaitableFactory> _waitables;
         };
-        class Sequencer : public Core::IDispatchType<void> {
+        class Sequencer : public Core::IDispatchType<void>, public Plugin::Command::IWaitable::ICallback {
         private:
             Sequencer() = delete;
             Sequencer(const Sequencer& copy) = delete;
             Sequencer& operator=(const Sequencer&) = delete;
 
+            // A single entry of the loaded sequence. Steps that can wait without a thread (observers, delays)
+            // are created by the engine itself, all others are ICommands, executed on a worker pool thread.
+            class Step {
+            public:
+                Step() = delete;
+                Step& operator=(const Step&) = delete;
+
+                Step(const string& label, const string& group, const string& type, const Core::ProxyType<Exchange::ICommand>& command, Plugin::Command::IWaitable* waitable)
+                    : Label(label)
+                    , Group(group)
+                    , Type(type)
+                    , Command(command)
+                    , Waitable(waitable)
+                {
+                }
+                Step(const Step& copy)
+                    : Label(copy.Label)
+                    , Group(copy.Group)
+                    , Type(copy.Type)
+                    , Command(copy.Command)
+                    , Waitable(copy.Waitable)
+                {
+                }
+                ~Step()
+                {
+                }
+
+            public:
+                string Label;
+                string Group;
+                string Type;
+                Core::ProxyType<Exchange::ICommand> Command;
+                Plugin::Command::IWaitable* Waitable;
+            };
+
+            // Runs one blocking step on a worker pool thread and reports back to the sequencer.
+            class Job : public Core::IDispatchType<void> {
+            private:
+                Job() = delete;
+                Job(const Job&) = delete;
+                Job& operator=(const Job&) = delete;
+
+            public:
+                Job(Sequencer& parent, const Core::ProxyType<Exchange::ICommand>& command, const uint32_t index)
+                    : _parent(parent)
+                    , _command(command)
+                    , _index(index)
+                {
+                }
+                ~Job()
+                {
+                }
+
+            private:
+                virtual void Dispatch()
+                {
+                    _parent.Completed(_index, _command->Execute(_parent._service));
+                }
+
+            private:
+                Sequencer& _parent;
+                Core::ProxyType<Exchange::ICommand> _command;
+                const uint32_t _index;
+            };
+
         public:
             Sequencer(const string& name, Administrator* commandFactory, PluginHost::IShell* service)
                 : _commandFactory(commandFactory)
                 , _adminLock()
                 , _currentIndex(0)
+                , _stageEnd(0)
+                , _outstanding(0)
                 , _state(Commander::IDLE)
                 , _name(name)
                 , _service(service)
-                , _sequenceList(5)
+                , _steps()
+                , _timings()
+                , _started(0)
+                , _idle(true, false)
             {
                 ASSERT(service != nullptr);
 
@@ -264,6 +461,8 @@ namespace Plugin {
                 // Make sure we are not executing anything if we get destructed.
                 Abort();
 
+                Clear();
+
                 if (_service != nullptr) {
                     _service->Release();
                 }
@@ -305,15 +504,26 @@ namespace Plugin {
 
                 _adminLock.Lock();
 
-                if ((_state != Commander::IDLE) && (_state != Commander::LOADED) && (_currentIndex < _sequenceList.Count())) {
+                if ((_state != Commander::IDLE) && (_state != Commander::LOADED) && (_currentIndex < _steps.size())) {
 
-                    result = _sequenceList[_currentIndex]->Label();
+                    result = _steps[_currentIndex].Label;
                 }
 
                 _adminLock.Unlock();
 
                 return (result);
             }
+            // Timing of the steps of the running, or last, sequence. Offsets are relative to the start of the sequence.
+            void Timings(Core::JSON::ArrayType<Commander::Timing>& timings) const
+            {
+                _adminLock.Lock();
+
+                for (const Commander::Timing& timing : _timings) {
+                    timings.Add(timing);
+                }
+
+                _adminLock.Unlock();
+            }
             uint32_t Load(const Core::JSON::ArrayType<Command>& commandList)
             {
 
@@ -326,9 +536,7 @@ namespace Plugin {
 
                     ASSERT(_commandFactory != nullptr);
 
-                    if (_sequenceList.Count() > 0) {
-                        _sequenceList.Clear(0, _sequenceList.Count());
-                    }
+                    Clear();
 
                     Core::JSON::ArrayType<Command>::ConstIterator index(commandList.Elements());
 
@@ -337,23 +545,32 @@ namespace Plugin {
                         const string& label(index.Current().Label.Value());
                         const string& className(index.Current().Item.Value());
                         const string& parameters(index.Current().Parameters.Value());
+                        const string& group(index.Current().Group.Value());
+
+                        // Steps that only wait are driven by the engine, they do not need a thread.
+                        Plugin::Command::IWaitable* waitable = _commandFactory->Arm(className, parameters);
 
-                        Core::ProxyType<Exchange::ICommand> newCommand(_commandFactory->Create(label, className, parameters));
+                        if (waitable != nullptr) {
+                            _steps.push_back(Step(label, group, className, Core::ProxyType<Exchange::ICommand>(), waitable));
+                        } else {
+                            Core::ProxyType<Exchange::ICommand> newCommand(_commandFactory->Create(label, className, parameters));
 
-                        if (newCommand.IsValid() == true) {
-                            _sequenceList.Add(newCommand);
+                            if (newCommand.IsValid() == true) {
+                                _steps.push_back(Step(label, group, className, newCommand, nullptr));
+                            }
                         }
                     }
 
-                    if (_sequenceList.Count() > 0) {
+                    if (_steps.size() > 0) {
                         _state = Commander::LOADED;
                         _currentIndex = 0;
+                        _stageEnd = 0;
                     }
                 }
 
                 _adminLock.Unlock();
 
-                return (_sequenceList.Count());
+                return (static_cast<uint32_t>(_steps.size()));
             }
             uint32_t Execute()
             {
@@ -365,6 +582,9 @@ namespace Plugin {
                 if (_state == Commander::LOADED) {
                     result = Core::ERROR_NONE;
                     _state = Commander::RUNNING;
+                    _idle.ResetEvent();
+                    _timings.clear();
+                    _started = Core::Time::Now().Ticks();
                 }
 
                 _adminLock.Unlock();
@@ -374,85 +594,270 @@ namespace Plugin {
             uint32_t Abort()
             {
                 uint32_t result = Core::ERROR_ILLEGAL_STATE;
+                std::list<Core::ProxyType<Exchange::ICommand>> commands;
+                std::list<Plugin::Command::IWaitable*> waitables;
 
                 _adminLock.Lock();
 
                 if (_state == Commander::RUNNING) {
                     result = Core::ERROR_NONE;
                     _state = Commander::ABORTING;
-                    _sequenceList[_currentIndex]->Abort();
+
+                    // Everything of the current stage that did not report yet, has to be stopped.
+                    for (uint32_t index = _currentIndex; index < _stageEnd; index++) {
+                        if (_timings[index].Duration.IsSet() == false) {
+                            if (_steps[index].Waitable != nullptr) {
+                                waitables.push_back(_steps[index].Waitable);
+                            } else {
+                                commands.push_back(_steps[index].Command);
+                            }
+                        }
+                    }
                 }
 
                 _adminLock.Unlock();
 
+                for (Core::ProxyType<Exchange::ICommand>& command : commands) {
+                    command->Abort();
+                }
+                for (Plugin::Command::IWaitable* waitable : waitables) {
+                    waitable->Abort();
+                }
+
                 // Wait for the sequencer to reaach a safe positon..
                 return (result);
             }
+            // Waits until the sequencer is no longer running or aborting.
+            uint32_t Wait(const uint32_t waitTime) const
+            {
+                return (_idle.Lock(waitTime));
+            }
+
+            // A step of the current stage is done, called from any thread.
+            virtual void Completed(const uint32_t index, const string& result) override
+            {
+                _adminLock.Lock();
+
+                if ((index < _timings.size()) && (_timings[index].Duration.IsSet() == false)) {
+                    const uint64_t now = Core::Time::Now().Ticks();
+
+                    _timings[index].Duration = static_cast<uint32_t>((now - _started) / 1000) - _timings[index].Start.Value();
+                    _timings[index].Result = result;
+
+                    Settle();
+                }
+
+                _adminLock.Unlock();
+            }
 
         private:
+            // Takes the next step(s). Never blocks for a step: blocking steps are handed to the worker pool, waiting
+            // steps are armed, and the sequencer is resubmitted once the whole stage reported back.
             virtual void Dispatch()
             {
                 _adminLock.Lock();
 
-                // See if we still need to take some "next steps"
-                while ((_currentIndex < _sequenceList.Count()) && (_state == Commander::RUNNING)) {
+                ASSERT(_outstanding == 0);
+
+                std::list<Plugin::Command::IWaitable*> waitables;
+
+                // Release what the previous stage was waiting on, outside of our lock, as that might be reporting.
+                for (uint32_t index = _currentIndex; index < _stageEnd; index++) {
+                    if (_steps[index].Waitable != nullptr) {
+                        waitables.push_back(_steps[index].Waitable);
+                    }
+                }
+
+                _adminLock.Unlock();
+
+                for (Plugin::Command::IWaitable* waitable : waitables) {
+                    waitable->Disarm(_service);
+                }
+
+                _adminLock.Lock();
+
+                if (_stageEnd != 0) {
+                    Next();
+                }
+
+                if ((_currentIndex < _steps.size()) && (_state == Commander::RUNNING)) {
+
+                    const uint32_t start = static_cast<uint32_t>((Core::Time::Now().Ticks() - _started) / 1000);
 
-                    Core::ProxyType<Exchange::ICommand> step(_sequenceList[_currentIndex]);
+                    // A stage is a single step, or all consecutive steps of the same group, they run in parallel.
+                    _stageEnd = _currentIndex + 1;
+
+                    if (_steps[_currentIndex].Group.empty() == false) {
+                        while ((_stageEnd < _steps.size()) && (_steps[_stageEnd].Group == _steps[_currentIndex].Group)) {
+                            _stageEnd++;
+                        }
+                    }
+
+                    std::list<std::pair<Plugin::Command::IWaitable*, uint32_t>> armed;
+
+                    // One extra, for ourselves, so the stage can not complete before it is completely started.
+                    _outstanding = (_stageEnd - _currentIndex) + 1;
+
+                    for (uint32_t index = _currentIndex; index < _stageEnd; index++) {
+                        Commander::Timing& timing(Track(index));
+
+                        timing.Start = start;
+
+                        if (_steps[index].Waitable != nullptr) {
+                            armed.push_back(std::pair<Plugin::Command::IWaitable*, uint32_t>(_steps[index].Waitable, index));
+                        } else {
+                            Core::ProxyType<Core::IDispatchType<void>> job(Core::proxy_cast<Core::IDispatchType<void>>(Core::ProxyType<Job>::Create(*this, _steps[index].Command, index)));
+                            Core::IWorkerPool::Instance().Submit(job);
+                        }
+                    }
 
                     _adminLock.Unlock();
 
-                    const string result = step->Execute(_service);
+                    for (const std::pair<Plugin::Command::IWaitable*, uint32_t>& entry : armed) {
+                        entry.first->Arm(_service, this, entry.second);
+                    }
 
                     _adminLock.Lock();
 
-                    if (result.empty() == true) {
-                        _currentIndex++;
-                    } else {
-                        uint32_t index = _currentIndex + 1;
+                    // An abort that came in while arming could not reach the steps that were not armed yet.
+                    if (_state == Commander::ABORTING) {
+                        _adminLock.Unlock();
 
-                        // See if we have a forward label, as mentioned from the execute
-                        while ((index < _sequenceList.Count()) && (_sequenceList[index]->Label() != result)) {
-                            index++;
+                        for (const std::pair<Plugin::Command::IWaitable*, uint32_t>& entry : armed) {
+                            entry.first->Abort();
                         }
 
-                        if (index < _sequenceList.Count()) {
-                            // Seems like we found a next step, set it..
-                            _currentIndex = index;
-                        } else {
-                            // There are no steps before our current step, so no label found, just progress...
-                            _currentIndex++;
+                        _adminLock.Lock();
+                    }
 
-                            // But let's check if there is a step before us (or we are ourselves :-), we might need to jump to..
-                            index = _currentIndex;
+                    Settle();
 
-                            // Check if we have a step with the given label prior to our current step..
-                            while ((index > 0) && (_sequenceList[index - 1]->Label() != result)) {
-                                index--;
-                            }
+                } else {
 
-                            if (index > 0) {
-                                _currentIndex = (index - 1);
-                            }
+                    ASSERT((_state == Commander::RUNNING) || (_state == Commander::ABORTING));
+
+                    TRACE_L1("Sequencer %s completed in %d ms", _name.c_str(), static_cast<uint32_t>((Core::Time::Now().Ticks() - _started) / 1000));
+
+                    _state = IDLE;
+
+                    Clear();
+
+                    _idle.SetEvent();
+                }
+
+                _adminLock.Unlock();
+            }
+
+            // Called with the lock taken, once the last step of a stage reported, the next stage can be taken.
+            void Settle()
+            {
+                ASSERT(_outstanding > 0);
+
+                _outstanding--;
+
+                if (_outstanding == 0) {
+                    Core::ProxyType<Core::IDispatchType<void>> job(*this);
+
+                    Core::IWorkerPool::Instance().Submit(job);
+                }
+            }
+
+            // Called with the lock taken, determines the first step after the stage that just completed.
+            void Next()
+            {
+                string result;
+                uint64_t last = 0;
+
+                // The first step that returned a label decides the jump, the step that finished last is the one
+                // that kept the sequence waiting.
+                for (uint32_t index = _currentIndex; index < _stageEnd; index++) {
+                    Commander::Timing& timing(_timings[index]);
+                    const uint64_t finished = timing.Start.Value() + timing.Duration.Value();
+
+                    if ((result.empty() == true) && (timing.Result.Value().empty() == false)) {
+                        result = timing.Result.Value();
+                    }
+                    if ((index == _currentIndex) || (finished > last)) {
+                        last = finished;
+                    }
+                }
+                for (uint32_t index = _currentIndex; index < _stageEnd; index++) {
+                    Commander::Timing& timing(_timings[index]);
+                    timing.Critical = ((timing.Start.Value() + timing.Duration.Value()) == last);
+                }
+
+                if (result.empty() == true) {
+                    _currentIndex = _stageEnd;
+                } else {
+                    uint32_t index = _stageEnd;
+
+                    // See if we have a forward label, as mentioned from the execute
+                    while ((index < _steps.size()) && (_steps[index].Label != result)) {
+                        index++;
+                    }
+
+                    if (index < _steps.size()) {
+                        // Seems like we found a next step, set it..
+                        _currentIndex = index;
+                    } else {
+                        // No label found after this stage, just progress...
+                        _currentIndex = _stageEnd;
+
+                        // But let's check if there is a step before us (or we are ourselves :-), we might need to jump to..
+                        index = _stageEnd;
+
+                        while ((index > 0) && (_steps[index - 1].Label != result)) {
+                            index--;
+                        }
+
+                        if (index > 0) {
+                            _currentIndex = (index - 1);
                         }
                     }
                 }
+            }
+
+            // Called with the lock taken, a step that is executed again in a loop gets its timing overwritten.
+            Commander::Timing& Track(const uint32_t index)
+            {
+                while (_timings.size() <= index) {
+                    const Step& step(_steps[_timings.size()]);
 
-                ASSERT((_state == Commander::RUNNING) || (_state == Commander::ABORTING));
-                _state = IDLE;
+                    _timings.push_back(Commander::Timing(step.Label, step.Type, step.Group));
+                }
 
-                _sequenceList.Clear(0, _sequenceList.Count());
+                _timings[index].Duration.Clear();
+                _timings[index].Result.Clear();
+                _timings[index].Critical.Clear();
 
-                _adminLock.Unlock();
+                return (_timings[index]);
+            }
+
+            void Clear()
+            {
+                for (Step& step : _steps) {
+                    if (step.Waitable != nullptr) {
+                        delete step.Waitable;
+                    }
+                }
+                _steps.clear();
+                _currentIndex = 0;
+                _stageEnd = 0;
             }
 
         private:
             Administrator* _commandFactory;
             mutable Core::CriticalSection _adminLock;
-            uint32_t _currentIndex;
+            uint32_t _currentIndex; // First step of the running stage
+            uint32_t _stageEnd; // One past the last step of the running stage
+            uint32_t _outstanding;
             state _state;
             string _name;
             PluginHost::IShell* _service;
-            Core::ProxyList<Exchange::ICommand> _sequenceList;
+            std::vector<Step> _steps;
+            std::vector<Commander::Timing> _timings;
+            uint64_t _started;
+            mutable Core::Event _idle;
         };
 
         Commander(const Commander&) = delete;
@@ -487,6 +892,20 @@ namespace Plugin {
             const string name(Core::ClassNameOnly(typeid(COMMAND).name()).Data());
             _commandAdministrator.Register(name, new Exchange::Command::FactoryType<COMMAND>());
         }
+        // A command that only waits, the sequencer arms it instead of blocking a thread on its Execute().
+        template <typename COMMAND>
+        void RegisterWaitable()
+        {
+            const string name(Core::ClassNameOnly(typeid(COMMAND).name()).Data());
+            _commandAdministrator.Register(name, new Exchange::Command::FactoryType<COMMAND>());
+            _commandAdministrator.Register(name, &Commander::Waitable<COMMAND>);
+        }
+        template <typename COMMAND>
+        void UnregisterWaitable()
+        {
+            _commandAdministrator.Revoke(string(Core::ClassNameOnly(typeid(COMMAND).name()).Data()));
+            Unregister<COMMAND>();
+        }
         template <typename COMMAND>
         void Unregister()
         {
@@ -508,6 +927,12 @@ namespace Plugin {
     private:
         Commander::Data MetaData(const Commander::Sequencer& sequencer);
 
+        template <typename COMMAND>
+        static Plugin::Command::IWaitable* Waitable(const string& parameters)
+        {
+            return (new COMMAND(parameters));
+        }
+
     private:
         uint8_t _skipURL;
         PluginHost::IShell* _service;
@@ -17,12 +17,33 @@
  * limitations under the License.
  */
  
+#ifndef __COMMANDER_COMMANDS_H
+#define __COMMANDER_COMMANDS_H
+
 #include "Module.h"
 
 namespace WPEFramework {
 namespace Plugin {
     namespace Command {
 
+        // Steps that wait for something to happen, implement this next to the blocking Execute(). The sequencer
+        // arms them and continues when they report, instead of keeping a thread blocked for the whole wait.
+        struct IWaitable {
+            struct ICallback {
+                virtual ~ICallback() {}
+
+                virtual void Completed(const uint32_t id, const string& result) = 0;
+            };
+
+            virtual ~IWaitable() {}
+
+            // Starts the wait and returns immediately. The callback is called exactly once, also on an Abort().
+            virtual void Arm(PluginHost::IShell* service, ICallback* callback, const uint32_t id) = 0;
+            // Releases whatever was needed for the wait, called once the callback has been reported.
+            virtual void Disarm(PluginHost::IShell* service) = 0;
+            virtual void Abort() = 0;
+        };
+
         class PluginControl {
         private:
             PluginControl(const PluginControl&) = delete;
@@ -117,7 +138,7 @@ namespace Plugin {
             Config _config;
         };
 
-        class PluginObserver {
+        class PluginObserver : public IWaitable {
         private:
             PluginObserver(const PluginObserver&) = delete;
             PluginObserver& operator=(const PluginObserver&) = delete;
@@ -183,6 +204,9 @@ namespace Plugin {
                 : _config()
                 , _waitEvent(true, false)
                 , _observer(Core::Service<Observer>::Create<Observer>(this))
+                , _lock()
+                , _callback(nullptr)
+                , _id(0)
             {
 
                 _config.FromString(configuration);
@@ -208,9 +232,35 @@ namespace Plugin {
                 return (EMPTY_STRING);
             }
 
-            void Abort()
+            void Abort() override
             {
                 _waitEvent.SetEvent();
+                Report();
+            }
+
+            void Arm(PluginHost::IShell* service, ICallback* callback, const uint32_t id) override
+            {
+                ASSERT(callback != nullptr);
+
+                _lock.Lock();
+                _callback = callback;
+                _id = id;
+                _lock.Unlock();
+
+                service->Register(_observer);
+
+                // The plugin might already be in the state we are waiting for.
+                PluginHost::IShell* plugin = service->QueryInterfaceByCallsign<PluginHost::IShell>(_config.Callsign.Value());
+
+                if (plugin != nullptr) {
+                    StateChange(plugin);
+                    plugin->Release();
+                }
+            }
+
+            void Disarm(PluginHost::IShell* service) override
+            {
+                service->Unregister(_observer);
             }
 
         private:
@@ -221,15 +271,152 @@ namespace Plugin {
 
                     if (((_config.Active.Value() == true) && (plugin->State() == PluginHost::IShell::ACTIVATED)) || ((_config.Active.Value() == false) && (plugin->State() == PluginHost::IShell::DEACTIVATED))) {
                         _waitEvent.SetEvent();
+                        Report();
                     }
                 }
             }
+            void Report()
+            {
+                _lock.Lock();
+                ICallback* callback = _callback;
+                _callback = nullptr;
+                _lock.Unlock();
+
+                if (callback != nullptr) {
+                    callback->Completed(_id, EMPTY_STRING);
+                }
+            }
 
         private:
             Config _config;
             Core::Event _waitEvent;
             Observer* _observer;
+            Core::CriticalSection _lock;
+            ICallback* _callback;
+            uint32_t _id;
+        };
+
+        class Delay : public IWaitable {
+        private:
+            Delay(const Delay&) = delete;
+            Delay& operator=(const Delay&) = delete;
+
+        private:
+            class Timer : public Core::IDispatchType<void> {
+            private:
+                Timer() = delete;
+                Timer(const Timer&) = delete;
+                Timer& operator=(const Timer&) = delete;
+
+            public:
+                Timer(Delay& parent)
+                    : _parent(parent)
+                {
+                }
+                ~Timer()
+                {
+                }
+
+            private:
+                virtual void Dispatch()
+                {
+                    _parent.Report();
+                }
+
+            private:
+                Delay& _parent;
+            };
+
+            class Config : public Core::JSON::Container {
+            private:
+                Config(const Config&) = delete;
+                Config& operator=(const Config&) = delete;
+
+            public:
+                Config()
+                    : Core::JSON::Container()
+                    , Duration(0)
+                {
+                    Add(_T("duration"), &Duration);
+                }
+                ~Config()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt32 Duration; // In ms
+            };
+
+        public:
+            Delay(const string& configuration)
+                : _config()
+                , _waitEvent(false, true)
+                , _timer(Core::proxy_cast<Core::IDispatchType<void>>(Core::ProxyType<Timer>::Create(*this)))
+                , _lock()
+                , _callback(nullptr)
+                , _id(0)
+            {
+                _config.FromString(configuration);
+            }
+            ~Delay()
+            {
+                Core::IWorkerPool::Instance().Revoke(_timer);
+            }
+
+            const string Execute(PluginHost::IShell*)
+            {
+                _waitEvent.ResetEvent();
+                _waitEvent.Lock(_config.Duration.Value());
+
+                return (EMPTY_STRING);
+            }
+
+            void Abort() override
+            {
+                _waitEvent.SetEvent();
+                Report();
+            }
+
+            void Arm(PluginHost::IShell*, ICallback* callback, const uint32_t id) override
+            {
+                ASSERT(callback != nullptr);
+
+                _lock.Lock();
+                _callback = callback;
+                _id = id;
+                _lock.Unlock();
+
+                Core::IWorkerPool::Instance().Schedule(Core::Time::Now().Add(_config.Duration.Value()), _timer);
+            }
+
+            void Disarm(PluginHost::IShell*) override
+            {
+                Core::IWorkerPool::Instance().Revoke(_timer);
+            }
+
+        private:
+            void Report()
+            {
+                _lock.Lock();
+                ICallback* callback = _callback;
+                _callback = nullptr;
+                _lock.Unlock();
+
+                if (callback != nullptr) {
+                    callback->Completed(_id, EMPTY_STRING);
+                }
+            }
+
+        private:
+            Config _config;
+            Core::Event _waitEvent;
+            Core::ProxyType<Core::IDispatchType<void>> _timer;
+            Core::CriticalSection _lock;
+            ICallback* _callback;
+            uint32_t _id;
         };
     }
 }
 }
+
+#endif // __COMMANDER_COMMANDS_H
@@ -120,25 +120,197 @@ namespace Plugin {
         return (index);
     }
 
+    DIALServer::Responder::Responder(const string& searchTarget)
+        : Core::Thread(Core::Thread::DefaultStackSize(), _T("DIALResponder"))
+        , _lock()
+        , _signal(false, true)
+        , _socket(::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0))
+        , _searchTarget(searchTarget)
+        , _datagram()
+        , _pending()
+        , _answered()
+        , _nextDue(~0)
+        , _dropped(0)
+        , _random(static_cast<uint32_t>(Core::Time::Now().Ticks()))
+    {
+        if (_socket == -1) {
+            TRACE_L1("Could not open the SSDP response socket, error: %d", errno);
+        } else {
+            Run();
+        }
+    }
+
+    /* virtual */ DIALServer::Responder::~Responder()
+    {
+        Stop();
+        _signal.SetEvent();
+        Wait(Core::Thread::STOPPED | Core::Thread::INITIALIZED, Core::infinite);
+
+        if (_socket != -1) {
+            ::close(_socket);
+        }
+    }
+
+    void DIALServer::Responder::Location(const string& location)
+    {
+        string datagram(_T("HTTP/1.1 200 OK\r\n")
+                        _T("CACHE-CONTROL: max-age=1800\r\n")
+                        _T("EXT:\r\n")
+                        _T("LOCATION: ") + location + _T("\r\n")
+                        _T("SERVER: Linux/2.6 UPnP/1.0 quick_ssdp/1.0\r\n")
+                        _T("ST: ") + _searchTarget + _T("\r\n")
+                        // FIXME: Add "WAKEUP: MAC=<MACAddress>;Timeout=10" when adding WoL/WoWLAN support. This SHALL NOT
+                        // be present if neither WoL nor WoWLAN is supported. Moreover real MAC address of the network
+                        // iface (either wired or wireless one) should be used, not the Device identifier.
+                        _T("USN: uuid:UniqueIdentifier::") + _searchTarget + _T("\r\n")
+                        _T("\r\n"));
+
+        _lock.Lock();
+        _datagram = datagram;
+        _lock.Unlock();
+    }
+
+    void DIALServer::Responder::Queue(const Core::NodeId& source)
+    {
+        struct sockaddr_in address;
+
+        ::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(source.PortNumber());
+
+        if (::inet_pton(AF_INET, source.HostAddress().c_str(), &(address.sin_addr)) != 1) {
+            TRACE_L1("M-SEARCH from an unsupported address: %s", source.HostAddress().c_str());
+        } else {
+            const uint64_t key = (static_cast<uint64_t>(address.sin_addr.s_addr) << 16) | address.sin_port;
+            const uint64_t now = Core::Time::Now().Ticks();
+            bool wakeup = false;
+
+            _lock.Lock();
+
+            std::unordered_map<uint64_t, uint64_t>::const_iterator answered(_answered.find(key));
+
+            // Control points retransmit their M-SEARCH, skip those still waiting for, or already given, an
+            // answer within this MX window.
+            if ((_pending.find(key) == _pending.end()) && ((answered == _answered.end()) || ((now - answered->second) >= (Window * Core::Time::TicksPerMillisecond)))) {
+
+                if (_pending.size() >= MaxPending) {
+                    _dropped++;
+                    if ((_dropped & 0xFF) == 1) {
+                        TRACE_L1("Too many pending M-SEARCH requests, %d dropped so far", _dropped);
+                    }
+                } else {
+                    Pending& entry(_pending[key]);
+                    entry.Address = address;
+                    entry.Due = now + ((_random() % Window) * Core::Time::TicksPerMillisecond);
+
+                    if (entry.Due < _nextDue) {
+                        _nextDue = entry.Due;
+                        wakeup = true;
+                    }
+                }
+            }
+
+            _lock.Unlock();
+
+            if (wakeup == true) {
+                _signal.SetEvent();
+            }
+        }
+    }
+
+    /* virtual */ uint32_t DIALServer::Responder::Worker()
+    {
+        struct sockaddr_in addresses[BatchSize];
+        struct mmsghdr messages[BatchSize];
+        struct iovec vector;
+        string datagram;
+        uint8_t count = 0;
+        uint32_t delay = Core::infinite;
+
+        _lock.Lock();
+
+        const uint64_t now = Core::Time::Now().Ticks();
+
+        std::unordered_map<uint64_t, Pending>::iterator index(_pending.begin());
+
+        _nextDue = ~0;
+
+        while (index != _pending.end()) {
+            if ((index->second.Due <= now) && (count < BatchSize)) {
+                addresses[count] = index->second.Address;
+                count++;
+                _answered[index->first] = now;
+                index = _pending.erase(index);
+            } else {
+                if (index->second.Due < _nextDue) {
+                    _nextDue = index->second.Due;
+                }
+                index++;
+            }
+        }
+
+        if (count > 0) {
+            // Forget the sources of which the MX window has passed.
+            std::unordered_map<uint64_t, uint64_t>::iterator loop(_answered.begin());
+
+            while (loop != _answered.end()) {
+                if ((now - loop->second) >= (Window * Core::Time::TicksPerMillisecond)) {
+                    loop = _answered.erase(loop);
+                } else {
+                    loop++;
+                }
+            }
+        }
+
+        datagram = _datagram;
+
+        if (_nextDue != static_cast<uint64_t>(~0)) {
+            delay = (_nextDue <= now ? 0 : static_cast<uint32_t>(((_nextDue - now) / Core::Time::TicksPerMillisecond) + 1));
+        }
+
+        _lock.Unlock();
+
+        if ((count > 0) && (datagram.empty() == false)) {
+            vector.iov_base = const_cast<char*>(datagram.c_str());
+            vector.iov_len = datagram.length();
+
+            ::memset(messages, 0, sizeof(messages));
+
+            for (uint8_t index = 0; index < count; index++) {
+                messages[index].msg_hdr.msg_name = &(addresses[index]);
+                messages[index].msg_hdr.msg_namelen = sizeof(addresses[index]);
+                messages[index].msg_hdr.msg_iov = &vector;
+                messages[index].msg_hdr.msg_iovlen = 1;
+            }
+
+            uint8_t sent = 0;
+
+            while (sent < count) {
+                int result = ::sendmmsg(_socket, &(messages[sent]), count - sent, 0);
+
+                if (result > 0) {
+                    sent += static_cast<uint8_t>(result);
+                } else if (errno != EINTR) {
+                    TRACE_L1("Failed to send %d M-SEARCH responses, error: %d", count - sent, errno);
+                    break;
+                }
+            }
+        }
+
+        if (IsRunning() == true) {
+            _signal.Lock(delay);
+        }
+
+        return (0);
+    }
+
     DIALServer::DIALServerImpl::DIALServerImpl(const string& MACAddress, const string& baseURL, const string& appPath)
         : BaseClass(5, false, Core::NodeId(DialServerInterface.AnyInterface(), DialServerInterface.PortNumber()), DialServerInterface.AnyInterface(), 1024, 1024)
-        , _response(Core::ProxyType<Web::Response>::Create())
-        , _destinations()
+        , _responder(_SearchTarget)
         , _baseURL(baseURL)
         , _appPath(appPath)
     {
-        _response->ErrorCode = Web::STATUS_OK;
-        _response->Message = _T("OK");
-        _response->CacheControl = _T("max-age=1800");
-        _response->Server = _T("Linux/2.6 UPnP/1.0 quick_ssdp/1.0");
-        _response->ST = _SearchTarget;
-        _response->USN = _T("uuid:UniqueIdentifier::") + _SearchTarget;
-        // FIXME: Uncomment when adding WoL/WoWLAN support.
-        // This SHALL NOT be present if neither WoL nor WoWLAN is supported.
-        // Moreover real MAC address of the network iface (either wired or wireless one) should be passed
-        // where currently Device identifier is passed in MACAddress.
-        // _response->WakeUp = _T("MAC=") + MACAddress + _T(";Timeout=10");
-        _response->Mode(Web::MARSHAL_UPPERCASE);
+        Refresh();
 
         if (Link().Open(1000) != Core::ERROR_NONE) {
             ASSERT(false && "Seems we can not open the DIAL discovery port");
@@ -169,16 +341,9 @@ namespace Plugin {
             if (request->ST.Value() == _SearchTarget) {
 
                 TRACE(Protocol, (&(*request)));
-                _destinations.push_back(sourceNode);
-                // remember the NodeId where this comes from.
-                if (_destinations.size() == 1) {
 
-                    Link().RemoteNode(_destinations.front());
-
-                    _response->Location = URL() + '/' + _DefaultAppInfoDevice;
-
-                    Submit(_response);
-                }
+                // The responder takes it from here, it answers from its own socket.
+                _responder.Queue(sourceNode);
             }
         }
     }
@@ -186,21 +351,8 @@ namespace Plugin {
     // Notification of a Response send.
     /* virtual */ void DIALServer::DIALServerImpl::Send(const Core::ProxyType<Web::Response>& response)
     {
-        TRACE(WebFlow, (response, _destinations.front()));
-
+        // All responses are sent by the responder, nothing is submitted on this link.
         TRACE(Protocol, (&(*response)));
-
-        // Drop the current destination.
-        _destinations.pop_front();
-
-        if (_destinations.size() > 0) {
-            _response->Location = URL() + '/' + _DefaultAppInfoDevice;
-
-            // Move on to notifying the next one.
-            Link().RemoteNode(_destinations.front());
-
-            Submit(response);
-        }
     }
 
     // Notification of a channel state change..
@@ -208,22 +360,50 @@ namespace Plugin {
     {
     }
 
-    void DIALServer::AppInformation::GetData(string& data, const Version& version) const
+    void DIALServer::DIALServerImpl::Refresh()
+    {
+        _responder.Location(URL() + '/' + _DefaultAppInfoDevice);
+    }
+
+    void DIALServer::AppInformation::GetData(string& data, string& tag, const Version& version) const
     {
         bool running = IsRunning();
         bool hidden = HasHideAndShow() == true && IsHidden() == true;
         bool isAtLeast2_1 = Version{2, 1, 0} <= version;
         // allowSop is mandatory to be true starting from 2.1
-        string allowStop = isAtLeast2_1 == true || HasStartAndStop() == true ? "true" : "false";
+        bool allowStop = isAtLeast2_1 == true || HasStartAndStop() == true;
+        uint8_t state = (running == true ? RUNNING : 0) | (hidden == true ? HIDDEN : 0) | (allowStop == true ? ALLOW_STOP : 0);
+
+        _lock.Lock();
+
+        Rendering& rendering(_renderings[isAtLeast2_1 == true ? 1 : 0]);
+
+        if ((rendering.Revision == 0) || (rendering.State != state) || (rendering.DataRevision != _dataRevision)) {
+            Render(rendering, state, isAtLeast2_1);
+        }
+
+        data = rendering.Document;
+        tag = rendering.Tag;
+
+        _lock.Unlock();
+    }
+
+    void DIALServer::AppInformation::Render(Rendering& rendering, const uint8_t state, const bool isAtLeast2_1) const
+    {
+        bool running = ((state & RUNNING) != 0);
+        bool hidden = ((state & HIDDEN) != 0);
+        string allowStop = ((state & ALLOW_STOP) != 0) ? "true" : "false";
         string dialVersion;
         if (isAtLeast2_1 == true) {
           dialVersion = " dialVer=\"2.1\" ";
         }
 
+        string& data(rendering.Document);
+
         data = _T("<?xml version=\"1.0\" encoding=\"UTF-8\"?>")
                _T("<service xmlns=\"urn:dial-multiscreen-org:schemas:dial\"") + dialVersion + _T(">")
                _T("<name>")
-            + Name() + _T("</name>")
+            + XMLEncode(Name()) + _T("</name>")
                        _T("<options allowStop=\"")
             + allowStop + _T("\"/><state>")
             // 2.2 spec adds "hidden" state. It also introduces "installable" state.
@@ -235,11 +415,23 @@ namespace Plugin {
         auto additionalData = AdditionalData();
         if (additionalData.empty() == false) {
             for (const auto& adata : additionalData) {
-                // FIXME: escape/validate keys and values
-                data += "<" + adata.first + ">"+ adata.second + "</" + adata.first + ">";
+                // Keys become element names, so they can not be escaped, only rejected.
+                if (IsXMLName(adata.first) == false) {
+                    TRACE(Trace::Error, (_T("Dropping additionalData key [%s], not a valid XML name"), adata.first.c_str()));
+                } else {
+                    data += "<" + adata.first + ">" + XMLEncode(adata.second) + "</" + adata.first + ">";
+                }
             }
         }
         data += _T("</additionalData></service>");
+
+        rendering.State = state;
+        rendering.DataRevision = _dataRevision;
+        rendering.Revision++;
+        // Clients send it back in If-None-Match, the instance stamp keeps a tag of an earlier instance from matching.
+        rendering.Tag = _T("\"") + Core::NumberType<uint64_t>(_instance).Text() + '-' + (isAtLeast2_1 == true ? '2' : '1') + '.' + Core::NumberType<uint32_t>(rendering.Revision).Text() + _T("\"");
+
+        TRACE(Trace::Information, (_T("Rendered state of [%s], revision %d"), Name().c_str(), rendering.Revision));
     }
 
     void DIALServer::AppInformation::SetData(const string& data)
@@ -268,6 +460,7 @@ namespace Plugin {
         }
 
         _application->AdditionalData(std::move(additionalData));
+        _dataRevision++;
         _lock.Unlock();
     }
 
@@ -581,13 +774,22 @@ namespace Plugin {
                         TRACE(Trace::Information, (_T("Serving the Application [%s] Description File"), selectedApp->second.Name().c_str()));
 
                         Core::ProxyType<Web::TextBody> info(_textBodies.Element());
-                        result->ErrorCode = Web::STATUS_OK;
-                        result->Message = _T("OK");
-                        result->ContentType = Web::MIME_XML;
                         Core::ProxyType<Web::TextBody> textBody(_textBodies.Element());
-                        selectedApp->second.GetData(*textBody, version);
-                        result->Body(textBody);
-                        TRACE(Protocol, (static_cast<const string&>(*textBody)));
+                        string tag;
+                        selectedApp->second.GetData(*textBody, tag, version);
+                        result->ETag = tag;
+
+                        if ((request.IfNoneMatch.IsSet() == true) && (Matches(request.IfNoneMatch.Value(), tag) == true)) {
+                            // The client polled this state before, it can keep what it has.
+                            result->ErrorCode = Web::STATUS_NOT_MODIFIED;
+                            result->Message = _T("Not Modified");
+                        } else {
+                            result->ErrorCode = Web::STATUS_OK;
+                            result->Message = _T("OK");
+                            result->ContentType = Web::MIME_XML;
+                            result->Body(textBody);
+                            TRACE(Protocol, (static_cast<const string&>(*textBody)));
+                        }
                     } else if (request.Verb == Web::Request::HTTP_POST) {
                         StartApplication(request, result, selectedApp->second);
                     }
@@ -25,6 +25,13 @@
 #include <interfaces/IWebServer.h>
 #include <interfaces/IBrowser.h>
 
+#include <random>
+#include <unordered_map>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
 namespace WPEFramework {
 namespace Plugin {
 
@@ -477,6 +484,34 @@ namespace Plugin {
 
         static const uint32_t MaxDialQuerySize = 4096;
 
+        // If-None-Match holds "*" or a list of tags, weak ones prefixed with W/.
+        static bool Matches(const string& list, const string& tag)
+        {
+            bool result = false;
+            size_t start = 0;
+
+            while ((result == false) && (start < list.length())) {
+                size_t end = list.find(',', start);
+                end = (end == string::npos ? list.length() : end);
+
+                while ((start < end) && (::isspace(list[start]) != 0)) {
+                    start++;
+                }
+                size_t last = end;
+                while ((last > start) && (::isspace(list[last - 1]) != 0)) {
+                    last--;
+                }
+                if (list.compare(start, 2, _T("W/")) == 0) {
+                    start += 2;
+                }
+
+                result = ((list.compare(start, last - start, _T("*")) == 0) || (list.compare(start, last - start, tag) == 0));
+                start = end + 1;
+            }
+
+            return (result);
+        }
+
         static void ParseVersion(const string& version, Version* parsed)
         {
             ASSERT(parsed);
@@ -601,6 +636,56 @@ namespace Plugin {
         private:
             uint8_t _keywordLength;
         };
+        // Answers the M-SEARCH requests collected by the DIALServerImpl. Every source is answered once per
+        // MX window, after a random delay within that window (UPnP Device Architecture 1.0, 1.2.3), with a
+        // datagram that is only rebuilt when the location changes. Due replies go out in batches through
+        // sendmmsg, so a burst of control points does not queue up behind each other.
+        class Responder : public Core::Thread {
+        private:
+            // The MX header is not available from the parsed request, use its lower bound (seconds).
+            static constexpr uint32_t Window = 1000;
+            // Maximum number of control points waiting for an answer, others are dropped (they retry).
+            static constexpr uint16_t MaxPending = 256;
+            // Maximum number of replies handed to a single sendmmsg call.
+            static constexpr uint8_t BatchSize = 32;
+
+            struct Pending {
+                struct sockaddr_in Address;
+                uint64_t Due;
+            };
+
+        public:
+            Responder(const Responder&) = delete;
+            Responder& operator=(const Responder&) = delete;
+
+            Responder(const string& searchTarget);
+            ~Responder() override;
+
+        public:
+            bool IsValid() const
+            {
+                return (_socket != -1);
+            }
+            void Location(const string& location);
+            void Queue(const Core::NodeId& source);
+
+        private:
+            uint32_t Worker() override;
+
+        private:
+            mutable Core::CriticalSection _lock;
+            Core::Event _signal;
+            int _socket;
+            const string _searchTarget;
+            string _datagram;
+            std::unordered_map<uint64_t, Pending> _pending;
+            // When a source was last answered, to suppress the retransmissions within its MX window.
+            std::unordered_map<uint64_t, uint64_t> _answered;
+            uint64_t _nextDue;
+            uint32_t _dropped;
+            std::minstd_rand _random;
+        };
+
         class DIALServerImpl : public Web::WebLinkType<Core::SocketDatagram, Web::Request, Web::Response, Core::ProxyPoolType<Web::Request>, WebTransform> {
         private:
             static const Core::NodeId DialServerInterface;
@@ -649,13 +734,16 @@ namespace Plugin {
                 _baseURL = hostName;
 
                 _lock.Unlock();
+
+                Refresh();
             }
 
+        private:
+            void Refresh();
+
         private:
             mutable Core::CriticalSection _lock;
-            // This should be the "Response" as depicted by the parent/DIALserver.
-            Core::ProxyType<Web::Response> _response;
-            std::list<Core::NodeId> _destinations;
+            Responder _responder;
             string _baseURL;
             const string _appPath;
         };
@@ -671,6 +759,9 @@ namespace Plugin {
                 , _name(info.Name.Value())
                 , _url(info.URL.Value())
                 , _application(nullptr)
+                , _dataRevision(1)
+                , _instance(Core::Time::Now().Ticks())
+                , _renderings()
             {
                 ASSERT(parent != nullptr);
 
@@ -789,10 +880,50 @@ namespace Plugin {
                 AppInformation::_applicationFactory.erase(index);
             }
 
-            void GetData(string& data, const Version& version = {}) const;
+            // The tag identifies the returned document, it changes whenever the document does.
+            void GetData(string& data, string& tag, const Version& version = {}) const;
             void SetData(const string& data);
 
         private:
+            // The application state document, as last rendered for a DIAL version class. It is only
+            // rendered again if the state or the additional data changed since.
+            struct Rendering {
+                Rendering()
+                    : Document()
+                    , State(0)
+                    , DataRevision(0)
+                    , Revision(0)
+                    , Tag()
+                {
+                }
+
+                string Document;
+                uint8_t State;
+                uint32_t DataRevision;
+                uint32_t Revision;
+                string Tag;
+            };
+
+            enum state : uint8_t {
+                RUNNING = 0x01,
+                HIDDEN = 0x02,
+                ALLOW_STOP = 0x04
+            };
+
+            void Render(Rendering& rendering, const uint8_t state, const bool isAtLeast2_1) const;
+
+            static bool IsXMLName(const string& name)
+            {
+                bool result = (name.empty() == false) && ((::isalpha(name[0]) != 0) || (name[0] == '_'));
+                uint32_t index = 1;
+
+                while ((result == true) && (index < name.length())) {
+                    const TCHAR c = name[index++];
+                    result = (::isalnum(c) != 0) || (c == '_') || (c == '-') || (c == '.');
+                }
+
+                return (result);
+            }
             string XMLEncode(const string& source) const
             {
                 string result;
@@ -829,6 +960,10 @@ namespace Plugin {
             const string _name;
             const string _url;
             IApplication* _application;
+            uint32_t _dataRevision;
+            const uint64_t _instance;
+            // Index 0 for the pre 2.1 document, index 1 for 2.1 and up.
+            mutable Rendering _renderings[2];
 
             static std::map<string, IApplicationFactory*> _applicationFactory;
         };
@@ -29,7 +29,7 @@ namespace Plugin {
         Config config;
         config.FromString(service->ConfigLine());
 
-        _logOutput.SetDestination(config.Destination.Binding.Value(), config.Destination.Port.Value());
+        _logOutput.SetDestination(config.Destination.Binding.Value(), config.Destination.Port.Value(), config.MTU.Value());
         _observer.Register(config.FilePath.Value(), &_fileUpdate, config.FullFile.Value());
 
         return string();
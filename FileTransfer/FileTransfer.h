@@ -19,9 +19,11 @@
  
 #pragma once
 #include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <libgen.h>
 #include <unordered_map>
-#include <iostream>
-#include <fstream>
 #include "../FileTransfer/Module.h"
 
 namespace WPEFramework {
@@ -108,11 +110,13 @@ namespace Core {
             {
                 return (_notifyFd != -1);
             }
-            bool Register(ICallback *callback, const string &filename)
+            bool Register(ICallback *callback, const string &filename, const uint32_t mask = IN_CLOSE_WRITE)
             {
                 ASSERT(_notifyFd != -1);
                 ASSERT(callback != nullptr);
 
+                bool result = true;
+
                 _adminLock.Lock();
 
                 Files::iterator index = _files.find(filename);
@@ -124,7 +128,7 @@ namespace Core {
                 }
                 else
                 {
-                    int fileFd = inotify_add_watch(_notifyFd, filename.c_str(), IN_CLOSE_WRITE);
+                    int fileFd = inotify_add_watch(_notifyFd, filename.c_str(), mask);
                     if (fileFd >= 0) {
                         _files.emplace(std::piecewise_construct,
                                        std::forward_as_tuple(filename),
@@ -137,12 +141,14 @@ namespace Core {
                             // This is the first entry, lets start monitoring
                             Core::ResourceMonitor::Instance().Register(*this);
                         }
+                    } else {
+                        result = false;
                     }
                 }
 
                 _adminLock.Unlock();
 
-                return (IsValid());
+                return (result);
             }
             void Unregister(ICallback *callback, const string &filename)
             {
@@ -188,13 +194,16 @@ namespace Core {
             void Handle(const uint16_t events) override
             {
                 if ((events & POLLIN) != 0) {
-                    uint8_t eventBuffer[(sizeof(struct inotify_event) + NAME_MAX + 1)];
+                    uint8_t eventBuffer[16 * (sizeof(struct inotify_event) + NAME_MAX + 1)] __attribute__((aligned(__alignof__(struct inotify_event))));
                     int length;
                     do
                     {
                         length = ::read(_notifyFd, eventBuffer, sizeof(eventBuffer));
-                        if (length > 0) {
-                            const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(eventBuffer);
+
+                        // A single read can hold many events, walk all of them.
+                        int offset = 0;
+                        while (offset < length) {
+                            const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(&eventBuffer[offset]);
 
                             _adminLock.Lock();
 
@@ -205,6 +214,8 @@ namespace Core {
                             }
 
                             _adminLock.Unlock();
+
+                            offset += sizeof(struct inotify_event) + event->len;
                         }
                     } while (length > 0);
                 }
@@ -253,9 +264,17 @@ namespace Plugin
             struct ICallback
             {
                 virtual ~ICallback() {}
-                virtual void NewLine(const string &) = 0;
+                // A block of complete lines, each one terminated by a '\n'.
+                virtual void NewLines(const char text[], const uint32_t length) = 0;
             };
 
+        private:
+            static constexpr uint32_t ReadChunkSize = 64 * 1024;
+            // Appended to the watched file (IN_MODIFY, the writer might never close it) or it was moved/removed.
+            static constexpr uint32_t FileEvents = IN_MODIFY | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF | IN_ATTRIB;
+            // A (new) file appeared in the directory, possibly the replacement of a rotated file.
+            static constexpr uint32_t DirectoryEvents = IN_CREATE | IN_MOVED_TO;
+
         public:
             FileObserver(const FileObserver &) = delete;
             FileObserver &operator=(const FileObserver &) = delete;
@@ -264,6 +283,12 @@ namespace Plugin
                 , _callback(nullptr)
                 , _position(0)
                 , _path()
+                , _directory()
+                , _descriptor(-1)
+                , _inode(0)
+                , _watched(false)
+                , _partial()
+                , _buffer()
             {
             }
             ~FileObserver()
@@ -281,54 +306,133 @@ namespace Plugin
             {
                 ASSERT((_callback == nullptr) && (callback != nullptr));
 
-                if (fullFile == false) {
-                    _position = GetCurrentPosition(entry);
-                } else {
+                _path = entry;
+                _callback = callback;
+
+                char* directory = ::strdup(entry.c_str());
+                _directory = ::dirname(directory);
+                ::free(directory);
+
+                Open();
+
+                if (fullFile == true) {
                     _position = 0;
                 }
 
-                _path = entry;
-                _callback = callback;
-                Core::FileSystemMonitor::Instance().Register(&(*_job), _path);
+                _watched = Core::FileSystemMonitor::Instance().Register(&(*_job), _path, FileEvents);
+                Core::FileSystemMonitor::Instance().Register(&(*_job), _directory, DirectoryEvents);
+
+                if ((fullFile == true) && (_descriptor != -1)) {
+                    Updated();
+                }
             }
             void Unregister()
             {
                 ASSERT(_callback != nullptr);
 
                 // First make sure the dispatcher Job will longer be fired
-                Core::FileSystemMonitor::Instance().Unregister(&(*_job), _path);
+                Core::FileSystemMonitor::Instance().Unregister(&(*_job), _directory);
+                if (_watched == true) {
+                    Core::FileSystemMonitor::Instance().Unregister(&(*_job), _path);
+                    _watched = false;
+                }
 
                 // Potentially the Job might still be waiting, let’s kill it
                 Core::IWorkerPool::Instance().Revoke(Core::proxy_cast<Core::IDispatchType<void> >(_job));
 
+                Close();
+
                 _path = EMPTY_STRING;
+                _directory = EMPTY_STRING;
                 _position = 0;
                 _callback = nullptr;
             }
 
         private:
-            long int GetCurrentPosition(const string &filePath) const
+            void Open()
             {
-                long int pos = 0;
-                std::ifstream file(filePath.c_str());
-                if (file) {
-                    file.seekg(0, file.end);
-                    pos = file.tellg();
+                struct stat info;
+
+                _descriptor = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+                _partial.clear();
+
+                if ((_descriptor != -1) && (::fstat(_descriptor, &info) == 0)) {
+                    _inode = info.st_ino;
+                    _position = info.st_size;
+                } else {
+                    _inode = 0;
+                    _position = 0;
                 }
-                return pos;
             }
-            void Dispatch()
+            void Close()
             {
-                std::ifstream file(_path);
-                if (file) {
-                    file.seekg(_position, file.beg);
-                    std::string str;
-                    while ((std::getline(file, str)) && (str.size() > 0)) {
+                if (_descriptor != -1) {
+                    ::close(_descriptor);
+                    _descriptor = -1;
+                }
+                _partial.clear();
+            }
+            // Reads everything appended since the last time, only whole lines are reported.
+            void Drain()
+            {
+                ssize_t length;
+
+                while ((length = ::pread(_descriptor, _buffer, sizeof(_buffer), _position)) > 0) {
+                    _position += length;
+
+                    const char* end = static_cast<const char*>(::memrchr(_buffer, '\n', length));
+
+                    if (end == nullptr) {
+                        _partial.append(_buffer, length);
+                    } else {
+                        uint32_t complete = static_cast<uint32_t>(end - _buffer) + 1;
+
                         ASSERT(_callback != nullptr);
-                        _callback->NewLine(str);
+
+                        if (_partial.empty() == true) {
+                            _callback->NewLines(_buffer, complete);
+                        } else {
+                            _partial.append(_buffer, complete);
+                            _callback->NewLines(_partial.c_str(), static_cast<uint32_t>(_partial.length()));
+                            _partial.clear();
+                        }
+
+                        _partial.append(&(_buffer[complete]), length - complete);
+                    }
+                }
+            }
+            void Dispatch()
+            {
+                struct stat info;
+
+                if (_descriptor != -1) {
+                    if ((::fstat(_descriptor, &info) == 0) && (info.st_size < _position)) {
+                        // Truncated (e.g. copytruncate rotation), start over from the beginning.
+                        TRACE_L1(_T("File %s got truncated"), _path.c_str());
+                        _position = 0;
+                        _partial.clear();
+                    }
+
+                    // Whatever was written to the file up till now, even if it got rotated already.
+                    Drain();
+                }
+
+                if ((::stat(_path.c_str(), &info) == 0) && ((_descriptor == -1) || (info.st_ino != _inode))) {
+                    // The file got replaced (rotated), continue with the new one from its start.
+                    TRACE_L1(_T("File %s got replaced"), _path.c_str());
+
+                    if (_watched == true) {
+                        Core::FileSystemMonitor::Instance().Unregister(&(*_job), _path);
+                    }
+                    Close();
+                    Open();
+                    _position = 0;
+                    _watched = Core::FileSystemMonitor::Instance().Register(&(*_job), _path, FileEvents);
+
+                    if (_descriptor != -1) {
+                        Drain();
                     }
                 }
-                _position = GetCurrentPosition(_path);
             }
             void Updated()
             {
@@ -338,47 +442,97 @@ namespace Plugin
         private:
             const Core::ProxyType<Sink> _job;
             ICallback *_callback;
-            long int _position;
+            off_t _position;
             string _path;
+            string _directory;
+            int _descriptor;
+            ino_t _inode;
+            bool _watched;
+            string _partial;
+            char _buffer[ReadChunkSize];
         };
 
     class FileTransfer : public PluginHost::IPlugin {
         private:
 
-            static constexpr uint16_t MAX_BUFFER_LENGHT = 1024;
+            // Large enough to hold a datagram for a jumbo frame MTU.
+            static constexpr uint16_t MAX_BUFFER_LENGHT = 9216;
             static constexpr uint16_t TIMEOUT_MS = 0;
 
             class TextChannel : public Core::SocketDatagram
             {
+                private:
+                    // Maximum number of datagrams handed to the kernel in one sendmmsg call.
+                    static constexpr uint8_t BATCH_SIZE = 16;
+                    // Lines that are not sent yet are dropped beyond this size, the destination can not keep up.
+                    static constexpr uint32_t MAX_PENDING = 1024 * 1024;
+                    static constexpr uint16_t IPV4_UDP_HEADER = 28;
+                    static constexpr uint16_t IPV6_UDP_HEADER = 48;
+
                 public:
                     TextChannel()
                         : Core::SocketDatagram(false, Core::NodeId().Origin(), Core::NodeId(), MAX_BUFFER_LENGHT, 0)
-                        , _sendQueue()
+                        , _adminLock()
+                        , _pending()
                         , _offset(0)
+                        , _payload(MAX_BUFFER_LENGHT)
+                        , _triggered(false)
+                        , _dropped(0)
+                        , _terminator()
                     {
                     }
                     virtual ~TextChannel()
                     {
-                        _sendQueue.clear();
+                        _pending.clear();
                         _offset = 0;
                         Close(Core::infinite);
                     }
 
-                    void SetDestination(const string& binding, const uint16_t &port)
+                    void SetDestination(const string& binding, const uint16_t &port, const uint16_t mtu)
                     {
                         Core::NodeId logNode(binding.c_str(), port);
                         LocalNode(logNode.Origin());
                         RemoteNode(logNode);
 
+                        // Keep every datagram within a single frame, IP fragments are lost as a whole.
+                        const uint16_t header = (logNode.Type() == Core::NodeId::TYPE_IPV6 ? IPV6_UDP_HEADER : IPV4_UDP_HEADER);
+                        _payload = (mtu > header ? static_cast<uint16_t>(mtu - header) : MAX_BUFFER_LENGHT);
+                        _payload = (_payload > MAX_BUFFER_LENGHT ? MAX_BUFFER_LENGHT : _payload);
+
                         Open(TIMEOUT_MS);
                     }
 
-                    void NewLine(const string& text)
+                    // Accepts a block of '\n' terminated lines, every line is forwarded with the line terminator.
+                    void NewLines(const char text[], const uint32_t length)
                     {
                         _adminLock.Lock();
 
-                        _sendQueue.emplace_back(text);
-                        bool trigger = (_sendQueue.size() == 1);
+                        if (((_pending.length() - _offset) + length) > MAX_PENDING) {
+                            _dropped++;
+                            TRACE_L1(_T("Dropped %d bytes of lines, the destination does not keep up [%d]"), length, _dropped);
+                        }
+                        else {
+                            uint32_t index = 0;
+                            while (index < length) {
+                                const char* end = static_cast<const char*>(::memchr(&(text[index]), '\n', length - index));
+                                uint32_t size = (end == nullptr ? length : static_cast<uint32_t>(end - text)) - index;
+
+                                _pending.append(&(text[index]), size);
+                                _pending.append(_terminator.Marker(), _terminator.SizeOf());
+                                index += size + 1;
+                            }
+
+                            if (_triggered == false) {
+                                // Nothing queued in the socket layer, so no ordering issue, hand it over in bulk.
+                                Flush();
+
+                                if (_offset < _pending.length()) {
+                                    _triggered = true;
+                                }
+                            }
+                        }
+
+                        bool trigger = _triggered;
 
                         _adminLock.Unlock();
 
@@ -388,47 +542,100 @@ namespace Plugin
                         }
                     }
                 private:
-                    // Methods to extract and insert data into the socket buffers
-                    uint16_t SendData(uint8_t *dataFrame, const uint16_t maxSendSize) override
+                    // Size of the next datagram: as many whole lines as fit, only a line that does not fit on its own is split.
+                    uint16_t NextDatagram(const uint16_t maxSendSize) const
                     {
-                        uint16_t result = 0;
+                        const uint32_t available = static_cast<uint32_t>(_pending.length() - _offset);
+                        uint16_t result = static_cast<uint16_t>(std::min(available, static_cast<uint32_t>(std::min(maxSendSize, _payload))));
 
-                        _adminLock.Lock();
+                        if (result < available) {
+                            const char last = _terminator.Marker()[_terminator.SizeOf() - 1];
+                            const char* begin = &(_pending.c_str()[_offset]);
+                            const char* end = static_cast<const char*>(::memrchr(begin, last, result));
 
-                        if (_offset == static_cast<uint32_t>(~0)) {
-                            // We are done with this entry it has been sent!!! discard it.
-                            _sendQueue.pop_front();
-                            _offset = 0;
+                            if (end != nullptr) {
+                                result = static_cast<uint16_t>(end - begin) + 1;
+                            }
                         }
 
-                        if (_sendQueue.size() > 0) {
-                            const string& sendObject = _sendQueue.front();
+                        return (result);
+                    }
+                    void Compact()
+                    {
+                        if (_offset == _pending.length()) {
+                            _pending.clear();
+                            _offset = 0;
+                        }
+                        else if (_offset > (MAX_PENDING / 2)) {
+                            _pending.erase(0, _offset);
+                            _offset = 0;
+                        }
+                    }
+                    // Sends as many datagrams as possible with a single system call.
+                    void Flush()
+                    {
+                        const Core::NodeId& remote(RemoteNode());
+                        const struct sockaddr* address = reinterpret_cast<const struct sockaddr*>(&static_cast<const Core::NodeId::SocketInfo&>(remote));
+                        struct mmsghdr messages[BATCH_SIZE];
+                        struct iovec vectors[BATCH_SIZE];
+                        uint32_t position = _offset;
+                        uint8_t count = 0;
+
+                        while ((count < BATCH_SIZE) && (position < _pending.length())) {
+                            uint32_t original = _offset;
+                            _offset = position;
+                            uint16_t size = NextDatagram(MAX_BUFFER_LENGHT);
+                            _offset = original;
+
+                            vectors[count].iov_base = const_cast<char*>(&(_pending.c_str()[position]));
+                            vectors[count].iov_len = size;
+
+                            ::memset(&(messages[count]), 0, sizeof(struct mmsghdr));
+                            messages[count].msg_hdr.msg_name = const_cast<struct sockaddr*>(address);
+                            messages[count].msg_hdr.msg_namelen = remote.Size();
+                            messages[count].msg_hdr.msg_iov = &(vectors[count]);
+                            messages[count].msg_hdr.msg_iovlen = 1;
+
+                            position += size;
+                            count++;
+                        }
 
-                            // Do we still need to send data from the text..
-                            if (_offset < (sendObject.size() * sizeof(TCHAR))) {
-                                result = (((sendObject.size() * sizeof(TCHAR)) - _offset) > maxSendSize ? maxSendSize : ((sendObject.size() * sizeof(TCHAR)) - _offset));
+                        if (count > 0) {
+                            int sent = ::sendmmsg(Descriptor(), messages, count, MSG_DONTWAIT);
 
-                                _offset += SendCharacters(dataFrame, &(sendObject.c_str()[(_offset / sizeof(TCHAR))]), (_offset % sizeof(TCHAR)), result);
+                            if (sent > 0) {
+                                for (int index = 0; index < sent; index++) {
+                                    _offset += static_cast<uint32_t>(vectors[index].iov_len);
+                                }
                             }
+                            else if ((sent < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                                TRACE_L1(_T("Invoke of sendmmsg failed: %d"), errno);
+                            }
+
+                            Compact();
+                        }
+                    }
+                    // Methods to extract and insert data into the socket buffers
+                    uint16_t SendData(uint8_t *dataFrame, const uint16_t maxSendSize) override
+                    {
+                        uint16_t result = 0;
 
-                            // See if we can write the closing marker
-                            if ((maxSendSize != result) && (_offset >= (sendObject.size() * sizeof(TCHAR))) && (_offset < ((sendObject.size() + (_terminator.SizeOf())) * sizeof(TCHAR)))) {
-                                uint8_t markerSize = (static_cast<uint8_t>(_terminator.SizeOf()) * sizeof(TCHAR));
-                                uint8_t markerOffset = ((sendObject.size() * sizeof(TCHAR)) - _offset);
-                                uint16_t size = ((markerSize - markerOffset) > (maxSendSize - result) ? (maxSendSize - result) : (markerSize - markerOffset));
+                        _adminLock.Lock();
 
-                                _offset += SendCharacters(&(dataFrame[result]), &(_terminator.Marker()[(markerOffset / sizeof(TCHAR))]), (markerOffset % sizeof(TCHAR)), size);
-                                result += size;
+                        if (_offset < _pending.length()) {
+                            result = NextDatagram(maxSendSize);
 
-                                if ((size + markerOffset) == markerSize) {
-                                    // Report as completed on the next run
-                                    _offset = static_cast<uint32_t>(~0);
-                                }
-                            }
+                            ::memcpy(dataFrame, &(_pending.c_str()[_offset]), result);
+                            _offset += result;
+
+                            Compact();
 
                             // If we went through this entry we must have processed something....
                             ASSERT(result != 0);
                         }
+                        else {
+                            _triggered = false;
+                        }
 
                         _adminLock.Unlock();
 
@@ -444,18 +651,13 @@ namespace Plugin
                     {
                     }
 
-                    uint16_t SendCharacters(uint8_t *dataFrame, const TCHAR stream[], const uint8_t delta, const uint16_t total)
-                    {
-                        ASSERT(delta == 0);
-                        // Copying from an aligned position..
-                        ::memcpy(dataFrame, stream, total);
-                        return (total);
-                    }
-
                 private:
                     Core::CriticalSection _adminLock;
-                    std::list<string> _sendQueue;
+                    std::string _pending;
                     uint32_t _offset;
+                    uint16_t _payload;
+                    bool _triggered;
+                    uint32_t _dropped;
                     Core::TerminatorCarriageReturn _terminator;
             };
 
@@ -474,11 +676,11 @@ namespace Plugin
                     OnChangeFile(const OnChangeFile &) = delete;
                     OnChangeFile &operator=(const OnChangeFile &) = delete;
 
-                    void NewLine(const string &text) override
+                    void NewLines(const char text[], const uint32_t length) override
                     {
                         _adminLock.Lock();
 
-                        _parent.NewLine(text);
+                        _parent.NewLines(text, length);
 
                         _adminLock.Unlock();
                     }
@@ -525,11 +727,12 @@ namespace Plugin
 
                 public:
                     Config()
-                        : FilePath(_T("/var/log/messages")), FullFile(false), Destination()
+                        : FilePath(_T("/var/log/messages")), FullFile(false), Destination(), MTU(1500)
                     {
                         Add(_T("filepath"), &FilePath);
                         Add(_T("fullfile"), &FullFile);
                         Add(_T("destination"), &Destination);
+                        Add(_T("mtu"), &MTU);
                     }
                     ~Config() override {}
 
@@ -537,6 +740,7 @@ namespace Plugin
                     Core::JSON::String FilePath;
                     Core::JSON::Boolean FullFile;
                     NetworkNode Destination;
+                    Core::JSON::DecUInt16 MTU;
             };
 
             public:
@@ -55,6 +55,466 @@ ENUM_CONVERSION_END(GPIO::Pin::pull_mode)
 namespace GPIO
 {
 
+    // ----------------------------------------------------------------------------------------------------
+    // Class: CHIP
+    // ----------------------------------------------------------------------------------------------------
+
+    /* static */ Core::CriticalSection Chip::_chipsLock;
+    /* static */ Chip::Chips Chip::_chips;
+
+    Chip::Chip(const string& name)
+        : _adminLock()
+        , _name(name)
+        , _refCount(1)
+        , _chip(-1)
+        , _request(-1)
+        , _monitored(false)
+        , _requested(false)
+        , _dirty(false)
+        , _active(false)
+        , _lines()
+    {
+        string device(name);
+
+        // Accept "/dev/gpiochip0", "gpiochip0" and "0"
+        if (device.empty() == false) {
+            if (::isdigit(device[0]) != 0) {
+                device = _T("/dev/gpiochip") + device;
+            } else if (device[0] != '/') {
+                device = _T("/dev/") + device;
+            }
+        }
+
+        _chip = open(device.c_str(), O_RDWR | O_CLOEXEC);
+
+        if (_chip == -1) {
+            TRACE(Trace::Error, (_T("Could not open GPIO chip %s, error: %d"), device.c_str(), errno));
+        }
+    }
+
+    /* virtual */ Chip::~Chip()
+    {
+        Close();
+
+        if (_chip != -1) {
+            close(_chip);
+            _chip = -1;
+        }
+    }
+
+    /* static */ Chip* Chip::Instance(const string& name)
+    {
+        Chip* result = nullptr;
+
+        _chipsLock.Lock();
+
+        Chips::iterator index(_chips.find(name));
+
+        if (index != _chips.end()) {
+            result = index->second;
+            result->_refCount++;
+        } else {
+            result = new Chip(name);
+
+            if (result->IsValid() == false) {
+                delete result;
+                result = nullptr;
+            } else {
+                _chips.insert(std::pair<const string, Chip*>(name, result));
+            }
+        }
+
+        _chipsLock.Unlock();
+
+        return (result);
+    }
+
+    /* static */ void Chip::Commit()
+    {
+        _chipsLock.Lock();
+
+        for (std::pair<const string, Chip*>& entry : _chips) {
+            Chip& chip(*(entry.second));
+
+            chip._adminLock.Lock();
+            chip._active = true;
+            chip.Apply();
+            chip._adminLock.Unlock();
+        }
+
+        _chipsLock.Unlock();
+    }
+
+    void Chip::Release()
+    {
+        _chipsLock.Lock();
+
+        ASSERT(_refCount > 0);
+
+        if (--_refCount == 0) {
+            _chips.erase(_name);
+            delete this;
+        }
+
+        _chipsLock.Unlock();
+    }
+
+    bool Chip::Add(Pin* pin, const uint32_t line)
+    {
+        bool result = false;
+
+        _adminLock.Lock();
+
+        ASSERT(_lines.find(line) == _lines.end());
+
+        if (_lines.find(line) != _lines.end()) {
+            TRACE(Trace::Error, (_T("Line %d of GPIO chip %s is already in use"), line, _name.c_str()));
+        } else if (_lines.size() >= GPIO_V2_LINES_MAX) {
+            // All lines go into one request, the kernel does not take more.
+            TRACE(Trace::Error, (_T("Line %d not added, GPIO chip %s has reached the maximum of %d lines"), line, _name.c_str(), GPIO_V2_LINES_MAX));
+        } else {
+            _lines[line].Pin = pin;
+            _requested = false;
+            result = true;
+        }
+
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    void Chip::Remove(const uint32_t line)
+    {
+        _adminLock.Lock();
+
+        if (_lines.erase(line) > 0) {
+            _requested = false;
+
+            if (_lines.empty() == true) {
+                Close();
+            } else if (_active == true) {
+                Apply();
+            }
+        }
+
+        _adminLock.Unlock();
+    }
+
+    void Chip::Configure(const uint32_t line, const uint64_t flags, const uint32_t debounce)
+    {
+        _adminLock.Lock();
+
+        Lines::iterator index(_lines.find(line));
+
+        ASSERT(index != _lines.end());
+
+        if ((index != _lines.end()) && ((index->second.Flags != flags) || (index->second.Debounce != debounce))) {
+            index->second.Flags = flags;
+            index->second.Debounce = debounce;
+            index->second.Latched = false;
+            _dirty = true;
+
+            if (_active == true) {
+                Apply();
+            }
+        }
+
+        _adminLock.Unlock();
+    }
+
+    bool Chip::Get(const uint32_t line)
+    {
+        bool result = false;
+
+        _adminLock.Lock();
+
+        if (_active == false) {
+            // Used before all pins were committed, request what we have.
+            _active = true;
+            Apply();
+        }
+
+        Lines::iterator index(_lines.find(line));
+
+        if (index != _lines.end()) {
+            // Once a line reported an edge, its value is the level of that edge, as taken from the event record.
+            // Reading the line again could return a level it already bounced back from, before the edge was
+            // handled, and the change would be lost. Lines without a reported edge are read from the kernel.
+            if ((index->second.Latched == false) && (_request != -1)) {
+                struct gpio_v2_line_values values;
+
+                values.mask = Mask(line);
+                values.bits = 0;
+
+                if (ioctl(_request, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) == 0) {
+                    index->second.Value = ((values.bits & values.mask) != 0);
+                }
+            }
+
+            result = index->second.Value;
+        }
+
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    void Chip::Set(const uint32_t line, const bool value)
+    {
+        _adminLock.Lock();
+
+        if (_active == false) {
+            _active = true;
+            Apply();
+        }
+
+        Lines::iterator index(_lines.find(line));
+
+        if (index != _lines.end()) {
+            index->second.Value = value;
+
+            if ((_request != -1) && ((index->second.Flags & GPIO_V2_LINE_FLAG_OUTPUT) != 0)) {
+                struct gpio_v2_line_values values;
+
+                values.mask = Mask(line);
+                values.bits = (value ? values.mask : 0);
+
+                ioctl(_request, GPIO_V2_LINE_SET_VALUES_IOCTL, &values);
+            }
+        }
+
+        _adminLock.Unlock();
+    }
+
+    /* virtual */ Core::IResource::handle Chip::Descriptor() const
+    {
+        return (_request);
+    }
+
+    /* virtual */ uint16_t Chip::Events()
+    {
+        return (_request != -1 ? POLLIN : 0);
+    }
+
+    /* virtual */ void Chip::Handle(const uint16_t events)
+    {
+        if ((events & POLLIN) != 0) {
+            struct gpio_v2_line_event edges[EventBatch];
+            ssize_t size;
+
+            // Drain all pending edges, a full batch means there might be more.
+            do {
+                size = read(_request, edges, sizeof(edges));
+
+                if (size > 0) {
+                    // Kernel timestamps are CLOCK_MONOTONIC, translate them to our ticks.
+                    struct timespec monotonic;
+                    clock_gettime(CLOCK_MONOTONIC, &monotonic);
+                    const int64_t offset = static_cast<int64_t>(Core::Time::Now().Ticks()) - ((static_cast<int64_t>(monotonic.tv_sec) * 1000000) + (monotonic.tv_nsec / 1000));
+
+                    const uint32_t count = static_cast<uint32_t>(size) / sizeof(struct gpio_v2_line_event);
+
+                    for (uint32_t index = 0; index < count; index++) {
+                        const bool active = (edges[index].id == GPIO_V2_LINE_EVENT_RISING_EDGE);
+                        Pin* pin = nullptr;
+
+                        _adminLock.Lock();
+
+                        Lines::iterator entry(_lines.find(edges[index].offset));
+
+                        if (entry != _lines.end()) {
+                            entry->second.Value = active;
+                            entry->second.Latched = true;
+                            pin = entry->second.Pin;
+                        }
+
+                        _adminLock.Unlock();
+
+                        if (pin != nullptr) {
+                            pin->Edge(active, static_cast<uint64_t>(static_cast<int64_t>(edges[index].timestamp_ns / 1000) + offset));
+                        }
+                    }
+                }
+            } while (size == static_cast<ssize_t>(sizeof(edges)));
+        }
+    }
+
+    // Called with the lock taken.
+    void Chip::Apply()
+    {
+        if (_lines.empty() == false) {
+            if (_requested == false) {
+                Request();
+            } else if (_dirty == true) {
+                struct gpio_v2_line_config config;
+
+                Build(config);
+
+                if (ioctl(_request, GPIO_V2_LINE_SET_CONFIG_IOCTL, &config) != 0) {
+                    TRACE(Trace::Error, (_T("Could not reconfigure the lines of GPIO chip %s, error: %d"), _name.c_str(), errno));
+                }
+                _dirty = false;
+
+                Monitor();
+            }
+        }
+    }
+
+    // Called with the lock taken.
+    void Chip::Request()
+    {
+        struct gpio_v2_line_request request;
+
+        Close();
+
+        memset(&request, 0, sizeof(request));
+
+        for (const std::pair<const uint32_t, Line>& entry : _lines) {
+            ASSERT(request.num_lines < GPIO_V2_LINES_MAX);
+            request.offsets[request.num_lines++] = entry.first;
+        }
+
+        strncpy(request.consumer, _T("IOConnector"), sizeof(request.consumer) - 1);
+        Build(request.config);
+
+        if (ioctl(_chip, GPIO_V2_GET_LINE_IOCTL, &request) != 0) {
+            TRACE(Trace::Error, (_T("Could not request %d lines of GPIO chip %s, error: %d"), request.num_lines, _name.c_str(), errno));
+        } else {
+            _request = request.fd;
+
+            fcntl(_request, F_SETFL, fcntl(_request, F_GETFL) | O_NONBLOCK);
+
+            // Start from the actual values of the lines.
+            struct gpio_v2_line_values values;
+            values.mask = (request.num_lines < 64 ? ((1ULL << request.num_lines) - 1) : ~0ULL);
+            values.bits = 0;
+
+            if (ioctl(_request, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) == 0) {
+                uint8_t bit = 0;
+                for (std::pair<const uint32_t, Line>& entry : _lines) {
+                    entry.second.Value = ((values.bits & (1ULL << bit)) != 0);
+                    entry.second.Latched = false;
+                    bit++;
+                }
+            }
+
+            Monitor();
+        }
+
+        _requested = true;
+        _dirty = false;
+    }
+
+    // Called with the lock taken.
+    void Chip::Close()
+    {
+        if (_monitored == true) {
+            Core::ResourceMonitor::Instance().Unregister(*this);
+            _monitored = false;
+        }
+        if (_request != -1) {
+            close(_request);
+            _request = -1;
+        }
+    }
+
+    // Called with the lock taken, only watch the request if one of the lines reports edges.
+    void Chip::Monitor()
+    {
+        bool edges = false;
+
+        for (const std::pair<const uint32_t, Line>& entry : _lines) {
+            edges = edges || ((entry.second.Flags & (GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING)) != 0);
+        }
+
+        if ((edges == true) && (_monitored == false) && (_request != -1)) {
+            Core::ResourceMonitor::Instance().Register(*this);
+            _monitored = true;
+        } else if ((edges == false) && (_monitored == true)) {
+            Core::ResourceMonitor::Instance().Unregister(*this);
+            _monitored = false;
+        }
+    }
+
+    // The configuration of all lines, the flags most lines have are the default, the rest go into attributes.
+    void Chip::Build(struct gpio_v2_line_config& config) const
+    {
+        std::map<uint64_t, uint64_t> flags; // flags -> mask
+        std::map<uint32_t, uint64_t> debounces; // period -> mask
+        uint64_t outputs = 0;
+        uint64_t values = 0;
+        uint8_t bit = 0;
+
+        memset(&config, 0, sizeof(config));
+
+        for (const std::pair<const uint32_t, Line>& entry : _lines) {
+            const uint64_t mask = (1ULL << bit);
+
+            flags[entry.second.Flags] |= mask;
+
+            if ((entry.second.Flags & GPIO_V2_LINE_FLAG_OUTPUT) != 0) {
+                outputs |= mask;
+                values |= (entry.second.Value ? mask : 0);
+            } else if (entry.second.Debounce != 0) {
+                debounces[entry.second.Debounce] |= mask;
+            }
+            bit++;
+        }
+
+        std::map<uint64_t, uint64_t>::const_iterator common(flags.begin());
+        for (std::map<uint64_t, uint64_t>::const_iterator index(flags.begin()); index != flags.end(); index++) {
+            if (__builtin_popcountll(index->second) > __builtin_popcountll(common->second)) {
+                common = index;
+            }
+        }
+
+        config.flags = common->first;
+
+        for (std::map<uint64_t, uint64_t>::const_iterator index(flags.begin()); index != flags.end(); index++) {
+            if (index != common) {
+                if (config.num_attrs < GPIO_V2_LINE_NUM_ATTRS_MAX) {
+                    config.attrs[config.num_attrs].attr.id = GPIO_V2_LINE_ATTR_ID_FLAGS;
+                    config.attrs[config.num_attrs].attr.flags = index->first;
+                    config.attrs[config.num_attrs].mask = index->second;
+                    config.num_attrs++;
+                } else {
+                    TRACE(Trace::Error, (_T("Too many different line configurations on GPIO chip %s"), _name.c_str()));
+                }
+            }
+        }
+        if ((outputs != 0) && (config.num_attrs < GPIO_V2_LINE_NUM_ATTRS_MAX)) {
+            config.attrs[config.num_attrs].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+            config.attrs[config.num_attrs].attr.values = values;
+            config.attrs[config.num_attrs].mask = outputs;
+            config.num_attrs++;
+        }
+        for (const std::pair<const uint32_t, uint64_t>& entry : debounces) {
+            if (config.num_attrs < GPIO_V2_LINE_NUM_ATTRS_MAX) {
+                config.attrs[config.num_attrs].attr.id = GPIO_V2_LINE_ATTR_ID_DEBOUNCE;
+                config.attrs[config.num_attrs].attr.debounce_period_us = entry.first;
+                config.attrs[config.num_attrs].mask = entry.second;
+                config.num_attrs++;
+            } else {
+                TRACE(Trace::Error, (_T("No room left to debounce lines on GPIO chip %s"), _name.c_str()));
+            }
+        }
+    }
+
+    // Lines are requested in the order of their offset, the mask is the position in the request.
+    uint64_t Chip::Mask(const uint32_t line) const
+    {
+        uint8_t bit = 0;
+        Lines::const_iterator index(_lines.begin());
+
+        while ((index != _lines.end()) && (index->first != line)) {
+            index++;
+            bit++;
+        }
+
+        return (index != _lines.end() ? (1ULL << bit) : 0);
+    }
+
+
     // ----------------------------------------------------------------------------------------------------
     // Class: PIN
     // ----------------------------------------------------------------------------------------------------
@@ -66,6 +526,13 @@ namespace GPIO
         , _lastValue(false)
         , _descriptor(-1)
         , _timedPin(this)
+        , _timestamp(0)
+        , _chip(nullptr)
+        , _line(0)
+        , _debounce(0)
+        , _mode(INPUT)
+        , _trigger(NONE)
+        , _pull(OFF)
     {
         if (_pin != 0xFFFF) {
             struct stat properties;
@@ -96,8 +563,41 @@ namespace GPIO
         _timedPin.AddReference();
     }
 
+    Pin::Pin(const uint16_t pin, const string& chip, const uint32_t line, const bool activeLow, const uint16_t debounce)
+        : BaseClass(pin, IExternal::regulator, IExternal::general, IExternal::logic, 0)
+        , _pin(pin)
+        , _activeLow(activeLow ? 1 : 0)
+        , _lastValue(false)
+        , _descriptor(-1)
+        , _timedPin(this)
+        , _timestamp(0)
+        , _chip(Chip::Instance(chip))
+        , _line(line)
+        , _debounce(static_cast<uint32_t>(debounce) * 1000)
+        , _mode(INPUT)
+        , _trigger(NONE)
+        , _pull(OFF)
+    {
+        if ((_chip != nullptr) && (_chip->Add(this, _line) == false)) {
+            _chip->Release();
+            _chip = nullptr;
+        }
+        if (_chip != nullptr) {
+            Configure();
+        }
+
+        _timedPin.AddRef();
+        _timedPin.AddReference();
+    }
+
     /* virtual */ Pin::~Pin()
     {
+        if (_chip != nullptr) {
+            _chip->Remove(_line);
+            _chip->Release();
+            _chip = nullptr;
+        }
+
         if (_descriptor != -1) {
 
             Core::ResourceMonitor::Instance().Unregister(*this);
@@ -167,6 +667,8 @@ namespace GPIO
 
             read(_descriptor, &buffer, sizeof(buffer));
 
+            _timestamp = Core::Time::Now().Ticks();
+
             // If we are only triggered on a falling edge, or a rising edge
             // the change is not detected compared to the previous value,
             // force HasChanged to be true!!
@@ -176,9 +678,49 @@ namespace GPIO
         }
     }
 
+    void Pin::Edge(const bool active, const uint64_t timestamp)
+    {
+        _timestamp = timestamp;
+
+        // Same as for the sysfs pins, an edge is a change, also if it happens to be reverted already. The chip
+        // latched the level of the edge, so Get() reports that level and not what the line reads by now.
+        _lastValue = !active;
+
+        Updated();
+    }
+
+    void Pin::Configure()
+    {
+        ASSERT(_chip != nullptr);
+
+        uint64_t flags = (_activeLow != 0 ? GPIO_V2_LINE_FLAG_ACTIVE_LOW : 0);
+        uint32_t debounce = 0;
+
+        if (_mode == OUTPUT) {
+            flags |= GPIO_V2_LINE_FLAG_OUTPUT;
+        } else {
+            flags |= GPIO_V2_LINE_FLAG_INPUT;
+            flags |= ((_trigger & RISING) != 0 ? GPIO_V2_LINE_FLAG_EDGE_RISING : 0);
+            flags |= ((_trigger & FALLING) != 0 ? GPIO_V2_LINE_FLAG_EDGE_FALLING : 0);
+            debounce = _debounce;
+        }
+
+        if (_pull == UP) {
+            flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_UP;
+        } else if (_pull == DOWN) {
+            flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN;
+        }
+
+        _chip->Configure(_line, flags, debounce);
+    }
+
     void Pin::Trigger(const trigger_mode mode)
     {
-        if (_descriptor != -1) {
+        if (_chip != nullptr) {
+            // Level triggers do not exist for lines, only edges.
+            _trigger = mode;
+            Configure();
+        } else if (_descriptor != -1) {
             // Oke looks like we have a valid pin.
             char buffer[64];
             sprintf(buffer, "/sys/class/gpio/gpio%d/edge", _pin);
@@ -211,7 +753,10 @@ namespace GPIO
     {
         bool result = false;
 
-        if (_descriptor != -1) {
+        if (_chip != nullptr) {
+            // The kernel takes care of active low lines.
+            result = _chip->Get(_line);
+        } else if (_descriptor != -1) {
             uint8_t value;
             lseek(_descriptor, 0, SEEK_SET);
             read(_descriptor, &value, 1);
@@ -225,7 +770,9 @@ namespace GPIO
 
     void Pin::Set(const bool value)
     {
-        if (_descriptor != -1) {
+        if (_chip != nullptr) {
+            _chip->Set(_line, value);
+        } else if (_descriptor != -1) {
             uint8_t newValue;
             if (_activeLow != 0) {
                 newValue = (value ? '0' : '1');
@@ -238,7 +785,12 @@ namespace GPIO
 
     void Pin::Mode(const pin_mode mode)
     {
-        if (_descriptor != -1) {
+        if (_chip != nullptr) {
+            if ((mode == GPIO::Pin::INPUT) || (mode == GPIO::Pin::OUTPUT)) {
+                _mode = mode;
+                Configure();
+            }
+        } else if (_descriptor != -1) {
             // Oke looks like we have a valid pin.
             char buffer[64];
             sprintf(buffer, "/sys/class/gpio/gpio%d/direction", _pin);
@@ -261,7 +813,10 @@ namespace GPIO
 
     void Pin::Pull(const pull_mode mode)
     {
-        if (_descriptor != -1) {
+        if (_chip != nullptr) {
+            _pull = mode;
+            Configure();
+        } else if (_descriptor != -1) {
             // Oke looks like we have a valid pin.
             char buffer[64];
             sprintf(buffer, "/sys/class/gpio/gpio%d/active_low", _pin);
@@ -26,10 +26,99 @@
 #include <interfaces/IExternalBase.h>
 #include <interfaces/IInputPin.h>
 
+#include <linux/gpio.h>
+
 namespace WPEFramework {
 
 namespace GPIO {
 
+    class Pin;
+
+    // A /dev/gpiochipN device, using the GPIO v2 character device interface. All lines of the chip that are in use
+    // are requested through one line request, so all edges of all pins arrive, batched, on a single descriptor.
+    class Chip : public Core::IResource {
+    private:
+        // Number of edge events read in one go.
+        static constexpr uint8_t EventBatch = 16;
+
+        // A line is addressed by its position in the request, as a bit in a 64 bit mask.
+        static_assert(GPIO_V2_LINES_MAX <= 64, "GPIO line masks do not fit the request");
+
+        struct Line {
+            Line()
+                : Pin(nullptr)
+                , Flags(0)
+                , Debounce(0)
+                , Value(false)
+                , Latched(false)
+            {
+            }
+
+            GPIO::Pin* Pin;
+            uint64_t Flags;
+            uint32_t Debounce; // us
+            bool Value;
+            bool Latched; // Value is the level of the last reported edge
+        };
+
+        using Lines = std::map<uint32_t, Line>;
+        using Chips = std::map<string, Chip*>;
+
+    public:
+        Chip() = delete;
+        Chip(const Chip&) = delete;
+        Chip& operator=(const Chip&) = delete;
+
+        Chip(const string& name);
+        ~Chip() override;
+
+    public:
+        static Chip* Instance(const string& name);
+        // Requests the lines of all chips that changed since the last commit.
+        static void Commit();
+        void Release();
+
+        inline bool IsValid() const
+        {
+            return (_chip != -1);
+        }
+
+        // Fails if the line is in use, or the chip already has the maximum number of lines in its request.
+        bool Add(Pin* pin, const uint32_t line);
+        void Remove(const uint32_t line);
+        void Configure(const uint32_t line, const uint64_t flags, const uint32_t debounce);
+
+        bool Get(const uint32_t line);
+        void Set(const uint32_t line, const bool value);
+
+    private:
+        Core::IResource::handle Descriptor() const override;
+        uint16_t Events() override;
+        void Handle(const uint16_t events) override;
+
+        void Apply();
+        void Request();
+        void Close();
+        void Monitor();
+        void Build(struct gpio_v2_line_config& config) const;
+        uint64_t Mask(const uint32_t line) const;
+
+    private:
+        Core::CriticalSection _adminLock;
+        const string _name;
+        uint32_t _refCount;
+        int _chip;
+        int _request;
+        bool _monitored;
+        bool _requested; // The lines in the request are the lines we have
+        bool _dirty; // The line configuration changed since it was requested
+        bool _active; // Committed, changes are applied right away
+        Lines _lines;
+
+        static Core::CriticalSection _chipsLock;
+        static Chips _chips;
+    };
+
     class Pin : public Exchange::ExternalBase<Exchange::IExternal::GPIO>, 
                 public Exchange::IInputPin,
                 public Core::IResource {
@@ -171,7 +260,7 @@ namespace GPIO {
             {
                 uint32_t marker;
 
-                if (_monitor.Reached(pressed, marker) == true) {
+                if (_monitor.Reached(pressed, marker, _parent.Timestamp()) == true) {
  
                     _parent.Lock();
 
@@ -249,6 +338,8 @@ namespace GPIO {
         Pin& operator=(const Pin&) = delete;
 
         Pin(const uint16_t id, const bool activeLow);
+        // A line of a gpiochip. The debounce period (in ms) is applied by the kernel.
+        Pin(const uint16_t id, const string& chip, const uint32_t line, const bool activeLow, const uint16_t debounce);
         ~Pin() override;
 
     public:
@@ -262,14 +353,26 @@ namespace GPIO {
         bool HasChanged() const;
         void Align();
 
+        // Moment (in ticks) of the last change of the pin. For a gpiochip line this is the kernel timestamp of the edge.
+        inline uint64_t Timestamp() const
+        {
+            return (_timestamp);
+        }
+
         inline void Subscribe(Exchange::IExternal::INotification* sink)
         {
             BaseClass::Register(sink);
-            Core::ResourceMonitor::Instance().Register(*this);
+
+            // Lines of a gpiochip are monitored by their chip.
+            if (_chip == nullptr) {
+                Core::ResourceMonitor::Instance().Register(*this);
+            }
         }
         inline void Unsubscribe(Exchange::IExternal::INotification* sink)
         {
-            Core::ResourceMonitor::Instance().Unregister(*this);
+            if (_chip == nullptr) {
+                Core::ResourceMonitor::Instance().Unregister(*this);
+            }
             BaseClass::Unregister(sink);
         }
 
@@ -295,12 +398,25 @@ namespace GPIO {
         void Handle(const uint16_t events) override;
         void Flush();
 
+        friend class Chip;
+        void Edge(const bool active, const uint64_t timestamp);
+        void Configure();
+
     private:
         const uint16_t _pin;
         uint8_t _activeLow;
         bool _lastValue;
         mutable int _descriptor;
         Core::ProxyObject<TimedPin> _timedPin;
+        uint64_t _timestamp;
+
+        // Only used for a line of a gpiochip.
+        Chip* _chip;
+        const uint32_t _line;
+        const uint32_t _debounce; // us
+        pin_mode _mode;
+        trigger_mode _trigger;
+        pull_mode _pull;
     };
 }
 } // namespace WPEFramework::GPIO
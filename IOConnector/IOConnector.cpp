@@ -106,7 +106,9 @@ namespace Plugin
 
         while (index.Next() == true) {
 
-            GPIO::Pin* pin = Core::Service<GPIO::Pin>::Create<GPIO::Pin>(index.Current().Id.Value(), index.Current().ActiveLow.Value());
+            GPIO::Pin* pin = (index.Current().Chip.IsSet() == true
+                ? Core::Service<GPIO::Pin>::Create<GPIO::Pin>(index.Current().Id.Value(), index.Current().Chip.Value(), index.Current().Line.Value(), index.Current().ActiveLow.Value(), index.Current().Debounce.Value())
+                : Core::Service<GPIO::Pin>::Create<GPIO::Pin>(index.Current().Id.Value(), index.Current().ActiveLow.Value()));
             uint8_t mode = 0;
 
             if (pin != nullptr) {
@@ -207,6 +209,9 @@ namespace Plugin
             }
         }
 
+        // All lines of a gpiochip are requested at once, now that all pins are configured.
+        GPIO::Chip::Commit();
+
         // On success return empty, to indicate there is no error text.
         return (_pins.size() > 0 ? string() : _T("Could not instantiate the requested Pin"));
     }
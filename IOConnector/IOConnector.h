@@ -193,22 +193,34 @@ namespace Plugin {
                     , Mode(LOW)
                     , ActiveLow(false)
                     , Handlers()
+                    , Chip()
+                    , Line(0)
+                    , Debounce(0)
                 {
                     Add(_T("id"), &Id);
                     Add(_T("mode"), &Mode);
                     Add(_T("activelow"), &ActiveLow);
                     Add(_T("handlers"), &Handlers);
+                    Add(_T("chip"), &Chip);
+                    Add(_T("line"), &Line);
+                    Add(_T("debounce"), &Debounce);
                 }
                 Pin(const Pin& copy)
                     : Id(copy.Id)
                     , Mode(copy.Mode)
                     , ActiveLow(copy.ActiveLow)
                     , Handlers(copy.Handlers)
+                    , Chip(copy.Chip)
+                    , Line(copy.Line)
+                    , Debounce(copy.Debounce)
                 {
                     Add(_T("id"), &Id);
                     Add(_T("mode"), &Mode);
                     Add(_T("activelow"), &ActiveLow);
                     Add(_T("handlers"), &Handlers);
+                    Add(_T("chip"), &Chip);
+                    Add(_T("line"), &Line);
+                    Add(_T("debounce"), &Debounce);
                 }
                 ~Pin() override
                 {
@@ -220,6 +232,9 @@ namespace Plugin {
                     Mode = RHS.Mode;
                     ActiveLow = RHS.ActiveLow;
                     Handlers = RHS.Handlers;
+                    Chip = RHS.Chip;
+                    Line = RHS.Line;
+                    Debounce = RHS.Debounce;
 
                     return (*this);
                 }
@@ -229,6 +244,9 @@ namespace Plugin {
                 Core::JSON::EnumType<mode> Mode;
                 Core::JSON::Boolean ActiveLow;
                 Core::JSON::ArrayType<Handler> Handlers;
+                Core::JSON::String Chip; // gpiochip the pin is a line of, if not set the sysfs interface is used
+                Core::JSON::DecUInt32 Line;
+                Core::JSON::DecUInt16 Debounce; // ms, applied by the kernel, gpiochip lines only
             };
 
         public:
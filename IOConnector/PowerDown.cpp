@@ -90,7 +90,7 @@ namespace Plugin {
 
             ASSERT(_service != nullptr);
 
-            if (_state.Reached(pin.Get(), marker) == true) {
+            if (_state.Reached(pin.Get(), marker, pin.Timestamp()) == true) {
                 Exchange::IPower* handler(_service->QueryInterfaceByCallsign<Exchange::IPower>(_callsign));
 
                 if (handler != nullptr) {
@@ -77,7 +77,7 @@ namespace Plugin {
 
             ASSERT(_service != nullptr);
 
-            if ( (_state.Reached(pin.Get(), marker) == true) && (_marker == marker) ) {
+            if ( (_state.Reached(pin.Get(), marker, pin.Timestamp()) == true) && (_marker == marker) ) {
                 Exchange::IKeyHandler* handler(_service->QueryInterfaceByCallsign<Exchange::IKeyHandler>(_callsign));
 
                 if (handler != nullptr) {
@@ -52,7 +52,7 @@ namespace Plugin {
 
             ASSERT(_service != nullptr);
 
-            if ( (_state.Reached(pin.Get(), marker) == true) && (_begin == marker) ) {
+            if ( (_state.Reached(pin.Get(), marker, pin.Timestamp()) == true) && (_begin == marker) ) {
  
                 TRACE(Trace::Information, (_T("Reached Interval [%d] - [%d] seconds."), _begin / 1000, _end / 1000));
                 _service->Notify(_message);
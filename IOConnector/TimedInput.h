@@ -69,10 +69,11 @@ namespace GPIO {
                 _markers.erase(index);
             }
         }
-        bool Reached(bool pressed, uint32_t& marker) const
+        // The timestamp is the moment the pin changed (in ticks), if known. Otherwise it is taken now.
+        bool Reached(bool pressed, uint32_t& marker, const uint64_t timestamp = 0) const
         {
             bool reached = false;
-            uint64_t now = Core::Time::Now().Ticks();
+            uint64_t now = (timestamp != 0 ? timestamp : Core::Time::Now().Ticks());
 
             marker = ~0;
 
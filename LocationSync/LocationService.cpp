@@ -210,7 +210,7 @@ namespace Plugin {
         Geography _geo;
     };
 
-    static Core::ProxyPoolType<Web::Response> g_Factory(1);
+    static Core::ProxyPoolType<Web::Response> g_Factory(2);
 
     static Core::NodeId FindLocalIPV6()
     {
@@ -257,16 +257,105 @@ namespace Plugin {
         return (index < (sizeof(g_domainFactory) / sizeof(DomainConstructor)) ? &(g_domainFactory[index]) : nullptr);
     }
 
+    LocationService::Connection::Connection(LocationService& parent, Core::ProxyPoolType<Web::Response>& factory)
+        : BaseClass(1, factory, false, Core::NodeId(), Core::NodeId(), 256, 1024)
+        , _parent(parent)
+        , _racing(false)
+        , _infoCarrier()
+        , _request(Core::ProxyType<Web::Request>::Create())
+    {
+    }
+
+    /* virtual */ LocationService::Connection::~Connection()
+    {
+        Close(Core::infinite);
+    }
+
+    bool LocationService::Connection::Start(const Core::NodeId& remote, const Core::ProxyType<IGeography>& carrier)
+    {
+        ASSERT(_racing == false);
+
+        Link().LocalNode(remote.AnyInterface());
+        Link().RemoteNode(remote);
+
+        TRACE(Trace::Information, (_T("Probing [%s:%d] on [%s]"), remote.HostAddress().c_str(), remote.PortNumber(), remote.Type() == Core::NodeId::TYPE_IPV6 ? _T("IPV6") : _T("IPv4")));
+
+        _infoCarrier = carrier;
+
+        uint32_t status = Open(0);
+
+        _racing = ((status == Core::ERROR_NONE) || (status == Core::ERROR_INPROGRESS));
+
+        if (_racing == false) {
+            TRACE_L1("Failed to open a connection on %s, status: %d", (remote.Type() == Core::NodeId::TYPE_IPV6 ? _T("IPv6") : _T("IPv4")), status);
+
+            Close(0);
+            _infoCarrier.Release();
+        }
+
+        return (_racing);
+    }
+
+    void LocationService::Connection::Abort()
+    {
+        _racing = false;
+
+        if (IsClosed() == false) {
+            Close(0);
+        }
+
+        if (_infoCarrier.IsValid() == true) {
+            _infoCarrier.Release();
+        }
+    }
+
+    // Methods to extract and insert data into the socket buffers
+    /* virtual */ void LocationService::Connection::LinkBody(Core::ProxyType<Web::Response>& element)
+    {
+        if ((element->ErrorCode == Web::STATUS_OK) && (_infoCarrier.IsValid() == true)) {
+
+            element->Body<Web::IBody>(Core::proxy_cast<Web::IBody>(_infoCarrier));
+        }
+    }
+
+    /* virtual */ void LocationService::Connection::Received(Core::ProxyType<Web::Response>& element)
+    {
+        if (element->HasBody() == true) {
+            _parent.Received(*this);
+        } else {
+            TRACE_L1("Got a response but had an empty body. %d", __LINE__);
+
+            _parent.Failed(*this);
+        }
+    }
+
+    /* virtual */ void LocationService::Connection::Send(const Core::ProxyType<Web::Request>& element)
+    {
+        // Not much to do, just so we know we are done...
+        ASSERT(element == _request);
+    }
+
+    // Signal a state change, Opened, Closed or Accepted
+    /* virtual */ void LocationService::Connection::StateChange()
+    {
+        if (Link().IsOpen() == true) {
+
+            // Send out a trigger to send the request
+            Submit(_request);
+        } else if (Link().HasError() == true) {
+            _parent.Failed(*this);
+        }
+    }
+
 #ifdef __WINDOWS__
 #pragma warning(disable : 4355)
 #endif
     LocationService::LocationService(Core::IDispatchType<void>* callback)
-        : BaseClass(1, g_Factory, false, Core::NodeId(), Core::NodeId(), 256, 1024)
-        , _adminLock()
+        : _adminLock()
         , _state(IDLE)
         , _remoteId()
-        , _sourceNode()
         , _tryInterval(0)
+        , _retries(0)
         , _callback(callback)
         , _publicIPAddress()
         , _timeZone()
@@ -274,8 +363,13 @@ namespace Plugin {
         , _region()
         , _city()
         , _activity(*this)
-        , _infoCarrier()
-        , _request(Core::ProxyType<Web::Request>::Create())
+        , _factory(nullptr)
+        , _remoteIPV6()
+        , _remoteIPV4()
+        , _ipv4Pending(false)
+        , _deadline(0)
+        , _ipv6(*this, g_Factory)
+        , _ipv4(*this, g_Factory)
     {
     }
 #ifdef __WINDOWS__
@@ -286,8 +380,6 @@ namespace Plugin {
     {
 
         Stop();
-
-        Close(Core::infinite);
     }
 
     uint32_t LocationService::Probe(const string& remote, const uint32_t retries, const uint32_t retryTimeSpan)
@@ -298,8 +390,6 @@ namespace Plugin {
 
         if ((_state == IDLE) || (_state == FAILED) || (_state == LOADED)) {
 
-            ASSERT(_infoCarrier.IsValid() == false);
-
             result = Core::ERROR_GENERAL;
 
             // Determine the request
@@ -314,34 +404,45 @@ namespace Plugin {
                 if (constructor != nullptr) {
 
                     const string hostName(info.Host().Value());
-
+                    string remoteId(hostName);
 
                     _state = ACTIVE;
 
                     // it runs till zero, so subtract by definition 1 :-)
                     _retries = (retries - 1);
                     _tryInterval = retryTimeSpan * 1000; // Move from seconds to mS.
-                    _request->Host = hostName;
-                    _request->Verb = Web::Request::HTTP_GET;
-                    _request->Path = _T("/");
-                    if (info.Path().IsSet() == true) {
-                        _request->Path += info.Path().Value();
-                    }
-                    _remoteId = hostName;
 
                     if (info.Port().IsSet() == true) {
-                        _remoteId += ':' + Core::NumberType<uint16_t>(info.Port().Value()).Text();
+                        remoteId += ':' + Core::NumberType<uint16_t>(info.Port().Value()).Text();
                     }
                     else {
-                        _remoteId += ':' + Core::NumberType<uint16_t>(Core::URL::Port(info.Type())).Text();
+                        remoteId += ':' + Core::NumberType<uint16_t>(Core::URL::Port(info.Type())).Text();
                     }
 
-                    if (info.Query().IsSet() == true) {
-                        _request->Query = info.Query().Value();
+                    if (remoteId != _remoteId) {
+                        // Different remote, the addresses we resolved before are of no use.
+                        _remoteId = remoteId;
+                        _remoteIPV6 = Core::NodeId();
+                        _remoteIPV4 = Core::NodeId();
                     }
 
-                    string fullRequest; _request->ToString(fullRequest);
-                    _infoCarrier = constructor->factory();
+                    Connection* connections[] = { &_ipv6, &_ipv4 };
+
+                    for (Connection* connection : connections) {
+                        Web::Request& request(connection->Request());
+
+                        request.Host = hostName;
+                        request.Verb = Web::Request::HTTP_GET;
+                        request.Path = _T("/");
+                        if (info.Path().IsSet() == true) {
+                            request.Path += info.Path().Value();
+                        }
+                        if (info.Query().IsSet() == true) {
+                            request.Query = info.Query().Value();
+                        }
+                    }
+
+                    _factory = constructor->factory;
 
                     _activity.Submit();
 
@@ -363,45 +464,45 @@ namespace Plugin {
 
         if ((_state != IDLE) && (_state != FAILED) && (_state != LOADED)) {
 
-            if (IsClosed() == false) {
-                Close(0);
-            }
-
             _state = FAILED;
         }
 
-        if(_infoCarrier.IsValid() == true) {
-            _infoCarrier.Release();
-        }
+        Abort();
 
         _adminLock.Unlock();
     }
 
-    // Methods to extract and insert data into the socket buffers
-    /* virtual */ void LocationService::LinkBody(Core::ProxyType<Web::Response>& element)
+    void LocationService::Provisional(const string& timeZone, const string& country, const string& region, const string& city)
     {
-        if (element->ErrorCode == Web::STATUS_OK) {
-
-            ASSERT(_infoCarrier.IsValid() == true);
+        _adminLock.Lock();
 
-            element->Body<Web::IBody>(Core::proxy_cast<Web::IBody>(_infoCarrier));
+        // Whatever the probe reported is more recent than what was remembered.
+        if (_state != LOADED) {
+            _timeZone = timeZone;
+            _country = country;
+            _region = region;
+            _city = city;
         }
+
+        _adminLock.Unlock();
     }
 
-    /* virtual */ void LocationService::Received(Core::ProxyType<Web::Response>& element)
+    void LocationService::Received(Connection& connection)
     {
-        if (element->HasBody() == true) {
+        _adminLock.Lock();
+
+        if ((_state == RACING) && (connection.IsRacing() == true)) {
 
-            // ASSERT(element->Body<Web::JSONBodyType<IGeography> >() == _response);
+            const Core::ProxyType<IGeography>& carrier(connection.Carrier());
 
-            _adminLock.Lock();
+            ASSERT(carrier.IsValid() == true);
 
-            _timeZone = _infoCarrier->TimeZone();
-            _country = _infoCarrier->Country();
-            _region = _infoCarrier->Region();
-            _city = _infoCarrier->City();
+            _timeZone = carrier->TimeZone();
+            _country = carrier->Country();
+            _region = carrier->Region();
+            _city = carrier->City();
 
-            if (_state == IPV6_INPROGRESS) {
+            if (&connection == &_ipv6) {
 
                 // For now the source IPV6 is not returned but as IPV6 is not NAT'ed our IF Address should be
                 // the outside IP address as well.
@@ -411,10 +512,13 @@ namespace Plugin {
 
                 _publicIPAddress = localId.HostAddress();
             } else {
-                _publicIPAddress = _infoCarrier->IP();
+                _publicIPAddress = carrier->IP();
             }
             _state = LOADED;
 
+            // We have a winner, the other connection can stop racing.
+            Abort();
+
             ASSERT(!_publicIPAddress.empty());
 
             Core::NodeId node(_publicIPAddress.c_str(), Core::NodeId::TYPE_UNSPECIFIED);
@@ -434,62 +538,96 @@ namespace Plugin {
                 TRACE(Trace::Information, (_T("LocationSync: Network connectivity established. Type: %s, on %s"), (node.Type() == Core::NodeId::TYPE_IPV6 ? _T("IPv6") : _T("IPv4")), node.HostAddress().c_str()));
                 _callback->Dispatch();
             }
-
-            ASSERT(_infoCarrier.IsValid() == true);
-
-            _infoCarrier.Release();
-
-            _adminLock.Unlock();
-        } else {
-            TRACE_L1("Got a response but had an empty body. %d", __LINE__);
         }
 
+        _adminLock.Unlock();
+
         // Finish the cycle..
         _activity.Submit();
     }
 
-    /* virtual */ void LocationService::Send(const Core::ProxyType<Web::Request>& element)
+    void LocationService::Failed(Connection& connection)
     {
-        // Not much to do, just so we know we are done...
-        ASSERT(element == _request);
-    }
+        _adminLock.Lock();
 
-    // Signal a state change, Opened, Closed or Accepted
-    /* virtual */ void LocationService::StateChange()
-    {
-        if (Link().IsOpen() == true) {
+        connection.Abort();
 
-            // Send out a trigger to send the request
-            Submit(_request);
-        } else if (Link().HasError() == true) {
-            Close(0);
+        _adminLock.Unlock();
+
+        // Let the race move on, if IPv6 failed, IPv4 does not have to wait for the attempt delay.
+        _activity.Submit();
+    }
 
-            _activity.Submit();
+    void LocationService::Resolve()
+    {
+        if ((Core::NodeId::IsIPV6Enabled() == true) && (_remoteIPV6.IsValid() == false)) {
+            _remoteIPV6 = Core::NodeId(_remoteId.c_str(), Core::NodeId::TYPE_IPV6);
+        }
+        if (_remoteIPV4.IsValid() == false) {
+            _remoteIPV4 = Core::NodeId(_remoteId.c_str(), Core::NodeId::TYPE_IPV4);
         }
     }
 
-    // The network might be down, keep on trying until we have connectivity.
-    // We start using IPV6, preferred network...
+    void LocationService::Abort()
+    {
+        _ipv6.Abort();
+        _ipv4.Abort();
+        _ipv4Pending = false;
+    }
+
+    // The network might be down, keep on trying until we have connectivity. Both IPv6 (preferred) and
+    // IPv4 race for the answer, IPv4 joins AttemptDelay mS after IPv6 was started (RFC 8305).
     void LocationService::Dispatch()
     {
         uint32_t result = Core::infinite;
 
-        if ((IsClosed() == false) || (Close(100) != Core::ERROR_NONE)) {
+        if ((_ipv6.IsClosed() == false) || (_ipv4.IsClosed() == false)) {
+            if ((_state != RACING) || ((_ipv6.IsRacing() == false) && (_ipv4.IsRacing() == false))) {
+                // Leftovers of a previous attempt, give them some time to close down.
+                _ipv6.Close(100);
+                _ipv4.Close(100);
+            }
+        }
 
-            result = 500; // ms...Check again..
-        } else {
+        _adminLock.Lock();
+
+        state previous = _state;
+
+        if (_state == RACING) {
+
+            uint64_t now = Core::Time::Now().Ticks();
 
-            _adminLock.Lock();
+            if ((_ipv4Pending == true) && (now < _deadline)) {
+                _ipv4Pending = false;
+
+                if (_ipv4.Start(_remoteIPV4, _factory()) == true) {
+                    TRACE_L1("IPv4 joined the race. Attempt: %d", _retries);
+                }
+            }
+
+            if ((now >= _deadline) || ((_ipv6.IsRacing() == false) && (_ipv4.IsRacing() == false))) {
+
+                TRACE_L1("No answer on this attempt. Reschedule for the next attempt: %d", _retries);
+
+                Abort();
 
-            if (_state == IPV4_INPROGRESS) {
                 _state = (_retries-- == 0 ? FAILED : ACTIVE);
+
+                // Give the connections a moment to close before the next attempt.
+                result = 100;
+            } else {
+                result = static_cast<uint32_t>((_deadline - now) / Core::Time::TicksPerMillisecond);
             }
+        } else if (_state == ACTIVE) {
 
-            if ((_state != LOADED) && (_state != FAILED)) {
+            if ((_ipv6.IsClosed() == false) || (_ipv4.IsClosed() == false)) {
+                result = 500; // ms...Check again..
+            } else {
+                Resolve();
 
-                Core::NodeId remote(_remoteId.c_str(), ((_state == ACTIVE) && (Core::NodeId::IsIPV6Enabled()) ? Core::NodeId::TYPE_IPV6 : Core::NodeId::TYPE_IPV4));
+                bool ipv6 = ((Core::NodeId::IsIPV6Enabled() == true) && (_remoteIPV6.IsValid() == true));
 
-                if (remote.IsValid() == false) {
+                if ((ipv6 == false) && (_remoteIPV4.IsValid() == false)) {
 
                     TRACE_L1("DNS resolving failed. Sleep for %d mS for attempt %d", _tryInterval, _retries);
 
@@ -499,38 +637,35 @@ namespace Plugin {
                     else
                         result = _tryInterval;
                 } else {
-                    Link().LocalNode(remote.AnyInterface());
-                    Link().RemoteNode(remote);
+                    _state = RACING;
+                    _deadline = Core::Time::Now().Add(_tryInterval).Ticks();
 
-                    TRACE(Trace::Information, (_T("Probing [%s:%d] on [%s]"), remote.HostAddress().c_str(), remote.PortNumber(), remote.Type() == Core::NodeId::TYPE_IPV6 ? _T("IPV6") : _T("IPv4")));
-                    _state = (remote.Type() == Core::NodeId::TYPE_IPV6 ? IPV6_INPROGRESS : IPV4_INPROGRESS);
+                    TRACE_L1("Sending out a network package. Attempt: %d", _retries);
 
-                    uint32_t status = Open(0);
-
-                    if ((status == Core::ERROR_NONE) || (status == Core::ERROR_INPROGRESS)) {
-
-                        TRACE_L1("Sending out a network package on %s. Attempt: %d", (remote.Type() == Core::NodeId::TYPE_IPV6 ? _T("IPv6") : _T("IPv4")), _retries);
+                    if ((ipv6 == true) && (_ipv6.Start(_remoteIPV6, _factory()) == true)) {
+                        // IPv6 gets a head start, IPv4 joins if no answer came in time.
+                        _ipv4Pending = _remoteIPV4.IsValid();
+                        result = _tryInterval;
 
-                        // We need to get a response in the given time..
+                        if (_ipv4Pending == true) {
+                            result = AttemptDelay;
+                        }
+                    } else if ((_remoteIPV4.IsValid() == true) && (_ipv4.Start(_remoteIPV4, _factory()) == true)) {
                         result = _tryInterval;
                     } else {
-                        TRACE_L1("Failed on network %s. Reschedule for the next attempt: %d", (remote.Type() == Core::NodeId::TYPE_IPV6 ? _T("IPv6") : _T("IPv4")), _retries);
-
-                        // Seems we could not open this connection, move on to the next attempt.
-                        Close(0);
+                        // Seems we could not open any connection, move on to the next attempt.
+                        _state = (_retries-- == 0 ? FAILED : ACTIVE);
                         result = 100;
                     }
                 }
             }
+        }
 
-            if (_state == FAILED) {
-                _infoCarrier.Release();
-            }
+        state current = _state;
 
-            _adminLock.Unlock();
-        }
+        _adminLock.Unlock();
 
-        if (_state == FAILED) {
+        if ((current == FAILED) && (previous != FAILED)) {
             Core::NodeId::ClearIPV6Enabled();
 
             TRACE(Trace::Information, (_T("LocationSync: Network connectivity could *NOT* be established. Falling back to IPv4. %d"), __LINE__));
@@ -30,28 +30,70 @@ namespace Plugin {
 
     class EXTERNAL LocationService
         : public PluginHost::ISubSystem::ILocation,
-          public PluginHost::ISubSystem::IInternet,
-          public Web::WebLinkType<Core::SocketStream, Web::Response, Web::Request, Core::ProxyPoolType<Web::Response>&> {
+          public PluginHost::ISubSystem::IInternet {
 
     private:
         enum state {
             IDLE,
             ACTIVE,
-            IPV6_INPROGRESS,
-            IPV4_INPROGRESS,
+            RACING,
             LOADED,
             FAILED
         };
 
-        using Job = Core::ThreadPool::JobType<LocationService>;
+        // Time IPv6 gets to answer before IPv4 joins the race, in mS (RFC 8305 connection attempt delay).
+        static constexpr uint32_t AttemptDelay = 250;
+
+        // One HTTP connection of the race, there is one per address family.
+        class Connection : public Web::WebLinkType<Core::SocketStream, Web::Response, Web::Request, Core::ProxyPoolType<Web::Response>&> {
+        private:
+            typedef Web::WebLinkType<Core::SocketStream, Web::Response, Web::Request, Core::ProxyPoolType<Web::Response>&> BaseClass;
+
+        public:
+            Connection() = delete;
+            Connection(const Connection&) = delete;
+            Connection& operator=(const Connection&) = delete;
+
+            Connection(LocationService& parent, Core::ProxyPoolType<Web::Response>& factory);
+            ~Connection() override;
+
+        public:
+            inline bool IsRacing() const
+            {
+                return (_racing);
+            }
+            inline Web::Request& Request()
+            {
+                return (*_request);
+            }
+            inline const Core::ProxyType<IGeography>& Carrier() const
+            {
+                return (_infoCarrier);
+            }
+            bool Start(const Core::NodeId& remote, const Core::ProxyType<IGeography>& carrier);
+            void Abort();
+
+        private:
+            // Notification of a Partial Request received, time to attach a body..
+            void LinkBody(Core::ProxyType<Web::Response>& element) override;
+            void Received(Core::ProxyType<Web::Response>& element) override;
+            void Send(const Core::ProxyType<Web::Request>& element) override;
+
+            // Signal a state change, Opened, Closed or Accepted
+            void StateChange() override;
+
+        private:
+            LocationService& _parent;
+            bool _racing;
+            Core::ProxyType<IGeography> _infoCarrier;
+            Core::ProxyType<Web::Request> _request;
+        };
 
     private:
         LocationService() = delete;
         LocationService(const LocationService&) = delete;
         LocationService& operator=(const LocationService&) = delete;
 
-        typedef Web::WebLinkType<Core::SocketStream, Web::Response, Web::Request, Core::ProxyPoolType<Web::Response>&> BaseClass;
-
     public:
         LocationService(Core::IDispatchType<void>* update);
         virtual ~LocationService();
@@ -68,6 +110,9 @@ namespace Plugin {
         uint32_t Probe(const string& remoteNode, const uint32_t retries, const uint32_t retryTimeSpan);
         void Stop();
 
+        // Location known from an earlier run, reported until the probe comes up with the actual one.
+        void Provisional(const string& timeZone, const string& country, const string& region, const string& city);
+
         /*
        * ------------------------------------------------------------------------------------------------------------
        * ISubSystem::INetwork methods
@@ -104,13 +149,10 @@ namespace Plugin {
         }
 
     private:
-        // Notification of a Partial Request received, time to attach a body..
-        virtual void LinkBody(Core::ProxyType<Web::Response>& element) override;
-        virtual void Received(Core::ProxyType<Web::Response>& element) override;
-        virtual void Send(const Core::ProxyType<Web::Request>& element) override;
-
-        // Signal a state change, Opened, Closed or Accepted
-        virtual void StateChange() override;
+        void Received(Connection& connection);
+        void Failed(Connection& connection);
+        void Resolve();
+        void Abort();
 
         friend Core::ThreadPool::JobType<LocationService&>;
         void Dispatch();
@@ -119,7 +161,6 @@ namespace Plugin {
         Core::CriticalSection _adminLock;
         state _state;
         string _remoteId;
-        Core::NodeId _sourceNode;
         uint32_t _tryInterval;
         uint32_t _retries;
         Core::IDispatch* _callback;
@@ -129,8 +170,14 @@ namespace Plugin {
         string _region;
         string _city;
         Core::WorkerPool::JobType<LocationService&> _activity;
-        Core::ProxyType<IGeography> _infoCarrier;
-        Core::ProxyType<Web::Request> _request;
+        Core::ProxyType<IGeography> (*_factory)();
+        // Resolved addresses of the remote, kept over retries and probes to the same remote.
+        Core::NodeId _remoteIPV6;
+        Core::NodeId _remoteIPV4;
+        bool _ipv4Pending;
+        uint64_t _deadline;
+        Connection _ipv6;
+        Connection _ipv4;
     };
 }
 } // namespace WPEFramework:Plugin
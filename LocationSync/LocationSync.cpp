@@ -33,7 +33,13 @@ namespace Plugin {
     LocationSync::LocationSync()
         : _skipURL(0)
         , _source()
+        , _cacheFile()
+        , _cacheTTL(0)
+        , _adminLock()
+        , _unverified(0)
+        , _observing(false)
         , _sink(this)
+        , _timeObserver(this)
         , _service(nullptr)
     {
         RegisterAll();
@@ -58,6 +64,13 @@ namespace Plugin {
             _skipURL = static_cast<uint16_t>(service->WebPrefix().length());
             _source = config.Source.Value();
             _service = service;
+            _cacheTTL = config.CacheTTL.Value();
+
+            if ((_cacheTTL != 0) && (Core::Directory(service->PersistentPath().c_str()).CreatePath() == true)) {
+                _cacheFile = service->PersistentPath() + _T("location.json");
+
+                Restore();
+            }
 
             _sink.Initialize(service, config.Source.Value(), config.Interval.Value(), config.Retries.Value());
         } else {
@@ -73,6 +86,23 @@ namespace Plugin {
         ASSERT(_service == service);
 
         _sink.Deinitialize();
+
+        _adminLock.Lock();
+
+        const bool observing = _observing;
+        _observing = false;
+        _unverified = 0;
+
+        _adminLock.Unlock();
+
+        if (observing == true) {
+            PluginHost::ISubSystem* subSystem = _service->SubSystems();
+
+            if (subSystem != nullptr) {
+                subSystem->Unregister(&_timeObserver);
+                subSystem->Release();
+            }
+        }
     }
 
     /* virtual */ string LocationSync::Information() const
@@ -138,6 +168,15 @@ namespace Plugin {
 
     void LocationSync::SyncedLocation()
     {
+        const bool probed = ((_sink.Network() != nullptr) && (_sink.Network()->PublicIPAddress().empty() == false));
+
+        if (probed == true) {
+            // The probe answered, a remembered location no longer needs checking once the time is set.
+            _adminLock.Lock();
+            _unverified = 0;
+            _adminLock.Unlock();
+        }
+
         PluginHost::ISubSystem* subSystem = _service->SubSystems();
 
         ASSERT(subSystem != nullptr);
@@ -153,6 +192,116 @@ namespace Plugin {
                 event_locationchange();
             }
         }
+
+        if (probed == true) {
+            Store();
+        }
+    }
+
+    void LocationSync::Restore()
+    {
+        Core::File file(_cacheFile);
+
+        if (file.Open(true) == true) {
+            Cache cache;
+            Core::OptionalType<Core::JSON::Error> error;
+            cache.IElement::FromFile(file, error);
+
+            if (error.IsSet() == true) {
+                SYSLOG(Logging::ParsingError, (_T("Parsing failed with %s"), ErrorDisplayMessage(error.Value()).c_str()));
+            } else {
+                uint64_t now = Core::Time::Now().Ticks() / Core::Time::TicksPerMillisecond / 1000;
+                uint64_t stored = cache.Timestamp.Value();
+
+                if ((cache.TimeZone.Value().empty() == true) || ((stored <= now) && ((now - stored) > _cacheTTL))) {
+                    TRACE(Trace::Information, (_T("Remembered location is outdated, waiting for the probe.")));
+                } else {
+                    PluginHost::ISubSystem* subSystem = _service->SubSystems();
+
+                    ASSERT(subSystem != nullptr);
+
+                    _sink.Provisional(cache);
+
+                    // Only the location is known, connectivity is up to the probe to confirm.
+                    if (subSystem != nullptr) {
+                        subSystem->Set(PluginHost::ISubSystem::LOCATION, _sink.Location());
+
+                        if (stored > now) {
+                            // Stored in the future: the clock is not set yet after a cold boot without an RTC. The age
+                            // is unknown, it is checked once the time is.
+                            _adminLock.Lock();
+                            _unverified = stored;
+                            _observing = true;
+                            _adminLock.Unlock();
+
+                            subSystem->Register(&_timeObserver);
+                        }
+
+                        subSystem->Release();
+                    }
+
+                    if (stored > now) {
+                        TRACE(Trace::Information, (_T("Using the remembered location, tz: %s, its age is not known till the time is set"), cache.TimeZone.Value().c_str()));
+                    } else {
+                        TRACE(Trace::Information, (_T("Using the remembered location, tz: %s, stored %d seconds ago"), cache.TimeZone.Value().c_str(), static_cast<uint32_t>(now - stored)));
+                    }
+
+                    Core::SystemInfo::SetEnvironment(_T("TZ"), cache.TimeZone.Value());
+                    event_locationchange();
+                }
+            }
+        }
+    }
+
+    void LocationSync::TimeUpdated()
+    {
+        PluginHost::ISubSystem* subSystem = _service->SubSystems();
+
+        ASSERT(subSystem != nullptr);
+
+        if (subSystem != nullptr) {
+            _adminLock.Lock();
+
+            if ((_unverified != 0) && (subSystem->IsActive(PluginHost::ISubSystem::TIME) == true)) {
+                const uint64_t now = Core::Time::Now().Ticks() / Core::Time::TicksPerMillisecond / 1000;
+
+                // Still in the future with the time set, it was stored by a clock that ran ahead, keep it.
+                const bool outdated = ((_unverified <= now) && ((now - _unverified) > _cacheTTL));
+                _unverified = 0;
+
+                TRACE(Trace::Information, (_T("Remembered location is %s now the time is set"), (outdated == true ? _T("outdated") : _T("still valid"))));
+
+                // The probe did not answer yet, it clears _unverified before it reports. With the lock held, its
+                // location can not be withdrawn here.
+                if (outdated == true) {
+                    subSystem->Set(PluginHost::ISubSystem::NOT_LOCATION, nullptr);
+                }
+            }
+
+            _adminLock.Unlock();
+
+            subSystem->Release();
+        }
+    }
+
+    void LocationSync::Store()
+    {
+        if (_cacheFile.empty() == false) {
+            Core::File file(_cacheFile);
+
+            if (file.Create() == true) {
+                Cache cache;
+                cache.TimeZone = _sink.Location()->TimeZone();
+                cache.Region = _sink.Location()->Region();
+                cache.Country = _sink.Location()->Country();
+                cache.City = _sink.Location()->City();
+                cache.Timestamp = Core::Time::Now().Ticks() / Core::Time::TicksPerMillisecond / 1000;
+
+                cache.IElement::ToFile(file);
+            } else {
+                TRACE(Trace::Error, (_T("Could not store the location in %s"), _cacheFile.c_str()));
+            }
+        }
     }
 
 } // namespace Plugin
@@ -62,6 +62,39 @@ namespace Plugin {
         };
 
     private:
+        // Last known location, remembered over reboots so it can be reported before the probe completes.
+        class Cache : public Core::JSON::Container {
+        public:
+            Cache(Cache const& other) = delete;
+            Cache& operator=(Cache const& other) = delete;
+
+            Cache()
+                : Core::JSON::Container()
+                , TimeZone()
+                , Region()
+                , Country()
+                , City()
+                , Timestamp(0)
+            {
+                Add(_T("timezone"), &TimeZone);
+                Add(_T("region"), &Region);
+                Add(_T("country"), &Country);
+                Add(_T("city"), &City);
+                Add(_T("timestamp"), &Timestamp);
+            }
+
+            ~Cache()
+            {
+            }
+
+        public:
+            Core::JSON::String TimeZone;
+            Core::JSON::String Region;
+            Core::JSON::String Country;
+            Core::JSON::String City;
+            Core::JSON::DecUInt64 Timestamp; // Seconds since the epoch
+        };
+
         class Notification : public Core::IDispatch {
         private:
             Notification() = delete;
@@ -114,6 +147,12 @@ namespace Plugin {
             {
                 return (_locator);
             }
+            inline void Provisional(const Cache& cache)
+            {
+                ASSERT(_locator != nullptr);
+
+                _locator->Provisional(cache.TimeZone.Value(), cache.Country.Value(), cache.Region.Value(), cache.City.Value());
+            }
             inline PluginHost::ISubSystem::IInternet* Network()
             {
                 return (_locator);
@@ -141,6 +180,37 @@ namespace Plugin {
             LocationService* _locator;
         };
 
+        // Reports subsystem changes, a remembered location of unknown age is checked once the time is set.
+        class TimeObserver : public PluginHost::ISubSystem::INotification {
+        private:
+            TimeObserver() = delete;
+            TimeObserver(const TimeObserver&) = delete;
+            TimeObserver& operator=(const TimeObserver&) = delete;
+
+        public:
+            explicit TimeObserver(LocationSync* parent)
+                : _parent(*parent)
+            {
+                ASSERT(parent != nullptr);
+            }
+            ~TimeObserver()
+            {
+            }
+
+        public:
+            void Updated() override
+            {
+                _parent.TimeUpdated();
+            }
+
+            BEGIN_INTERFACE_MAP(TimeObserver)
+            INTERFACE_ENTRY(PluginHost::ISubSystem::INotification)
+            END_INTERFACE_MAP
+
+        private:
+            LocationSync& _parent;
+        };
+
         class Config : public Core::JSON::Container {
         private:
             Config(const Config&) = delete;
@@ -151,10 +221,12 @@ namespace Plugin {
                 : Interval(30)
                 , Retries(8)
                 , Source()
+                , CacheTTL(24 * 60 * 60)
             {
                 Add(_T("interval"), &Interval);
                 Add(_T("retries"), &Retries);
                 Add(_T("source"), &Source);
+                Add(_T("cachettl"), &CacheTTL);
             }
             ~Config()
             {
@@ -164,6 +236,7 @@ namespace Plugin {
             Core::JSON::DecUInt16 Interval;
             Core::JSON::DecUInt8 Retries;
             Core::JSON::String Source;
+            Core::JSON::DecUInt32 CacheTTL; // Seconds a remembered location stays usable, 0 disables it
         };
 
     private:
@@ -201,11 +274,21 @@ namespace Plugin {
         void event_locationchange();
 
         void SyncedLocation();
+        void Restore();
+        void Store();
+        void TimeUpdated();
 
     private:
         uint16_t _skipURL;
         string _source;
+        string _cacheFile;
+        uint32_t _cacheTTL;
+        Core::CriticalSection _adminLock;
+        // Timestamp of a remembered location in use while the clock was not set yet, 0 if there is none.
+        uint64_t _unverified;
+        bool _observing;
         Core::Sink<Notification> _sink;
+        Core::Sink<TimeObserver> _timeObserver;
         PluginHost::IShell* _service;
     };
 
@@ -85,6 +85,7 @@ namespace Plugin
         , _dns()
         , _interfaces()
         , _dhcpInterfaces()
+        , _links()
         , _observer(Core::ProxyType<AdapterObserver>::Create(this))
     {
         RegisterAll();
@@ -214,6 +215,15 @@ namespace Plugin
         // the re-read of this file....
         RefreshDNS();
 
+        // What we configured so far is the baseline, only changes to it need to be reported.
+        std::map<const string, StaticInfo>::const_iterator configured(_interfaces.begin());
+
+        while (configured != _interfaces.end()) {
+            Core::AdapterIterator adapter(configured->first);
+            _links.emplace(configured->first, LinkState(adapter));
+            configured++;
+        }
+
         // From now on we observer the states of the give interfaces.
         _observer->Open();
 
@@ -237,6 +247,7 @@ namespace Plugin
         _dns.clear();
         _dhcpInterfaces.clear();
         _interfaces.clear();
+        _links.clear();
         _service = nullptr;
     }
 
@@ -600,7 +611,7 @@ namespace Plugin
         }
 
         if (syncDNS == true) {
-            RefreshDNS();
+            _observer->RefreshDNS();
         }
 
         _adminLock.Unlock();
@@ -631,7 +642,7 @@ namespace Plugin
         }
 
         if (syncDNS == true) {
-            RefreshDNS();
+            _observer->RefreshDNS();
         }
 
         _adminLock.Unlock();
@@ -680,26 +691,25 @@ namespace Plugin
 
             if (info != _interfaces.end()) {
 
-                bool update = false;
                 _adminLock.Lock();
 
                 // First add all new entries.
                 DHCPClientImplementation::Offer::DnsIterator servers(offer.DNS());
                 while (servers.Next() == true) {
-                    update = AddDNSEntry(_dns, servers.Current()) | update;
+                    AddDNSEntry(_dns, servers.Current());
                 }
 
                 // Than remove all old ones.
                 servers = info->second.Offer().DNS();
                 while (servers.Next() == true) {
-                    update = RemoveDNSEntry(_dns, servers.Current()) | update;
+                    RemoveDNSEntry(_dns, servers.Current());
                 }
 
                 _adminLock.Unlock();
 
-                if (update == true) {
-                    RefreshDNS();
-                }
+                // Also if the servers did not change, the DNS file might have been overwritten since. The refresh
+                // only writes the file if our section is not in it as it should be.
+                _observer->RefreshDNS();
 
                 SetIP(adapter, Core::IPNode(offer.Address(), offer.Netmask()), offer.Gateway(), offer.Broadcast(), true);
                 
@@ -760,13 +770,35 @@ namespace Plugin
 
     void NetworkControl::RefreshDNS()
     {
+        string data((_T("#++SECTION: ")) + _service->Callsign() + '\n');
+        string endMarker((_T("#--SECTION: ")) + _service->Callsign() + '\n');
+        const string startMarker(data);
+
+        _adminLock.Lock();
+
+        std::list<std::pair<uint16_t, Core::NodeId>>::const_iterator pointer(_dns.begin());
+
+        while (pointer != _dns.end()) {
+            data += string(NAMESERVER, sizeof(NAMESERVER) - 1) + pointer->second.HostAddress() + '\n';
+            pointer++;
+        }
+
+        data += endMarker;
+
+        _adminLock.Unlock();
+
         Core::DataElementFile file(_dnsFile, Core::File::SHAREABLE|Core::File::USER_READ|Core::File::USER_WRITE|Core::File::USER_EXECUTE|Core::File::GROUP_READ|Core::File::GROUP_WRITE, 0);
 
-        if (file.IsValid() == false) {
+        // A burst of DHCP renewals mostly hands out the same servers, no need to touch the file then. Check the
+        // file itself and not what we wrote last, another process may have rewritten it since.
+        const bool unchanged = (file.IsValid() == true) &&
+            (string(reinterpret_cast<const char*>(file.Buffer()), static_cast<size_t>(file.Size())).find(data) != string::npos);
+
+        if (unchanged == true) {
+            TRACE(Trace::Information, (_T("DNS servers unchanged, [%s] not rewritten"), _dnsFile.c_str()));
+        } else if (file.IsValid() == false) {
             SYSLOG(Logging::Startup, (_T("DNS functionality could NOT be updated [%s]"), _dnsFile.c_str()));
         } else {
-            string data((_T("#++SECTION: ")) + _service->Callsign() + '\n');
-            string endMarker((_T("#--SECTION: ")) + _service->Callsign() + '\n');
             uint16_t start = 0;
             uint16_t end = 0;
             uint16_t offset = 1;
@@ -777,15 +809,15 @@ namespace Plugin
                 offset = 0;
 
                 // Find the first comparible character && check the remainder in the next step...
-                while ((index < file.Size()) && (file[index] != data[offset])) {
+                while ((index < file.Size()) && (file[index] != startMarker[offset])) {
                     index++;
                 }
-                while ((index < file.Size()) && (offset < data.length()) && (file[index] == data[offset])) {
+                while ((index < file.Size()) && (offset < startMarker.length()) && (file[index] == startMarker[offset])) {
                     index++;
                     offset++;
                 }
 
-            } while ((index < file.Size()) && (offset != data.length()));
+            } while ((index < file.Size()) && (offset != startMarker.length()));
 
             start = index - offset;
             offset = 1;
@@ -815,27 +847,49 @@ namespace Plugin
 
             offset = (static_cast<uint16_t>(file.Size()) - reduction);
 
+            file.Size(offset + data.length());
+            ::memcpy(&(file[offset]), data.c_str(), data.length());
+            file.Sync();
+
+            SYSLOG(Logging::Startup, (_T("DNS functionality updated [%s]"), _dnsFile.c_str()));
+        }
+    }
+
+    void NetworkControl::Activity(const std::set<string>& interfaces)
+    {
+        std::set<string>::const_iterator index(interfaces.begin());
+
+        while (index != interfaces.end()) {
+            Core::AdapterIterator adapter(*index);
+            LinkState state(adapter);
+            bool report = true;
+            bool reconfigure = true;
+
             _adminLock.Lock();
 
-            std::list<std::pair<uint16_t, Core::NodeId>>::const_iterator pointer(_dns.begin());
+            std::map<const string, LinkState>::iterator entry(_links.find(*index));
 
-            while (pointer != _dns.end()) {
-                data += string(NAMESERVER, sizeof(NAMESERVER) - 1) + pointer->second.HostAddress() + '\n';
-                pointer++;
+            if (entry == _links.end()) {
+                _links.emplace(*index, state);
+            } else {
+                report = (entry->second != state);
+                reconfigure = entry->second.IsLinkChange(state);
+                entry->second = state;
             }
 
             _adminLock.Unlock();
 
-            data += endMarker;
-            file.Size(offset + data.length());
-            ::memcpy(&(file[offset]), data.c_str(), data.length());
-            file.Sync();
+            if (report == true) {
+                Activity(*index, reconfigure);
+            } else {
+                TRACE(Trace::Information, (_T("No change on: %s, nothing to report"), index->c_str()));
+            }
 
-            SYSLOG(Logging::Startup, (_T("DNS functionality updated [%s]"), _dnsFile.c_str()));
+            index++;
         }
     }
 
-    void NetworkControl::Activity(const string& interfaceName)
+    void NetworkControl::Activity(const string& interfaceName, const bool reconfigure)
     {
         string message;
         Core::AdapterIterator adapter(interfaceName);
@@ -866,21 +920,24 @@ namespace Plugin
                 TRACE(Trace::Information, (_T("Updated interface: %s"), interfaceName.c_str()));
             }
 
-            if ((adapter.IsRunning() == true) && (adapter.IsUp() == true)) {
-                std::map<const string, StaticInfo>::iterator index(_interfaces.find(interfaceName));
+            // When only the addresses changed, there is nothing to (re)configure.
+            if (reconfigure == true) {
+                if ((adapter.IsRunning() == true) && (adapter.IsUp() == true)) {
+                    std::map<const string, StaticInfo>::iterator index(_interfaces.find(interfaceName));
 
-                if (index != _interfaces.end()) {
+                    if (index != _interfaces.end()) {
 
-                    JsonData::NetworkControl::NetworkData::ModeType how(index->second.Mode());
-                    if (how != JsonData::NetworkControl::NetworkData::ModeType::MANUAL) {
-                        Reload(interfaceName, how == JsonData::NetworkControl::NetworkData::ModeType::DYNAMIC);
+                        JsonData::NetworkControl::NetworkData::ModeType how(index->second.Mode());
+                        if (how != JsonData::NetworkControl::NetworkData::ModeType::MANUAL) {
+                            Reload(interfaceName, how == JsonData::NetworkControl::NetworkData::ModeType::DYNAMIC);
+                        }
                     }
-                }
-            } else {
-                ClearAssignedIPV4IPs(adapter);
-                ClearAssignedIPV6IPs(adapter);
+                } else {
+                    ClearAssignedIPV4IPs(adapter);
+                    ClearAssignedIPV6IPs(adapter);
 
-                Core::AdapterIterator::Flush();
+                    Core::AdapterIterator::Flush();
+                }
             }
 
             _adminLock.Unlock();
@@ -899,6 +956,8 @@ namespace Plugin
                 _dhcpInterfaces.erase(dhcp);
             }
 
+            _links.erase(interfaceName);
+
             _adminLock.Unlock();
 
             TRACE(Trace::Information, (_T("Removed interface: %s"), interfaceName.c_str()));
@@ -26,6 +26,8 @@
 #include <interfaces/IIPNetwork.h>
 #include <interfaces/json/JsonData_NetworkControl.h> 
 
+#include <set>
+
 namespace WPEFramework {
 namespace Plugin {
 
@@ -109,6 +111,9 @@ namespace Plugin {
         };
 
     private:
+        // Collects adapter events (link, address and route changes reported by the rtnetlink socket
+        // of the Core::AdapterObserver) and DNS refresh requests into bursts. A burst is handed over
+        // once no new event came in for Settle ms, or at the latest MaxDelay ms after its first event.
         class AdapterObserver : public Core::IDispatch,
                                 public WPEFramework::Core::AdapterObserver::INotification {
         private:
@@ -116,6 +121,9 @@ namespace Plugin {
             AdapterObserver(const AdapterObserver&) = delete;
             AdapterObserver& operator=(const AdapterObserver&) = delete;
 
+            static constexpr uint32_t Settle = 100;
+            static constexpr uint32_t MaxDelay = 1000;
+
         public:
 #ifdef __WINDOWS__
 #pragma warning(disable : 4355)
@@ -125,6 +133,9 @@ namespace Plugin {
                 , _adminLock()
                 , _observer(this)
                 , _reporting()
+                , _refreshDNS(false)
+                , _first(0)
+                , _last(0)
             {
                 ASSERT(parent != nullptr);
             }
@@ -150,51 +161,145 @@ namespace Plugin {
                 Core::IWorkerPool::Instance().Revoke(job);
 
                 _reporting.clear();
+                _refreshDNS = false;
+                _first = 0;
 
                 _adminLock.Unlock();
             }
             virtual void Event(const string& interface) override
             {
-
                 _adminLock.Lock();
 
-                if (std::find(_reporting.begin(), _reporting.end(), interface) == _reporting.end()) {
-                    // We need to add this interface, it is currently not present.
-                    _reporting.push_back(interface);
+                _reporting.insert(interface);
+                Burst();
 
-                    // If this is the first entry, we need to submit a job for processing
-                    if (_reporting.size() == 1) {
-                        // These events tend to "dender" a lot. Give it some time
-                        Core::Time entry(Core::Time::Now().Add(100));
-                        Core::ProxyType<Core::IDispatch> job(*this);
+                _adminLock.Unlock();
+            }
+            void RefreshDNS()
+            {
+                _adminLock.Lock();
 
-                        Core::IWorkerPool::Instance().Schedule(entry, job);
-                    }
-                }
+                _refreshDNS = true;
+                Burst();
 
                 _adminLock.Unlock();
             }
             virtual void Dispatch() override
             {
-                // Yippie a yee, we have an interface notification:
+                std::set<string> interfaces;
+                bool refreshDNS = false;
+
                 _adminLock.Lock();
-                while (_reporting.size() != 0) {
-                    const string interfaceName(_reporting.front());
-                    _reporting.pop_front();
-                    _adminLock.Unlock();
 
-                    _parent.Activity(interfaceName);
+                uint64_t now = Core::Time::Now().Ticks();
+                uint64_t settled = _last + (Settle * Core::Time::TicksPerMillisecond);
+                uint64_t deadline = _first + (MaxDelay * Core::Time::TicksPerMillisecond);
+
+                if ((now < settled) && (now < deadline)) {
+                    // These events tend to "dender" a lot, the burst is not over yet.
+                    Core::ProxyType<Core::IDispatch> job(*this);
 
-                    _adminLock.Lock();
+                    Core::IWorkerPool::Instance().Schedule(Core::Time(settled < deadline ? settled : deadline), job);
+                } else {
+                    interfaces.swap(_reporting);
+                    refreshDNS = _refreshDNS;
+                    _refreshDNS = false;
+                    _first = 0;
                 }
+
                 _adminLock.Unlock();
+
+                if (interfaces.empty() == false) {
+                    _parent.Activity(interfaces);
+                }
+                if (refreshDNS == true) {
+                    _parent.RefreshDNS();
+                }
+            }
+
+        private:
+            void Burst()
+            {
+                _last = Core::Time::Now().Ticks();
+
+                // If this is the first event of a burst, we need to submit a job for processing
+                if (_first == 0) {
+                    _first = _last;
+
+                    Core::ProxyType<Core::IDispatch> job(*this);
+
+                    Core::IWorkerPool::Instance().Schedule(Core::Time::Now().Add(Settle), job);
+                }
             }
 
         private:
             NetworkControl& _parent;
             Core::CriticalSection _adminLock;
             Core::AdapterObserver _observer;
-            std::list<string> _reporting;
+            std::set<string> _reporting;
+            bool _refreshDNS;
+            uint64_t _first;
+            uint64_t _last;
+        };
+
+        // What we last reported for an adapter. Events that do not change it are not reported again.
+        class LinkState {
+        public:
+            LinkState()
+                : _valid(false)
+                , _up(false)
+                , _running(false)
+                , _addresses()
+            {
+            }
+            LinkState(Core::AdapterIterator& adapter)
+                : _valid(adapter.IsValid())
+                , _up(false)
+                , _running(false)
+                , _addresses()
+            {
+                if (_valid == true) {
+                    _up = adapter.IsUp();
+                    _running = adapter.IsRunning();
+
+                    Core::IPV4AddressIterator ipv4(adapter.IPV4Addresses());
+                    while (ipv4.Next() == true) {
+                        _addresses += ipv4.Address().HostAddress() + '/' + std::to_string(ipv4.Address().Mask()) + ' ';
+                    }
+
+                    Core::IPV6AddressIterator ipv6(adapter.IPV6Addresses());
+                    while (ipv6.Next() == true) {
+                        _addresses += ipv6.Address().HostAddress() + '/' + std::to_string(ipv6.Address().Mask()) + ' ';
+                    }
+                }
+            }
+            LinkState(const LinkState&) = default;
+            LinkState& operator=(const LinkState&) = default;
+            ~LinkState()
+            {
+            }
+
+        public:
+            bool operator==(const LinkState& rhs) const
+            {
+                return ((IsLinkChange(rhs) == false) && (_addresses == rhs._addresses));
+            }
+            bool operator!=(const LinkState& rhs) const
+            {
+                return (!operator==(rhs));
+            }
+            // Only a change of the link itself asks for the addresses to be (re)configured, an address
+            // change is most likely the result of our own configuration (e.g. a DHCP renewal).
+            bool IsLinkChange(const LinkState& rhs) const
+            {
+                return ((_valid != rhs._valid) || (_up != rhs._up) || (_running != rhs._running));
+            }
+
+        private:
+            bool _valid;
+            bool _up;
+            bool _running;
+            string _addresses;
         };
 
         class Config : public Core::JSON::Container {
@@ -512,7 +617,8 @@ namespace Plugin {
         void RequestFailed(const string& interfaceName, const DHCPClientImplementation::Offer& offer);
         void NoOffers(const string& interfaceName);
         void RefreshDNS();
-        void Activity(const string& interface);
+        void Activity(const std::set<string>& interfaces);
+        void Activity(const string& interface, const bool reconfigure);
         uint16_t DeleteSection(Core::DataElementFile& file, const string& startMarker, const string& endMarker);
         inline uint8_t ResponseTime() const
         {
@@ -547,6 +653,7 @@ namespace Plugin {
         std::list<std::pair<uint16_t, Core::NodeId>> _dns;
         std::map<const string, StaticInfo> _interfaces;
         std::map<const string, Core::ProxyType<DHCPEngine>> _dhcpInterfaces;
+        std::map<const string, LinkState> _links;
         Core::ProxyType<AdapterObserver> _observer;
     };
 
@@ -26,6 +26,10 @@
 #endif
 #include <opkg_download.h>
 
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
 
 namespace WPEFramework {
 namespace Plugin {
@@ -126,9 +130,11 @@ namespace Plugin {
         _adminLock.Lock();
         notification->AddRef();
         _notifications.push_back(notification);
-        if (_inProgress.Install != nullptr) {
-            ASSERT(_inProgress.Package != nullptr);
-            notification->StateChange(_inProgress.Package, _inProgress.Install);
+        for (const InstallationData& entry : _inProgress) {
+            notification->StateChange(entry.Package, entry.Install);
+        }
+        for (const InstallationData& entry : _queue) {
+            notification->StateChange(entry.Package, entry.Install);
         }
         _adminLock.Unlock();
     }
@@ -156,31 +162,25 @@ namespace Plugin {
 
     uint32_t PackagerImplementation::DoWork(const string* name, const string* version, const string* arch)
     {
-        uint32_t result = Core::ERROR_INPROGRESS;
+        uint32_t result = Core::ERROR_NONE;
 
         _adminLock.Lock();
-        if (_inProgress.Install == nullptr && _isSyncing == false) {
-            ASSERT(_inProgress.Package == nullptr);
-            result = Core::ERROR_NONE;
-            // OPKG bug: it marks it checked dependency for a package as cyclic dependency handling fix
-            // but since in our case it's not an process which dies when done, this info survives and makes the
-            // deps check to be skipped on subsequent calls. This is why hash_deinit() is called below
-            // and needs to be initialized here agian.
-            if (_opkgInitialized == true)  // it was initialized
-                FreeOPKG();
-            _opkgInitialized = InitOPKG();
-
-            if (_opkgInitialized) {
-                if (name && version && arch) {
-                    _inProgress.Package = Core::Service<PackageInfo>::Create<PackageInfo>(*name, *version, *arch);
-                    _inProgress.Install = Core::Service<InstallInfo>::Create<InstallInfo>();
-                } else {
-                    _isSyncing = true;
-                }
-                _worker.Run();
+        if (name && version && arch) {
+            if (IsQueued(*name) == true) {
+                result = Core::ERROR_INPROGRESS;
             } else {
-                result = Core::ERROR_GENERAL;
+                _queue.emplace_back();
+                _queue.back().Package = Core::Service<PackageInfo>::Create<PackageInfo>(*name, *version, *arch);
+                _queue.back().Install = Core::Service<InstallInfo>::Create<InstallInfo>();
             }
+        } else if (_isSyncing == true) {
+            result = Core::ERROR_INPROGRESS;
+        } else {
+            _isSyncing = true;
+        }
+
+        if (result == Core::ERROR_NONE) {
+            _worker.Run();
         }
         _adminLock.Unlock();
 
@@ -188,40 +188,125 @@ namespace Plugin {
 
     }
 
+    bool PackagerImplementation::IsQueued(const string& name) const
+    {
+        auto match = [&name](const InstallationData& entry) { return (entry.Package->Name() == name); };
+
+        return ((std::find_if(_queue.begin(), _queue.end(), match) != _queue.end()) || (std::find_if(_inProgress.begin(), _inProgress.end(), match) != _inProgress.end()));
+    }
+
+    void PackagerImplementation::ResetOPKG()
+    {
+        // OPKG bug: it marks it checked dependency for a package as cyclic dependency handling fix
+        // but since in our case it's not an process which dies when done, this info survives and makes the
+        // deps check to be skipped on subsequent calls. This is why hash_deinit() is called below
+        // and needs to be initialized here agian.
+        if (_opkgInitialized == true)  // it was initialized
+            FreeOPKG();
+        _opkgInitialized = InitOPKG();
+    }
+
     void PackagerImplementation::BlockingInstallUntilCompletionNoLock() {
-        ASSERT(_inProgress.Install != nullptr && _inProgress.Package != nullptr);
+        ASSERT(_inProgress.empty() == false);
+
+        bool fresh = true;
+
+#if defined (DO_NOT_USE_DEPRECATED_API)
+        if (_inProgress.size() > 1) {
+            if (BlockingInstallBatchNoLock() == true) {
+                return;
+            }
+            // Install them one by one, to find out which one(s) failed.
+            fresh = false;
+        }
+#endif
+        for (InstallationData& entry : _inProgress) {
+            if (fresh == false) {
+                ResetOPKG();
+            }
+            fresh = false;
+
+            if (_opkgInitialized == true) {
+                BlockingInstallNoLock(entry);
+            } else {
+                entry.Install->SetError(Core::ERROR_GENERAL);
+                NotifyStateChange(entry);
+            }
+        }
+    }
+
+#if defined (DO_NOT_USE_DEPRECATED_API)
+    // Hands all packages of the batch to a single opkg run, so the dependencies are resolved once.
+    bool PackagerImplementation::BlockingInstallBatchNoLock() {
+        bool result = false;
+        opkg_cmd_t* command = opkg_cmd_find("install");
+
+        if ((command != nullptr) && (_opkgInitialized == true)) {
+            std::vector<string> names;
+            std::vector<const char*> argv;
+
+            names.reserve(_inProgress.size());
+            for (InstallationData& entry : _inProgress) {
+                names.push_back(entry.Package->Name());
+                argv.push_back(names.back().c_str());
+                entry.Install->SetState(Exchange::IPackager::INSTALLING);
+                NotifyStateChange(entry);
+            }
+
+            opkg_config->pfm = command->pfm;
+            result = (opkg_cmd_exec(command, static_cast<int>(argv.size()), argv.data()) == 0);
+
+            if (result == true) {
+                for (InstallationData& entry : _inProgress) {
+                    entry.Install->SetProgress(100);
+                    entry.Install->SetState(Exchange::IPackager::INSTALLED);
+                    NotifyStateChange(entry);
+                }
+            } else {
+                TRACE_L1("Installing a batch of %d packages failed, retrying one by one", static_cast<uint32_t>(_inProgress.size()));
+            }
+        }
+
+        return (result);
+    }
+#endif
+
+    void PackagerImplementation::BlockingInstallNoLock(InstallationData& data) {
+        ASSERT(data.Install != nullptr && data.Package != nullptr);
+
+        _current = &data;
 
 #if defined (DO_NOT_USE_DEPRECATED_API)
         opkg_cmd_t* command = opkg_cmd_find("install");
         if (command) {
-            _inProgress.Install->SetState(Exchange::IPackager::INSTALLING);
-            NotifyStateChange();
+            data.Install->SetState(Exchange::IPackager::INSTALLING);
+            NotifyStateChange(data);
             opkg_config->pfm = command->pfm;
-            std::unique_ptr<char[]> targetCopy(new char [_inProgress.Package->Name().length() + 1]);
-            std::copy_n(_inProgress.Package->Name().begin(), _inProgress.Package->Name().length(), targetCopy.get());
-            (targetCopy.get())[_inProgress.Package->Name().length()] = 0;
+            std::unique_ptr<char[]> targetCopy(new char [data.Package->Name().length() + 1]);
+            std::copy_n(data.Package->Name().begin(), data.Package->Name().length(), targetCopy.get());
+            (targetCopy.get())[data.Package->Name().length()] = 0;
             const char* argv[1];
             argv[0] = targetCopy.get();
             if (opkg_cmd_exec(command, 1, argv) == 0) {
-                _inProgress.Install->SetProgress(100);
-                _inProgress.Install->SetState(Exchange::IPackager::INSTALLED);
+                data.Install->SetProgress(100);
+                data.Install->SetState(Exchange::IPackager::INSTALLED);
             } else {
-                _inProgress.Install->SetError(Core::ERROR_GENERAL);
+                data.Install->SetError(Core::ERROR_GENERAL);
             }
-            NotifyStateChange();
+            NotifyStateChange(data);
         } else {
-            _inProgress.Install->SetError(Core::ERROR_GENERAL);
-            NotifyStateChange();
+            data.Install->SetError(Core::ERROR_GENERAL);
+            NotifyStateChange(data);
         }
 #else
         _isUpgrade = false;
         opkg_package_callback_t checkUpgrade = [](pkg* pkg, void* user_data) {
             PackagerImplementation* self = static_cast<PackagerImplementation*>(user_data);
             if (self->_isUpgrade == false) {
-                self->_isUpgrade = self->_inProgress.Package->Name() == pkg->name;
-                if (self->_isUpgrade && self->_inProgress.Package->Version().empty() == false) {
+                self->_isUpgrade = self->_current->Package->Name() == pkg->name;
+                if (self->_isUpgrade && self->_current->Package->Version().empty() == false) {
                     self->_isUpgrade = opkg_compare_versions(pkg->version,
-                                                             self->_inProgress.Package->Version().c_str()) < 0;
+                                                             self->_current->Package->Version().c_str()) < 0;
                 }
             }
         };
@@ -234,12 +319,14 @@ namespace Plugin {
         }
         _isUpgrade = false;
 
-        if (installFunction(_inProgress.Package->Name().c_str(), PackagerImplementation::InstallationProgessNoLock,
+        if (installFunction(data.Package->Name().c_str(), PackagerImplementation::InstallationProgessNoLock,
                             this) != 0) {
-            _inProgress.Install->SetError(Core::ERROR_GENERAL);
-            NotifyStateChange();
+            data.Install->SetError(Core::ERROR_GENERAL);
+            NotifyStateChange(data);
         }
 #endif
+
+        _current = nullptr;
     }
 
 #if !defined (DO_NOT_USE_DEPRECATED_API)
@@ -247,43 +334,44 @@ namespace Plugin {
                                                                         void* data)
     {
         PackagerImplementation* self = static_cast<PackagerImplementation*>(data);
-        self->_inProgress.Install->SetProgress(progress->percentage);
+        InstallationData& current = *(self->_current);
+        current.Install->SetProgress(progress->percentage);
         if (progress->action == OPKG_INSTALL &&
-            self->_inProgress.Install->State() == Exchange::IPackager::DOWNLOADING) {
-            self->_inProgress.Install->SetState(Exchange::IPackager::DOWNLOADED);
-            self->NotifyStateChange();
+            current.Install->State() == Exchange::IPackager::DOWNLOADING) {
+            current.Install->SetState(Exchange::IPackager::DOWNLOADED);
+            self->NotifyStateChange(current);
         }
         bool stateChanged = false;
         switch (progress->action) {
             case OPKG_DOWNLOAD:
-                if (self->_inProgress.Install->State() != Exchange::IPackager::DOWNLOADING) {
-                    self->_inProgress.Install->SetState(Exchange::IPackager::DOWNLOADING);
+                if (current.Install->State() != Exchange::IPackager::DOWNLOADING) {
+                    current.Install->SetState(Exchange::IPackager::DOWNLOADING);
                     stateChanged = true;
                 }
                 break;
             case OPKG_INSTALL:
-                if (self->_inProgress.Install->State() != Exchange::IPackager::INSTALLING) {
-                    self->_inProgress.Install->SetState(Exchange::IPackager::INSTALLING);
+                if (current.Install->State() != Exchange::IPackager::INSTALLING) {
+                    current.Install->SetState(Exchange::IPackager::INSTALLING);
                     stateChanged = true;
                 }
                 break;
         }
 
         if (stateChanged == true)
-            self->NotifyStateChange();
+            self->NotifyStateChange(current);
         if (progress->percentage == 100) {
-            self->_inProgress.Install->SetState(Exchange::IPackager::INSTALLED);
-            self->NotifyStateChange();
+            current.Install->SetState(Exchange::IPackager::INSTALLED);
+            self->NotifyStateChange(current);
         }
     }
 #endif
 
-    void PackagerImplementation::NotifyStateChange()
+    void PackagerImplementation::NotifyStateChange(const InstallationData& data)
     {
         _adminLock.Lock();
-        TRACE_L1("State for %s changed to %d (%d %%, %d)", _inProgress.Package->Name().c_str(), _inProgress.Install->State(), _inProgress.Install->Progress(), _inProgress.Install->ErrorCode());
+        TRACE_L1("State for %s changed to %d (%d %%, %d)", data.Package->Name().c_str(), data.Install->State(), data.Install->Progress(), data.Install->ErrorCode());
         for (auto* notification : _notifications) {
-            notification->StateChange(_inProgress.Package, _inProgress.Install);
+            notification->StateChange(data.Package, data.Install);
         }
         _adminLock.Unlock();
     }
@@ -317,35 +405,191 @@ namespace Plugin {
         }
     }
 
+    static Core::ProxyPoolType<Web::Response> g_probeFactory(1);
+
+    PackagerImplementation::FeedProbe::FeedProbe(Core::ProxyPoolType<Web::Response>& factory)
+        : BaseClass(1, factory, false, Core::NodeId(), Core::NodeId(), 256, 1024)
+        , _adminLock()
+        , _request(Core::ProxyType<Web::Request>::Create())
+        , _done(false, true)
+        , _stamp()
+    {
+    }
+
+    /* virtual */ PackagerImplementation::FeedProbe::~FeedProbe()
+    {
+        Close(Core::infinite);
+    }
+
+    bool PackagerImplementation::FeedProbe::Stamp(const Core::URL& index, string& stamp, const uint32_t waitTime)
+    {
+        bool result = false;
+        const uint16_t port = (index.Port().IsSet() == true ? index.Port().Value() : Core::URL::Port(index.Type()));
+        const Core::NodeId remote(index.Host().Value().c_str(), port);
+
+        if (remote.IsValid() == true) {
+            _request->Verb = Web::Request::HTTP_GET;
+            _request->Host = index.Host().Value();
+            _request->Path = _T("/");
+            if (index.Path().IsSet() == true) {
+                _request->Path += index.Path().Value();
+            }
+
+            _adminLock.Lock();
+            _stamp.clear();
+            _adminLock.Unlock();
+            _done.ResetEvent();
+
+            Link().LocalNode(remote.AnyInterface());
+            Link().RemoteNode(remote);
+
+            const uint32_t status = Open(0);
+
+            if (((status == Core::ERROR_NONE) || (status == Core::ERROR_INPROGRESS)) && (_done.Lock(waitTime) == Core::ERROR_NONE)) {
+                _adminLock.Lock();
+                stamp = _stamp;
+                _adminLock.Unlock();
+
+                result = (stamp.empty() == false);
+            }
+
+            Close(Core::infinite);
+        }
+
+        return (result);
+    }
+
+    /* virtual */ void PackagerImplementation::FeedProbe::LinkBody(Core::ProxyType<Web::Response>& element)
+    {
+        // No body is attached, the headers are all we came for.
+        Validators(*element);
+    }
+
+    /* virtual */ void PackagerImplementation::FeedProbe::Received(Core::ProxyType<Web::Response>& element)
+    {
+        Validators(*element);
+    }
+
+    /* virtual */ void PackagerImplementation::FeedProbe::Send(const Core::ProxyType<Web::Request>& element)
+    {
+        ASSERT(element == _request);
+    }
+
+    /* virtual */ void PackagerImplementation::FeedProbe::StateChange()
+    {
+        if (Link().IsOpen() == true) {
+            Submit(_request);
+        } else {
+            // Closed or failed before the headers came in, nothing to validate.
+            _done.SetEvent();
+        }
+    }
+
+    void PackagerImplementation::FeedProbe::Validators(const Web::Response& response)
+    {
+        _adminLock.Lock();
+
+        if ((response.ErrorCode == Web::STATUS_OK) && ((response.LastModified.IsSet() == true) || (response.ETag.IsSet() == true))) {
+            _stamp = (response.ETag.IsSet() == true ? response.ETag.Value() : string()) + ':' +
+                (response.LastModified.IsSet() == true ? Core::NumberType<uint64_t>(response.LastModified.Value().Ticks()).Text() : string()) + ':' +
+                (response.ContentLength.IsSet() == true ? Core::NumberType<uint32_t>(response.ContentLength.Value()).Text() : string());
+        }
+
+        _adminLock.Unlock();
+
+        _done.SetEvent();
+    }
+
+    // Returns true if any feed might have changed since the last sync. Local (file://) feeds are validated on the
+    // size and modification time of their index, remote http:// feeds on the validators (ETag, Last-Modified and
+    // length) of their index. Feeds that can not be validated count as changed.
+    bool PackagerImplementation::FeedsChanged(std::map<string, string>& stamps) const
+    {
+        bool changed = false;
+        std::ifstream conf(_configFile);
+        FeedProbe probe(g_probeFactory);
+        string line;
+
+        while (std::getline(conf, line)) {
+            std::istringstream fields(line);
+            string type, name, url;
+
+            fields >> type >> name >> url;
+
+            if ((type == _T("src")) || (type == _T("src/gz"))) {
+                const string index(url + (type == _T("src/gz") ? _T("/Packages.gz") : _T("/Packages")));
+                struct stat info;
+
+                if (url.compare(0, 7, _T("file://")) == 0) {
+                    if (::stat(index.substr(7).c_str(), &info) == 0) {
+                        stamps[name] = Core::NumberType<uint64_t>(info.st_size).Text() + ':' + Core::NumberType<uint64_t>(info.st_mtime).Text();
+                    } else {
+                        changed = true;
+                    }
+                } else {
+                    const Core::URL remote(index.c_str());
+                    string stamp;
+
+                    if ((remote.IsValid() == true) && (remote.Type() == Core::URL::SCHEME_HTTP) && (probe.Stamp(remote, stamp, FeedProbeTime) == true)) {
+                        stamps[name] = stamp;
+                    } else {
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        return ((changed == true) || (stamps != _feedStamps));
+    }
+
     void PackagerImplementation::BlockingSetupLocalRepoNoLock(RepoSyncMode mode)
     {
-        string dirPath = Core::ToString(opkg_config->lists_dir);
-        Core::Directory dir(dirPath.c_str());
-        bool containFiles = false;
-        if (mode == RepoSyncMode::SETUP && _alwaysUpdateFirst == false) {
+        ASSERT(mode == RepoSyncMode::SETUP || _isSyncing == true);
+
+        // Every batch starts from a fresh OPKG, see ResetOPKG().
+        ResetOPKG();
+
+        if (_opkgInitialized == false) {
+            TRACE_L1("Failed to initialize OPKG. Installing might not work");
+            if (mode == RepoSyncMode::FORCED) {
+                NotifyRepoSynced(Core::ERROR_GENERAL);
+            }
+        } else {
+            string dirPath = Core::ToString(opkg_config->lists_dir);
+            Core::Directory dir(dirPath.c_str());
+            bool containFiles = false;
             while (dir.Next() == true) {
                 if (dir.Name() != _T(".") && dir.Name() != _T("..") && dir.Name() != dirPath) {
                     containFiles = true;
                     break;
                 }
             }
-        }
-        ASSERT(mode == RepoSyncMode::SETUP || _isSyncing == true);
-        if (containFiles == false) {
-            uint32_t result = Core::ERROR_NONE;
+
+            std::map<string, string> stamps;
+            bool changed = FeedsChanged(stamps);
+            bool sync = (containFiles == false) || (((mode == RepoSyncMode::FORCED) || (_alwaysUpdateFirst == true)) && (changed == true));
+
+            if (sync == true) {
+                uint32_t result = Core::ERROR_NONE;
 #if defined DO_NOT_USE_DEPRECATED_API
-            opkg_cmd_t* command = opkg_cmd_find("update");
-            if (command)
-                opkg_config->pfm = command->pfm;
-            if (command == nullptr || opkg_cmd_exec(command, 0, nullptr) != 0)
+                opkg_cmd_t* command = opkg_cmd_find("update");
+                if (command)
+                    opkg_config->pfm = command->pfm;
+                if (command == nullptr || opkg_cmd_exec(command, 0, nullptr) != 0)
 #else
-            if (opkg_update_package_lists(nullptr, nullptr) != 0)
+                if (opkg_update_package_lists(nullptr, nullptr) != 0)
 #endif
-            {
-                TRACE_L1("Failed to set up local repo. Installing might not work");
-                result = Core::ERROR_GENERAL;
+                {
+                    TRACE_L1("Failed to set up local repo. Installing might not work");
+                    result = Core::ERROR_GENERAL;
+                } else {
+                    _feedStamps = stamps;
+                }
+                NotifyRepoSynced(result);
+            } else if (mode == RepoSyncMode::FORCED) {
+                TRACE_L1("Feeds did not change since the last sync, skipping it");
+                NotifyRepoSynced(Core::ERROR_NONE);
             }
-            NotifyRepoSynced(result);
         }
     }
 
@@ -23,6 +23,7 @@
 #include <interfaces/IPackager.h>
 
 #include <list>
+#include <map>
 #include <string>
 
 // Forward declarations so we do not need to include the OPKG headers here.
@@ -33,6 +34,10 @@ namespace WPEFramework {
 namespace Plugin {
 
     class PackagerImplementation : public Exchange::IPackager {
+    private:
+        // Time a remote feed gets to send the headers of its index, in mS.
+        static constexpr uint32_t FeedProbeTime = 5000;
+
     public:
         PackagerImplementation(const PackagerImplementation&) = delete;
         PackagerImplementation& operator=(const PackagerImplementation&) = delete;
@@ -87,6 +92,10 @@ namespace Plugin {
             , _alwaysUpdateFirst(false)
             , _volatileCache(false)
             , _opkgInitialized(false)
+            , _queue()
+            , _inProgress()
+            , _current(nullptr)
+            , _feedStamps()
             , _worker(this)
             , _isUpgrade(false)
             , _isSyncing(false)
@@ -227,6 +236,8 @@ namespace Plugin {
             InstallInfo* Install = nullptr;
         };
 
+        using InstallationQueue = std::list<InstallationData>;
+
         class InstallThread : public Core::Thread {
         public:
             InstallThread(PackagerImplementation* parent)
@@ -239,26 +250,26 @@ namespace Plugin {
             uint32_t Worker() override {
                 while(IsRunning() == true) {
                     _parent->_adminLock.Lock(); // The parent may have lock when this starts so wait for it to release.
-                    bool isInstall = _parent->_inProgress.Install != nullptr;
-                    ASSERT(isInstall != true || _parent->_inProgress.Package != nullptr);
+                    // Take everything queued so far as one batch, it shares a single repository sync.
+                    _parent->_inProgress.splice(_parent->_inProgress.end(), _parent->_queue);
+                    bool isInstall = (_parent->_inProgress.empty() == false);
+                    bool isSync = _parent->_isSyncing;
                     _parent->_adminLock.Unlock();
 
-                    // After this point locking is not needed because API running on other threads only read if in
-                    // progress is filled in.
-                    _parent->BlockingSetupLocalRepoNoLock(isInstall == true ? RepoSyncMode::SETUP : RepoSyncMode::FORCED);
-                    if (isInstall)
-                        _parent->BlockingInstallUntilCompletionNoLock();
-
-                    if (isInstall) {
-                        _parent->_adminLock.Lock();
-                        _parent->_inProgress.Install->Release();
-                        _parent->_inProgress.Package->Release();
-                        _parent->_inProgress.Install = nullptr;
-                        _parent->_inProgress.Package = nullptr;
-                        _parent->_adminLock.Unlock();
+                    if ((isInstall == true) || (isSync == true)) {
+                        // After this point locking is not needed for the batch, API running on other threads only
+                        // appends to the queue.
+                        _parent->BlockingSetupLocalRepoNoLock(isSync == true ? RepoSyncMode::FORCED : RepoSyncMode::SETUP);
+                        if (isInstall)
+                            _parent->BlockingInstallUntilCompletionNoLock();
                     }
 
-                    Block();
+                    _parent->_adminLock.Lock();
+                    _parent->_inProgress.clear();
+                    if ((_parent->_queue.empty() == true) && (_parent->_isSyncing == false)) {
+                        Block();
+                    }
+                    _parent->_adminLock.Unlock();
                 }
 
                 return Core::infinite;
@@ -268,6 +279,39 @@ namespace Plugin {
             PackagerImplementation* _parent;
         };
 
+        // Fetches the headers of the index of a remote feed, the validators in there tell if the feed changed.
+        // The body is not needed, the connection is closed as soon as the headers are in.
+        class FeedProbe : public Web::WebLinkType<Core::SocketStream, Web::Response, Web::Request, Core::ProxyPoolType<Web::Response>&> {
+        private:
+            typedef Web::WebLinkType<Core::SocketStream, Web::Response, Web::Request, Core::ProxyPoolType<Web::Response>&> BaseClass;
+
+        public:
+            FeedProbe() = delete;
+            FeedProbe(const FeedProbe&) = delete;
+            FeedProbe& operator=(const FeedProbe&) = delete;
+
+            FeedProbe(Core::ProxyPoolType<Web::Response>& factory);
+            ~FeedProbe() override;
+
+        public:
+            // Returns false if the index has no validators, or could not be reached within the wait time (ms).
+            bool Stamp(const Core::URL& index, string& stamp, const uint32_t waitTime);
+
+        private:
+            void LinkBody(Core::ProxyType<Web::Response>& element) override;
+            void Received(Core::ProxyType<Web::Response>& element) override;
+            void Send(const Core::ProxyType<Web::Request>& element) override;
+            void StateChange() override;
+
+            void Validators(const Web::Response& response);
+
+        private:
+            Core::CriticalSection _adminLock;
+            Core::ProxyType<Web::Request> _request;
+            Core::Event _done;
+            string _stamp;
+        };
+
         enum class RepoSyncMode {
             FORCED,
             SETUP
@@ -277,13 +321,19 @@ namespace Plugin {
         void UpdateConfig() const;
 #if !defined (DO_NOT_USE_DEPRECATED_API)
         static void InstallationProgessNoLock(const _opkg_progress_data_t* progress, void* data);
+#else
+        bool BlockingInstallBatchNoLock();
 #endif
-        void NotifyStateChange();
+        void NotifyStateChange(const InstallationData& data);
         void NotifyRepoSynced(uint32_t status);
         void BlockingInstallUntilCompletionNoLock();
+        void BlockingInstallNoLock(InstallationData& data);
         void BlockingSetupLocalRepoNoLock(RepoSyncMode mode);
+        bool FeedsChanged(std::map<string, string>& stamps) const;
+        bool IsQueued(const string& name) const;
         bool InitOPKG();
         void FreeOPKG();
+        void ResetOPKG();
 
         Core::CriticalSection _adminLock;
         string _configFile;
@@ -296,7 +346,10 @@ namespace Plugin {
         bool _volatileCache;
         bool _opkgInitialized;
         std::vector<Exchange::IPackager::INotification*> _notifications;
-        InstallationData _inProgress;
+        InstallationQueue _queue;
+        InstallationQueue _inProgress;
+        InstallationData* _current;
+        std::map<string, string> _feedStamps;
         InstallThread _worker;
         bool _isUpgrade;
         bool _isSyncing;
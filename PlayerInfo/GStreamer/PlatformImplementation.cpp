@@ -22,6 +22,10 @@
 
 #include <gst/gst.h>
 
+#include <dirent.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+
 namespace WPEFramework {
 namespace Plugin {
 
@@ -199,14 +203,48 @@ private:
         std::list<VideoCodec> _codecs;
     };
 
+    // Outcome of the last probe, valid as long as the set of GStreamer plugins did not change.
+    class CodecCache : public Core::JSON::Container {
+    public:
+        CodecCache(const CodecCache&) = delete;
+        CodecCache& operator=(const CodecCache&) = delete;
+
+        CodecCache()
+            : Core::JSON::Container()
+            , Fingerprint()
+            , Audio()
+            , Video()
+        {
+            Add(_T("fingerprint"), &Fingerprint);
+            Add(_T("audio"), &Audio);
+            Add(_T("video"), &Video);
+        }
+        ~CodecCache() override
+        {
+        }
+
+    public:
+        Core::JSON::String Fingerprint;
+        Core::JSON::ArrayType<Core::JSON::DecUInt32> Audio;
+        Core::JSON::ArrayType<Core::JSON::DecUInt32> Video;
+    };
+
     typedef std::map<const string, const Exchange::IPlayerProperties::IAudioIterator::AudioCodec> AudioCaps;
     typedef std::map<const string, const Exchange::IPlayerProperties::IVideoIterator::VideoCodec> VideoCaps;
 
 public:
     PlayerInfoImplementation() {
-        gst_init(0, nullptr);
-        UpdateAudioCodecInfo();
-        UpdateVideoCodecInfo();
+        const string fingerprint(RegistryFingerprint());
+        const string cacheFile(string(g_get_user_cache_dir()) + _T("/gstreamer-1.0/playerinfo-codecs.json"));
+
+        // Probing means loading the full registry and walking all decoders and parsers, skip it if the
+        // plugins are still the same as the last time.
+        if (LoadCache(cacheFile, fingerprint) == false) {
+            gst_init(0, nullptr);
+            UpdateAudioCodecInfo();
+            UpdateVideoCodecInfo();
+            SaveCache(cacheFile, fingerprint);
+        }
     }
 
     PlayerInfoImplementation(const PlayerInfoImplementation&) = delete;
@@ -232,7 +270,124 @@ public:
    END_INTERFACE_MAP
 
 private:
+    static void AddPaths(const TCHAR* list, std::list<string>& paths)
+    {
+        if (list != nullptr) {
+            const string value(list);
+            Core::TextSegmentIterator index(Core::TextFragment(value), true, ':');
+
+            while (index.Next() == true) {
+                paths.push_back(index.Current().Text());
+            }
+        }
+    }
+    // Fingerprint of all plugin modules GStreamer would load: their path, size and modification time.
+    static string RegistryFingerprint()
+    {
+        std::list<string> paths;
+        std::map<string, string> modules;
+
+        const TCHAR* systemPath = ::getenv(_T("GST_PLUGIN_SYSTEM_PATH_1_0"));
+        if (systemPath == nullptr) {
+            systemPath = ::getenv(_T("GST_PLUGIN_SYSTEM_PATH"));
+        }
+
+        if (systemPath != nullptr) {
+            AddPaths(systemPath, paths);
+        } else {
+            // The default system plugin directory lives next to the GStreamer library itself.
+            Dl_info info;
+            paths.push_back(string(g_get_user_data_dir()) + _T("/gstreamer-1.0/plugins"));
+            if ((::dladdr(reinterpret_cast<void*>(&gst_init), &info) != 0) && (info.dli_fname != nullptr)) {
+                string library(info.dli_fname);
+                paths.push_back(library.substr(0, library.rfind('/')) + _T("/gstreamer-1.0"));
+            }
+        }
+
+        const TCHAR* pluginPath = ::getenv(_T("GST_PLUGIN_PATH_1_0"));
+        AddPaths(pluginPath != nullptr ? pluginPath : ::getenv(_T("GST_PLUGIN_PATH")), paths);
+
+        for (const string& path : paths) {
+            DIR* dir = ::opendir(path.c_str());
 
+            if (dir != nullptr) {
+                struct dirent* entry;
+
+                while ((entry = ::readdir(dir)) != nullptr) {
+                    const string name(path + '/' + entry->d_name);
+                    struct stat info;
+
+                    if ((name.length() > 3) && (name.compare(name.length() - 3, 3, _T(".so")) == 0) && (::stat(name.c_str(), &info) == 0)) {
+                        modules[name] = Core::NumberType<uint64_t>(info.st_size).Text() + ':' + Core::NumberType<uint64_t>(info.st_mtime).Text();
+                    }
+                }
+
+                ::closedir(dir);
+            }
+        }
+
+        string result;
+
+        if (modules.empty() == false) {
+            // FNV-1a over the sorted module list.
+            uint64_t hash = 14695981039346656037ULL;
+
+            for (const auto& module : modules) {
+                const string line(module.first + '=' + module.second + ';');
+                for (const TCHAR c : line) {
+                    hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+                }
+            }
+
+            result = Core::NumberType<uint32_t>(static_cast<uint32_t>(modules.size())).Text() + '-' + Core::NumberType<uint64_t>(hash).Text();
+        }
+
+        return (result);
+    }
+    bool LoadCache(const string& fileName, const string& fingerprint)
+    {
+        bool result = false;
+        Core::File file(fileName);
+
+        if ((fingerprint.empty() == false) && (file.Open(true) == true)) {
+            CodecCache cache;
+            Core::OptionalType<Core::JSON::Error> error;
+            cache.IElement::FromFile(file, error);
+
+            if ((error.IsSet() == false) && (cache.Fingerprint.Value() == fingerprint)) {
+                auto audio(cache.Audio.Elements());
+                while (audio.Next() == true) {
+                    _audioCodecs.push_back(static_cast<Exchange::IPlayerProperties::IAudioIterator::AudioCodec>(audio.Current().Value()));
+                }
+                auto video(cache.Video.Elements());
+                while (video.Next() == true) {
+                    _videoCodecs.push_back(static_cast<Exchange::IPlayerProperties::IVideoIterator::VideoCodec>(video.Current().Value()));
+                }
+                TRACE_L1(_T("Codec information taken from %s"), fileName.c_str());
+                result = true;
+            }
+        }
+
+        return (result);
+    }
+    void SaveCache(const string& fileName, const string& fingerprint) const
+    {
+        if ((fingerprint.empty() == false) && (Core::Directory(fileName.substr(0, fileName.rfind('/') + 1).c_str()).CreatePath() == true)) {
+            Core::File file(fileName);
+
+            if (file.Create() == true) {
+                CodecCache cache;
+                cache.Fingerprint = fingerprint;
+                for (const auto codec : _audioCodecs) {
+                    cache.Audio.Add() = static_cast<uint32_t>(codec);
+                }
+                for (const auto codec : _videoCodecs) {
+                    cache.Video.Add() = static_cast<uint32_t>(codec);
+                }
+                cache.IElement::ToFile(file);
+            }
+        }
+    }
 
     void UpdateAudioCodecInfo()
     {
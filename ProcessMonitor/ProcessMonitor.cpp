@@ -41,8 +41,13 @@ void ProcessMonitor::Deinitialize(PluginHost::IShell* service)
 
 string ProcessMonitor::Information() const
 {
-    string emptyString;
-    return emptyString;
+    // The last observed shutdown of every out-of-process plugin.
+    Data data;
+    _notification.Shutdowns(data.Shutdowns);
+
+    string result;
+    data.ToString(result);
+    return (result);
 }
 }
 }
@@ -22,10 +22,24 @@
 
 #include "Module.h"
 
+#include <atomic>
+#include <queue>
 #include <string>
 #include <syslog.h>
 #include <unordered_map>
 
+#include <poll.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+#ifndef SYS_pidfd_send_signal
+#define SYS_pidfd_send_signal 424
+#endif
+
 namespace WPEFramework {
 namespace Plugin {
 
@@ -54,6 +68,71 @@ public:
         Core::JSON::DecUInt32 ExitTimeout;
     };
 
+    class Data: public Core::JSON::Container
+    {
+    public:
+        class Shutdown: public Core::JSON::Container
+        {
+        public:
+            Shutdown()
+                : Core::JSON::Container()
+                , Callsign()
+                , Duration()
+                , Killed()
+            {
+                Init();
+            }
+            Shutdown(const Shutdown& copy)
+                : Core::JSON::Container()
+                , Callsign(copy.Callsign)
+                , Duration(copy.Duration)
+                , Killed(copy.Killed)
+            {
+                Init();
+            }
+            Shutdown& operator=(const Shutdown& rhs)
+            {
+                Callsign = rhs.Callsign;
+                Duration = rhs.Duration;
+                Killed = rhs.Killed;
+                return (*this);
+            }
+            ~Shutdown() override
+            {
+            }
+
+        private:
+            void Init()
+            {
+                Add(_T("callsign"), &Callsign);
+                Add(_T("duration"), &Duration);
+                Add(_T("killed"), &Killed);
+            }
+
+        public:
+            Core::JSON::String Callsign;
+            Core::JSON::DecUInt32 Duration; // In ms, from the start of the deactivation until the process was gone
+            Core::JSON::Boolean Killed;
+        };
+
+    public:
+        Data(const Data&) = delete;
+        Data& operator=(const Data&) = delete;
+
+        Data()
+            : Core::JSON::Container()
+            , Shutdowns()
+        {
+            Add(_T("shutdowns"), &Shutdowns);
+        }
+        ~Data() override
+        {
+        }
+
+    public:
+        Core::JSON::ArrayType<Shutdown> Shutdowns;
+    };
+
     class Notification: public PluginHost::IPlugin::INotification,
             public RPC::IRemoteConnection::INotification
     {
@@ -64,47 +143,173 @@ public:
 
         using Job = Core::WorkerPool::JobType<Notification&>;
 
-        class ProcessObject
+        // Closes the descriptors of processes that exited. Runs on the worker pool, as the resource
+        // monitor can not unregister a resource from within its own Handle().
+        class Releaser
+        {
+        public:
+            Releaser() = delete;
+            Releaser(const Releaser&) = delete;
+            Releaser& operator=(const Releaser&) = delete;
+
+            Releaser(Notification& parent)
+                : _parent(parent)
+            {
+            }
+            ~Releaser()
+            {
+            }
+
+        public:
+            void Dispatch()
+            {
+                _parent.Cleanup();
+            }
+
+        private:
+            Notification& _parent;
+        };
+
+        // Watches a single out-of-process plugin through a pidfd. The descriptor becomes readable as soon
+        // as the process is gone, so there is no need to wait for the exit timeout to find out.
+        class ProcessObject: public Core::IResource
         {
         public:
             ProcessObject() = delete;
-            ProcessObject(const ProcessObject&) = default;
-            ProcessObject& operator=(const ProcessObject&) = default;
+            ProcessObject(const ProcessObject&) = delete;
+            ProcessObject& operator=(const ProcessObject&) = delete;
 
         public:
             ProcessObject(
+                Notification& parent,
+                const string& callsign,
                 const uint32_t processId)
-                : _processId(processId)
+                : _parent(parent)
+                , _callsign(callsign)
+                , _processId(processId)
+                , _descriptor(static_cast<int>(::syscall(SYS_pidfd_open, processId, 0)))
+                , _deactivated(0)
                 , _exitTime(0)
+                , _exited(false)
             {
                 ASSERT(_processId != 0);
+
+                if (_descriptor == -1) {
+                    TRACE(Trace::Information, (_T("No pidfd for [%s], falling back to the exit timeout, error: %d"), _callsign.c_str(), errno));
+                }
+            }
+            ~ProcessObject() override
+            {
+                if (_descriptor != -1) {
+                    ::close(_descriptor);
+                }
             }
-            ~ProcessObject()
+
+        public:
+            const string& Callsign() const
             {
+                return _callsign;
             }
-            uint32_t ProcessId()
+            uint32_t ProcessId() const
             {
                 return _processId;
             }
-            void SetExitTime(const uint64_t exitTime)
+            bool IsMonitored() const
+            {
+                return (_descriptor != -1);
+            }
+            void SetExitTime(const uint64_t deactivated, const uint64_t exitTime)
             {
+                _deactivated = deactivated;
                 _exitTime = exitTime;
             }
-            uint64_t ExitTime()
+            uint64_t Deactivated() const
+            {
+                return _deactivated;
+            }
+            uint64_t ExitTime() const
             {
                 return _exitTime;
             }
+            bool Kill()
+            {
+                bool killed = false;
+
+                if (_descriptor != -1) {
+                    // Signalling through the pidfd can not hit a recycled process id.
+                    killed = (::syscall(SYS_pidfd_send_signal, _descriptor, SIGKILL, nullptr, 0) == 0);
+                }
+                else {
+                    Core::Process proc(_processId);
+                    if (proc.IsActive()) {
+                        proc.Kill(true);
+                        killed = true;
+                    }
+                }
+
+                return (killed);
+            }
+
+            Core::IResource::handle Descriptor() const override
+            {
+                return (_descriptor);
+            }
+            uint16_t Events() override
+            {
+                return (_exited == false ? POLLIN : 0);
+            }
+            void Handle(const uint16_t events) override
+            {
+                if (((events & POLLIN) != 0) && (_exited.exchange(true) == false)) {
+                    _parent.Exited(*this);
+                }
+            }
 
         private:
+            Notification& _parent;
+            const string _callsign;
             const uint32_t _processId;
+            int _descriptor;
+            uint64_t _deactivated;
             uint64_t _exitTime;
+            std::atomic<bool> _exited;
         };
 
+    private:
+        // Deadlines live in a min-heap. Entries are not removed when a process exits early, they are
+        // skipped once they reach the top and no longer match the process registered for the callsign.
+        struct Deadline {
+            Deadline(const uint64_t time, const string& callsign)
+                : Time(time)
+                , Callsign(callsign)
+            {
+            }
+
+            uint64_t Time;
+            string Callsign;
+        };
+        struct Later {
+            bool operator()(const Deadline& lhs, const Deadline& rhs) const
+            {
+                return (lhs.Time > rhs.Time);
+            }
+        };
+
+        using Deadlines = std::priority_queue<Deadline, std::vector<Deadline>, Later>;
+        using Processes = std::unordered_map<string, ProcessObject*>;
+        using ShutdownMap = std::unordered_map<string, std::pair<uint32_t, bool>>;
+
     public:
         Notification(ProcessMonitor* parent)
             : _adminLock()
+            , _scheduleLock()
             , _processMap()
+            , _deadlines()
+            , _released()
+            , _shutdowns()
             , _job(*this)
+            , _releaser(*this)
+            , _cleanupJob(_releaser)
             , _service(nullptr)
             , _parent(*parent)
             ,_exittimeout(10000000)
@@ -142,8 +347,25 @@ public:
             _service = nullptr;
 
             _job.Revoke();
+            _cleanupJob.Revoke();
+
+            std::vector<ProcessObject*> released;
+
+            _adminLock.Lock();
+
+            for (auto& entry : _processMap) {
+                released.push_back(entry.second);
+            }
+            released.insert(released.end(), _released.begin(), _released.end());
 
             _processMap.clear();
+            _released.clear();
+            _deadlines = Deadlines();
+            _shutdowns.clear();
+
+            _adminLock.Unlock();
+
+            Release(released);
         }
         void StateChange(PluginHost::IShell* service) override
         {
@@ -154,74 +376,85 @@ public:
 
                 _adminLock.Lock();
 
-                std::unordered_map<string, ProcessObject>::iterator itr(
-                        _processMap.find(service->Callsign()));
+                Processes::iterator itr(_processMap.find(service->Callsign()));
                 if (itr != _processMap.end()) {
-                    exitTime = Core::Time::Now().Ticks() + _exittimeout;
-                    itr->second.SetExitTime(exitTime);
+                    uint64_t now = Core::Time::Now().Ticks();
+                    exitTime = now + _exittimeout;
+                    itr->second->SetExitTime(now, exitTime);
+                    _deadlines.emplace(exitTime, itr->first);
                 }
 
+                _adminLock.Unlock();
+
                 if (exitTime != 0) {
                     ScheduleJob();
                 }
-
-                _adminLock.Unlock();
             }
         }
-        void AddProcess(const string callsign, const uint32_t processId)
+        void AddProcess(const string& callsign, const uint32_t processId)
         {
+            ProcessObject* process = new ProcessObject(*this, callsign, processId);
+            ProcessObject* previous = nullptr;
+
             _adminLock.Lock();
 
-            _processMap.emplace(callsign, ProcessObject(processId));
+            Processes::iterator itr(_processMap.find(callsign));
+            if (itr != _processMap.end()) {
+                // A new instance of the plugin, whatever we had is stale.
+                previous = itr->second;
+                itr->second = process;
+            }
+            else {
+                _processMap.emplace(callsign, process);
+            }
 
             _adminLock.Unlock();
+
+            if (previous != nullptr) {
+                Release(previous);
+            }
+            if (process->IsMonitored() == true) {
+                Core::ResourceMonitor::Instance().Register(*process);
+            }
         }
         void Dispatch()
         {
             uint64_t currTime(Core::Time::Now().Ticks());
+            std::vector<ProcessObject*> released;
 
             _adminLock.Lock();
 
-            auto itr = _processMap.begin();
-            while (itr != _processMap.end()) {
+            while ((_deadlines.empty() == false) && (_deadlines.top().Time <= currTime)) {
 
-                uint64_t exitTime = itr->second.ExitTime();
-                if ((exitTime != 0) && (exitTime <= currTime)) {
-                    Core::Process proc(itr->second.ProcessId());
-                    if (proc.IsActive()) {
-                        proc.Kill(true);
+                const Deadline& deadline(_deadlines.top());
+                Processes::iterator itr(_processMap.find(deadline.Callsign));
+
+                if ((itr != _processMap.end()) && (itr->second->ExitTime() == deadline.Time)) {
+                    ProcessObject* process = itr->second;
+
+                    if (process->Kill() == true) {
+                        Record(*process, currTime, true);
                         SYSLOG(Logging::Notification,
                                 (_T("ProcessMonitor killed: [%s]!"),
                                         itr->first.c_str()));
                     }
-                    itr = _processMap.erase(itr);
-                }
-                else {
-                    itr++;
+
+                    released.push_back(process);
+                    _processMap.erase(itr);
                 }
+
+                _deadlines.pop();
             }
 
-            ScheduleJob();
+            uint64_t scheduleTime = NextDeadline();
 
             _adminLock.Unlock();
-        }
-        void ScheduleJob()
-        {
-            uint64_t scheduleTime = 0;
-
-            for (auto itr : _processMap) {
-                uint64_t exitTime = itr.second.ExitTime();
-                if (exitTime != 0) {
-                    if ((scheduleTime == 0) || (scheduleTime > exitTime)) {
-                        scheduleTime = exitTime;
-                    }
-                }
-            }
 
             if (scheduleTime != 0) {
-                _job.Revoke();
                 _job.Schedule(scheduleTime);
             }
+
+            Release(released);
         }
         void Activated(RPC::IRemoteConnection* connection) override
         {
@@ -236,15 +469,137 @@ public:
         {
         }
 
+        void Shutdowns(Core::JSON::ArrayType<Data::Shutdown>& shutdowns) const
+        {
+            _adminLock.Lock();
+
+            for (const auto& entry : _shutdowns) {
+                Data::Shutdown& shutdown(shutdowns.Add());
+                shutdown.Callsign = entry.first;
+                shutdown.Duration = entry.second.first;
+                shutdown.Killed = entry.second.second;
+            }
+
+            _adminLock.Unlock();
+        }
+
         BEGIN_INTERFACE_MAP(Notification)
         INTERFACE_ENTRY(PluginHost::IPlugin::INotification)
         INTERFACE_ENTRY(RPC::IRemoteConnection::INotification)
         END_INTERFACE_MAP
 
     private:
-        Core::CriticalSection _adminLock;
-        std::unordered_map<string, ProcessObject> _processMap;
+        // Called from the resource monitor once the pidfd signals the process is gone.
+        void Exited(ProcessObject& process)
+        {
+            bool found = false;
+
+            _adminLock.Lock();
+
+            Processes::iterator itr(_processMap.find(process.Callsign()));
+            if ((itr != _processMap.end()) && (itr->second == &process)) {
+                found = true;
+
+                if (process.Deactivated() != 0) {
+                    Record(process, Core::Time::Now().Ticks(), false);
+                }
+                else {
+                    TRACE(Trace::Information, (_T("Process of [%s] exited without a deactivation"), process.Callsign().c_str()));
+                }
+
+                // Its deadline is dropped lazily, the descriptor is closed on the worker pool.
+                _released.push_back(&process);
+                _processMap.erase(itr);
+            }
+
+            _adminLock.Unlock();
+
+            if (found == true) {
+                _cleanupJob.Submit();
+            }
+        }
+        void Cleanup()
+        {
+            std::vector<ProcessObject*> released;
+
+            _adminLock.Lock();
+            released.swap(_released);
+            _adminLock.Unlock();
+
+            Release(released);
+        }
+        void Record(const ProcessObject& process, const uint64_t now, const bool killed)
+        {
+            uint32_t duration = static_cast<uint32_t>((now - process.Deactivated()) / Core::Time::TicksPerMillisecond);
+
+            _shutdowns[process.Callsign()] = std::make_pair(duration, killed);
+
+            if (killed == false) {
+                SYSLOG(Logging::Notification,
+                        (_T("ProcessMonitor: [%s] exited %u ms after deactivation"),
+                                process.Callsign().c_str(), duration));
+            }
+        }
+        // Drops the deadlines of processes that already exited, must be called with the admin lock taken.
+        uint64_t NextDeadline()
+        {
+            uint64_t scheduleTime = 0;
+
+            while ((scheduleTime == 0) && (_deadlines.empty() == false)) {
+                const Deadline& deadline(_deadlines.top());
+                Processes::const_iterator itr(_processMap.find(deadline.Callsign));
+
+                if ((itr != _processMap.end()) && (itr->second->ExitTime() == deadline.Time)) {
+                    scheduleTime = deadline.Time;
+                }
+                else {
+                    _deadlines.pop();
+                }
+            }
+
+            return (scheduleTime);
+        }
+        void ScheduleJob()
+        {
+            // Serializes the callers outside of the job, the job itself only ever schedules what is left.
+            _scheduleLock.Lock();
+
+            _adminLock.Lock();
+            uint64_t scheduleTime = NextDeadline();
+            _adminLock.Unlock();
+
+            if (scheduleTime != 0) {
+                _job.Revoke();
+                _job.Schedule(scheduleTime);
+            }
+
+            _scheduleLock.Unlock();
+        }
+        void Release(ProcessObject* process)
+        {
+            if (process->IsMonitored() == true) {
+                Core::ResourceMonitor::Instance().Unregister(*process);
+            }
+            delete process;
+        }
+        void Release(std::vector<ProcessObject*>& processes)
+        {
+            for (ProcessObject* process : processes) {
+                Release(process);
+            }
+            processes.clear();
+        }
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        Core::CriticalSection _scheduleLock;
+        Processes _processMap;
+        Deadlines _deadlines;
+        std::vector<ProcessObject*> _released;
+        ShutdownMap _shutdowns;
         Job  _job;
+        Releaser _releaser;
+        Core::WorkerPool::JobType<Releaser&> _cleanupJob;
         PluginHost::IShell* _service;
         ProcessMonitor& _parent;
         uint32_t _exittimeout;
@@ -20,8 +20,10 @@
 #include "RemoteAdministrator.h"
 
 #include <interfaces/IKeyHandler.h>
+#include <fcntl.h>
 #include <libudev.h>
 #include <linux/uinput.h>
+#include <sys/epoll.h>
 
 namespace WPEFramework {
 namespace Plugin {
@@ -40,6 +42,10 @@ namespace Plugin {
     private:
         static constexpr const TCHAR* InputDeviceSysFilePath = _T("/sys/class/input/");
         static constexpr const TCHAR* DeviceNamePath = _T("/device/name");
+        // Number of ready descriptors handled per epoll_wait call.
+        static constexpr uint8_t MaxEvents = 16;
+        // Number of input events read per read call, a device is read until it has nothing left.
+        static constexpr uint8_t MaxInputEvents = 64;
 
     private:
         LinuxDevice(const LinuxDevice&) = delete;
@@ -513,10 +519,11 @@ namespace Plugin {
             , _devices()
             , _monitor(nullptr)
             , _update(-1)
+            , _epoll(-1)
         {
             _pipe[0] = -1;
             _pipe[1] = -1;
-            if (::pipe(_pipe) < 0) {
+            if (::pipe2(_pipe, O_CLOEXEC) < 0) {
                 // Pipe not successfully opened. Close, if needed;
                 if (_pipe[0] != -1) {
                     close(_pipe[0]);
@@ -538,6 +545,11 @@ namespace Plugin {
 
                 udev_unref(udev);
 
+                // The interest set is persistent, only changes on hotplug of an input device.
+                _epoll = ::epoll_create1(EPOLL_CLOEXEC);
+                Watch(_pipe[0]);
+                Watch(_update);
+
                 _inputDevices.emplace_back(Core::Service<KeyDevice>::Create<KeyDevice>(this));
                 _inputDevices.emplace_back(Core::Service<WheelDevice>::Create<WheelDevice>(this));
                 _inputDevices.emplace_back(Core::Service<PointerDevice>::Create<PointerDevice>(this));
@@ -557,6 +569,10 @@ namespace Plugin {
                 close(_pipe[1]);
             }
 
+            if (_epoll != -1) {
+                ::close(_epoll);
+            }
+
             if (_update != -1) {
                 ::close(_update);
             }
@@ -610,10 +626,11 @@ namespace Plugin {
 
                     TRACE(Trace::Information, (_T("Opening input device: %s"), entry.Name().c_str()));
 
-                    if (entry.Open(true) == true) {
+                    std::map<string, std::pair<int, IDevInputDevice*>>::iterator device(_devices.find(entry.Name()));
+                    if ((device == _devices.end()) && (entry.Open(true) == true)) {
                         int fd = entry.DuplicateHandle();
-                        std::map<string, std::pair<int, IDevInputDevice*>>::iterator device(_devices.find(entry.Name()));
-                        if (device == _devices.end()) {
+
+                        if (fd != -1) {
                             string deviceName;
                             ReadDeviceName(entry.Name(), deviceName);
                             std::transform(deviceName.begin(), deviceName.end(), deviceName.begin(), std::ptr_fun<int, int>(std::toupper));
@@ -627,7 +644,11 @@ namespace Plugin {
                                 }
                             }
 
+                            // Non blocking, so a device can be drained completely on every wakeup.
+                            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+
                             _devices.insert(std::make_pair(entry.Name(), std::make_pair(fd, inputDevice)));
+                            Watch(fd);
                         }
                     }
                 }
@@ -642,10 +663,41 @@ namespace Plugin {
         {
             for (std::map<string, std::pair<int, IDevInputDevice*>>::const_iterator it = _devices.begin(), end = _devices.end();
                  it != end; ++it) {
+                Unwatch(it->second.first);
                 close(it->second.first);
             }
             _devices.clear();
         }
+        void Watch(const int fd)
+        {
+            struct epoll_event event;
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+
+            if (::epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event) < 0) {
+                TRACE_L1("Could not add descriptor %d to the input set, error: %d", fd, errno);
+            }
+        }
+        void Unwatch(const int fd)
+        {
+            ::epoll_ctl(_epoll, EPOLL_CTL_DEL, fd, nullptr);
+        }
+        void Remove(const int fd)
+        {
+            std::map<string, std::pair<int, IDevInputDevice*>>::iterator index(_devices.begin());
+
+            while ((index != _devices.end()) && (index->second.first != fd)) {
+                ++index;
+            }
+
+            Unwatch(fd);
+            close(fd);
+
+            if (index != _devices.end()) {
+                TRACE(Trace::Information, (_T("Closed input device: %s"), index->first.c_str()));
+                _devices.erase(index);
+            }
+        }
         void Block()
         {
             Core::Thread::Block();
@@ -655,81 +707,72 @@ namespace Plugin {
         virtual uint32_t Worker()
         {
             while (IsRunning() == true) {
-                fd_set readset;
-                FD_ZERO(&readset);
-                FD_SET(_pipe[0], &readset);
-                FD_SET(_update, &readset);
+                struct epoll_event events[MaxEvents];
+                bool reload = false;
 
-                int result = std::max(_pipe[0], _update);
+                int result = ::epoll_wait(_epoll, events, MaxEvents, -1);
 
-                // set up all the input devices
-                for (std::map<string, std::pair<int, IDevInputDevice*>>::const_iterator index = _devices.begin(), end = _devices.end(); index != end; ++index) {
-                    FD_SET(index->second.first, &readset);
-                    result = std::max(result, index->second.first);
-                }
-
-                result = select(result + 1, &readset, 0, 0, nullptr);
+                for (int index = 0; index < result; index++) {
+                    const int fd = events[index].data.fd;
 
-                if (result > 0) {
-                    if (FD_ISSET(_pipe[0], &readset)) {
+                    if (fd == _pipe[0]) {
                         char buff;
                         (void)read(_pipe[0], &buff, 1);
                     }
-                    if (FD_ISSET(_update, &readset)) {
-                        // Make the call to receive the device. select() ensured that this will not block.
-                        udev_device* dev = udev_monitor_receive_device(_monitor);
-                        if (dev) {
+                    else if (fd == _update) {
+                        // The monitor is non blocking, take all pending changes at once.
+                        udev_device* dev;
+                        while ((dev = udev_monitor_receive_device(_monitor)) != nullptr) {
                             const char* nodeId = udev_device_get_devnode(dev);
-                            bool reload = ((nodeId != nullptr) && (strncmp(Locator, nodeId, sizeof(Locator) - 1) == 0));
+                            reload = reload || ((nodeId != nullptr) && (strncmp(Locator, nodeId, sizeof(Locator) - 1) == 0));
                             udev_device_unref(dev);
-                            TRACE_L1("Changes from udev perspective. Reload (%s)", reload ? _T("true") : _T("false"));
-                            if (reload == true) {
-                                Refresh();
-                            }
                         }
+                        TRACE_L1("Changes from udev perspective. Reload (%s)", reload ? _T("true") : _T("false"));
                     }
-
-                    // find the devices to read from
-                    std::map<string, std::pair<int, IDevInputDevice*>>::iterator index = _devices.begin();
-
-                    while (index != _devices.end()) {
-                        if (FD_ISSET(index->second.first, &readset)) {
-
-                            if (HandleInput(index->second.first) == false) {
-                                // fd closed?
-                                close(index->second.first);
-                                index = _devices.erase(index);
-                            } else {
-                                ++index;
-                            }
-                        } else {
-                            ++index;
-                        }
+                    else if (HandleInput(fd) == false) {
+                        // fd closed?
+                        Remove(fd);
                     }
                 }
+
+                // Only after handling this batch, as descriptors of this batch should not be reused in between.
+                if (reload == true) {
+                    Refresh();
+                }
             }
             return (Core::infinite);
         }
         bool HandleInput(const int fd)
         {
-            input_event entry[16];
-            int index = 0;
-            int result = ::read(fd, entry, sizeof(entry));
+            input_event entry[MaxInputEvents];
+            int result;
+
+            do {
+                result = ::read(fd, entry, sizeof(entry));
+
+                int count = (result > 0 ? (result / static_cast<int>(sizeof(input_event))) : 0);
+
+                for (int index = 0; index < count; index++) {
+                    // Forward the moment the kernel registered the event, so latency can be measured end to end.
+#ifdef input_event_sec
+                    Remotes::RemoteAdministrator::Timestamp((static_cast<uint64_t>(entry[index].input_event_sec) * 1000000) + entry[index].input_event_usec);
+#else
+                    Remotes::RemoteAdministrator::Timestamp((static_cast<uint64_t>(entry[index].time.tv_sec) * 1000000) + entry[index].time.tv_usec);
+#endif
 
-            if (result > 0) {
-                while (result >= static_cast<int>(sizeof(input_event))) {
-                    ASSERT(index < static_cast<int>((sizeof(entry) / sizeof(input_event))));
                     for (auto& device : _inputDevices) {
                         if (device->HandleInput(entry[index].code,  entry[index].type, entry[index].value) == true) {
                             break;
                         }
                     }
-                    index++;
-                    result -= sizeof(input_event);
                 }
-            }
 
-            return (result >= 0);
+                // Not consumed by any device, do not let it leak into the next event.
+                Remotes::RemoteAdministrator::Timestamp();
+
+            } while ((result == static_cast<int>(sizeof(entry))) || ((result < 0) && (errno == EINTR)));
+
+            return ((result > 0) || ((result < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))));
         }
         bool ReadDeviceName(const string& eventLocation, string& deviceName)
         {
@@ -764,6 +807,7 @@ namespace Plugin {
         int _pipe[2];
         udev_monitor* _monitor;
         int _update;
+        int _epoll;
         std::vector<IDevInputDevice*> _inputDevices;
         static LinuxDevice* _singleton;
     };
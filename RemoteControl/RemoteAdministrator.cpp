@@ -22,6 +22,8 @@
 namespace WPEFramework {
 namespace Remotes {
 
+    /* static */ thread_local uint64_t RemoteAdministrator::_timestamp = 0;
+
     /* static */ RemoteAdministrator& RemoteAdministrator::Instance()
     {
         static RemoteAdministrator singleton;
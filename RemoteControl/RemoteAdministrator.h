@@ -366,6 +366,20 @@ namespace Remotes {
 
             _adminLock.Unlock();
         }
+        // The handler interfaces carry no time information. A producer that knows when an event really
+        // happened (e.g. the kernel timestamp of an evdev event, in microseconds since the epoch) reports
+        // it here, right before it calls the handler on the same thread. Reading it clears it, so it applies
+        // to that single call only.
+        static void Timestamp(const uint64_t timestamp)
+        {
+            _timestamp = timestamp;
+        }
+        static uint64_t Timestamp()
+        {
+            uint64_t result = _timestamp;
+            _timestamp = 0;
+            return (result);
+        }
         void RevokeAll()
         {
             _adminLock.Lock();
@@ -527,6 +541,7 @@ namespace Remotes {
         std::list<Exchange::IWheelProducer*> _wheels;
         std::list<Exchange::IPointerProducer*> _pointers;
         std::list<Exchange::ITouchProducer*> _touchpanels;
+        static thread_local uint64_t _timestamp;
     };
 }
 }
@@ -136,6 +136,10 @@ namespace Plugin {
         , _inputHandler(PluginHost::InputHandler::Handler())
         , _persistentPath()
         , _feedback(*this)
+        , _eventLock()
+        , _notificationClients()
+        , _latencyLock()
+        , _latencies()
     {
         ASSERT(_inputHandler != nullptr);
 
@@ -355,8 +359,26 @@ namespace Plugin {
 
     /* virtual */ uint32_t RemoteControl::KeyEvent(const bool pressed, const uint32_t code, const string& mapName)
     {
+        // Set by the producer, if it knows when the key really was pressed.
+        const uint64_t origin = Remotes::RemoteAdministrator::Timestamp();
+        const uint64_t received = Core::Time::Now().Ticks();
+
         uint32_t result = _inputHandler->KeyEvent(pressed, code, mapName);
 
+        const uint64_t dispatched = Core::Time::Now().Ticks();
+
+        _latencyLock.Lock();
+
+        Latency& latency(_latencies[mapName]);
+        latency.Dispatch.Add(dispatched - received);
+
+        if ((origin != 0) && (origin <= received)) {
+            latency.Delivery.Add(received - origin);
+            latency.Total.Add(dispatched - origin);
+        }
+
+        _latencyLock.Unlock();
+
         if (result == Core::ERROR_NONE) {
             TRACE(KeyActivity, (mapName, code, pressed));
         } else {
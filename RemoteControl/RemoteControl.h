@@ -188,6 +188,201 @@ namespace Plugin {
             Core::JSON::ArrayType<Core::JSON::String> Devices;
         };
 
+        // Latency distribution, bucket N counts the samples of [2^N, 2^(N+1)) microseconds (bucket 0 includes 0).
+        class Histogram {
+        public:
+            static constexpr uint8_t Buckets = 24;
+
+        public:
+            Histogram()
+                : _count(0)
+                , _sum(0)
+                , _minimum(~0)
+                , _maximum(0)
+            {
+                ::memset(_buckets, 0, sizeof(_buckets));
+            }
+            ~Histogram()
+            {
+            }
+
+        public:
+            void Add(const uint64_t value)
+            {
+                uint8_t bucket = 0;
+                uint64_t remainder = (value >> 1);
+
+                while ((remainder != 0) && (bucket < (Buckets - 1))) {
+                    remainder >>= 1;
+                    bucket++;
+                }
+
+                _buckets[bucket]++;
+                _count++;
+                _sum += value;
+                _minimum = (value < _minimum ? value : _minimum);
+                _maximum = (value > _maximum ? value : _maximum);
+            }
+            uint32_t Count() const
+            {
+                return (_count);
+            }
+            uint64_t Minimum() const
+            {
+                return (_count == 0 ? 0 : _minimum);
+            }
+            uint64_t Maximum() const
+            {
+                return (_maximum);
+            }
+            uint64_t Average() const
+            {
+                return (_count == 0 ? 0 : (_sum / _count));
+            }
+            uint32_t Bucket(const uint8_t index) const
+            {
+                ASSERT(index < Buckets);
+                return (_buckets[index]);
+            }
+
+        private:
+            uint32_t _count;
+            uint64_t _sum;
+            uint64_t _minimum;
+            uint64_t _maximum;
+            uint32_t _buckets[Buckets];
+        };
+
+        // Per producer, the stages a key goes through before it is handed to the applications.
+        class Latency {
+        public:
+            Latency()
+                : Delivery()
+                , Dispatch()
+                , Total()
+            {
+            }
+            ~Latency()
+            {
+            }
+
+        public:
+            // Kernel (or producer) timestamp up till the KeyEvent call, only for producers reporting a timestamp.
+            Histogram Delivery;
+            // Key map lookup and virtual input dispatch.
+            Histogram Dispatch;
+            // Kernel (or producer) timestamp up till the key is dispatched.
+            Histogram Total;
+        };
+
+    public:
+        class LatencyData : public Core::JSON::Container {
+        public:
+            class StageData : public Core::JSON::Container {
+            public:
+                StageData()
+                    : Core::JSON::Container()
+                {
+                    Init();
+                }
+                StageData(const StageData& copy)
+                    : Core::JSON::Container()
+                    , Count(copy.Count)
+                    , Minimum(copy.Minimum)
+                    , Maximum(copy.Maximum)
+                    , Average(copy.Average)
+                    , Buckets(copy.Buckets)
+                {
+                    Init();
+                }
+                ~StageData() override
+                {
+                }
+                StageData& operator=(const StageData& rhs)
+                {
+                    Count = rhs.Count;
+                    Minimum = rhs.Minimum;
+                    Maximum = rhs.Maximum;
+                    Average = rhs.Average;
+                    Buckets = rhs.Buckets;
+                    return (*this);
+                }
+                StageData& operator=(const Histogram& rhs)
+                {
+                    Count = rhs.Count();
+                    Minimum = rhs.Minimum();
+                    Maximum = rhs.Maximum();
+                    Average = rhs.Average();
+                    Buckets.Clear();
+                    for (uint8_t index = 0; index < Histogram::Buckets; index++) {
+                        Core::JSON::DecUInt32 entry;
+                        entry = rhs.Bucket(index);
+                        Buckets.Add(entry);
+                    }
+                    return (*this);
+                }
+
+            private:
+                void Init()
+                {
+                    Add(_T("count"), &Count);
+                    Add(_T("minimum"), &Minimum);
+                    Add(_T("maximum"), &Maximum);
+                    Add(_T("average"), &Average);
+                    Add(_T("buckets"), &Buckets);
+                }
+
+            public:
+                Core::JSON::DecUInt32 Count;
+                Core::JSON::DecUInt64 Minimum; // microseconds
+                Core::JSON::DecUInt64 Maximum; // microseconds
+                Core::JSON::DecUInt64 Average; // microseconds
+                Core::JSON::ArrayType<Core::JSON::DecUInt32> Buckets;
+            };
+
+        public:
+            LatencyData()
+                : Core::JSON::Container()
+            {
+                Init();
+            }
+            LatencyData(const LatencyData& copy)
+                : Core::JSON::Container()
+                , Producer(copy.Producer)
+                , Delivery(copy.Delivery)
+                , Dispatch(copy.Dispatch)
+                , Total(copy.Total)
+            {
+                Init();
+            }
+            ~LatencyData() override
+            {
+            }
+            LatencyData& operator=(const LatencyData& rhs)
+            {
+                Producer = rhs.Producer;
+                Delivery = rhs.Delivery;
+                Dispatch = rhs.Dispatch;
+                Total = rhs.Total;
+                return (*this);
+            }
+
+        private:
+            void Init()
+            {
+                Add(_T("producer"), &Producer);
+                Add(_T("delivery"), &Delivery);
+                Add(_T("dispatch"), &Dispatch);
+                Add(_T("total"), &Total);
+            }
+
+        public:
+            Core::JSON::String Producer;
+            StageData Delivery;
+            StageData Dispatch;
+            StageData Total;
+        };
+
     public:
         RemoteControl(const RemoteControl&) = delete;
         RemoteControl& operator=(const RemoteControl&) = delete;
@@ -376,6 +571,8 @@ namespace Plugin {
         uint32_t endpoint_unpair(const JsonData::RemoteControl::UnpairParamsData& params);
         uint32_t get_devices(Core::JSON::ArrayType<Core::JSON::String>& response) const;
         uint32_t get_device(const string& index, JsonData::RemoteControl::DeviceData& response) const;
+        uint32_t get_latency(Core::JSON::ArrayType<LatencyData>& response) const;
+        uint32_t endpoint_resetlatency();
         void event_keypressed(const string& id, const bool& pressed);
 
     private:
@@ -386,6 +583,8 @@ namespace Plugin {
         Feedback _feedback;
         Core::CriticalSection _eventLock;
         std::list<Exchange::IRemoteControl::INotification*> _notificationClients;
+        mutable Core::CriticalSection _latencyLock;
+        std::map<string, Latency> _latencies;
     };
 }
 }
@@ -46,10 +46,14 @@ namespace Plugin {
         Register<UnpairParamsData,void>(_T("unpair"), &RemoteControl::endpoint_unpair, this);
         Property<Core::JSON::ArrayType<Core::JSON::String>>(_T("devices"), &RemoteControl::get_devices, nullptr, this);
         Property<DeviceData>(_T("device"), &RemoteControl::get_device, nullptr, this);
+        Property<Core::JSON::ArrayType<LatencyData>>(_T("latency"), &RemoteControl::get_latency, nullptr, this);
+        Register<void,void>(_T("resetlatency"), &RemoteControl::endpoint_resetlatency, this);
     }
 
     void RemoteControl::UnregisterAll()
     {
+        Unregister(_T("resetlatency"));
+        Unregister(_T("latency"));
         Unregister(_T("unpair"));
         Unregister(_T("pair"));
         Unregister(_T("save"));
@@ -185,6 +189,35 @@ namespace Plugin {
        return result;
    }
 
+   uint32_t RemoteControl::get_latency(Core::JSON::ArrayType<LatencyData>& response) const
+   {
+       _latencyLock.Lock();
+
+       std::map<string, Latency>::const_iterator index(_latencies.begin());
+
+       while (index != _latencies.end()) {
+           LatencyData& entry(response.Add());
+           entry.Producer = index->first;
+           entry.Delivery = index->second.Delivery;
+           entry.Dispatch = index->second.Dispatch;
+           entry.Total = index->second.Total;
+           index++;
+       }
+
+       _latencyLock.Unlock();
+
+       return Core::ERROR_NONE;
+   }
+
+   uint32_t RemoteControl::endpoint_resetlatency()
+   {
+       _latencyLock.Lock();
+       _latencies.clear();
+       _latencyLock.Unlock();
+
+       return Core::ERROR_NONE;
+   }
+
     uint32_t RemoteControl::endpoint_key(const KeyobjInfo& params, KeyResultData& response)
     {
         uint32_t result = Core::ERROR_NONE;
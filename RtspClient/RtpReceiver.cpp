@@ -0,0 +1,518 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "Module.h"
+#include "RtpReceiver.h"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Interval between two RTCP receiver reports, in microseconds.
+    static constexpr uint64_t ReportInterval = 5 * 1000 * 1000;
+    // Time without any packet after which the jitter buffer gives up on the missing ones, in milliseconds.
+    static constexpr int IdleFlushTime = 100;
+    static constexpr uint8_t RtpHeaderSize = 12;
+    // Sequence number jumps beyond this are considered a restart of the stream (RFC 3550, A.1).
+    static constexpr int16_t MaxDropout = 3000;
+    static constexpr uint8_t RtcpSenderReport = 200;
+    static constexpr uint8_t RtcpReceiverReport = 201;
+
+    static inline uint16_t Read16(const uint8_t data[])
+    {
+        return ((data[0] << 8) | data[1]);
+    }
+    static inline uint32_t Read32(const uint8_t data[])
+    {
+        return ((data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3]);
+    }
+    static inline void Write32(uint8_t data[], const uint32_t value)
+    {
+        data[0] = (value >> 24) & 0xFF;
+        data[1] = (value >> 16) & 0xFF;
+        data[2] = (value >> 8) & 0xFF;
+        data[3] = value & 0xFF;
+    }
+
+    RtpReceiver::RtpReceiver(const uint32_t clockRate, const uint16_t reorderWindow)
+        : Core::Thread(Core::Thread::DefaultStackSize(), _T("RtpReceiver"))
+        , _adminLock()
+        , _clockRate(clockRate)
+        , _reorderWindow(std::min(reorderWindow, static_cast<uint16_t>(JitterSlots - 1)))
+        , _rtp(-1)
+        , _rtcp(-1)
+        , _port(0)
+        , _sender()
+        , _packets(new Packet[Buffers])
+        , _recycled()
+        , _free()
+        , _ready()
+        , _available(false, true)
+        , _localSsrc(static_cast<uint32_t>(Core::Time::Now().Ticks()))
+    {
+        _recycled.reserve(Buffers);
+        Reset();
+    }
+
+    RtpReceiver::~RtpReceiver()
+    {
+        Close();
+
+        delete[] _packets;
+    }
+
+    uint32_t RtpReceiver::Open(const uint16_t port)
+    {
+        uint32_t result = Core::ERROR_ALREADY_CONNECTED;
+
+        if (_rtp == -1) {
+            struct sockaddr_in address;
+            memset(&address, 0, sizeof(address));
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_ANY);
+
+            _rtp = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+            _rtcp = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+
+            // Bursts of a video stream easily exceed the default socket buffer.
+            int size = Buffers * BufferSize;
+            ::setsockopt(_rtp, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+            address.sin_port = htons(port);
+            bool bound = (::bind(_rtp, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0);
+            address.sin_port = htons(port + 1);
+            bound = bound && (::bind(_rtcp, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0);
+
+            if (bound == false) {
+                TRACE_L1("%s: Could not bind RTP/RTCP ports %d-%d, error: %d", __FUNCTION__, port, port + 1, errno);
+                Close();
+                result = Core::ERROR_OPENING_FAILED;
+            } else {
+                Reset();
+                _port = port;
+                Run();
+                result = Core::ERROR_NONE;
+            }
+        }
+
+        return (result);
+    }
+
+    void RtpReceiver::Close()
+    {
+        Block();
+        Wait(Core::Thread::INITIALIZED | Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+
+        if (_rtp != -1) {
+            ::close(_rtp);
+            _rtp = -1;
+        }
+        if (_rtcp != -1) {
+            ::close(_rtcp);
+            _rtcp = -1;
+        }
+        _port = 0;
+    }
+
+    void RtpReceiver::Reset()
+    {
+        // Only to be called while the receiving thread is not running.
+        uint16_t buffer;
+
+        while (_free.Pop(buffer) == true) {
+        }
+        _ready.Clear();
+        _recycled.clear();
+
+        for (uint16_t index = 0; index < Buffers; index++) {
+            _recycled.push_back(index);
+        }
+        for (uint16_t index = 0; index < JitterSlots; index++) {
+            _jitter[index] = EmptySlot;
+        }
+
+        memset(&_sender, 0, sizeof(_sender));
+        _synchronized = false;
+        _ssrc = 0;
+        _expected = 0;
+        _highest = 0;
+        _cycles = 0;
+        _baseSequence = 0;
+        _firstArrival = 0;
+        _lastTransit = 0;
+        _jitterEstimate = 0;
+        _lastSR = 0;
+        _lastSRArrival = 0;
+        _expectedPrior = 0;
+        _receivedPrior = 0;
+        _nextReport = 0;
+        memset(&_statistics, 0, sizeof(_statistics));
+        memset(&_published, 0, sizeof(_published));
+    }
+
+    bool RtpReceiver::Acquire(Payload& payload, const uint32_t waitTime)
+    {
+        uint16_t buffer;
+        bool result = _ready.Pop(buffer);
+
+        if ((result == false) && (_available.Lock(waitTime) == Core::ERROR_NONE)) {
+            result = _ready.Pop(buffer);
+        }
+
+        if (result == true) {
+            const Packet& packet(_packets[buffer]);
+
+            payload.Data = &(packet.Data[packet.Offset]);
+            payload.Length = packet.Length - packet.Offset;
+            payload.Sequence = Read16(&(packet.Data[2]));
+            payload.Timestamp = Read32(&(packet.Data[4]));
+            payload.Marker = ((packet.Data[1] & 0x80) != 0);
+            payload._buffer = buffer;
+        }
+
+        return (result);
+    }
+
+    void RtpReceiver::Release(Payload& payload)
+    {
+        ASSERT(payload._buffer < Buffers);
+
+        _free.Push(payload._buffer);
+        payload.Data = nullptr;
+        payload.Length = 0;
+        payload._buffer = ~0;
+    }
+
+    void RtpReceiver::Get(Statistics& statistics) const
+    {
+        _adminLock.Lock();
+        statistics = _published;
+        _adminLock.Unlock();
+    }
+
+    void RtpReceiver::Recycle(const uint16_t buffer)
+    {
+        _recycled.push_back(buffer);
+    }
+
+    /* virtual */ uint32_t RtpReceiver::Worker()
+    {
+        struct pollfd fds[2];
+
+        fds[0].fd = _rtp;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = _rtcp;
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+
+        int result = ::poll(fds, 2, IdleFlushTime);
+
+        if (result > 0) {
+            if ((fds[0].revents & POLLIN) != 0) {
+                Receive();
+            }
+            if ((fds[1].revents & POLLIN) != 0) {
+                Control();
+            }
+        } else if ((result == 0) && (_synchronized == true)) {
+            // Nothing came in for a while, do not hold back what we have waiting for missing packets.
+            Deliver(true);
+        }
+
+        uint64_t now = Core::Time::Now().Ticks();
+
+        if ((_synchronized == true) && (now >= _nextReport)) {
+            Report(now);
+            _nextReport = now + ReportInterval;
+        }
+
+        _adminLock.Lock();
+        _published = _statistics;
+        _published.Jitter = static_cast<uint32_t>((_jitterEstimate * 1000000) / _clockRate);
+        _adminLock.Unlock();
+
+        return (0);
+    }
+
+    void RtpReceiver::Receive()
+    {
+        struct mmsghdr messages[BatchSize];
+        struct iovec vectors[BatchSize];
+        uint16_t buffers[BatchSize];
+        uint8_t count = 0;
+        uint16_t buffer;
+
+        // Take back what the consumer is done with.
+        while (_free.Pop(buffer) == true) {
+            _recycled.push_back(buffer);
+        }
+
+        while ((count < BatchSize) && (_recycled.empty() == false)) {
+            buffers[count] = _recycled.back();
+            _recycled.pop_back();
+
+            vectors[count].iov_base = _packets[buffers[count]].Data;
+            vectors[count].iov_len = BufferSize;
+
+            memset(&messages[count], 0, sizeof(messages[count]));
+            messages[count].msg_hdr.msg_iov = &vectors[count];
+            messages[count].msg_hdr.msg_iovlen = 1;
+            count++;
+        }
+
+        // The first datagram also tells us where the stream comes from, RTCP reports go back there.
+        messages[0].msg_hdr.msg_name = &_sender;
+        messages[0].msg_hdr.msg_namelen = sizeof(_sender);
+
+        if (count == 0) {
+            // All buffers are in use, the consumer is not keeping up. Drop the datagram.
+            uint8_t scratch[BufferSize];
+
+            if (::recv(_rtp, scratch, sizeof(scratch), MSG_DONTWAIT) >= 0) {
+                _statistics.Overflows++;
+            }
+        } else {
+            int received = ::recvmmsg(_rtp, messages, count, MSG_DONTWAIT, nullptr);
+            uint64_t arrival = Core::Time::Now().Ticks();
+            uint8_t index = 0;
+
+            while (index < static_cast<uint8_t>(std::max(received, 0))) {
+                _packets[buffers[index]].Length = static_cast<uint16_t>(messages[index].msg_len);
+                Insert(buffers[index], arrival);
+                index++;
+            }
+            while (index < count) {
+                Recycle(buffers[index]);
+                index++;
+            }
+
+            Deliver(false);
+        }
+    }
+
+    void RtpReceiver::Insert(const uint16_t buffer, const uint64_t arrival)
+    {
+        Packet& packet(_packets[buffer]);
+        const uint8_t* data = packet.Data;
+        uint16_t offset = RtpHeaderSize + ((data[0] & 0x0F) * 4);
+
+        if ((packet.Length < RtpHeaderSize) || ((data[0] >> 6) != 2) || (offset > packet.Length)) {
+            Recycle(buffer);
+        } else {
+            if (((data[0] & 0x10) != 0) && ((offset + 4) <= packet.Length)) {
+                // Header extension
+                offset += 4 + (Read16(&data[offset + 2]) * 4);
+            }
+
+            uint16_t length = packet.Length;
+
+            if (((data[0] & 0x20) != 0) && (length > offset)) {
+                // Padding, the last byte holds the padding length
+                length -= std::min(static_cast<uint16_t>(data[length - 1]), static_cast<uint16_t>(length - offset));
+            }
+
+            if (offset > length) {
+                Recycle(buffer);
+            } else {
+                const uint16_t sequence = Read16(&data[2]);
+                const uint32_t timestamp = Read32(&data[4]);
+                const uint32_t ssrc = Read32(&data[8]);
+
+                packet.Offset = offset;
+                packet.Length = length;
+
+                if ((_synchronized == false) || (ssrc != _ssrc)) {
+                    if (_synchronized == true) {
+                        TRACE_L1("%s: Source changed from %08X to %08X", __FUNCTION__, _ssrc, ssrc);
+                        Deliver(true);
+                    }
+                    _synchronized = true;
+                    _ssrc = ssrc;
+                    _expected = sequence;
+                    _highest = sequence;
+                    _baseSequence = sequence;
+                    _cycles = 0;
+                    _expectedPrior = 0;
+                    _receivedPrior = 0;
+                    _jitterEstimate = 0;
+                    _firstArrival = arrival;
+                    _lastTransit = 0;
+                    _statistics.Received = 0;
+                }
+
+                int16_t delta = static_cast<int16_t>(sequence - _expected);
+
+                if ((delta >= MaxDropout) || (delta <= -MaxDropout)) {
+                    // A jump this big is a restart of the sequence, not a loss. Start over from here.
+                    TRACE_L1("%s: Sequence jumped from %d to %d", __FUNCTION__, _expected, sequence);
+                    Deliver(true);
+                    _expected = sequence;
+                    _highest = sequence;
+                    delta = 0;
+                }
+
+                if (delta < 0) {
+                    // Its slot has been delivered or given up already.
+                    _statistics.Late++;
+                    Recycle(buffer);
+                } else {
+                    if (delta >= static_cast<int16_t>(JitterSlots)) {
+                        // Too far ahead to fit, give up on the oldest missing packets to make room.
+                        while (static_cast<int16_t>(sequence - _expected) >= static_cast<int16_t>(JitterSlots)) {
+                            const uint16_t slot = _expected & (JitterSlots - 1);
+
+                            if (_jitter[slot] != EmptySlot) {
+                                if (_ready.Push(_jitter[slot]) == false) {
+                                    _statistics.Overflows++;
+                                    Recycle(_jitter[slot]);
+                                }
+                                _jitter[slot] = EmptySlot;
+                            } else {
+                                _statistics.Lost++;
+                            }
+                            _expected++;
+                        }
+                        _available.SetEvent();
+                    }
+
+                    const uint16_t slot = sequence & (JitterSlots - 1);
+
+                    if (_jitter[slot] != EmptySlot) {
+                        _statistics.Duplicates++;
+                        Recycle(buffer);
+                    } else {
+                        _jitter[slot] = buffer;
+                        _statistics.Received++;
+
+                        if (static_cast<int16_t>(sequence - _highest) > 0) {
+                            if (sequence < _highest) {
+                                _cycles += 0x10000;
+                            }
+                            _highest = sequence;
+                        } else if (sequence != _highest) {
+                            _statistics.Reordered++;
+                        }
+
+                        // RFC 3550, A.8: interarrival jitter, in timestamp units. The arrival is taken relative to the
+                        // first packet of the source, the absolute time in uS times the clock rate overflows 64 bits.
+                        uint32_t transit = static_cast<uint32_t>(((arrival - _firstArrival) * _clockRate) / 1000000) - timestamp;
+
+                        if (_statistics.Received > 1) {
+                            int32_t difference = static_cast<int32_t>(transit - _lastTransit);
+                            _jitterEstimate += ((std::abs(difference) - _jitterEstimate) / 16.0);
+                        }
+                        _lastTransit = transit;
+                    }
+                }
+            }
+        }
+    }
+
+    void RtpReceiver::Deliver(const bool flush)
+    {
+        bool delivered = false;
+
+        while (static_cast<int16_t>(_highest - _expected) >= 0) {
+            const uint16_t slot = _expected & (JitterSlots - 1);
+
+            if (_jitter[slot] != EmptySlot) {
+                if (_ready.Push(_jitter[slot]) == false) {
+                    _statistics.Overflows++;
+                    Recycle(_jitter[slot]);
+                }
+                _jitter[slot] = EmptySlot;
+                delivered = true;
+            } else if ((flush == true) || (static_cast<int16_t>(_highest - _expected) >= static_cast<int16_t>(_reorderWindow))) {
+                // Waited long enough for this one, it is lost.
+                _statistics.Lost++;
+            } else {
+                break;
+            }
+            _expected++;
+        }
+
+        if (delivered == true) {
+            _available.SetEvent();
+        }
+    }
+
+    void RtpReceiver::Control()
+    {
+        uint8_t data[BufferSize];
+        int length = ::recv(_rtcp, data, sizeof(data), MSG_DONTWAIT);
+        int offset = 0;
+
+        // Walk the compound packet, only the sender report is of interest to us.
+        while ((offset + 4) <= length) {
+            const uint8_t type = data[offset + 1];
+            const int size = (Read16(&data[offset + 2]) + 1) * 4;
+
+            if ((type == RtcpSenderReport) && ((offset + 16) <= length)) {
+                // The middle 32 bits of the NTP timestamp, echoed in our reports for round trip calculation.
+                _lastSR = Read32(&data[offset + 10]);
+                _lastSRArrival = Core::Time::Now().Ticks();
+            }
+
+            offset += size;
+        }
+    }
+
+    void RtpReceiver::Report(const uint64_t now)
+    {
+        // RFC 3550, 6.4.2: receiver report with a single report block.
+        uint8_t report[32];
+        const uint32_t extendedHighest = _cycles + _highest;
+        const uint32_t expected = extendedHighest - _baseSequence + 1;
+        const int32_t lost = static_cast<int32_t>(expected - _statistics.Received);
+        const uint32_t expectedInterval = expected - _expectedPrior;
+        const uint32_t receivedInterval = _statistics.Received - _receivedPrior;
+        const int32_t lostInterval = static_cast<int32_t>(expectedInterval - receivedInterval);
+        const uint8_t fraction = ((expectedInterval == 0) || (lostInterval <= 0) ? 0 : static_cast<uint8_t>((lostInterval << 8) / expectedInterval));
+        const int32_t cumulative = std::max(std::min(lost, 0x7FFFFF), -0x800000);
+
+        _expectedPrior = expected;
+        _receivedPrior = _statistics.Received;
+
+        report[0] = 0x81; // V=2, P=0, RC=1
+        report[1] = RtcpReceiverReport;
+        report[2] = 0;
+        report[3] = 7; // length in 32 bit words, minus one
+        Write32(&report[4], _localSsrc);
+        Write32(&report[8], _ssrc);
+        Write32(&report[12], (static_cast<uint32_t>(fraction) << 24) | (static_cast<uint32_t>(cumulative) & 0xFFFFFF));
+        Write32(&report[16], extendedHighest);
+        Write32(&report[20], static_cast<uint32_t>(_jitterEstimate));
+        Write32(&report[24], _lastSR);
+        // Delay since the last sender report, in units of 1/65536 seconds.
+        Write32(&report[28], (_lastSR == 0 ? 0 : static_cast<uint32_t>(((now - _lastSRArrival) * 65536) / 1000000)));
+
+        if (_sender.ss_family == AF_INET) {
+            struct sockaddr_in destination(*reinterpret_cast<struct sockaddr_in*>(&_sender));
+            destination.sin_port = htons(ntohs(destination.sin_port) + 1);
+
+            ::sendto(_rtcp, report, sizeof(report), MSG_DONTWAIT, reinterpret_cast<struct sockaddr*>(&destination), sizeof(destination));
+        }
+    }
+}
+} // WPEFramework::Plugin
@@ -0,0 +1,236 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RTPRECEIVER_H
+#define RTPRECEIVER_H
+
+#include <atomic>
+#include <vector>
+
+#include <sys/socket.h>
+
+#include <core/Sync.h>
+#include <core/Thread.h>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Single producer/single consumer ring of buffer indexes. Lock free, as long as exactly one thread
+    // pushes and exactly one thread pops.
+    template <const uint16_t CAPACITY>
+    class RtpIndexRing {
+    private:
+        static_assert((CAPACITY & (CAPACITY - 1)) == 0, "Ring capacity must be a power of 2");
+
+    public:
+        RtpIndexRing(const RtpIndexRing&) = delete;
+        RtpIndexRing& operator=(const RtpIndexRing&) = delete;
+
+        RtpIndexRing()
+            : _head(0)
+            , _tail(0)
+        {
+        }
+        ~RtpIndexRing()
+        {
+        }
+
+    public:
+        inline bool Push(const uint16_t value)
+        {
+            uint32_t head = _head.load(std::memory_order_relaxed);
+            bool result = ((head - _tail.load(std::memory_order_acquire)) < CAPACITY);
+
+            if (result == true) {
+                _slots[head & (CAPACITY - 1)] = value;
+                _head.store(head + 1, std::memory_order_release);
+            }
+            return (result);
+        }
+        inline bool Pop(uint16_t& value)
+        {
+            uint32_t tail = _tail.load(std::memory_order_relaxed);
+            bool result = (_head.load(std::memory_order_acquire) != tail);
+
+            if (result == true) {
+                value = _slots[tail & (CAPACITY - 1)];
+                _tail.store(tail + 1, std::memory_order_release);
+            }
+            return (result);
+        }
+        inline void Clear()
+        {
+            _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release);
+        }
+
+    private:
+        std::atomic<uint32_t> _head;
+        std::atomic<uint32_t> _tail;
+        uint16_t _slots[CAPACITY];
+    };
+
+    // Receives an RTP stream on a UDP port (and RTCP on the next port), puts the packets back in sequence
+    // through a fixed size jitter buffer and offers the payloads to a single consumer without copying them.
+    class RtpReceiver : public Core::Thread {
+    public:
+        // Number of packet buffers. Every buffer is either free, waiting in the jitter buffer or owned by the consumer.
+        static constexpr uint16_t Buffers = 1024;
+        // Size of a single packet buffer, enough for any non fragmented UDP datagram on ethernet.
+        static constexpr uint16_t BufferSize = 1536;
+        // Number of sequence numbers the jitter buffer can hold ahead of the next packet to deliver.
+        static constexpr uint16_t JitterSlots = 256;
+        // Maximum number of datagrams read with a single recvmmsg call.
+        static constexpr uint8_t BatchSize = 32;
+
+        struct Statistics {
+            uint32_t Received; // Valid RTP packets received
+            uint32_t Lost; // Packets never received (or too late to be used)
+            uint32_t Reordered; // Packets received out of order, but still in time
+            uint32_t Duplicates; // Packets received more than once
+            uint32_t Late; // Packets received after their slot was delivered or given up
+            uint32_t Overflows; // Packets dropped because the consumer did not keep up
+            uint32_t Jitter; // RFC 3550 interarrival jitter, in microseconds
+        };
+
+        // A payload handed to the consumer. It points directly into the packet buffer, which stays
+        // valid until it is given back through Release().
+        class Payload {
+        public:
+            Payload()
+                : Data(nullptr)
+                , Length(0)
+                , Timestamp(0)
+                , Sequence(0)
+                , Marker(false)
+                , _buffer(~0)
+            {
+            }
+            ~Payload()
+            {
+            }
+
+        public:
+            const uint8_t* Data;
+            uint16_t Length;
+            uint32_t Timestamp;
+            uint16_t Sequence;
+            bool Marker;
+
+        private:
+            friend class RtpReceiver;
+            uint16_t _buffer;
+        };
+
+    private:
+        class Packet {
+        public:
+            Packet()
+                : Length(0)
+                , Offset(0)
+            {
+            }
+            ~Packet()
+            {
+            }
+
+        public:
+            uint8_t Data[BufferSize];
+            uint16_t Length;
+            uint16_t Offset; // Start of the payload, after the RTP header
+        };
+
+        static constexpr int16_t EmptySlot = -1;
+
+    public:
+        RtpReceiver(const RtpReceiver&) = delete;
+        RtpReceiver& operator=(const RtpReceiver&) = delete;
+
+        RtpReceiver(const uint32_t clockRate = 90000, const uint16_t reorderWindow = 32);
+        ~RtpReceiver();
+
+    public:
+        // The RTP socket is bound to the given (even) port, RTCP to the port following it.
+        uint32_t Open(const uint16_t port);
+        void Close();
+        bool IsOpen() const
+        {
+            return (_rtp != -1);
+        }
+        uint16_t Port() const
+        {
+            return (_port);
+        }
+
+        // Consumer side, to be used by a single thread.
+        bool Acquire(Payload& payload, const uint32_t waitTime);
+        void Release(Payload& payload);
+
+        void Get(Statistics& statistics) const;
+
+    private:
+        virtual uint32_t Worker() override;
+
+        void Receive();
+        void Control();
+        void Insert(const uint16_t buffer, const uint64_t arrival);
+        void Deliver(const bool flush);
+        void Report(const uint64_t now);
+        void Recycle(const uint16_t buffer);
+        void Reset();
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        const uint32_t _clockRate;
+        const uint16_t _reorderWindow;
+        int _rtp;
+        int _rtcp;
+        uint16_t _port;
+        struct sockaddr_storage _sender;
+        Packet* _packets;
+        // Buffers owned by the receiving thread, and buffers given back by the consumer.
+        std::vector<uint16_t> _recycled;
+        RtpIndexRing<Buffers> _free;
+        RtpIndexRing<Buffers> _ready;
+        Core::Event _available;
+        int16_t _jitter[JitterSlots];
+
+        // Stream state, only touched by the receiving thread.
+        bool _synchronized;
+        uint32_t _ssrc;
+        uint32_t _localSsrc;
+        uint16_t _expected;
+        uint16_t _highest;
+        uint32_t _cycles;
+        uint16_t _baseSequence;
+        uint64_t _firstArrival; // Ticks, of the first packet of the source
+        uint32_t _lastTransit;
+        double _jitterEstimate;
+        uint32_t _lastSR;
+        uint64_t _lastSRArrival;
+        uint32_t _expectedPrior;
+        uint32_t _receivedPrior;
+        uint64_t _nextReport;
+        Statistics _statistics;
+        // Copy of the statistics, published once per batch, so the reader does not contend per packet.
+        Statistics _published;
+    };
+}
+} // WPEFramework::Plugin
+
+#endif
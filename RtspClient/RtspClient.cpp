@@ -89,8 +89,8 @@ namespace Plugin {
 
     /* virtual */ string RtspClient::Information() const
     {
-        // No additional info to report.
-        return (nullptr);
+        // Reception statistics of the built-in RTP receiver, if it is in use.
+        return (_implementation != nullptr ? _implementation->Get(_T("rtp")) : string());
     }
 
     /* virtual */ void RtspClient::Inbound(WPEFramework::Web::Request& request)
@@ -37,11 +37,15 @@ namespace Plugin {
             Config()
                 : Core::JSON::Container()
                 , TestNum(0)
+                , RtpPort(0)
+                , RtpSink()
             {
                 Add(_T("hostname"), &Hostname);
                 Add(_T("port"), &Port);
                 Add(_T("testNum"), &TestNum);
                 Add(_T("testStr"), &TestStr);
+                Add(_T("rtpport"), &RtpPort);
+                Add(_T("rtpsink"), &RtpSink);
             }
             ~Config()
             {
@@ -52,6 +56,39 @@ namespace Plugin {
             Core::JSON::DecUInt16 Port;
             Core::JSON::DecUInt16 TestNum;
             Core::JSON::String TestStr;
+            Core::JSON::DecUInt16 RtpPort;
+            Core::JSON::String RtpSink;
+        };
+
+        class RtpData : public Core::JSON::Container {
+        private:
+            RtpData(const RtpData&) = delete;
+            RtpData& operator=(const RtpData&) = delete;
+
+        public:
+            RtpData()
+                : Core::JSON::Container()
+            {
+                Add(_T("received"), &Received);
+                Add(_T("lost"), &Lost);
+                Add(_T("reordered"), &Reordered);
+                Add(_T("duplicates"), &Duplicates);
+                Add(_T("late"), &Late);
+                Add(_T("overflows"), &Overflows);
+                Add(_T("jitter"), &Jitter);
+            }
+            ~RtpData()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt32 Received;
+            Core::JSON::DecUInt32 Lost;
+            Core::JSON::DecUInt32 Reordered;
+            Core::JSON::DecUInt32 Duplicates;
+            Core::JSON::DecUInt32 Late;
+            Core::JSON::DecUInt32 Overflows;
+            Core::JSON::DecUInt32 Jitter; // in microseconds
         };
 
     private:
@@ -77,6 +114,8 @@ namespace Plugin {
 
             config.FromString(service->ConfigLine());
 
+            _rtspSession.ConfigureRtp(config.RtpPort.Value(), config.RtpSink.Value());
+
             return (result);
         }
 
@@ -120,7 +159,25 @@ namespace Plugin {
         string Get(const string& name) const
         {
             string value;
-            RtspReturnCode rc = _rtspSession.Get(name, value);
+
+            if (name == _T("rtp")) {
+                RtpReceiver::Statistics statistics;
+
+                if (_rtspSession.RtpStatistics(statistics) == true) {
+                    RtpData data;
+                    data.Received = statistics.Received;
+                    data.Lost = statistics.Lost;
+                    data.Reordered = statistics.Reordered;
+                    data.Duplicates = statistics.Duplicates;
+                    data.Late = statistics.Late;
+                    data.Overflows = statistics.Overflows;
+                    data.Jitter = statistics.Jitter;
+                    data.ToString(value);
+                }
+            } else {
+                _rtspSession.Get(name, value);
+            }
+
             return value;
         }
 
@@ -47,6 +47,16 @@ namespace Plugin {
             RTSP_UNKNOWN
         };
 
+        RtspMessage()
+            : message()
+            , bSRM(true)
+            , sequence(0)
+        {
+        }
+        virtual ~RtspMessage()
+        {
+        }
+
         virtual RtspMessage::Type getType()
         {
             return RTSP_UNKNOWN;
@@ -56,6 +66,7 @@ namespace Plugin {
         //RtspMessage::Type _type;
         string message;
         bool bSRM; // true: to/from SRM, false: to/from Pump
+        uint32_t sequence; // CSeq, used to match responses with their requests
     };
 
     typedef std::shared_ptr<RtspMessage> RtspMessagePtr;
@@ -80,9 +91,10 @@ namespace Plugin {
 
     class RtspResponse : public RtspMessage {
     public:
-        RtspResponse(uint16_t code)
+        RtspResponse(uint16_t code, uint32_t cseq)
             : _code(code)
         {
+            sequence = cseq;
         }
 
         ~RtspResponse()
@@ -93,10 +105,13 @@ namespace Plugin {
         {
             return RTSP_RESPONSE;
         }
+        uint16_t GetCode() const
+        {
+            return _code;
+        }
 
     private:
         uint16_t _code;
-        uint32_t _sequence;
     };
 
     class RtspAnnounce : public RtspMessage {
@@ -19,7 +19,7 @@
 
 #include <iomanip>
 #include <sstream>
-#include <vector>
+#include <strings.h>
 
 #include <tracing/Logging.h>
 
@@ -39,7 +39,7 @@ namespace Plugin {
         TRACE_L2("%s: %s:%d", __FUNCTION__, __FILE__, __LINE__);
     }
 
-    RtspMessagePtr RtspParser::BuildSetupRequest(const std::string& server, const std::string& assetId)
+    RtspMessagePtr RtspParser::BuildSetupRequest(const std::string& server, const std::string& assetId, const uint16_t rtpPort)
     {
         RtspMessagePtr request = RtspMessagePtr(new RtspRequst);
         std::stringstream ss;
@@ -50,9 +50,15 @@ namespace Plugin {
         ss << "StbId=943BB162A323&";
         ss << "CADeviceId=943BB162A323";
         ss << " RTSP/1.0" << RtspLineTerminator;
-        ss << "CSeq:" << ++_sequence << RtspLineTerminator;
+        request->sequence = ++_sequence;
+        ss << "CSeq:" << request->sequence << RtspLineTerminator;
         ss << "User-Agent: Metro" << RtspLineTerminator;
-        ss << "Transport: MP2T/DVBC/QAM;unicast;" << RtspLineTerminator;
+        if (rtpPort != 0) {
+            // Media is delivered over IP, received by ourselves.
+            ss << "Transport: RTP/AVP;unicast;client_port=" << rtpPort << "-" << (rtpPort + 1) << RtspLineTerminator;
+        } else {
+            ss << "Transport: MP2T/DVBC/QAM;unicast;" << RtspLineTerminator;
+        }
         ss << RtspLineTerminator;
 
         HexDump("SETUP", ss.str());
@@ -77,7 +83,8 @@ namespace Plugin {
             request->bSRM = false;
         }
         ss << cmd << " * RTSP/1.0" << RtspLineTerminator;
-        ss << "CSeq:" << ++_sequence << RtspLineTerminator;
+        request->sequence = ++_sequence;
+        ss << "CSeq:" << request->sequence << RtspLineTerminator;
         ss << "Session:" << sessionId << RtspLineTerminator;
         ss << "Range: npt=" << position << RtspLineTerminator;
         ss << "Scale: " << scale << RtspLineTerminator;
@@ -96,6 +103,8 @@ namespace Plugin {
         string strParams;
         string sessId;
 
+        request->bSRM = bSRM;
+
         if (bSRM) {
             sessId = _sessionInfo.sessionId;
         } else {
@@ -109,7 +118,8 @@ namespace Plugin {
 
         std::stringstream ss;
         ss << "GET_PARAMETER * RTSP/1.0" << RtspLineTerminator;
-        ss << "CSeq:" << ++_sequence << RtspLineTerminator;
+        request->sequence = ++_sequence;
+        ss << "CSeq:" << request->sequence << RtspLineTerminator;
         ss << "Session:" << sessId << RtspLineTerminator;
         ss << "Content-Type: text/parameters" << RtspLineTerminator;
         ss << "Content-Length: " << strParams.length() << RtspLineTerminator;
@@ -133,7 +143,8 @@ namespace Plugin {
         string strReason = "Cleint Intiated";
 
         ss << "TEARDOWN * RTSP/1.0" << RtspLineTerminator;
-        ss << "CSeq:" << ++_sequence << RtspLineTerminator;
+        request->sequence = ++_sequence;
+        ss << "CSeq:" << request->sequence << RtspLineTerminator;
         ss << "Session:" << _sessionInfo.sessionId << RtspLineTerminator;
         ss << "Reason:" << reason << " " << strReason << RtspLineTerminator;
         ss << RtspLineTerminator;
@@ -164,40 +175,126 @@ namespace Plugin {
         return request;
     }
 
+    RtspFields::RtspFields(const Core::TextFragment& text, const TCHAR terminator[], const TCHAR separator[])
+        : _fields()
+    {
+        const uint32_t terminatorLength = static_cast<uint32_t>(strlen(terminator));
+        const uint32_t separatorLength = static_cast<uint32_t>(strlen(separator));
+        const TCHAR* data = text.Data();
+        const uint32_t length = text.Length();
+        uint32_t start = 0;
+
+        while (start < length) {
+            uint32_t end = start;
+
+            while ((end < length) && (((length - end) < terminatorLength) || (strncmp(&data[end], terminator, terminatorLength) != 0))) {
+                end++;
+            }
+
+            if (end > start) {
+                uint32_t split = start;
+
+                while ((split < end) && (((end - split) < separatorLength) || (strncmp(&data[split], separator, separatorLength) != 0))) {
+                    split++;
+                }
+
+                if (split < end) {
+                    _fields.emplace_back(Core::TextFragment(&data[start], split - start),
+                        Core::TextFragment(&data[split + separatorLength], end - split - separatorLength));
+                } else {
+                    _fields.emplace_back(Core::TextFragment(&data[start], end - start), Core::TextFragment());
+                }
+            }
+
+            start = end + terminatorLength;
+        }
+    }
+
+    bool RtspFields::Has(const TCHAR name[]) const
+    {
+        const uint32_t length = static_cast<uint32_t>(strlen(name));
+        std::vector<Field>::const_iterator index(_fields.begin());
+
+        while ((index != _fields.end()) && ((index->first.Length() != length) || (strncasecmp(index->first.Data(), name, length) != 0))) {
+            index++;
+        }
+
+        return (index != _fields.end());
+    }
+
+    Core::TextFragment RtspFields::Value(const TCHAR name[]) const
+    {
+        const uint32_t length = static_cast<uint32_t>(strlen(name));
+        std::vector<Field>::const_iterator index(_fields.begin());
+
+        while ((index != _fields.end()) && ((index->first.Length() != length) || (strncasecmp(index->first.Data(), name, length) != 0))) {
+            index++;
+        }
+
+        return (index != _fields.end() ? index->second : Core::TextFragment());
+    }
+
+    /* static */ uint32_t RtspFields::Number(const Core::TextFragment& value)
+    {
+        uint32_t result = 0;
+        uint32_t index = 0;
+
+        while ((index < value.Length()) && (value.Data()[index] == ' ')) {
+            index++;
+        }
+        while ((index < value.Length()) && (isdigit(value.Data()[index]))) {
+            const uint32_t digit = (value.Data()[index] - '0');
+
+            // Saturate, a bogus value must not wrap around to a small one.
+            result = (result > ((static_cast<uint32_t>(~0) - digit) / 10) ? static_cast<uint32_t>(~0) : (result * 10) + digit);
+            index++;
+        }
+
+        return (result);
+    }
+
+    /* static */ float RtspFields::Float(const Core::TextFragment& value)
+    {
+        // The fragment is not terminated, strtof needs a terminated copy.
+        TCHAR buffer[32];
+        uint32_t length = std::min(value.Length(), static_cast<uint32_t>(sizeof(buffer) - 1));
+
+        memcpy(buffer, value.Data(), length);
+        buffer[length] = '\0';
+
+        return (strtof(buffer, nullptr));
+    }
+
     void RtspParser::ProcessSetupResponse(const std::string& response)
     {
-        NAMED_ARRAY setupMap; // entire response
-        NAMED_ARRAY params; // single line
-        Parse(response, setupMap, RtspLineTerminator, ": ");
-
-        string sess = setupMap["Session"];
-        TRACE_L2("%s: session id='%s'", __FUNCTION__, sess.c_str());
-        if (sess.find(";") == string::npos) {
-            _sessionInfo.sessionId = sess;
+        RtspFields setupMap(Core::TextFragment(response.c_str(), static_cast<uint32_t>(response.length())), RtspLineTerminator, ": "); // entire response
+
+        Core::TextFragment sess = setupMap.Value("Session");
+        TRACE_L2("%s: session id='%s'", __FUNCTION__, sess.Text().c_str());
+        if (sess.ForwardFind(';') == sess.Length()) {
+            _sessionInfo.sessionId = sess.Text();
             _sessionInfo.sessionTimeout = SEC2MS(_sessionInfo.defaultSessionTimeout);
             TRACE_L2("%s: using default sessionTimeout %d", __FUNCTION__, _sessionInfo.defaultSessionTimeout);
         } else { // contains heartbeat
-            Parse(sess, params, ";", "=");
-            NAMED_ARRAY::iterator it = params.begin();
-            _sessionInfo.sessionId = it->first;
+            RtspFields params(sess, ";", "=");
+            _sessionInfo.sessionId = params.Name(0).Text();
 
-            if (params.size() > 1)
-                _sessionInfo.sessionTimeout = SEC2MS(atoi(params["timeout"].c_str()));
+            if (params.Has("timeout"))
+                _sessionInfo.sessionTimeout = SEC2MS(RtspFields::Number(params.Value("timeout")));
         }
 
-        sess = setupMap["ControlSession"];
-        if (sess.size()) {
-            if (sess.find(";") == string::npos) {
-                _sessionInfo.ctrlSessionId = sess;
+        sess = setupMap.Value("ControlSession");
+        if (sess.Length()) {
+            if (sess.ForwardFind(';') == sess.Length()) {
+                _sessionInfo.ctrlSessionId = sess.Text();
                 _sessionInfo.ctrlSessionTimeout = SEC2MS(_sessionInfo.defaultCtrlSessionTimeout);
                 TRACE_L2("%s: using default ctrlSessionTimeout %d", __FUNCTION__, _sessionInfo.defaultCtrlSessionTimeout);
             } else {
-                Parse(sess, params, ";", "=");
-                NAMED_ARRAY::iterator it = params.begin();
-                _sessionInfo.ctrlSessionId = it->first;
+                RtspFields params(sess, ";", "=");
+                _sessionInfo.ctrlSessionId = params.Name(0).Text();
 
-                if (params.size() > 1)
-                    _sessionInfo.ctrlSessionTimeout = SEC2MS(atoi(params["timeout"].c_str()));
+                if (params.Has("timeout"))
+                    _sessionInfo.ctrlSessionTimeout = SEC2MS(RtspFields::Number(params.Value("timeout")));
             }
 
             if (_sessionInfo.sessionId.compare(_sessionInfo.ctrlSessionId) == 0) // XXX: check IP Addr ???
@@ -206,46 +303,36 @@ namespace Plugin {
                 _sessionInfo.bSrmIsRtspProxy = false;
         }
 
-        string location = setupMap["Location"];
-        string chan = setupMap["Tuning"];
-        Parse(chan, params, ";", "=");
-        _sessionInfo.frequency = atoi(params["frequency"].c_str()) * 100;
-        _sessionInfo.modulation = atoi(params["modulation"].c_str());
-        _sessionInfo.symbolRate = atoi(params["symbol_rate"].c_str());
+        RtspFields chan(setupMap.Value("Tuning"), ";", "=");
+        _sessionInfo.frequency = RtspFields::Number(chan.Value("frequency")) * 100;
+        _sessionInfo.modulation = RtspFields::Number(chan.Value("modulation"));
+        _sessionInfo.symbolRate = RtspFields::Number(chan.Value("symbol_rate"));
 
-        string tune = setupMap["Channel"];
-        Parse(tune, params, ";", "=");
-        _sessionInfo.programNum = atoi(params["Svcid"].c_str());
+        RtspFields tune(setupMap.Value("Channel"), ";", "=");
+        _sessionInfo.programNum = RtspFields::Number(tune.Value("Svcid"));
 
-        _sessionInfo.bookmark = atof(setupMap["Bookmark"].c_str());
-        _sessionInfo.duration = atoi(setupMap["Duration"].c_str());
+        _sessionInfo.bookmark = RtspFields::Float(setupMap.Value("Bookmark"));
+        _sessionInfo.duration = RtspFields::Number(setupMap.Value("Duration"));
 
         TRACE_L2("%s: f=%d p=%d m=%d s=%d bookmark=%f duration=%d",
             __FUNCTION__, _sessionInfo.frequency, _sessionInfo.programNum, _sessionInfo.modulation, _sessionInfo.symbolRate, _sessionInfo.bookmark, _sessionInfo.duration);
     }
 
-    void RtspParser::UpdateNPT(NAMED_ARRAY& playMap)
+    void RtspParser::UpdateNPT(const RtspFields& playMap)
     {
-        float nptStart = 0, nptEnd = 0;
+        float nptStart = 0;
         float oldScale = _sessionInfo.scale;
         float oldNPT = _sessionInfo.npt;
 
-        NAMED_ARRAY::iterator it = playMap.find("Scale");
-        if (it != playMap.end())
-            _sessionInfo.scale = atof(playMap["Scale"].c_str());
-
-        it = playMap.find("Range");
-        if (it != playMap.end()) {
-            string range = playMap["Range"];
-            size_t posEq = range.find('=');
-            size_t posHyphen = range.find('-');
-            if (posEq != string::npos) {
-                if (posHyphen != string::npos) {
-                    nptStart = atof(range.substr(posEq + 1, posHyphen - 1).c_str());
-                    nptEnd = atoi(range.substr(posHyphen + 1).c_str());
-                } else {
-                    nptStart = atof(range.substr(posEq + 1).c_str());
-                }
+        if (playMap.Has("Scale"))
+            _sessionInfo.scale = RtspFields::Float(playMap.Value("Scale"));
+
+        if (playMap.Has("Range")) {
+            // Range: npt=<start>-[<end>]
+            Core::TextFragment range = playMap.Value("Range");
+            uint32_t posEq = range.ForwardFind('=');
+            if (posEq < range.Length()) {
+                nptStart = RtspFields::Float(Core::TextFragment(range, posEq + 1, range.Length() - posEq - 1));
             }
 
             _sessionInfo.npt = SEC2MS(nptStart);
@@ -255,64 +342,79 @@ namespace Plugin {
 
     void RtspParser::ProcessPlayResponse(const std::string& response)
     {
-        NAMED_ARRAY playMap;
-        Parse(response, playMap, RtspLineTerminator, ": ");
+        RtspFields playMap(Core::TextFragment(response.c_str(), static_cast<uint32_t>(response.length())), RtspLineTerminator, ": ");
         UpdateNPT(playMap);
     }
 
     void RtspParser::ProcessGetParamResponse(const std::string& response)
     {
-        NAMED_ARRAY playMap;
-        Parse(response, playMap, RtspLineTerminator, ": ");
+        RtspFields playMap(Core::TextFragment(response.c_str(), static_cast<uint32_t>(response.length())), RtspLineTerminator, ": ");
         UpdateNPT(playMap);
     }
 
     void RtspParser::ProcessTeardownResponse(const std::string& response)
     {
-        NAMED_ARRAY playMap;
-        Parse(response, playMap, RtspLineTerminator, ": ");
+        RtspFields playMap(Core::TextFragment(response.c_str(), static_cast<uint32_t>(response.length())), RtspLineTerminator, ": ");
+        TRACE_L2("%s: %d fields", __FUNCTION__, playMap.Count());
     }
 
-    void RtspParser::Parse(const std::string& str, NAMED_ARRAY& contents, const string& sep1, const string& sep2)
+    /* static */ uint32_t RtspParser::FrameSize(const uint8_t data[], const uint32_t length)
     {
-        TRACE_L4("%s: size=%d input='%s'", __FUNCTION__, str.size(), str.c_str());
-        contents.clear();
-
-        bool done = false;
-        size_t pos = 0;
-        size_t start = 0;
-        while (!done) {
-            pos = str.find(sep1, start);
-
-            //TRACE_L2("%s: pos=%u start=%u size=%u", __FUNCTION__, pos, start, str.size());
-            if ((pos == string::npos) || (pos >= str.size()))
-                done = true;
-
-            string sub = str.substr(start, pos - start);
-            size_t pos2 = sub.find(sep2);
-            if (pos2 == string::npos) {
-                string left = sub.substr(0, pos2);
-                contents[left] = "";
-            } else {
-                string left = sub.substr(0, pos2);
-                string right = sub.substr(pos2 + sep2.size());
-                TRACE_L4("%s:     left=%s right=%s pos=%u", __FUNCTION__, left.c_str(), right.c_str(), pos2);
-                contents[left] = right;
+        uint32_t result = 0;
+
+        if ((length > 0) && (data[0] == '$')) {
+            // Interleaved binary data: '$' <channel> <16 bit length> <data>
+            if (length >= 4) {
+                uint32_t size = 4 + ((data[2] << 8) | data[3]);
+                result = (size <= length ? size : 0);
             }
+        } else {
+            const char* text = reinterpret_cast<const char*>(data);
+            uint32_t headerEnd = 0;
 
-            start = pos + sep1.size();
-            if (start >= str.size())
-                done = true;
+            while (((headerEnd + 4) <= length) && (memcmp(&text[headerEnd], "\r\n\r\n", 4) != 0)) {
+                headerEnd++;
+            }
+
+            if ((headerEnd + 4) <= length) {
+                // The header is complete, see if it announces a body and if all of it is there.
+                RtspFields headers(Core::TextFragment(text, headerEnd), RtspLineTerminator, ":");
+                // Number() saturates and the sum is taken in 64 bits, so a bogus Content-Length can not end up as a
+                // frame within the data. Such a message never completes, Frames() drops it once it overflows.
+                uint64_t size = static_cast<uint64_t>(headerEnd) + 4 + RtspFields::Number(headers.Value("Content-Length"));
+
+                result = (size <= length ? static_cast<uint32_t>(size) : 0);
+            }
+        }
+
+        return (result);
+    }
+
+    /* static */ bool RtspParser::Frames(string& buffer, std::vector<string>& frames)
+    {
+        bool result = true;
+        uint32_t offset = 0;
+        uint32_t size;
+
+        // TCP does not preserve message boundaries, a read may hold several messages, or only part of one.
+        while ((size = FrameSize(reinterpret_cast<const uint8_t*>(&buffer[offset]), static_cast<uint32_t>(buffer.length() - offset))) != 0) {
+            frames.push_back(buffer.substr(offset, size));
+            offset += size;
+        }
+
+        buffer.erase(0, offset);
+
+        if (buffer.length() > MaxMessageSize) {
+            TRACE_L1("%s: No message boundary found in %d bytes, dropping them", __FUNCTION__, static_cast<uint32_t>(buffer.length()));
+            buffer.clear();
+            result = false;
         }
 
-        TRACE_L4("%s: contents.size=%d", __FUNCTION__, contents.size());
-        for (NAMED_ARRAY::iterator it = contents.begin(); it != contents.end(); ++it)
-            TRACE_L4("%s: %s => '%s'", __FUNCTION__, it->first.c_str(), it->second.c_str());
+        return (result);
     }
 
-    RtspMessagePtr RtspParser::ParseResponse(const std::string str)
+    RtspMessagePtr RtspParser::ParseResponse(const std::string& str)
     {
-        int rtspCode = 0;
         RtspMessagePtr response;
 
         HexDump("Response: ", str);
@@ -323,26 +425,19 @@ namespace Plugin {
         // -------------------------------------------------------------------------
         size_t pos = str.find(RtspLineTerminator);
         if (pos != std::string::npos) {
-            string header = str.substr(0, pos);
-            std::vector<string> tokens;
-            Split(header, " ", tokens);
-            //TRACE_L2( "%s: header.length=%d tokens.size=%d", __FUNCTION__, header.length(), tokens.size());
-            //for (int i = 0; i < tokens.size(); i++)
-            //    TRACE_L2( "%s: %d. '%s'", __FUNCTION__, i, tokens.at(i).c_str());
+            RtspFields tokens(Core::TextFragment(str.c_str(), static_cast<uint32_t>(pos)), " ", "\n");
 
             // Parse rest, only if the header is valid
-            if (tokens.size() >= 3) {
-                string first = tokens.at(0);
-                string rtspBody = str.substr(pos + 2); // +2 CRLR
-
-                if (first.compare("ANNOUNCE") == 0) {
-                    response = ParseAnnouncement(rtspBody, 0);
-                } else if (first.compare(0, 5, "RTSP/") == 0) {
-                    rtspCode = std::stoi(tokens.at(1));
-                    response = RtspMessagePtr(new RtspResponse(rtspCode));
-                    response->message = rtspBody;
+            if (tokens.Count() >= 3) {
+                const Core::TextFragment& first = tokens.Name(0);
+
+                if ((first.Length() == 8) && (strncmp(first.Data(), "ANNOUNCE", 8) == 0)) {
+                    response = ParseAnnouncement(str.substr(pos + 2), 0); // +2 CRLF
+                } else if ((first.Length() >= 5) && (strncmp(first.Data(), "RTSP/", 5) == 0)) {
+                    RtspFields headers(Core::TextFragment(&(str.c_str()[pos + 2]), static_cast<uint32_t>(str.length() - pos - 2)), RtspLineTerminator, ":");
+                    response = RtspMessagePtr(new RtspResponse(RtspFields::Number(tokens.Name(1)), RtspFields::Number(headers.Value("CSeq"))));
+                    response->message = str.substr(pos + 2); // +2 CRLF
                 }
-                //Parse(tokenStr, contents, ":", RtspLineTerminator);
             }
         }
 
@@ -359,25 +454,21 @@ namespace Plugin {
     */
         int code = 0;
         string reason;
-        NAMED_ARRAY announceMap;
-        Parse(response, announceMap, RtspLineTerminator, ": ");
-        if (announceMap.size()) {
-            int respSeq = atoi(announceMap["CSeq"].c_str());
+        RtspFields announceMap(Core::TextFragment(response.c_str(), static_cast<uint32_t>(response.length())), RtspLineTerminator, ": ");
+        if (announceMap.Count()) {
+            int respSeq = RtspFields::Number(announceMap.Value("CSeq"));
             TRACE_L2("%s: respSeq=%d", __FUNCTION__, respSeq);
 
-            string notice = announceMap["Notice"];
-            size_t pos = notice.find(' ');
-            if (pos != string::npos) {
-                size_t pos2;
+            Core::TextFragment notice = announceMap.Value("Notice");
+            uint32_t pos = notice.ForwardFind(' ');
+            if (pos < notice.Length()) {
+                code = RtspFields::Number(notice);
 
-                string strCode = notice.substr(0, pos);
-                code = atoi(strCode.c_str());
-
-                pos = notice.find('"');
-                if (pos != string::npos) {
-                    pos2 = notice.find('"', pos + 1);
-                    if (pos2 != string::npos) {
-                        reason = notice.substr(pos + 1, pos2 - pos);
+                pos = notice.ForwardFind('"');
+                if (pos < notice.Length()) {
+                    uint32_t pos2 = notice.ForwardFind('"', pos + 1);
+                    if (pos2 < notice.Length()) {
+                        reason = Core::TextFragment(notice, pos + 1, pos2 - pos - 1).Text();
                     }
                 }
             }
@@ -388,22 +479,6 @@ namespace Plugin {
         return RtspMessagePtr(new RtspAnnounce(code, reason));
     }
 
-    int RtspParser::Split(const string& str, const string& delim, std::vector<string>& tokens)
-    {
-        size_t prev = 0, pos = 0;
-        do {
-            pos = str.find(delim, prev);
-            if (pos == string::npos)
-                pos = str.length();
-            string token = str.substr(prev, pos - prev);
-            if (!token.empty())
-                tokens.push_back(token);
-            prev = pos + delim.length();
-        } while (pos < str.length() && prev < str.length());
-
-        return tokens.size();
-    }
-
     void RtspParser::HexDump(const char* label, const std::string& msg, uint16_t charsPerLine)
     {
         std::stringstream ssHex, ss;
@@ -20,8 +20,10 @@
 #ifndef RTSPPARSER_H
 #define RTSPPARSER_H
 
-#include <map>
 #include <string>
+#include <vector>
+
+#include <core/TextFragment.h>
 
 #include "RtspCommon.h"
 #include "RtspSessionInfo.h"
@@ -29,12 +31,49 @@
 namespace WPEFramework {
 namespace Plugin {
 
-    typedef std::map<std::string, std::string> NAMED_ARRAY;
+    // Zero copy view on "name<separator>value<terminator>..." formatted text, e.g. the header lines of an
+    // RTSP message or the parameters of a header value. All fragments point into the parsed text, so that
+    // text must outlive the RtspFields instance.
+    class RtspFields {
+    private:
+        using Field = std::pair<Core::TextFragment, Core::TextFragment>;
+
+    public:
+        RtspFields() = delete;
+        RtspFields(const RtspFields&) = delete;
+        RtspFields& operator=(const RtspFields&) = delete;
+
+        RtspFields(const Core::TextFragment& text, const TCHAR terminator[], const TCHAR separator[]);
+        ~RtspFields()
+        {
+        }
+
+    public:
+        inline uint32_t Count() const
+        {
+            return (static_cast<uint32_t>(_fields.size()));
+        }
+        inline const Core::TextFragment& Name(const uint32_t index) const
+        {
+            ASSERT(index < _fields.size());
+            return (_fields[index].first);
+        }
+        bool Has(const TCHAR name[]) const;
+        // Names are matched case insensitive, as required for RTSP headers. Returns an empty fragment
+        // if the field is not present.
+        Core::TextFragment Value(const TCHAR name[]) const;
+
+        static uint32_t Number(const Core::TextFragment& value);
+        static float Float(const Core::TextFragment& value);
+
+    private:
+        std::vector<Field> _fields;
+    };
 
     class RtspParser {
     public:
         RtspParser(RtspSessionInfo& sessionInfo);
-        RtspMessagePtr BuildSetupRequest(const std::string& server, const std::string& assetId);
+        RtspMessagePtr BuildSetupRequest(const std::string& server, const std::string& assetId, const uint16_t rtpPort = 0);
         RtspMessagePtr BuildPlayRequest(float scale = 1.0, uint32_t position = 0);
         RtspMessagePtr BuildGetParamRequest(bool bSRM);
         RtspMessagePtr BuildTeardownRequest(int reason);
@@ -45,15 +84,22 @@ namespace Plugin {
         void ProcessGetParamResponse(const std::string& response);
         void ProcessTeardownResponse(const std::string& response);
 
-        void Parse(const std::string& str, NAMED_ARRAY& contents, const string& sep1, const string& sep2);
-        RtspMessagePtr ParseResponse(const std::string str);
+        RtspMessagePtr ParseResponse(const std::string& str);
         RtspMessagePtr ParseAnnouncement(const std::string& response, bool bSRM);
 
+        // Determines the size of the first complete message (RTSP message including its body, or an
+        // interleaved '$' data frame) at the start of the given data. Returns 0 if more data is needed.
+        static uint32_t FrameSize(const uint8_t data[], const uint32_t length);
+        // Takes all complete messages off the front of the buffer. What remains can only be the start of a
+        // message, if it is larger than any message may be, it is dropped and false is returned.
+        static bool Frames(string& buffer, std::vector<string>& frames);
+
+        static constexpr uint32_t MaxMessageSize = 64 * 1024;
+
         static void HexDump(const char* label, const std::string& msg, uint16_t charsPerLine = 32);
 
     private:
-        void UpdateNPT(NAMED_ARRAY& playMap);
-        int Split(const string& str, const string& delim, std::vector<string>& tokens);
+        void UpdateNPT(const RtspFields& playMap);
 
     public:
         RtspSessionInfo& _sessionInfo;
@@ -17,7 +17,9 @@
  * limitations under the License.
  */
 
+#include <fcntl.h>
 #include <netdb.h>
+#include <unistd.h>
 
 #include "Module.h"
 #include "RtspSession.h"
@@ -30,8 +32,12 @@ namespace Plugin {
         , _srmSocket(nullptr)
         , _controlSocket(nullptr)
         , _parser(_sessionInfo)
+        , _rtpReceiver()
+        , _rtpSink(_rtpReceiver)
+        , _rtpPort(0)
+        , _rtpSinkPath()
         , _requestQueue(64)
-        , _responseQueue(64)
+        , _transactions()
         , _heartbeatTimer(Core::Thread::DefaultStackSize(), _T("RtspHeartbeatTimer"))
         , _isSessionActive(false)
         , _nextSRMHeartbeatMS(0)
@@ -42,6 +48,20 @@ namespace Plugin {
 
     RtspSession::~RtspSession()
     {
+        _rtpSink.Stop();
+        _rtpReceiver.Close();
+    }
+
+    void RtspSession::ConfigureRtp(const uint16_t port, const string& sink)
+    {
+        _rtpPort = port;
+        _rtpSinkPath = sink;
+    }
+
+    bool RtspSession::RtpStatistics(RtpReceiver::Statistics& statistics) const
+    {
+        _rtpReceiver.Get(statistics);
+        return (_rtpPort != 0);
     }
 
     RtspReturnCode RtspSession::Initialize(const string& hostname, uint16_t port)
@@ -98,6 +118,33 @@ namespace Plugin {
         return ERR_OK; // Handle return value
     }
 
+    RtspReturnCode RtspSession::Send(Transaction& transaction)
+    {
+        // Register before sending, the response might be in before Send returns.
+        _adminLock.Lock();
+        ASSERT(_transactions.find(transaction.Sequence()) == _transactions.end());
+        _transactions.emplace(transaction.Sequence(), &transaction);
+        _adminLock.Unlock();
+
+        return Send(transaction.Request());
+    }
+
+    RtspReturnCode RtspSession::Wait(Transaction& transaction)
+    {
+        RtspReturnCode rc = ERR_OK;
+
+        if (transaction.Wait(ResponseWaitTime) == false) {
+            TRACE_L1("%s: Failed to get Response for CSeq %d", __FUNCTION__, transaction.Sequence());
+            rc = ERR_TIMED_OUT;
+        }
+
+        _adminLock.Lock();
+        _transactions.erase(transaction.Sequence());
+        _adminLock.Unlock();
+
+        return rc;
+    }
+
     uint64_t RtspSession::Timed(const uint64_t scheduledTime)
     {
         if (_isSessionActive) {
@@ -117,23 +164,26 @@ namespace Plugin {
     RtspReturnCode RtspSession::Open(const string assetId, uint32_t position, const string& reqCpeId, const string& remoteIp)
     {
         RtspReturnCode rc = ERR_OK;
-        RtspMessagePtr response;
 
         if (!_isSessionActive) {
             _sessionInfo.reset();
-            // new session, flush any remaining message in the queue
-            while (!_responseQueue.IsEmpty()) {
-                TRACE_L1("%s: Removing old message", __FUNCTION__);
-                _responseQueue.Extract(response, 0);
+
+            if (_rtpPort != 0) {
+                // The receiver must be listening before the server starts streaming.
+                _rtpSink.Stop();
+                _rtpReceiver.Close();
+                if (_rtpReceiver.Open(_rtpPort) == Core::ERROR_NONE) {
+                    _rtpSink.Start(_rtpSinkPath);
+                }
             }
 
             _isSessionActive = true;
-            RtspMessagePtr request = _parser.BuildSetupRequest(_sessionInfo.srm.name, assetId);
-            Send(request);
+            Transaction setup(_parser.BuildSetupRequest(_sessionInfo.srm.name, assetId, _rtpReceiver.Port()));
+            Send(setup);
 
-            if (_responseQueue.Extract(response, ResponseWaitTime)) {
+            if (Wait(setup) == ERR_OK) {
                 _adminLock.Lock();
-                _parser.ProcessSetupResponse(response->message);
+                _parser.ProcessSetupResponse(setup.Response()->message);
 
                 Core::Time NextTick = Core::Time::Now();
                 NextTick.Add(NptUpdateInterwal);
@@ -152,7 +202,6 @@ namespace Plugin {
                 }
                 _adminLock.Unlock();
             } else {
-                TRACE_L1("%s: Failed to get Response", __FUNCTION__);
                 rc = ERR_TIMED_OUT;
             }
 
@@ -174,19 +223,19 @@ namespace Plugin {
     {
         RtspReturnCode rc = ERR_OK;
         int reason = 0;
-        RtspMessagePtr response;
 
         if (_isSessionActive) {
-            RtspMessagePtr request = _parser.BuildTeardownRequest(reason);
-            Send(request);
-            if (_responseQueue.Extract(response, ResponseWaitTime)) {
-                _parser.ProcessTeardownResponse(response->message);
-            } else {
-                TRACE_L1("%s: Failed to get Response", __FUNCTION__);
-                rc = ERR_TIMED_OUT;
+            Transaction teardown(_parser.BuildTeardownRequest(reason));
+            Send(teardown);
+            rc = Wait(teardown);
+            if (rc == ERR_OK) {
+                _parser.ProcessTeardownResponse(teardown.Response()->message);
             }
 
             _isSessionActive = false;
+
+            _rtpSink.Stop();
+            _rtpReceiver.Close();
         } else {
             rc = ERR_NO_ACTIVE_SESSION;
         }
@@ -201,15 +250,11 @@ namespace Plugin {
         if (_isSessionActive) {
             TRACE_L2("%s: scale=%f offset=%d", __FUNCTION__, scale, position);
 
-            RtspMessagePtr response;
-
-            RtspMessagePtr request = _parser.BuildPlayRequest(scale, position);
-            Send(request);
-            if (_responseQueue.Extract(response, ResponseWaitTime)) {
-                _parser.ProcessPlayResponse(response->message);
-            } else {
-                TRACE_L1("%s: Failed to get Response", __FUNCTION__);
-                rc = ERR_TIMED_OUT;
+            Transaction play(_parser.BuildPlayRequest(scale, position));
+            Send(play);
+            rc = Wait(play);
+            if (rc == ERR_OK) {
+                _parser.ProcessPlayResponse(play.Response()->message);
             }
         } else {
             rc = ERR_NO_ACTIVE_SESSION;
@@ -248,7 +293,14 @@ namespace Plugin {
                 }
                 _announcementHandler.announce(announcement);
             } else if (dynamic_cast<RtspResponse*>(response.get()) != nullptr) {
-                _responseQueue.Post(response);
+                _adminLock.Lock();
+                std::map<uint32_t, Transaction*>::iterator index(_transactions.find(response->sequence));
+                if (index != _transactions.end()) {
+                    index->second->Completed(response);
+                } else {
+                    TRACE_L1("%s: Response for unknown CSeq %d dropped", __FUNCTION__, response->sequence);
+                }
+                _adminLock.Unlock();
             } else {
                 TRACE_L1("%s: UNKNOWN response '%s'", __FUNCTION__, responseStr.c_str());
             }
@@ -256,6 +308,25 @@ namespace Plugin {
         return rc;
     }
 
+    RtspReturnCode RtspSession::ProcessFrames(string& buffer, bool bSRM)
+    {
+        RtspReturnCode rc = ERR_OK;
+        std::vector<string> frames;
+
+        if (RtspParser::Frames(buffer, frames) == false) {
+            rc = ERR_UNKNOWN;
+        }
+
+        for (const string& frame : frames) {
+            // Interleaved data is not handled here.
+            if (frame[0] != '$') {
+                ProcessResponse(frame, bSRM);
+            }
+        }
+
+        return rc;
+    }
+
     RtspReturnCode RtspSession::SendResponse(int respSeq, bool bSRM)
     {
         RtspReturnCode rc = ERR_OK;
@@ -270,16 +341,12 @@ namespace Plugin {
     RtspReturnCode RtspSession::SendHeartbeat(bool bSRM)
     {
         RtspReturnCode rc = ERR_OK;
-        RtspMessagePtr response;
-
-        RtspMessagePtr request = _parser.BuildGetParamRequest(bSRM);
-        Send(request);
 
-        if (_responseQueue.Extract(response, ResponseWaitTime)) {
-            _parser.ProcessGetParamResponse(response->message);
-        } else {
-            TRACE_L1("%s: Failed to get Response", __FUNCTION__);
-            rc = ERR_TIMED_OUT;
+        Transaction heartbeat(_parser.BuildGetParamRequest(bSRM));
+        Send(heartbeat);
+        rc = Wait(heartbeat);
+        if (rc == ERR_OK) {
+            _parser.ProcessGetParamResponse(heartbeat.Response()->message);
         }
 
         return rc;
@@ -290,12 +357,15 @@ namespace Plugin {
         RtspReturnCode rc = ERR_OK;
         int sessionTimeoutMS = _sessionInfo.sessionTimeout;
         int ctrlSessionTimeoutMS = _sessionInfo.ctrlSessionTimeout;
+        Core::ProxyType<Transaction> srm;
+        Core::ProxyType<Transaction> pump;
 
         // SRM Heartbeat
         if (!_sessionInfo.sessionId.empty() && sessionTimeoutMS > 0) {
             _nextSRMHeartbeatMS -= NptUpdateInterwal;
             if (_nextSRMHeartbeatMS <= 0) {
-                rc = SendHeartbeat(true);
+                srm = Core::ProxyType<Transaction>::Create(_parser.BuildGetParamRequest(true));
+                Send(*srm);
                 _nextSRMHeartbeatMS = sessionTimeoutMS;
             }
         }
@@ -304,17 +374,92 @@ namespace Plugin {
         if (!_sessionInfo.ctrlSessionId.empty() && ctrlSessionTimeoutMS > 0) {
             _nextPumpHeartbeatMS -= NptUpdateInterwal;
             if (_nextPumpHeartbeatMS <= 0) {
-                rc = SendHeartbeat(false);
+                pump = Core::ProxyType<Transaction>::Create(_parser.BuildGetParamRequest(false));
+                Send(*pump);
                 _nextPumpHeartbeatMS = ctrlSessionTimeoutMS;
             }
         }
 
+        // Both heartbeats are in flight now, collect the responses.
+        if (srm.IsValid() == true) {
+            rc = Wait(*srm);
+            if (rc == ERR_OK) {
+                _parser.ProcessGetParamResponse(srm->Response()->message);
+            }
+        }
+        if (pump.IsValid() == true) {
+            rc = Wait(*pump);
+            if (rc == ERR_OK) {
+                _parser.ProcessGetParamResponse(pump->Response()->message);
+            }
+        }
+
         return rc;
     }
 
+    RtspSession::RtpSink::RtpSink(RtpReceiver& receiver)
+        : Core::Thread(Core::Thread::DefaultStackSize(), _T("RtpSink"))
+        , _receiver(receiver)
+        , _descriptor(-1)
+    {
+    }
+
+    RtspSession::RtpSink::~RtpSink()
+    {
+        Stop();
+    }
+
+    bool RtspSession::RtpSink::Start(const string& path)
+    {
+        ASSERT(_descriptor == -1);
+
+        if (path.empty() == false) {
+            _descriptor = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+            if (_descriptor == -1) {
+                TRACE_L1("%s: Could not open RTP sink %s, error: %d", __FUNCTION__, path.c_str(), errno);
+            } else {
+                Run();
+            }
+        }
+
+        return (_descriptor != -1);
+    }
+
+    void RtspSession::RtpSink::Stop()
+    {
+        Block();
+        Wait(Core::Thread::INITIALIZED | Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+
+        if (_descriptor != -1) {
+            ::close(_descriptor);
+            _descriptor = -1;
+        }
+    }
+
+    /* virtual */ uint32_t RtspSession::RtpSink::Worker()
+    {
+        RtpReceiver::Payload payload;
+
+        while ((IsRunning() == true) && (_receiver.Acquire(payload, 100) == true)) {
+            // The payload points into the receive buffer, it is written out without an intermediate copy.
+            const ssize_t written = ::write(_descriptor, payload.Data, payload.Length);
+
+            if (written < 0) {
+                TRACE_L1("%s: Could not write to RTP sink, error: %d", __FUNCTION__, errno);
+            } else if (static_cast<size_t>(written) != payload.Length) {
+                TRACE_L1("%s: Short write to RTP sink, %d of %d bytes", __FUNCTION__, static_cast<int>(written), static_cast<int>(payload.Length));
+            }
+            _receiver.Release(payload);
+        }
+
+        return (0);
+    }
+
     RtspSession::Socket::Socket(const Core::NodeId& local, const Core::NodeId& remote, RtspSession& rtspSession)
         : Core::SocketStream(false, local, remote, 4096, 4096)
         , _rtspSession(rtspSession)
+        , _partial()
     {
         Open(1000, "");
     };
@@ -343,9 +488,9 @@ namespace Plugin {
     uint16_t RtspSession::Socket::ReceiveData(uint8_t* dataFrame, const uint16_t receivedSize)
     {
         TRACE(Trace::Information, ("%s: receivedSize=%d", __FUNCTION__, receivedSize));
-        string response((char*)dataFrame, receivedSize);
         bool bSRM = (_rtspSession._srmSocket == this);
-        _rtspSession.ProcessResponse(response, bSRM);
+        _partial.append(reinterpret_cast<const char*>(dataFrame), receivedSize);
+        _rtspSession.ProcessFrames(_partial, bSRM);
         return receivedSize;
     }
 
@@ -24,11 +24,14 @@
 #include <sys/socket.h>
 #include <sys/un.h>
 
+#include <map>
+
 #include <core/NodeId.h>
 #include <core/Queue.h>
 #include <core/SocketPort.h>
 #include <core/Timer.h>
 
+#include "RtpReceiver.h"
 #include "RtspCommon.h"
 #include "RtspParser.h"
 
@@ -36,7 +39,6 @@ namespace WPEFramework {
 namespace Plugin {
 
     typedef Core::QueueType<RtspMessagePtr> RequestQueue;
-    typedef Core::QueueType<RtspMessagePtr> ResponseQueue;
 
     class RtspSession {
     public:
@@ -50,6 +52,76 @@ namespace Plugin {
 
         private:
             RtspSession& _rtspSession;
+            // Received data that does not form a complete message (yet).
+            string _partial;
+        };
+
+        // A request that was sent out and is waiting for the response with the same CSeq.
+        class Transaction {
+        public:
+            Transaction() = delete;
+            Transaction(const Transaction&) = delete;
+            Transaction& operator=(const Transaction&) = delete;
+
+            Transaction(const RtspMessagePtr& request)
+                : _request(request)
+                , _response()
+                , _signal(false, true)
+            {
+            }
+            ~Transaction()
+            {
+            }
+
+        public:
+            inline uint32_t Sequence() const
+            {
+                return (_request->sequence);
+            }
+            inline const RtspMessagePtr& Request() const
+            {
+                return (_request);
+            }
+            inline const RtspMessagePtr& Response() const
+            {
+                return (_response);
+            }
+            inline void Completed(const RtspMessagePtr& response)
+            {
+                _response = response;
+                _signal.SetEvent();
+            }
+            inline bool Wait(const uint32_t waitTime)
+            {
+                return (_signal.Lock(waitTime) == Core::ERROR_NONE);
+            }
+
+        private:
+            RtspMessagePtr _request;
+            RtspMessagePtr _response;
+            Core::Event _signal;
+        };
+
+        // Drains the RTP payloads into a file descriptor (e.g. a FIFO read by the platform player).
+        class RtpSink : public Core::Thread {
+        public:
+            RtpSink() = delete;
+            RtpSink(const RtpSink&) = delete;
+            RtpSink& operator=(const RtpSink&) = delete;
+
+            RtpSink(RtpReceiver& receiver);
+            ~RtpSink();
+
+        public:
+            bool Start(const string& path);
+            void Stop();
+
+        private:
+            virtual uint32_t Worker() override;
+
+        private:
+            RtpReceiver& _receiver;
+            int _descriptor;
         };
 
         class AnnouncementHandler {
@@ -98,12 +170,17 @@ namespace Plugin {
         RtspReturnCode Play(float scale, uint32_t position = 0);
         RtspReturnCode Get(const string name, string& value) const;
         RtspReturnCode Set(const string& name, const string& value);
+        void ConfigureRtp(const uint16_t port, const string& sink);
+        bool RtpStatistics(RtpReceiver::Statistics& statistics) const;
 
         RtspReturnCode Send(const RtspMessagePtr& request);
+        RtspReturnCode Send(Transaction& transaction);
+        RtspReturnCode Wait(Transaction& transaction);
         RtspReturnCode SendHeartbeat(bool bSRM);
         RtspReturnCode SendHeartbeats();
 
         RtspReturnCode ProcessResponse(const string& response, bool bSRM);
+        RtspReturnCode ProcessFrames(string& buffer, bool bSRM);
         RtspReturnCode ProcessAnnouncement(const std::string& response, bool bSRM);
         RtspReturnCode SendResponse(int respSeq, bool bSRM);
         RtspReturnCode SendAnnouncement(int code, const string& reason);
@@ -133,10 +210,14 @@ namespace Plugin {
         RtspSession::Socket* _controlSocket;
 
         RtspParser _parser;
+        RtpReceiver _rtpReceiver;
+        RtpSink _rtpSink;
+        uint16_t _rtpPort;
+        string _rtpSinkPath;
         RtspSessionInfo _sessionInfo;
         Core::CriticalSection _adminLock;
         RequestQueue _requestQueue;
-        ResponseQueue _responseQueue;
+        std::map<uint32_t, Transaction*> _transactions;
         Core::TimerType<HeartbeatTimer> _heartbeatTimer;
 
         bool _isSessionActive;
@@ -23,7 +23,10 @@
 namespace WPEFramework {
 namespace Plugin {
 
-    constexpr uint32_t WaitForResponse = 2000;
+    // Time to wait for the responses of a single round, before moving on.
+    constexpr uint32_t WaitForResponse = 1000;
+    // Minimum time between two consecutive requests to the same server.
+    constexpr uint32_t RoundInterval = 500;
 
 #ifdef __WINDOWS__
 #pragma warning(disable : 4355)
@@ -33,10 +36,14 @@ namespace Plugin {
         , _adminLock()
         , _packet()
         , _syncedTimestamp()
+        , _roundStart()
         , _state(INITIAL)
-        , _fired(true)
         , _WaitForNetwork(2000) // Wait for 2 Seconds for a new attempt
         , _retryAttempts(5)
+        , _currentAttempt(0)
+        , _round(0)
+        , _servers()
+        , _source()
         , _activity(Core::ProxyType<Activity>::Create(this))
         , _clients()
     {
@@ -82,11 +89,9 @@ namespace Plugin {
                     hostname += ':' + Core::NumberType<uint16_t>(Core::URL::Port(url.Type())).Text();
                 }
 
-                _servers.push_back(hostname);
+                _servers.emplace_back(hostname);
             }
         }
-
-        _serverIndex = ServerIterator(_servers);
     }
 
     /* virtual */ uint32_t NTPClient::Synchronize()
@@ -97,7 +102,9 @@ namespace Plugin {
 
         _adminLock.Lock();
 
-        if ((_state == INITIAL) || (_state == SUCCESS) || ((_state == FAILED) && (_serverIndex.IsValid() == false))) {
+        if (_servers.empty() == true) {
+            TRACE(Trace::Error, (_T("TimeSync: No NTP servers configured")));
+        } else if ((_state == INITIAL) || (_state == SUCCESS) || (_state == FAILED)) {
             result = Core::ERROR_NONE;
             _state = SENDREQUEST;
             Core::IWorkerPool::Instance().Submit(_activity);
@@ -136,7 +143,24 @@ namespace Plugin {
 
     /* virtual */ string NTPClient::Source() const
     {
-        return (_serverIndex.IsValid() == true ? string(_T("NTP://")) + (*_serverIndex) + '/' : _T("NTP:///"));
+        _adminLock.Lock();
+
+        string result(_source.empty() == false ? string(_T("NTP://")) + _source + '/' : _T("NTP:///"));
+
+        _adminLock.Unlock();
+
+        return (result);
+    }
+
+    void NTPClient::Statistics(StatisticsList& statistics) const
+    {
+        _adminLock.Lock();
+
+        for (const Server& server : _servers) {
+            statistics.push_back({ server.Name(), server.Samples(), server.Delay(), server.Offset(), server.Jitter(), server.IsSelected() });
+        }
+
+        _adminLock.Unlock();
     }
 
     /* virtual */ void NTPClient::Register(Exchange::ITimeSync::INotification* notification)
@@ -174,17 +198,30 @@ namespace Plugin {
 
         _adminLock.Lock();
 
-        if (_fired == false) {
+        // All servers share this socket, every call sends out the request for the next server
+        // that is pending in this round, by retargeting the socket before the datagram leaves.
+        ServerList::iterator index(_servers.begin());
+
+        while ((index != _servers.end()) && (index->IsPending() == false)) {
+            index++;
+        }
 
-            _fired = true;
+        if (index != _servers.end()) {
 
             DataFrame newFrame(dataFrame, maxSendSize);
             DataFrame::Writer writer(newFrame, 0);
-            _packet.TransmitTimestamp(NTPPacket::Timestamp(Core::Time::Now()));
+            NTPPacket::Timestamp now(Core::Time::Now());
+
+            RemoteNode(index->Node());
+
+            _packet.TransmitTimestamp(now);
             _packet.Serialize(writer);
 
+            // Remember what we sent, as it is echoed back by the server in the origin timestamp.
+            index->Sent(NTPPacket::Timestamp(now.Seconds(), now.Fraction()).TimeSeconds());
+
             result = newFrame.Size();
-            TRACE_L1("Timesync: Send data: %d bytes", result);
+            TRACE_L1("Timesync: Send data: %d bytes to %s", result, index->Name().c_str());
         }
 
         _adminLock.Unlock();
@@ -192,20 +229,20 @@ namespace Plugin {
         return result;
     }
 
-    inline static uint64_t SecondsToTicks(double seconds)
+    inline static int64_t SecondsToTicks(double seconds)
     {
-        return static_cast<uint64_t>(seconds * NTPClient::MicroSeconds);
+        return static_cast<int64_t>(seconds * NTPClient::MicroSeconds);
     }
 
     /* virtual */ uint16_t NTPClient::ReceiveData(uint8_t* dataFrame, const uint16_t receivedSize)
     {
-        double received = static_cast<double>(Core::Time::Now().Ticks() / MicroSeconds);
+        double received = NTPPacket::Timestamp(Core::Time::Now()).TimeSeconds();
 
         TRACE_L1("Timesync: Received data: %d bytes", receivedSize);
 
         _adminLock.Lock();
 
-        if (receivedSize == NTPPacket::PacketSize) {
+        if ((receivedSize == NTPPacket::PacketSize) && (_state == INPROGRESS)) {
 
             DataFrame frame(dataFrame, receivedSize, receivedSize);
             NTPPacket packet;
@@ -215,49 +252,50 @@ namespace Plugin {
 // packet.DisplayPacket();
 #endif
 
-            double receivedServerTS = packet.ReceiveTimestamp().TimeSeconds();
-            double sentServerTS = packet.TransmitTimestamp().TimeSeconds();
+            const Core::NodeId source(ReceivedNode());
             double sentTS = packet.OriginalTimestamp().TimeSeconds();
+            ServerList::iterator index(_servers.begin());
 
-            double diffRequest = receivedServerTS - sentTS;
-            double diffResponse = sentServerTS - received;
-            double offset = (diffRequest + diffResponse) / 2;
+            while ((index != _servers.end()) && ((index->Node() != source) || (index->IsResponse(sentTS) == false))) {
+                index++;
+            }
 
-#ifdef __DEBUG__
-            double elapsedServer = sentServerTS - receivedServerTS;
-            double elapsedTotal = received - sentTS;
-            double roundTrip = elapsedTotal - elapsedServer;
-#endif
+            if (index == _servers.end()) {
+                TRACE(Trace::Warning, (_T("TimeSync: Dropping unexpected response from %s"), source.HostAddress().c_str()));
+            } else if ((packet.NTPMode() != 0x04) || (packet.Stratum() == 0) || (packet.LeapIndicator() == 0x03)) {
+                // Stratum 0 is a Kiss-o'-Death (e.g. RATE), leap 3 an unsynchronized server, both are not usable
+                // for the remainder of this synchronization.
+                TRACE(Trace::Warning, (_T("TimeSync: Server %s rejected [stratum: %d, leap: %d, reference: %s]"), index->Name().c_str(), packet.Stratum(), packet.LeapIndicator(), packet.ReferenceID().c_str()));
+                index->Reject();
+            } else {
+                const double Fraction_16_16 = 65536.0;
 
-            TRACE_L1("Request time diff  = %lf", diffRequest);
-            TRACE_L1("Response time diff = %lf", diffResponse);
-            TRACE_L1("Offset time        = %lf", offset);
+                double receivedServerTS = packet.ReceiveTimestamp().TimeSeconds();
+                double sentServerTS = packet.TransmitTimestamp().TimeSeconds();
 
-#ifdef __DEBUG__
-            TRACE_L1("Server elapsed time = %lf", elapsedServer);
-            TRACE_L1("Total elapsed time  = %lf", elapsedTotal);
-            TRACE_L1("Round trip time     = %lf", roundTrip);
-#endif
-            TRACE(Trace::Information, (_T("TimeSync: Request time diff   = %lf s"), diffRequest));
-            TRACE(Trace::Information, (_T("TimeSync: Response time diff  = %lf s"), diffResponse));
-            TRACE(Trace::Information, (_T("TimeSync: Offset time         = %lf s"), offset));
+                double diffRequest = receivedServerTS - sentTS;
+                double diffResponse = sentServerTS - received;
+                double offset = (diffRequest + diffResponse) / 2;
+                double delay = std::max((received - sentTS) - (sentServerTS - receivedServerTS), 0.0);
+                double dispersion = (packet.RootDelay() / Fraction_16_16 / 2) + (packet.RootDispersion() / Fraction_16_16);
 
-            uint64_t receivedTicks = SecondsToTicks(received);
-            TRACE(Trace::Information, (_T("TimeSync: Current time: %s"), Core::Time(receivedTicks).ToRFC1123(false).c_str()));
-            _syncedTimestamp = Core::Time(receivedTicks + SecondsToTicks(offset));
-            TRACE(Trace::Information, (_T("TimeSync: New time:     %s"), _syncedTimestamp.ToRFC1123(false).c_str()));
+                TRACE(Trace::Information, (_T("TimeSync: Server %s, offset = %lf s, delay = %lf s"), index->Name().c_str(), offset, delay));
 
-            _state = SUCCESS;
+                index->Received(offset, delay, dispersion);
+            }
 
-            // We don't need the socket anymore, so close it
-            TRACE_L1("TimeSync: %s", "Closing socket, no longer needed");
-            Close(0);
+            if ((index != _servers.end()) && (IsRoundCompleted() == true)) {
+                // Everyone answered, no need to wait for the round to time out. The first round of the first
+                // synchronization is evaluated right away, it might be all we need.
+                Core::Time next(_roundStart);
 
-            // Lets remove the watchdog subject, we do not want to wait anymore, we got an answer.
-            Core::IWorkerPool::Instance().Revoke(_activity);
+                if ((_round != 1) || (_syncedTimestamp.IsValid() == true)) {
+                    next.Add(RoundInterval);
+                }
 
-            // Schedule it again to broadcast the successfull update of the time.
-            Core::IWorkerPool::Instance().Submit(_activity);
+                Core::IWorkerPool::Instance().Revoke(_activity);
+                Core::IWorkerPool::Instance().Schedule(next, _activity);
+            }
         }
 
         _adminLock.Unlock();
@@ -275,10 +313,11 @@ namespace Plugin {
         }
     }
 
-    bool NTPClient::FireRequest()
+    bool NTPClient::Activate()
     {
+        // runs always in the context of the adminlock
 
-        bool activated = false;
+        Core::NodeId local;
 
         // Make sure socket is closed otherwise an assert will fire.
         if (!IsClosed()) {
@@ -286,52 +325,163 @@ namespace Plugin {
             Close(1000);
         }
 
-        if (true == IsClosed() && (_serverIndex.Count() > 0)) {
+        for (Server& server : _servers) {
+            if (server.Resolve() == true) {
+                if (local.IsValid() == false) {
+                    local = server.Node().AnyInterface();
+                }
+            } else {
+                TRACE(Trace::Warning, (_T("Could not resolve NTP Server [%s]"), server.Name().c_str()));
+            }
+        }
 
-            uint32_t lastonetried = _serverIndex.Index();
+        bool activated = false;
 
-            do {
+        if ((local.IsValid() == true) && (IsClosed() == true)) {
 
-                // next server
-                if( _serverIndex.Index() >= _serverIndex.Count() ) {
-                    _serverIndex.Reset(0);
-                }
-                _serverIndex.Next();
-                ASSERT(_serverIndex.IsValid());
+            // One socket serves all servers, the remote is selected per datagram.
+            LocalNode(local);
+
+            // UDP should open by definition directly...
+            uint32_t status = Open(100);
+
+            if ((status == Core::ERROR_NONE) || (status == Core::ERROR_INPROGRESS)) {
+                activated = true;
+            } else {
+                TRACE(Trace::Warning, (_T("Could not open the NTP socket, error: %d"), status));
+            }
+        }
+
+        return (activated);
+    }
+
+    void NTPClient::FireRound()
+    {
+        // runs always in the context of the adminlock
+
+        _round++;
+        _roundStart = Core::Time::Now();
+
+        TRACE(Trace::Information, (_T("TimeSync: Querying all NTP servers, round %d of %d"), _round, SamplesPerServer));
+
+        for (Server& server : _servers) {
+            server.Schedule();
+        }
 
-                TRACE(Trace::Information, (_T("Trying NTP Server: [%s]"), (*_serverIndex).c_str()));
+        Trigger();
+    }
+
+    bool NTPClient::IsRoundCompleted() const
+    {
+        ServerList::const_iterator index(_servers.begin());
+
+        while ((index != _servers.end()) && (index->IsOutstanding() == false)) {
+            index++;
+        }
+
+        return (index == _servers.end());
+    }
+
+    bool NTPClient::Select(const bool majority)
+    {
+        // runs always in the context of the adminlock
+
+        // Marzullo's algorithm: every server provides an interval [offset - distance, offset + distance] in which
+        // it claims the true offset lies. The true offset is in the intersection of the largest set of
+        // overlapping intervals, servers not contributing to that intersection are considered falsetickers.
+        std::vector<std::pair<double, int8_t>> edges;
+        uint32_t candidates = 0;
+        uint32_t usable = 0;
+
+        for (Server& server : _servers) {
+            usable += (server.IsValid() == true ? 1 : 0);
+
+            if ((server.IsValid() == true) && (server.Filter() == true)) {
+                edges.emplace_back(server.Offset() - server.Distance(), +1);
+                edges.emplace_back(server.Offset() + server.Distance(), -1);
+                candidates++;
+            } else {
+                server.Selected(false);
+            }
+        }
+
+        bool result = (candidates > 0);
 
-                // Set the socket to send to the remote
-                Core::NodeId remote((*_serverIndex).c_str(), Core::NodeId::TYPE_IPV4);
+        if (result == true) {
+            // On equal values, a starting edge must be counted before an ending edge.
+            std::sort(edges.begin(), edges.end(), [](const std::pair<double, int8_t>& lhs, const std::pair<double, int8_t>& rhs) {
+                return ((lhs.first < rhs.first) || ((lhs.first == rhs.first) && (lhs.second > rhs.second)));
+            });
 
-                if (remote.IsValid() == true) {
-                    // Set the remote endpoint for the socket to the selected NTP server
-                    RemoteNode(remote);
-                    LocalNode(remote.AnyInterface());
+            int32_t count = 0;
+            int32_t best = 0;
+            double low = 0;
+            double high = 0;
+
+            for (uint32_t index = 0; index < edges.size(); index++) {
+                count += edges[index].second;
+
+                if (count > best) {
+                    best = count;
+                    low = edges[index].first;
+                    high = edges[index + 1].first;
+                }
+            }
 
-                    // UDP should open by definition directly...
-                    uint32_t status = Open(100);
+            Server* peer = nullptr;
 
-                    if ((status == Core::ERROR_NONE) || (status == Core::ERROR_INPROGRESS)) {
+            if ((static_cast<uint32_t>(best * 2) <= usable) && (majority == true)) {
+                // Servers that did not answer (yet) count as disagreeing.
+                result = false;
+            } else if (static_cast<uint32_t>(best * 2) <= candidates) {
+                // No majority agrees on the time, the best we can do is trusting the closest server.
+                TRACE(Trace::Warning, (_T("TimeSync: No majority among %d servers, using the one with the lowest root distance"), candidates));
 
-                        activated = true;
-                        _fired = false;
-                        Trigger();
+                for (Server& server : _servers) {
+                    if ((server.Samples() > 0) && (server.IsValid() == true) && ((peer == nullptr) || (server.Distance() < peer->Distance()))) {
+                        peer = &server;
                     }
-                    else {
-                        TRACE(Trace::Warning, (_T("Could not open connection to NTP Server [%s]"), (*_serverIndex).c_str()));
+                }
+
+                peer->Selected(true);
+            } else {
+                for (Server& server : _servers) {
+                    bool truechimer = (server.Samples() > 0) && (server.IsValid() == true) && ((server.Offset() - server.Distance()) <= low) && ((server.Offset() + server.Distance()) >= high);
+
+                    server.Selected(truechimer);
+
+                    if ((truechimer == true) && ((peer == nullptr) || (server.Distance() < peer->Distance()))) {
+                        peer = &server;
                     }
                 }
-                else {
-                    TRACE(Trace::Warning, (_T("Could not resolve NTP Server [%s]"), (*_serverIndex).c_str()));
+            }
+
+            if (result == true) {
+                ASSERT(peer != nullptr);
+
+                // Combine the truechimers, weighted by the inverse of their root distance.
+                double weights = 0;
+                double offset = 0;
+
+                for (const Server& server : _servers) {
+                    if (server.IsSelected() == true) {
+                        double weight = 1.0 / std::max(server.Distance(), 0.000001);
+                        offset += (weight * server.Offset());
+                        weights += weight;
+                    }
                 }
+
+                offset /= weights;
+
+                _source = peer->Name();
+                _syncedTimestamp = Core::Time(Core::Time::Now().Ticks() + SecondsToTicks(offset));
+
+                TRACE(Trace::Information, (_T("TimeSync: Offset time         = %lf s, %d of %d servers agree"), offset, best, candidates));
+                TRACE(Trace::Information, (_T("TimeSync: New time:     %s"), _syncedTimestamp.ToRFC1123(false).c_str()));
             }
-            while ((activated == false) && ( ((lastonetried != 0) && (lastonetried != _serverIndex.Index())) ||
-                                             ((lastonetried == 0) && (_serverIndex.Index() != _serverIndex.Count())) 
-                                           ) );
         }
 
-        return (activated);
+        return (result);
     }
 
     void NTPClient::Update()
@@ -360,32 +510,62 @@ namespace Plugin {
 
         switch (_state) {
         case SENDREQUEST: {
-            // This case means that nothing has started yet, let reset the list of servers and start at the beginning...
-            _serverIndex.Reset(0);
+            // This case means that nothing has started yet, lets start with a fresh set of samples.
             _state = INPROGRESS;
             _currentAttempt = _retryAttempts;
+            _round = 0;
         }
         case INPROGRESS: {
-            // If we end up here in this state, it means that the package was send but no response was received,
-            // or a response was received but is was not properly formatted...
-            // Lets move to the next server in the list, see if that one responds correctly, if we tried all servers let's
-            // start at the first one again, this time it might work
-            if (FireRequest() == true) {
-              result = WaitForResponse;
-            } else {
+            // We query all servers in parallel, SamplesPerServer rounds in a row. A round ends when all servers
+            // responded or when it timed out. Once all rounds are done, the clock filter and the selection are
+            // applied on whatever came in. Without a time yet, waiting for all rounds keeps the system on a wrong
+            // clock for seconds: if a majority agrees after the first round that time is taken. Later
+            // synchronizations take all rounds, the clock filter refines the time from the extra samples.
+            if ((_round == 0) && (Activate() == false)) {
+                // Looks like there is no network connectivity, Just sleep and retry later
                 if (_currentAttempt-- != 0) {
-
-                    // Looks like there is no network connectivity, Just sleep and retry later
                     result = _WaitForNetwork;
                 } else {
-
-                    // Looks like there is no valid server anymore that we could use. There where servers
-                    // that did resolve correctly, so it is not a network connectivity problem.
                     _state = FAILED;
 
                     // Report the failure. Always report back when we are finished.
                     Update();
                 }
+            } else if ((_round == 1) && (_syncedTimestamp.IsValid() == false) && (Select(true) == true)) {
+                TRACE_L1("TimeSync: %s", "Majority after the first round, closing socket");
+                Close(0);
+
+                _round = 0;
+                _state = SUCCESS;
+                Update();
+            } else if (_round < SamplesPerServer) {
+                const uint64_t due = _roundStart.Ticks() + (static_cast<uint64_t>(RoundInterval) * Core::Time::TicksPerMillisecond);
+                const uint64_t now = Core::Time::Now().Ticks();
+
+                if ((_round != 0) && (now < due)) {
+                    // Evaluated early, the servers still get their time between two requests.
+                    result = static_cast<uint32_t>((due - now) / Core::Time::TicksPerMillisecond) + 1;
+                } else {
+                    FireRound();
+                    result = WaitForResponse;
+                }
+            } else {
+                // We don't need the socket anymore, so close it
+                TRACE_L1("TimeSync: %s", "Closing socket, no longer needed");
+                Close(0);
+
+                _round = 0;
+
+                if (Select(false) == true) {
+                    _state = SUCCESS;
+                    Update();
+                } else if (_currentAttempt-- != 0) {
+                    // None of the servers answered, maybe they will the next time.
+                    result = _WaitForNetwork;
+                } else {
+                    _state = FAILED;
+                    Update();
+                }
             }
             break;
         }
@@ -22,6 +22,7 @@
 
 #include "Module.h"
 #include <interfaces/ITimeSync.h>
+#include <cmath>
 
 namespace WPEFramework {
 namespace Plugin {
@@ -32,11 +33,23 @@ namespace Plugin {
         static constexpr uint32_t MicroSeconds = 1000 * MilliSeconds;
         static constexpr uint32_t NanoSeconds = 1000 * MicroSeconds;
 
+        // Number of request/response exchanges done with every server before the clock filter is applied.
+        static constexpr uint8_t SamplesPerServer = 4;
+
         using SourceIterator = Core::JSON::ArrayType<Core::JSON::String>::Iterator;
 
+        // Outcome of the clock filter for a single server, as determined during the last synchronization.
+        struct ServerStatistics {
+            string Server;
+            uint8_t Samples; // Number of valid responses received
+            double Delay; // Round trip delay of the selected sample, in seconds
+            double Offset; // Clock offset of the selected sample, in seconds
+            double Jitter; // RMS of the offset differences between all samples and the selected one, in seconds
+            bool Selected; // Server survived the intersection algorithm (truechimer)
+        };
+        using StatisticsList = std::list<ServerStatistics>;
+
     private:
-        using ServerList = std::vector<string>;
-        using ServerIterator = Core::IteratorType<const ServerList, const string&, ServerList::const_iterator>;
         using DataFrame = Core::FrameType<0>;
 
         // This enum tracks the state for actions begin performed. As the Worker() method is re-entered,
@@ -328,6 +341,212 @@ namespace Plugin {
                 // bit (NTP time)
         };
 
+        class Server {
+        private:
+            class Sample {
+            public:
+                Sample()
+                    : Offset(0)
+                    , Delay(0)
+                    , Dispersion(0)
+                {
+                }
+                Sample(const double offset, const double delay, const double dispersion)
+                    : Offset(offset)
+                    , Delay(delay)
+                    , Dispersion(dispersion)
+                {
+                }
+                ~Sample()
+                {
+                }
+
+            public:
+                double Offset;
+                double Delay;
+                double Dispersion; // Root delay/2 + root dispersion, as reported by the server
+            };
+
+        public:
+            Server() = delete;
+            Server& operator=(const Server&) = delete;
+
+            Server(const string& name)
+                : _name(name)
+                , _node()
+                , _samples()
+                , _count(0)
+                , _origin(0)
+                , _pending(false)
+                , _outstanding(false)
+                , _rejected(false)
+                , _offset(0)
+                , _delay(0)
+                , _jitter(0)
+                , _distance(0)
+                , _selected(false)
+            {
+            }
+            Server(const Server& copy)
+                : _name(copy._name)
+                , _node(copy._node)
+                , _samples()
+                , _count(0)
+                , _origin(0)
+                , _pending(false)
+                , _outstanding(false)
+                , _rejected(false)
+                , _offset(0)
+                , _delay(0)
+                , _jitter(0)
+                , _distance(0)
+                , _selected(false)
+            {
+            }
+            ~Server()
+            {
+            }
+
+        public:
+            const string& Name() const
+            {
+                return (_name);
+            }
+            const Core::NodeId& Node() const
+            {
+                return (_node);
+            }
+            bool IsValid() const
+            {
+                return ((_node.IsValid() == true) && (_rejected == false));
+            }
+            bool Resolve()
+            {
+                _node = Core::NodeId(_name.c_str(), Core::NodeId::TYPE_IPV4);
+                _count = 0;
+                _pending = false;
+                _outstanding = false;
+                _rejected = false;
+                _selected = false;
+
+                return (_node.IsValid());
+            }
+            // Mark the server to be queried in the upcoming round.
+            void Schedule()
+            {
+                _pending = IsValid();
+                _outstanding = _pending;
+            }
+            bool IsPending() const
+            {
+                return (_pending);
+            }
+            bool IsOutstanding() const
+            {
+                return ((_outstanding == true) && (_rejected == false));
+            }
+            void Sent(const double origin)
+            {
+                _pending = false;
+                _origin = origin;
+            }
+            bool IsResponse(const double origin) const
+            {
+                // The server echoes our transmit timestamp, anything else is stale or spoofed.
+                return ((_outstanding == true) && (std::fabs(origin - _origin) < 0.000002));
+            }
+            void Reject()
+            {
+                _rejected = true;
+            }
+            void Received(const double offset, const double delay, const double dispersion)
+            {
+                _outstanding = false;
+
+                if (_count < SamplesPerServer) {
+                    _samples[_count++] = Sample(offset, delay, dispersion);
+                }
+            }
+
+            // NTP clock filter: the sample with the lowest delay is the most trustworthy one.
+            bool Filter()
+            {
+                _selected = false;
+
+                if (_count > 0) {
+                    uint8_t best = 0;
+
+                    for (uint8_t index = 1; index < _count; index++) {
+                        if (_samples[index].Delay < _samples[best].Delay) {
+                            best = index;
+                        }
+                    }
+
+                    _offset = _samples[best].Offset;
+                    _delay = _samples[best].Delay;
+                    _jitter = 0;
+
+                    if (_count > 1) {
+                        for (uint8_t index = 0; index < _count; index++) {
+                            double difference = _samples[index].Offset - _offset;
+                            _jitter += (difference * difference);
+                        }
+                        _jitter = std::sqrt(_jitter / (_count - 1));
+                    }
+
+                    // Root distance, the half width of the interval the true time lies in, according to this server.
+                    _distance = (_delay / 2) + _samples[best].Dispersion + _jitter;
+                }
+
+                return (_count > 0);
+            }
+            uint8_t Samples() const
+            {
+                return (_count);
+            }
+            double Offset() const
+            {
+                return (_offset);
+            }
+            double Delay() const
+            {
+                return (_delay);
+            }
+            double Jitter() const
+            {
+                return (_jitter);
+            }
+            double Distance() const
+            {
+                return (_distance);
+            }
+            bool IsSelected() const
+            {
+                return (_selected);
+            }
+            void Selected(const bool selected)
+            {
+                _selected = selected;
+            }
+
+        private:
+            const string _name;
+            Core::NodeId _node;
+            Sample _samples[SamplesPerServer];
+            uint8_t _count;
+            double _origin;
+            bool _pending;
+            bool _outstanding;
+            bool _rejected;
+            double _offset;
+            double _delay;
+            double _jitter;
+            double _distance;
+            bool _selected;
+        };
+
+        using ServerList = std::vector<Server>;
+
         class Activity : public Core::IDispatchType<void> {
         private:
             Activity() = delete;
@@ -372,6 +591,8 @@ namespace Plugin {
         virtual string Source() const override;
         virtual uint64_t SyncTime() const override;
 
+        void Statistics(StatisticsList& statistics) const;
+
         // ITime methods
         virtual uint64_t TimeSync() const override
         {
@@ -393,19 +614,25 @@ namespace Plugin {
 
         void Update();
         void Dispatch();
-        bool FireRequest();
+        bool Activate();
+        void FireRound();
+        bool IsRoundCompleted() const;
+        // Applies the clock filter and the intersection, fails if there are no samples, or if a majority of the
+        // usable servers is required and does not agree.
+        bool Select(const bool majority);
 
     private:
-        Core::CriticalSection _adminLock;
+        mutable Core::CriticalSection _adminLock;
         NTPPacket _packet;
         Core::Time _syncedTimestamp;
+        Core::Time _roundStart;
         state _state;
-        bool _fired;
         uint32_t _WaitForNetwork;
         uint32_t _retryAttempts;
         uint32_t _currentAttempt;
+        uint8_t _round;
         ServerList _servers;
-        ServerIterator _serverIndex;
+        string _source;
         Core::ProxyType<Core::IDispatchType<void>> _activity;
         std::list<Exchange::ITimeSync::INotification*> _clients;
     };
@@ -74,6 +74,57 @@ namespace Plugin {
             TimeRep Time;
         };
 
+        class ServerData : public Core::JSON::Container {
+        public:
+            ServerData& operator=(ServerData const& other) = delete;
+
+            ServerData()
+                : Core::JSON::Container()
+                , Server()
+                , Samples()
+                , Delay()
+                , Offset()
+                , Jitter()
+                , Selected()
+            {
+                Init();
+            }
+            ServerData(ServerData const& other)
+                : Core::JSON::Container()
+                , Server(other.Server)
+                , Samples(other.Samples)
+                , Delay(other.Delay)
+                , Offset(other.Offset)
+                , Jitter(other.Jitter)
+                , Selected(other.Selected)
+            {
+                Init();
+            }
+
+            virtual ~ServerData()
+            {
+            }
+
+        private:
+            void Init()
+            {
+                Add(_T("server"), &Server);
+                Add(_T("samples"), &Samples);
+                Add(_T("delay"), &Delay);
+                Add(_T("offset"), &Offset);
+                Add(_T("jitter"), &Jitter);
+                Add(_T("selected"), &Selected);
+            }
+
+        public:
+            Core::JSON::String Server;
+            Core::JSON::DecUInt8 Samples;
+            Core::JSON::DecUInt32 Delay; // in microseconds
+            Core::JSON::DecSInt64 Offset; // in microseconds
+            Core::JSON::DecUInt32 Jitter; // in microseconds
+            Core::JSON::Boolean Selected;
+        };
+
     private:
         class Notification : protected Exchange::ITimeSync::INotification {
         private:
@@ -242,6 +293,7 @@ namespace Plugin {
         uint32_t endpoint_synchronize();
         uint32_t get_synctime(JsonData::TimeSync::SynctimeData& response) const;
         uint32_t get_time(Core::JSON::String& response) const;
+        uint32_t get_servers(Core::JSON::ArrayType<ServerData>& response) const;
         uint32_t set_time(const Core::JSON::String& param);
         void event_timechange();
 
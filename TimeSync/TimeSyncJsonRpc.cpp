@@ -19,6 +19,7 @@
 
 #include <interfaces/json/JsonData_TimeSync.h>
 #include "TimeSync.h"
+#include "NTPClient.h"
 #include "Module.h"
 
 namespace WPEFramework {
@@ -35,6 +36,7 @@ namespace Plugin {
         Register<void,void>(_T("synchronize"), &TimeSync::endpoint_synchronize, this);
         Property<SynctimeData>(_T("synctime"), &TimeSync::get_synctime, nullptr, this);
         Property<Core::JSON::String>(_T("time"), &TimeSync::get_time, &TimeSync::set_time, this);
+        Property<Core::JSON::ArrayType<ServerData>>(_T("servers"), &TimeSync::get_servers, nullptr, this);
     }
 
     void TimeSync::UnregisterAll()
@@ -42,6 +44,7 @@ namespace Plugin {
         Unregister(_T("synchronize"));
         Unregister(_T("time"));
         Unregister(_T("synctime"));
+        Unregister(_T("servers"));
     }
 
     // API implementation
@@ -86,6 +89,33 @@ namespace Plugin {
         return Core::ERROR_NONE;
     }
 
+    // Property: servers - Clock filter results per time source of the most recent synchronization
+    // Return codes:
+    //  - ERROR_NONE: Success
+    uint32_t TimeSync::get_servers(Core::JSON::ArrayType<ServerData>& response) const
+    {
+        NTPClient::StatisticsList statistics;
+
+        static_cast<const NTPClient*>(_client)->Statistics(statistics);
+
+        for (const NTPClient::ServerStatistics& entry : statistics) {
+            ServerData& server(response.Add());
+
+            server.Server = entry.Server;
+            server.Samples = entry.Samples;
+
+            if (entry.Samples > 0) {
+                server.Delay = static_cast<uint32_t>(entry.Delay * NTPClient::MicroSeconds);
+                server.Offset = static_cast<int64_t>(entry.Offset * NTPClient::MicroSeconds);
+                server.Jitter = static_cast<uint32_t>(entry.Jitter * NTPClient::MicroSeconds);
+            }
+
+            server.Selected = entry.Selected;
+        }
+
+        return Core::ERROR_NONE;
+    }
+
     // Property: time - Current system time
     // Return codes:
     //  - ERROR_NONE: Success
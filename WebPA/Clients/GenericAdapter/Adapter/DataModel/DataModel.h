@@ -22,8 +22,6 @@
 #include "Handler.h"
 #include "Utils.h"
 
-#include <tinyxml.h>
-
 namespace WPEFramework {
 
 typedef enum
@@ -37,10 +35,127 @@ typedef enum
 }
 DMStatus;
 
+// The data model (data-model.xml) is compiled once into a trie of path segments. Objects and parameters
+// are named children, multi instance objects have a single {i} child that stands for every instance.
 class DataModel {
 private:
     static constexpr const uint32_t  MaxNumParameters = 2048;
-    static constexpr const TCHAR* InstanceNumberIndicator = "{i}.";
+    static constexpr const TCHAR* InstanceNumberIndicator = "{i}";
+
+public:
+    class Node {
+    public:
+        Node() = delete;
+        Node(const Node&) = delete;
+        Node& operator= (const Node&) = delete;
+
+        Node(const std::string& name, const bool isParameter)
+            : _name(name)
+            , _isParameter(isParameter)
+            , _readable(false)
+            , _writable(false)
+            , _dataType()
+            , _paramType(Variant::ParamType::TypeNone)
+            , _timeToLive(0)
+            , _children()
+            , _ordered()
+            , _instance(nullptr)
+        {
+        }
+        ~Node()
+        {
+            for (Node* child : _ordered) {
+                delete child;
+            }
+            delete _instance;
+        }
+
+    public:
+        inline const std::string& Name() const
+        {
+            return (_name);
+        }
+        inline bool IsParameter() const
+        {
+            return (_isParameter);
+        }
+        inline bool IsReadable() const
+        {
+            return (_readable);
+        }
+        inline bool IsWritable() const
+        {
+            return (_writable);
+        }
+        inline const std::string& DataType() const
+        {
+            return (_dataType);
+        }
+        inline Variant::ParamType ParamType() const
+        {
+            return (_paramType);
+        }
+        // Time, in ms, a value read from the profile can be served again without asking the profile, 0 means never.
+        inline uint32_t TimeToLive() const
+        {
+            return (_timeToLive);
+        }
+        inline const Node* Child(const std::string& name) const
+        {
+            std::map<std::string, Node*>::const_iterator index(_children.find(name));
+            return (index != _children.end() ? index->second : nullptr);
+        }
+        inline const std::vector<Node*>& Children() const
+        {
+            return (_ordered);
+        }
+        inline const Node* Instance() const
+        {
+            return (_instance);
+        }
+
+    private:
+        friend class DataModel;
+
+        Node* Add(const std::string& name, const bool isParameter)
+        {
+            Node* result;
+
+            if (name == InstanceNumberIndicator) {
+                if (_instance == nullptr) {
+                    _instance = new Node(name, false);
+                }
+                result = _instance;
+            } else {
+                std::map<std::string, Node*>::iterator index(_children.find(name));
+
+                if (index != _children.end()) {
+                    result = index->second;
+                } else {
+                    result = new Node(name, isParameter);
+                    _children.insert(std::make_pair(name, result));
+                    // Keep the order of the document, it is the order of a wildcard expansion.
+                    _ordered.push_back(result);
+                }
+            }
+
+            return (result);
+        }
+
+    private:
+        const std::string _name;
+        const bool _isParameter;
+        bool _readable;
+        bool _writable;
+        std::string _dataType;
+        Variant::ParamType _paramType;
+        uint32_t _timeToLive;
+        std::map<std::string, Node*> _children;
+        std::vector<Node*> _ordered;
+        Node* _instance;
+    };
+
+    typedef std::vector<std::pair<std::string, const Node*>> ParameterList;
 
 public:
     DataModel() = delete;
@@ -52,21 +167,20 @@ public:
 
     DMStatus LoadDM(const std::string& filename);
     DMStatus Parameters(const std::string& paramName, std::map<uint32_t, std::pair<std::string, std::string>>& paramList) const;
+    DMStatus Parameters(const std::string& paramName, ParameterList& paramList) const;
     bool IsValidParameter(const std::string& paramName, std::string& dataType) const;
-    int DMHandle() { return _dmHandle; }
+    bool IsLoaded() const { return (_root != nullptr); }
+
+    // The node of an object (name ends with a '.') or parameter, numbers match {i} nodes.
+    const Node* Find(const std::string& paramName) const;
 
 private:
-    TiXmlNode* Parameters(TiXmlNode* pParent, const std::string& paramName, std::string& currentParam, std::map<uint32_t, std::pair<std::string, std::string>>& paramList) const;
-    void CheckforParameterMatch(TiXmlNode *pParent, const std::string& paramName, bool& pMatch, std::string& dataType) const;
-    bool IsParamEndsWithInstance(const std::string& paramName) const;
-    void ReplaceWithInstanceNumber(string& paramName, uint16_t instanceNumber) const;
-    bool CheckMatchingParameter(const char* attrValue, const char* paramName, uint32_t& ret) const;
-    bool ValidateParameterInstance(const std::string& paramName, std::string& dataType) const;
-    uint8_t FindInstanceOccurance(const std::string& paramName, std::map<uint8_t, std::pair<std::size_t, std::size_t>>& positions) const;
-    int16_t ParameterInstanceCount(const std::string& paramName) const;
+    void Expand(const Node& node, std::string& path, ParameterList& paramList) const;
+    uint32_t ParameterInstanceCount(const std::string& objectPath) const;
+    static bool IsInstanceNumber(const char segment[], const uint32_t length);
 
 private:
-    int _dmHandle;
+    Node* _root;
     Handler* _handler;
 };
 }
@@ -22,29 +22,139 @@
 namespace WPEFramework {
 namespace WebPA {
 
+void Parameter::Resolution::Run()
+{
+    uint32_t index;
+
+    while ((index = _next.fetch_add(1)) < _groups.size()) {
+        _parent.Resolve(_groups[index], _leaves);
+    }
+}
+
+uint32_t Parameter::Resolver::Worker()
+{
+    if (IsRunning() == true) {
+        _parent.Process();
+    }
+    return (0);
+}
+
 Parameter::Parameter(Handler* handler, DataModel* dataModel)
     : _dataModel(dataModel)
     , _handler(handler)
     , _adminLock()
+    , _profileLock()
+    , _profileLocks()
+    , _cacheLock()
+    , _cache()
+    , _poolLock()
+    , _queue()
+    , _queued(false, false)
+    , _resolvers()
 {
+    for (uint8_t index = 0; index < Resolvers; index++) {
+        Resolver* resolver = new Resolver(*this);
+        ASSERT(resolver != nullptr);
+        _resolvers.push_back(resolver);
+        resolver->Run();
+    }
 }
 
 Parameter::~Parameter()
 {
+    for (Resolver* resolver : _resolvers) {
+        resolver->Stop();
+    }
+
+    // Nothing is queued anymore, wake up all resolvers so they can see they have to stop.
+    _queued.SetEvent();
+
+    for (Resolver* resolver : _resolvers) {
+        resolver->Wait(Core::Thread::STOPPED, Core::infinite);
+        delete resolver;
+    }
+    _resolvers.clear();
 }
+
 const void Parameter::Values(const std::vector<std::string>& parameterNames, std::map<std::vector<Data>, WebPAStatus>& parametersList) const
 {
-    for (auto& name: parameterNames) {
-        std::vector<Data> parameters;
+    const uint64_t start = Core::Time::Now().Ticks();
+
+    std::vector<Leaf> leaves;
+    std::vector<WebPAStatus> status;
+    status.reserve(parameterNames.size());
+
+    // Translate all requested names (wildcards included) into the leaves to read.
+    for (uint16_t index = 0; index < parameterNames.size(); index++) {
+        status.push_back(Expand(parameterNames[index], index, leaves));
+    }
+
+    const uint64_t expanded = Core::Time::Now().Ticks();
+
+    // Serve what we can from the cache, group the rest per profile.
+    std::vector<Group> groups;
+    std::map<std::string, uint32_t> groupIndex;
+    uint32_t hits = 0;
+
+    for (uint32_t index = 0; index < leaves.size(); index++) {
+        if (Lookup(leaves[index], expanded) == true) {
+            hits++;
+        } else {
+            const std::string profile(Handler::Profile(leaves[index].Value.Name()));
+            std::map<std::string, uint32_t>::iterator entry(groupIndex.find(profile));
+
+            if (entry == groupIndex.end()) {
+                entry = groupIndex.insert(std::make_pair(profile, static_cast<uint32_t>(groups.size()))).first;
+                groups.push_back(Group(profile));
+            }
+            groups[entry->second].Leaves.push_back(index);
+        }
+    }
+
+    if (groups.size() == 1) {
+        Resolve(groups.front(), leaves);
+    } else if (groups.size() > 1) {
+        // The requesting thread takes its share as well, the resolvers pick up the other profiles.
+        Resolution resolution(*this, leaves, groups);
+        uint32_t helpers = static_cast<uint32_t>(groups.size() - 1);
 
-        WebPAStatus ret = Values(name, parameters);
-        parametersList.insert(std::make_pair(parameters, ret));
-        if ((ret == WEBPA_SUCCESS) && (parameters.size() > 0)) {
-            TRACE(Trace::Information, (_T( "Parameter Name: %s return: %d"), name.c_str(), parameters.size()));
+        Submit(resolution, (helpers > Resolvers ? Resolvers : helpers));
+        resolution.Run();
+        Revoke(resolution);
+    }
+
+    const uint64_t resolved = Core::Time::Now().Ticks();
+
+    std::vector<std::vector<Data>> results(parameterNames.size());
+
+    for (Leaf& leaf : leaves) {
+        WebPAStatus ret = Utils::ConvertFaultCodeToWPAStatus(leaf.Fault);
+
+        // Fill Only if we can able to get Proper value
+        if (WEBPA_SUCCESS == ret) {
+            Store(leaf, resolved);
+            results[leaf.Origin].push_back(leaf.Value);
+            status[leaf.Origin] = WEBPA_SUCCESS; //Set status as success, if there is atleast one parameter
+        } else if (Utils::IsWildCardParam(parameterNames[leaf.Origin]) == false) {
+            TRACE(Trace::Error, (_T( "Failed Get Param Values From Handler: for Param Name :-  %s"), leaf.Value.Name().c_str()));
+            status[leaf.Origin] = ret;
+        }
+    }
+
+    for (uint16_t index = 0; index < parameterNames.size(); index++) {
+        parametersList.insert(std::make_pair(results[index], status[index]));
+        if ((status[index] == WEBPA_SUCCESS) && (results[index].size() > 0)) {
+            TRACE(Trace::Information, (_T( "Parameter Name: %s return: %d"), parameterNames[index].c_str(), results[index].size()));
         } else {
-            TRACE(Trace::Information, (_T( "Parameter Name: %s return no value, so keeping empty values to get the status")));
+            TRACE(Trace::Information, (_T( "Parameter Name: %s return no value, so keeping empty values to get the status"), parameterNames[index].c_str()));
         }
     }
+
+    for (const Group& group : groups) {
+        TRACE(Trace::Information, (_T("Profile %s: %d parameters in %llu us"), group.Profile.c_str(), group.Leaves.size(), group.Duration));
+    }
+    TRACE(Trace::Information, (_T("GET of %d names: %d parameters, %d from cache, %d profiles, expand %llu us, resolve %llu us, total %llu us"),
+        parameterNames.size(), leaves.size(), hits, groups.size(), expanded - start, resolved - expanded, Core::Time::Now().Ticks() - start));
 }
 
 WebPAStatus Parameter::Values(const std::vector<Data>& parameters, std::vector<WebPAStatus>& status)
@@ -59,64 +169,36 @@ WebPAStatus Parameter::Values(const std::vector<Data>& parameters, std::vector<W
     return ret;
 }
 
-const WebPAStatus Parameter::Values(const std::string& parameterName, std::vector<Data>& parameters) const
+WebPAStatus Parameter::Expand(const std::string& parameterName, const uint16_t origin, std::vector<Leaf>& leaves) const
 {
-    WebPAStatus status = WEBPA_FAILURE; // Overall get status
-
-    int32_t dmHandle = _dataModel->DMHandle();
+    WebPAStatus status = WEBPA_FAILURE;
 
-    if (dmHandle) {
+    if (_dataModel->IsLoaded() == true) {
         if (Utils::IsWildCardParam(parameterName)) { // It is a wildcard Param
-            /* Translate wildcard to list of parameters */
-            std::map<uint32_t, std::pair<std::string, std::string>> dmParamters;
-            DMStatus dmRet = _dataModel->Parameters(parameterName, dmParamters);
-            if (dmRet == DM_SUCCESS && dmParamters.size() > 0) {
-                for (auto&  dmParamter:  dmParamters) {
-                    Variant value(Utils::ConvertToParamType(dmParamter.second.second));
-                    Data param(dmParamter.second.first, value);
-
-                    _adminLock.Lock();
-                    WebPAStatus ret = Utils::ConvertFaultCodeToWPAStatus((static_cast<const Handler&>(*_handler)).Parameter(param));
-                    _adminLock.Unlock();
-
-                    // Fill Only if we can able to get Proper value
-                    if (WEBPA_SUCCESS == ret) {
-                        parameters.push_back(param);
-                        status = WEBPA_SUCCESS; //Set status as success, if there is atleast one parameter
-                    }
-                } // End of Wild card for loop
+            /* Translate wildcard to list of parameters, the status is set once one of them is read */
+            DataModel::ParameterList dmParameters;
+            DMStatus dmRet = _dataModel->Parameters(parameterName, dmParameters);
+            if (dmRet == DM_SUCCESS && dmParameters.size() > 0) {
+                for (const std::pair<std::string, const DataModel::Node*>& dmParameter : dmParameters) {
+                    leaves.push_back(Leaf(dmParameter.first, Variant(dmParameter.second->ParamType()), origin, dmParameter.second->TimeToLive()));
+                }
             } else {
                 TRACE(Trace::Error, (_T( " Wild card Param list is empty")));
-                status = WEBPA_FAILURE;
             }
-            dmParamters.clear();
-
         } else { // Not a wildcard Parameter Lets fill it
-            TRACE(Trace::Information, (_T( "Get Request for a Non-WildCard Parameter")));
-            std::string dataType;
+            const DataModel::Node* node = _dataModel->Find(parameterName);
 
-            if (_dataModel->IsValidParameter (parameterName, dataType)) {
+            if ((node != nullptr) && (node->IsParameter() == true)) {
                 TRACE(Trace::Information, (_T( "Valid Parameter..! ")));
-                Variant value(Utils::ConvertToParamType(dataType));
-                Data param(parameterName, value);
-
-                // Convert param.paramType to ParamVal.type
-                TRACE(Trace::Information, (_T( " Values parameterType is %d"), dataType));
-                _adminLock.Lock();
-                status = Utils::ConvertFaultCodeToWPAStatus((static_cast<const Handler&>(*_handler)).Parameter(param));
-                _adminLock.Unlock();
-                if (WEBPA_SUCCESS == status) {
-                    parameters.push_back(param);
-                } else {
-                    TRACE(Trace::Error, (_T( "Failed Get Param Values From Handler: for Param Name :-  %s"), parameterName));
-                }
+                leaves.push_back(Leaf(parameterName, Variant(node->ParamType()), origin, node->TimeToLive()));
+                status = WEBPA_SUCCESS;
             } else {
-                TRACE(Trace::Error, (_T( "Invalid Parameter Name  :-  %s"), parameterName));
+                TRACE(Trace::Error, (_T( "Invalid Parameter Name  :-  %s"), parameterName.c_str()));
                 status = WEBPA_ERR_INVALID_PARAMETER_NAME;
             }
         }
     } else {
-        TRACE(Trace::Error, (_T( "Data base Handle is not Initialized %s"), parameterName));
+        TRACE(Trace::Error, (_T( "Data base Handle is not Initialized %s"), parameterName.c_str()));
     }
     return status;
 }
@@ -125,28 +207,181 @@ WebPAStatus Parameter::Values(const Data& parameter)
 {
     WebPAStatus ret = WEBPA_FAILURE;
 
-    int32_t dmHandle = _dataModel->DMHandle();
-
-    if (dmHandle) {
+    if (_dataModel->IsLoaded() == true) {
 
         std::string dataType;
         if (_dataModel->IsValidParameter(parameter.Name(), dataType)) {
             if (Utils::ConvertToParamType(dataType) == parameter.Value().Type()) {
 
-                _adminLock.Lock();
+                Core::CriticalSection& lock(ProfileLock(Handler::Profile(parameter.Name())));
+                lock.Lock();
                 ret = Utils::ConvertFaultCodeToWPAStatus(_handler->Parameter(parameter));
-                _adminLock.Unlock();
+                lock.Unlock();
+                Invalidate(parameter.Name());
                 TRACE(Trace::Information, (_T("handler::Parameter %d"), ret));
             } else {
                 ret = WEBPA_ERR_INVALID_PARAMETER_TYPE;
             }
         } else {
-            TRACE(Trace::Error, (_T(" Invalid Parameter name %s"), parameter.Name()));
+            TRACE(Trace::Error, (_T(" Invalid Parameter name %s"), parameter.Name().c_str()));
             ret = WEBPA_ERR_INVALID_PARAMETER_NAME;
         }
     }
     return ret;
 }
 
+void Parameter::Resolve(Group& group, std::vector<Leaf>& leaves) const
+{
+    std::vector<Data> values;
+    std::vector<FaultCode> faults;
+
+    values.reserve(group.Leaves.size());
+    for (const uint32_t index : group.Leaves) {
+        values.push_back(leaves[index].Value);
+    }
+
+    const uint64_t start = Core::Time::Now().Ticks();
+
+    Core::CriticalSection& lock(ProfileLock(group.Profile));
+    lock.Lock();
+    (static_cast<const Handler&>(*_handler)).Parameters(values, faults);
+    lock.Unlock();
+
+    group.Duration = Core::Time::Now().Ticks() - start;
+
+    for (uint32_t index = 0; index < group.Leaves.size(); index++) {
+        Leaf& leaf(leaves[group.Leaves[index]]);
+        leaf.Value.Value(values[index].Value());
+        leaf.Fault = faults[index];
+    }
+}
+
+Core::CriticalSection& Parameter::ProfileLock(const std::string& profile) const
+{
+    if (_handler->Reentrant(profile) == false) {
+        return (_profileLock);
+    }
+
+    _adminLock.Lock();
+    // Entries are never removed, so the reference stays valid.
+    Core::CriticalSection& lock(_profileLocks[profile]);
+    _adminLock.Unlock();
+
+    return (lock);
+}
+
+bool Parameter::Lookup(Leaf& leaf, const uint64_t now) const
+{
+    bool found = false;
+
+    if (leaf.TimeToLive > 0) {
+        _cacheLock.Lock();
+
+        std::map<std::string, Cached>::iterator index(_cache.find(leaf.Value.Name()));
+        if (index != _cache.end()) {
+            if (index->second.Expiry > now) {
+                leaf.Value.Value(index->second.Value);
+                found = true;
+            } else {
+                _cache.erase(index);
+            }
+        }
+
+        _cacheLock.Unlock();
+    }
+
+    return (found);
+}
+
+void Parameter::Store(const Leaf& leaf, const uint64_t now) const
+{
+    if (leaf.TimeToLive > 0) {
+        const std::string name(leaf.Value.Name());
+        const uint64_t expiry = now + (static_cast<uint64_t>(leaf.TimeToLive) * 1000);
+
+        _cacheLock.Lock();
+
+        std::map<std::string, Cached>::iterator index(_cache.find(name));
+        if (index != _cache.end()) {
+            // Served from the cache, keep its original expiry.
+            if (index->second.Expiry < now) {
+                index->second = Cached(leaf.Value.Value(), expiry);
+            }
+        } else {
+            _cache.insert(std::make_pair(name, Cached(leaf.Value.Value(), expiry)));
+        }
+
+        _cacheLock.Unlock();
+    }
+}
+
+void Parameter::Invalidate(const std::string& name) const
+{
+    _cacheLock.Lock();
+    _cache.erase(name);
+    _cacheLock.Unlock();
+}
+
+void Parameter::Submit(Resolution& resolution, const uint32_t helpers) const
+{
+    _poolLock.Lock();
+    for (uint32_t index = 0; index < helpers; index++) {
+        _queue.push_back(&resolution);
+    }
+    if (_queue.empty() == false) {
+        _queued.SetEvent();
+    }
+    _poolLock.Unlock();
+}
+
+void Parameter::Revoke(Resolution& resolution) const
+{
+    _poolLock.Lock();
+
+    // Whatever the resolvers did not pick up yet is done already, the requesting thread took it.
+    _queue.remove(&resolution);
+    if (_queue.empty() == true) {
+        _queued.ResetEvent();
+    }
+    const bool busy = (resolution._active > 0);
+
+    _poolLock.Unlock();
+
+    if (busy == true) {
+        resolution._done.Lock(Core::infinite);
+    }
+}
+
+bool Parameter::Process()
+{
+    Resolution* resolution = nullptr;
+
+    _queued.Lock(Core::infinite);
+
+    _poolLock.Lock();
+    if (_queue.empty() == false) {
+        resolution = _queue.front();
+        _queue.pop_front();
+        resolution->_active++;
+
+        if (_queue.empty() == true) {
+            _queued.ResetEvent();
+        }
+    }
+    _poolLock.Unlock();
+
+    if (resolution != nullptr) {
+        resolution->Run();
+
+        _poolLock.Lock();
+        if (--(resolution->_active) == 0) {
+            resolution->_done.SetEvent();
+        }
+        _poolLock.Unlock();
+    }
+
+    return (resolution != nullptr);
+}
+
 } // WebPA
 } // WPEFramework
@@ -23,6 +23,8 @@
 #include "Utils.h"
 #include "DataModel.h"
 
+#include <atomic>
+
 namespace WPEFramework {
 
 namespace WebPA {
@@ -35,6 +37,106 @@ typedef enum
 } WEBPA_SET_TYPE;
 
 class Parameter {
+private:
+    // Threads resolving profiles next to the requesting thread.
+    static constexpr const uint8_t Resolvers = 3;
+
+    // A single (non wildcard) parameter to read, in the order it was requested.
+    struct Leaf {
+        Leaf(const std::string& name, const Variant& value, const uint16_t origin, const uint32_t timeToLive)
+            : Value(name, value)
+            , Origin(origin)
+            , TimeToLive(timeToLive)
+            , Fault(FaultCode::NoFault)
+        {
+        }
+
+        Data Value;
+        uint16_t Origin; // Index of the requested name this leaf was expanded from
+        uint32_t TimeToLive;
+        FaultCode Fault;
+    };
+
+    // All leaves of a request that are handled by the same profile, read as one batch.
+    struct Group {
+        Group(const std::string& profile)
+            : Profile(profile)
+            , Leaves()
+            , Duration(0)
+        {
+        }
+
+        std::string Profile;
+        std::vector<uint32_t> Leaves;
+        uint64_t Duration;
+    };
+
+    class Resolution {
+    public:
+        Resolution() = delete;
+        Resolution(const Resolution&) = delete;
+        Resolution& operator= (const Resolution&) = delete;
+
+        Resolution(const Parameter& parent, std::vector<Leaf>& leaves, std::vector<Group>& groups)
+            : _parent(parent)
+            , _leaves(leaves)
+            , _groups(groups)
+            , _next(0)
+            , _active(0)
+            , _done(false, false)
+        {
+        }
+        ~Resolution()
+        {
+        }
+
+    public:
+        // Claims and resolves groups until all of them are taken, safe to call from several threads.
+        void Run();
+
+    private:
+        friend class Parameter;
+
+        const Parameter& _parent;
+        std::vector<Leaf>& _leaves;
+        std::vector<Group>& _groups;
+        std::atomic<uint32_t> _next;
+        uint32_t _active; // Resolver threads working on this resolution, guarded by the pool lock
+        Core::Event _done;
+    };
+
+    class Resolver : public Core::Thread {
+    public:
+        Resolver() = delete;
+        Resolver(const Resolver&) = delete;
+        Resolver& operator= (const Resolver&) = delete;
+
+        Resolver(Parameter& parent)
+            : Core::Thread(Core::Thread::DefaultStackSize(), _T("WebPAResolver"))
+            , _parent(parent)
+        {
+        }
+        virtual ~Resolver()
+        {
+        }
+
+    private:
+        virtual uint32_t Worker() override;
+
+    private:
+        Parameter& _parent;
+    };
+
+    struct Cached {
+        Cached(const Variant& value, const uint64_t expiry)
+            : Value(value)
+            , Expiry(expiry)
+        {
+        }
+
+        Variant Value;
+        uint64_t Expiry;
+    };
 
 public:
     Parameter() = delete;
@@ -49,14 +151,36 @@ public:
     WebPAStatus Values(const std::vector<Data>& parameters, std::vector<WebPAStatus>& status);
 
 private:
-    const WebPAStatus Values(const std::string& parameterName, std::vector<Data>& parameters) const;
+    WebPAStatus Expand(const std::string& parameterName, const uint16_t origin, std::vector<Leaf>& leaves) const;
     WebPAStatus Values(const Data& parameter);
 
+    void Resolve(Group& group, std::vector<Leaf>& leaves) const;
+    Core::CriticalSection& ProfileLock(const std::string& profile) const;
+    bool Lookup(Leaf& leaf, const uint64_t now) const;
+    void Store(const Leaf& leaf, const uint64_t now) const;
+    void Invalidate(const std::string& name) const;
+
+    void Submit(Resolution& resolution, const uint32_t helpers) const;
+    void Revoke(Resolution& resolution) const;
+    bool Process();
+
 private:
     DataModel* _dataModel;
     Handler* _handler;
 
     mutable Core::CriticalSection _adminLock;
+    // Profiles are not known to be reentrant: all calls into them are serialized on _profileLock,
+    // only profiles configured as "reentrant" get a lock of their own and run next to the others.
+    mutable Core::CriticalSection _profileLock;
+    mutable std::map<std::string, Core::CriticalSection> _profileLocks;
+
+    mutable Core::CriticalSection _cacheLock;
+    mutable std::map<std::string, Cached> _cache;
+
+    mutable Core::CriticalSection _poolLock;
+    mutable std::list<Resolution*> _queue;
+    mutable Core::Event _queued;
+    std::list<Resolver*> _resolvers;
 };
 
 } // WebPA
@@ -103,6 +103,7 @@ uint32_t Handler::Configure(PluginHost::IShell* service)
         if (name.empty() == false) {
             SystemProfileController systemProfileController;
             systemProfileController.name = name;
+            systemProfileController.reentrant = index.Current().Reentrant.Value();
 
             systemProfileController.control = WebPAProfileInstance(name.c_str());
             if (systemProfileController.control) {
@@ -164,6 +165,47 @@ FaultCode Handler::Parameter(const Data& parameter)
     return ret;
 }
 
+void Handler::Parameters(std::vector<Data>& parameters, std::vector<FaultCode>& faults) const
+{
+    TRACE(Trace::Information, (string(__FUNCTION__)));
+
+    faults.assign(parameters.size(), FaultCode::NoFault);
+
+    if (parameters.empty() == false) {
+        /* All parameters share the same manager, find it once */
+        const IProfileControl* control = GetProfileController(parameters.front().Name());
+
+        if (control) {
+            for (uint32_t index = 0; index < parameters.size(); index++) {
+                ASSERT(Profile(parameters[index].Name()) == Profile(parameters.front().Name()));
+                faults[index] = control->Parameter(parameters[index]);
+            }
+        } else {
+            faults.assign(parameters.size(), FaultCode::InvalidParameterName);
+        }
+    }
+}
+
+/* static */ std::string Handler::Profile(const std::string& name)
+{
+    std::string profile;
+    std::size_t start = name.find('.');
+
+    if (start != std::string::npos) {
+        std::size_t end = name.find('.', start + 1);
+        profile = name.substr(start + 1, (end == std::string::npos ? std::string::npos : end - start - 1));
+    }
+
+    return profile;
+}
+
+bool Handler::Reentrant(const std::string& profile) const
+{
+    std::map<const std::string, SystemProfileController>::const_iterator index(_systemProfileControllers.find(profile));
+
+    return ((index != _systemProfileControllers.end()) && (index->second.reentrant == true));
+}
+
 const FaultCode Handler::Attribute(Data& parameter) const
 {
     TRACE(Trace::Information, (string(__FUNCTION__)));
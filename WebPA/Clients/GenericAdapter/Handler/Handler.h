@@ -67,15 +67,19 @@ public:
         public:
             Link ()
                 : ProfileName()
-                , ProfileControl() {
+                , ProfileControl()
+                , Reentrant(false) {
                 Add("profilename", &ProfileName);
                 Add("profilecontrol", &ProfileControl);
+                Add("reentrant", &Reentrant);
             }
             Link (const Link& copy)
                 : ProfileName(copy.ProfileName)
-                , ProfileControl(copy.ProfileControl) {
+                , ProfileControl(copy.ProfileControl)
+                , Reentrant(copy.Reentrant) {
                 Add("profilename", &ProfileName);
                 Add("profilecontrol", &ProfileControl);
+                Add("reentrant", &Reentrant);
             }
             virtual ~Link() {
             }
@@ -83,6 +87,8 @@ public:
         public:
             Core::JSON::String ProfileName;
             Core::JSON::String ProfileControl;
+            // The profile shares no state with other profiles and may be called next to them.
+            Core::JSON::Boolean Reentrant;
         };
 
     public:
@@ -128,6 +134,7 @@ public:
     struct SystemProfileController {
         std::string name;
         IProfileControl* control;
+        bool reentrant;
     };
 
 public:
@@ -141,6 +148,13 @@ public:
     const FaultCode Parameter(Data& value) const;
     FaultCode Parameter(const Data& value);
 
+    // Reads parameters that all belong to the same profile, with a single controller lookup.
+    void Parameters(std::vector<Data>& values, std::vector<FaultCode>& faults) const;
+    // Name of the profile handling a parameter, "Device.<Profile>.<...>".
+    static std::string Profile(const std::string& name);
+    // True if the profile was configured to be called next to other profiles.
+    bool Reentrant(const std::string& profile) const;
+
     const FaultCode Attribute(Data& value) const;
     FaultCode Attribute(const Data& value);
 
@@ -19,50 +19,70 @@
 
 #include "WebShell.h"
 
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
 namespace WPEFramework {
 namespace Plugin {
 
     SERVICE_REGISTRATION(WebShell, 1, 0);
 
-#define SLOT_ALLOCATION 8
-
     class SessionMonitor : public Core::Thread {
     private:
-        class Session {
-        private:
-            Session& operator=(const Session&);
+        // Per session, the stdin, stdout and stderr of the shell are watched. The kind is stored in the
+        // lower bits of the epoll data, the channel id in the upper bits.
+        enum kind : uint8_t {
+            SHELL_INPUT = 0,
+            SHELL_OUTPUT = 1,
+            SHELL_ERROR = 2,
+            WAKEUP = 3
+        };
 
+        class Session {
         public:
-            Session()
-                : _channel()
-                , _process()
-                , _buffer()
-                , _leftSize(0)
-            {
-            }
-            Session(PluginHost::Channel& channel, Core::ProxyType<Core::Process> process)
+            Session() = delete;
+            Session(const Session&) = delete;
+            Session& operator=(const Session&) = delete;
+
+            Session(PluginHost::Channel& channel, Core::ProxyType<Core::Process> process, const uint32_t bufferSize)
                 : _channel(&channel)
                 , _process(process)
-                , _buffer()
-                , _leftSize(0)
-            {
-            }
-            Session(const Session& copy)
-                : _channel(copy._channel)
-                , _process(copy._process)
-                , _buffer()
                 , _leftSize(0)
+                , _tailOffset(0)
+                , _tailSize(0)
+                , _armed(false)
             {
+                _backlog[0] = -1;
+                _backlog[1] = -1;
+
+                // Data that the shell can not take yet is parked in a pipe, so it can be spliced into the stdin of
+                // the shell later on, without passing through user space again.
+                if (::pipe2(_backlog, O_NONBLOCK | O_CLOEXEC) == 0) {
+                    ::fcntl(_backlog[1], F_SETPIPE_SZ, bufferSize);
+                }
+
+                ::fcntl(_process->Input(), F_SETFL, ::fcntl(_process->Input(), F_GETFL) | O_NONBLOCK);
+                ::fcntl(_process->Output(), F_SETFL, ::fcntl(_process->Output(), F_GETFL) | O_NONBLOCK);
+                ::fcntl(_process->Error(), F_SETFL, ::fcntl(_process->Error(), F_GETFL) | O_NONBLOCK);
+
+                // The larger the pipes from the shell, the larger the websocket frames we can fill in one go.
+                ::fcntl(_process->Output(), F_SETPIPE_SZ, bufferSize);
+                ::fcntl(_process->Error(), F_SETPIPE_SZ, bufferSize);
             }
             ~Session()
             {
+                if (_backlog[0] != -1) {
+                    ::close(_backlog[0]);
+                    ::close(_backlog[1]);
+                }
             }
 
         public:
-            inline void Release()
+            inline uint32_t Id() const
             {
-                _channel = nullptr;
-                _process.Release();
+                ASSERT(_channel != nullptr);
+                return (_channel->Id());
             }
             inline PluginHost::Channel& Channel()
             {
@@ -94,40 +114,91 @@ namespace Plugin {
             {
                 return (!operator==(rhs));
             }
-            inline bool operator==(const Core::ProxyType<Core::Process>& rhs) const
+            uint32_t Backup(const uint8_t data[], const uint32_t size)
             {
-                return (rhs == _process);
-            }
-            inline bool operator!=(const Core::ProxyType<Core::Process>& rhs) const
-            {
-                return (!operator==(rhs));
+                int result = ::write(_backlog[1], data, size);
+
+                if (result > 0) {
+                    _leftSize += result;
+                }
+
+                return (result > 0 ? result : 0);
             }
-            uint16_t Backup(const uint8_t data[], const uint16_t size)
+            // Move the parked data into the stdin of the shell, returns true if everything is written.
+            bool Write()
             {
-                uint16_t copySize = (size <= (sizeof(_buffer) - _leftSize) ? size : (sizeof(_buffer) - _leftSize));
+                while (_leftSize > 0) {
+                    ssize_t moved;
+
+                    if (_tailOffset < _tailSize) {
+                        // What was left of a partial copy goes first, to keep the order.
+                        moved = ::write(_process->Input(), &(_tail[_tailOffset]), _tailSize - _tailOffset);
+
+                        if (moved > 0) {
+                            _tailOffset += static_cast<uint16_t>(moved);
+                        }
+                    } else {
+                        moved = ::splice(_backlog[0], nullptr, _process->Input(), nullptr, _leftSize, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+
+                        if ((moved < 0) && (errno == EINVAL)) {
+                            // Not spliceable, fall back to copying. The part the shell does not take stays in the tail.
+                            ssize_t loaded = ::read(_backlog[0], _tail, std::min(sizeof(_tail), static_cast<size_t>(_leftSize)));
+
+                            _tailOffset = 0;
+                            _tailSize = static_cast<uint16_t>(loaded > 0 ? loaded : 0);
 
-                ::memcpy(&(_buffer[_leftSize]), data, copySize);
-                _leftSize += copySize;
-                return (copySize);
+                            moved = (loaded > 0 ? ::write(_process->Input(), _tail, loaded) : loaded);
+
+                            if (moved > 0) {
+                                _tailOffset = static_cast<uint16_t>(moved);
+                            }
+                        }
+                    }
+
+                    if (moved <= 0) {
+                        break;
+                    }
+
+                    _leftSize -= static_cast<uint32_t>(moved);
+                }
+
+                return (_leftSize == 0);
             }
-            void Write()
+            // The shell does not read anymore, drop whatever is parked.
+            void Discard()
             {
-                uint32_t writtenBytes = ::write(_process->Input(), _buffer, _leftSize);
-                if (writtenBytes < _leftSize) {
-                    ::memcpy(_buffer, &(_buffer[writtenBytes]), (_leftSize - writtenBytes));
+                uint8_t buffer[4096];
+
+                while (::read(_backlog[0], buffer, sizeof(buffer)) > 0) {
                 }
-                _leftSize -= writtenBytes;
+
+                _leftSize = 0;
+                _tailOffset = 0;
+                _tailSize = 0;
             }
             bool WriteRequired() const
             {
                 return (_leftSize != 0);
             }
+            // Whether stdin of the shell is in the epoll interest set.
+            bool IsArmed() const
+            {
+                return (_armed);
+            }
+            void Armed(const bool armed)
+            {
+                _armed = armed;
+            }
 
         private:
             PluginHost::Channel* _channel;
             Core::ProxyType<Core::Process> _process;
-            uint8_t _buffer[1024];
-            uint32_t _leftSize;
+            int _backlog[2];
+            uint32_t _leftSize; // Parked in the backlog pipe and the tail
+            uint8_t _tail[4096];
+            uint16_t _tailOffset;
+            uint16_t _tailSize;
+            bool _armed;
         };
 
         typedef std::list<Session> Sessions;
@@ -136,22 +207,32 @@ namespace Plugin {
         SessionMonitor& operator=(const SessionMonitor&) = delete;
 
         static constexpr uint32_t MonitorStackSize = 64 * 1024;
+        static constexpr uint8_t MaxEvents = 16;
 
     public:
-        SessionMonitor()
+        SessionMonitor(const uint32_t bufferSize)
             : Core::Thread(MonitorStackSize, _T("SessionHandler"))
             , _adminLock()
             , _sessions()
-            , _signalFD(-1)
-            , _maxSlots(SLOT_ALLOCATION)
-            , _slots(static_cast<struct pollfd*>(::malloc((sizeof(struct pollfd) * (_maxSlots + 1)))))
+            , _bufferSize(bufferSize)
+            , _epoll(::epoll_create1(EPOLL_CLOEXEC))
+            , _wakeup(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
         {
+            Watch(EPOLL_CTL_ADD, _wakeup, 0, WAKEUP, EPOLLIN);
         }
         ~SessionMonitor()
         {
             Stop();
 
-            Wait(Thread::STOPPED, Core::infinite);
+            uint64_t value = 1;
+            (void)::write(_wakeup, &value, sizeof(value));
+
+            Wait(Thread::STOPPED | Thread::INITIALIZED, Core::infinite);
+
+            _sessions.clear();
+
+            ::close(_wakeup);
+            ::close(_epoll);
         }
 
     public:
@@ -171,13 +252,16 @@ namespace Plugin {
 
                 _adminLock.Lock();
 
-                _sessions.push_back(Session(channel, process));
+                _sessions.emplace_back(channel, process, _bufferSize);
 
-                if (_sessions.size() == 1) {
-                    Run();
-                } else {
-                    Signal(SIGUSR2);
-                }
+                // The interest set is kept up to date as sessions come and go, no need to wake the monitor.
+                // stdin is only in the interest set while there is data parked for it: epoll reports a hang up
+                // even with an empty event mask, so an idle stdin of an exited shell would keep on firing. The
+                // output is armed once and re-armed after the channel has pulled the data.
+                Watch(EPOLL_CTL_ADD, process->Output(), channel.Id(), SHELL_OUTPUT, EPOLLIN | EPOLLONESHOT);
+                Watch(EPOLL_CTL_ADD, process->Error(), channel.Id(), SHELL_ERROR, EPOLLIN | EPOLLONESHOT);
+
+                Run();
 
                 _adminLock.Unlock();
             }
@@ -193,10 +277,13 @@ namespace Plugin {
             ASSERT(index != _sessions.end());
 
             if (index != _sessions.end()) {
+                Core::ProxyType<Core::Process> process(index->Process());
 
-                index->Release();
+                Disarm(*index);
+                ::epoll_ctl(_epoll, EPOLL_CTL_DEL, process->Output(), nullptr);
+                ::epoll_ctl(_epoll, EPOLL_CTL_DEL, process->Error(), nullptr);
 
-                Signal(SIGUSR2);
+                _sessions.erase(index);
             }
 
             _adminLock.Unlock();
@@ -205,225 +292,182 @@ namespace Plugin {
         uint32_t Read(const uint32_t channelId, uint8_t data[], const uint16_t length) const
         {
             uint32_t result = 0;
-            Sessions::const_iterator index(_sessions.begin());
 
-            while ((index != _sessions.end()) && (index->Channel().Id() != channelId))
-                index++;
+            _adminLock.Lock();
+
+            Sessions::const_iterator index(Find(channelId));
 
             if (index != _sessions.end()) {
+                const Core::ProxyType<Core::Process> process(index->Process());
 
-                // Seems we found a process that could feed this stream.
-                int load = ::read(index->Process()->Output(), data, length);
+                bool closed = false;
 
-                if (load > 0) {
-                    result = load;
-                }
+                // Fill the frame as much as possible, first from the output, than from the error stream.
+                result = Load(process->Output(), data, length, closed);
+                result += Load(process->Error(), &(data[result]), (length - result), closed);
 
-                // Is there still some space left to load the the error stream ?
-                if (result < length) {
-                    load = ::read(index->Process()->Error(), &(data[result]), (length - result));
-
-                    if (load > 0) {
-                        result += load;
-                    }
-                }
                 if (result < length) {
                     data[result] = '\0';
                 }
+
+                if (closed == false) {
+                    // Whatever is still left will trigger a new outbound request.
+                    Watch(EPOLL_CTL_MOD, process->Output(), channelId, SHELL_OUTPUT, EPOLLIN | EPOLLONESHOT);
+                    Watch(EPOLL_CTL_MOD, process->Error(), channelId, SHELL_ERROR, EPOLLIN | EPOLLONESHOT);
+                }
             }
 
+            _adminLock.Unlock();
+
             return (result);
         }
         uint32_t Write(const uint32_t channelId, const uint8_t data[], const uint16_t length)
         {
             uint32_t result = 0;
-            Sessions::iterator index(_sessions.begin());
 
-            while ((index != _sessions.end()) && (index->Channel().Id() != channelId))
-                index++;
+            _adminLock.Lock();
+
+            Sessions::iterator index(Find(channelId));
 
             if (index != _sessions.end()) {
-                // Seems we found a process that should receive the data..
-                result = ::write(index->Process()->Input(), data, length);
+                // Seems we found a process that should receive the data.. Only directly, if nothing is parked,
+                // otherwise the order gets mixed up.
+                if (index->WriteRequired() == false) {
+                    int written = ::write(index->Process()->Input(), data, length);
+                    result = (written > 0 ? written : 0);
+                }
 
                 if (result < length) {
                     // We need to backup the data, we could not push
                     result += index->Backup(&data[result], (length - result));
 
-                    // Make sure we will read the input again..
-                    Signal(SIGUSR2);
+                    // Make sure we will write it as soon as the shell can take it.
+                    Arm(*index);
                 }
             }
+
+            _adminLock.Unlock();
+
             return (result);
         }
 
     private:
-        virtual bool Initialize()
+        void Watch(const int operation, const int fd, const uint32_t channelId, const kind type, const uint32_t events) const
         {
-            int err;
-            sigset_t sigset;
-
-            /* Create a sigset of all the signals that we're interested in */
-            err = sigemptyset(&sigset);
-            ASSERT(err == 0);
-            err = sigaddset(&sigset, SIGUSR2);
-            ASSERT(err == 0);
-
-            /* We must block the signals in order for signalfd to receive them */
-            err = pthread_sigmask(SIG_BLOCK, &sigset, nullptr);
-
-            assert(err == 0);
-
-            /* Create the signalfd */
-            _signalFD = signalfd(-1, &sigset, 0);
-            ASSERT(_signalFD != -1);
+            struct epoll_event event;
+            event.events = events;
+            event.data.u64 = ((static_cast<uint64_t>(channelId) << 8) | type);
 
-            return (err == 0);
+            if (::epoll_ctl(_epoll, operation, fd, &event) < 0) {
+                TRACE_L1("epoll_ctl failed on descriptor %d with error <%d>", fd, errno);
+            }
         }
-
-        virtual uint32_t Worker()
+        static uint32_t Load(const int fd, uint8_t data[], const uint32_t length, bool& closed)
         {
+            uint32_t result = 0;
+            int load = 1;
 
-            uint32_t delay = 0;
-
-            // Add entries not in the Array before we start !!!
-            _adminLock.Lock();
-
-            // Do we have enough space to allocate all file descriptors ?
-            if (((_sessions.size() * 3) + 1) > _maxSlots) {
-                _maxSlots = (((((_sessions.size() * 3) + 1) / SLOT_ALLOCATION) + 1) * SLOT_ALLOCATION);
-
-                ::free(_slots);
-
-                // Resize the array to fit..
-                _slots = static_cast<struct pollfd*>(::malloc(sizeof(struct pollfd) * _maxSlots));
-
-                _slots[0].fd = _signalFD;
-                _slots[0].events = POLLIN;
-                _slots[0].revents = 0;
+            while ((result < length) && ((load = ::read(fd, &(data[result]), (length - result))) > 0)) {
+                result += load;
             }
 
-            int filledFileDescriptors = 1;
-            Sessions::iterator index(_sessions.begin());
-
-            // Fill in all entries required/updated..
-            while (index != _sessions.end()) {
-                Core::ProxyType<Core::Process> port(index->Process());
+            // The shell is gone, no need to keep on watching it.
+            closed = closed || (load == 0);
 
-                if (port.IsValid() == false) {
-                    index = _sessions.erase(index);
+            return (result);
+        }
+        Sessions::iterator Find(const uint32_t channelId)
+        {
+            Sessions::iterator index(_sessions.begin());
 
-                    if (_sessions.size() == 0) {
-                        Block();
-                        delay = Core::infinite;
-                    }
-                } else {
-                    _slots[filledFileDescriptors].fd = port->Input();
-                    _slots[filledFileDescriptors].events = (index->WriteRequired() ? POLLOUT : 0);
-                    _slots[filledFileDescriptors].revents = 0;
-                    filledFileDescriptors++;
-                    _slots[filledFileDescriptors].fd = port->Output();
-                    _slots[filledFileDescriptors].events = POLLIN;
-                    _slots[filledFileDescriptors].revents = 0;
-                    filledFileDescriptors++;
-                    _slots[filledFileDescriptors].fd = port->Error();
-                    _slots[filledFileDescriptors].events = POLLIN;
-                    _slots[filledFileDescriptors].revents = 0;
-                    filledFileDescriptors++;
-                    index++;
-                }
+            while ((index != _sessions.end()) && (index->Id() != channelId)) {
+                index++;
             }
 
-            if (filledFileDescriptors > 1) {
-                _adminLock.Unlock();
-
-                int result = poll(_slots, filledFileDescriptors, -1);
-
-                _adminLock.Lock();
+            return (index);
+        }
+        Sessions::const_iterator Find(const uint32_t channelId) const
+        {
+            Sessions::const_iterator index(_sessions.begin());
 
-                if (result == -1) {
-                    TRACE_L1("poll failed with error <%d>", errno);
-                } else if (_slots[0].revents & POLLIN) {
-                    /* We have a valid signal, read the info from the fd */
-                    struct signalfd_siginfo info;
+            while ((index != _sessions.end()) && (index->Id() != channelId)) {
+                index++;
+            }
 
-                    uint32_t VARIABLE_IS_NOT_USED bytes = read(_signalFD, &info, sizeof(info));
+            return (index);
+        }
+        virtual uint32_t Worker()
+        {
+            struct epoll_event events[MaxEvents];
 
-                    ASSERT(bytes == sizeof(info));
+            int result = ::epoll_wait(_epoll, events, MaxEvents, -1);
 
-                    // Clear the signal port..
-                    _slots[0].revents = 0;
+            if (result == -1) {
+                if (errno != EINTR) {
+                    TRACE_L1("epoll_wait failed with error <%d>", errno);
                 }
-            } else {
-                Block();
-                delay = Core::infinite;
             }
 
-            // We are only interested in the filedescriptors that have a corresponding client.
-            // We also know that once a file descriptor is not found, we handled them all...
-            int fd_index = 1;
-            index = _sessions.begin();
-
-            while ((index != _sessions.end()) && (fd_index < filledFileDescriptors)) {
-                Core::ProxyType<Core::Process> port(index->Process());
+            _adminLock.Lock();
 
-                if (port.IsValid() == false) {
-                    index = _sessions.erase(index);
+            for (int slot = 0; slot < result; slot++) {
+                const kind type = static_cast<kind>(events[slot].data.u64 & 0xFF);
 
-                    if (_sessions.size() == 0) {
-                        Block();
-                        delay = Core::infinite;
-                    }
+                if (type == WAKEUP) {
+                    uint64_t value;
+                    (void)::read(_wakeup, &value, sizeof(value));
                 } else {
-                    int fd = port->Input();
-
-                    // Find the current file descriptor in our array..
-                    while ((fd_index < filledFileDescriptors) && (_slots[fd_index].fd != fd)) {
-                        fd_index += 3;
-                    }
-
-                    if (fd_index < filledFileDescriptors) {
-                        if ((_slots[fd_index].revents & POLLOUT) != 0) {
-                            Input(*index);
-                        }
-                        if ((_slots[fd_index + 1].revents & POLLIN) != 0) {
-                            Output(*index);
-                        }
-                        if ((_slots[fd_index + 2].revents & POLLIN) != 0) {
-                            Error(*index);
+                    // The session might have been closed in the mean time.
+                    Sessions::iterator index(Find(static_cast<uint32_t>(events[slot].data.u64 >> 8)));
+
+                    if (index != _sessions.end()) {
+                        if (type == SHELL_INPUT) {
+                            Input(*index, events[slot].events);
+                        } else {
+                            // Output and Error, the channel will pull both streams in one go.
+                            index->Channel().RequestOutbound();
                         }
                     }
                 }
-
-                index++;
-                fd_index += 3;
             }
 
             _adminLock.Unlock();
 
-            return (delay);
+            return (0);
         }
 
-        void Input(Session& session)
+        void Input(Session& session, const uint32_t events)
         {
-            // See if there was somthing left..
-            session.Write();
+            if ((events & (EPOLLERR | EPOLLHUP)) != 0) {
+                // The shell closed its stdin, the parked data can not be delivered anymore.
+                session.Discard();
+                Disarm(session);
+            } else if (session.Write() == true) {
+                // All written, no need to know when the shell can take more.
+                Disarm(session);
+            }
         }
-        void Output(Session& session)
+        void Arm(Session& session)
         {
-            session.Channel().RequestOutbound();
+            if (session.IsArmed() == false) {
+                Watch(EPOLL_CTL_ADD, session.Process()->Input(), session.Id(), SHELL_INPUT, EPOLLOUT);
+                session.Armed(true);
+            }
         }
-        void Error(Session& session)
+        void Disarm(Session& session)
         {
-            session.Channel().RequestOutbound();
+            if (session.IsArmed() == true) {
+                ::epoll_ctl(_epoll, EPOLL_CTL_DEL, session.Process()->Input(), nullptr);
+                session.Armed(false);
+            }
         }
 
     private:
-        Core::CriticalSection _adminLock;
+        mutable Core::CriticalSection _adminLock;
         Sessions _sessions;
-        int _signalFD;
-        uint32_t _maxSlots;
-        struct pollfd* _slots;
+        const uint32_t _bufferSize;
+        int _epoll;
+        int _wakeup;
     };
 
     /* virtual */ const string WebShell::Initialize(PluginHost::IShell* service)
@@ -434,7 +478,7 @@ namespace Plugin {
 
         service->EnableWebServer(_T("UI"), EMPTY_STRING);
 
-        _sessionMonitor = new SessionMonitor();
+        _sessionMonitor = new SessionMonitor(_config.BufferSize.Value());
 
         ASSERT(_sessionMonitor != nullptr);
 
@@ -127,8 +127,10 @@ namespace Plugin {
             Config()
                 : Core::JSON::Container()
                 , Connections(10)
+                , BufferSize(64 * 1024)
             {
                 Add(_T("connections"), &Connections);
+                Add(_T("buffersize"), &BufferSize);
             }
             ~Config()
             {
@@ -136,6 +138,8 @@ namespace Plugin {
 
         public:
             Core::JSON::DecUInt16 Connections;
+            // Size of the pipes towards and from the shell, in bytes.
+            Core::JSON::DecUInt32 BufferSize;
         };
 
     public:
@@ -288,19 +288,17 @@ namespace WPASupplicant {
 
                     _adminLock.Lock();
 
-                    // Let see what we need to do with this BSSID, add or remove :-)
-                    if ((event == CTRL_EVENT_BSS_ADDED) && (_detailRequest.Set(bssid) == true)) {
-                        // send out a request for detail.
-                        _adminLock.Unlock();
-                        Submit(&_detailRequest);
-                        _adminLock.Lock();
-                    } else if (event == CTRL_EVENT_BSS_REMOVED) {
+                    // Added BSSes are picked up in bulk with the scan results that follow, only removals are handled here.
+                    if (event == CTRL_EVENT_BSS_REMOVED) {
 
                         NetworkInfoContainer::iterator network(_networks.find(bssid));
 
                         if (network != _networks.end()) {
                             _networks.erase(network);
                         }
+
+                        // A paged fetch of the table that is still running would bring it back.
+                        _scanRequest.Removed(bssid);
                     }
 
                     if (_callback != nullptr) {
@@ -338,11 +336,17 @@ namespace WPASupplicant {
     }
     // These methods (add/add/update) are assumed to be running in a locked context.
     // Completion of requests are running in a locked context, so oke to update maps/lists
-    void Controller::Add(const uint64_t& bssid, const NetworkInfo& entry)
+    void Controller::Scanned(NetworkInfoContainer& networks)
     {
-        TRACE(Communication, (_T("Added SSID: %llX - %s"), bssid, entry.SSID().c_str()));
-        _networks[bssid] = entry;
-        Reevaluate();
+        TRACE(Communication, (_T("Scanned %d BSSes"), static_cast<uint32_t>(networks.size())));
+
+        // The BSS table of wpa_supplicant is leading, take it over as a whole.
+        _networks.swap(networks);
+
+        if ((_enabled.size() == 0) && (_networkRequest.Set() == true)) {
+            // send out a request for the network list
+            Submit(&_networkRequest);
+        }
     }
     void Controller::Add(const string& ssid, const bool current, const uint64_t& bssid)
     {
@@ -363,31 +367,6 @@ namespace WPASupplicant {
 
         Reevaluate();
     }
-    void Controller::Update(const uint64_t& bssid, const string& ssid, const uint32_t id, uint32_t frequency, const int32_t signal, const uint16_t pairs, const uint32_t keys, const uint32_t throughput)
-    {
-
-        bool scanInProgress = false;
-
-        NetworkInfoContainer::iterator index(_networks.find(bssid));
-
-        if (index != _networks.end()) {
-
-            scanInProgress = (index->second.Id() == static_cast<uint32_t>(~0));
-
-            TRACE(Communication, (_T("Updated BSSID: %llX, %d"), bssid, id));
-
-            index->second.Set(id, ssid, frequency, signal, pairs, keys, throughput);
-        } else {
-            _networks[bssid] = NetworkInfo(id, ssid, frequency, signal, pairs, keys, throughput);
-        }
-
-        if (scanInProgress == true) {
-            Reevaluate();
-        } else if (_callback != nullptr) {
-            _callback->Dispatch(CTRL_EVENT_NETWORK_CHANGED);
-        }
-    }
-
     void Controller::Update(const string& ssid, const uint32_t id, const bool succeeded)
     {
         NetworkInfoContainer::iterator index(_networks.begin());
@@ -410,21 +389,9 @@ namespace WPASupplicant {
     }
     void Controller::Reevaluate()
     {
-
-        NetworkInfoContainer::iterator index(_networks.begin());
-
-        while ((index != _networks.end()) && (index->second.HasDetail() == true)) {
-            index++;
-        }
-        if (index != _networks.end()) {
-            if (_detailRequest.Set(index->first) == true) {
-                // send out a request for detail.
-                Submit(&_detailRequest);
-            }
-        } else if (_enabled.size() == 0) {
+        if (_enabled.size() == 0) {
             // send out a request for the network list
             if (_networkRequest.Set() == true) {
-                // send out a request for detail.
                 Submit(&_networkRequest);
             }
         } else {
@@ -23,6 +23,8 @@
 #include "Module.h"
 #include "Network.h"
 
+#include <set>
+
 // Interface specification taken from:
 // https://w1.fi/wpa_supplicant/devel/ctrl_iface_page.html
 
@@ -221,9 +223,11 @@ namespace WPASupplicant {
                 , _id(~0)
                 , _throughput(0)
                 , _hidden(true)
+                , _seen(0)
             {
             }
             NetworkInfo(const uint32_t id, const string& ssid, const uint32_t frequency, const int32_t signal, const uint16_t pairs, const uint32_t keys, const uint32_t throughput)
+                : _seen(0)
             {
                 Set(id, ssid, frequency, signal, pairs, keys, throughput);
             }
@@ -236,6 +240,7 @@ namespace WPASupplicant {
                 , _id(copy._id)
                 , _throughput(copy._throughput)
                 , _hidden(copy._hidden)
+                , _seen(copy._seen)
             {
             }
             ~NetworkInfo()
@@ -252,6 +257,7 @@ namespace WPASupplicant {
                 _id = rhs._id;
                 _throughput = rhs._throughput;
                 _hidden = rhs._hidden;
+                _seen = rhs._seen;
 
                 return (*this);
             }
@@ -267,6 +273,9 @@ namespace WPASupplicant {
             uint32_t Key() const { return _key; }
             uint32_t Throughput() const { return _throughput; }
             bool IsHidden() const { return _hidden; }
+            // Time (ticks) wpa_supplicant last received a beacon or probe response of this BSS.
+            uint64_t Seen() const { return _seen; }
+            void Seen(const uint64_t ticks) { _seen = ticks; }
 
             void Set(const string& ssid, const uint32_t frequency, const int32_t signal, const uint16_t pairs, const uint32_t keys)
             {
@@ -307,7 +316,9 @@ namespace WPASupplicant {
             uint32_t _id;
             uint32_t _throughput;
             bool _hidden;
+            uint64_t _seen;
         };
+        typedef std::map<const uint64_t, NetworkInfo> NetworkInfoContainer;
         class Request {
         private:
             Request(const Request&) = delete;
@@ -388,6 +399,9 @@ namespace WPASupplicant {
                 , _scanning(false)
                 , _parent(parent)
                 , _eventReporting(~0)
+                , _scanned()
+                , _removed()
+                , _next(0)
             {
             }
             virtual ~ScanRequest()
@@ -413,7 +427,21 @@ namespace WPASupplicant {
             }
             bool Set()
             {
-                return (Request::Set(string(_TXT("SCAN_RESULTS"))));
+                bool result = Page(0);
+
+                if (result == true) {
+                    _scanned.clear();
+                    _removed.clear();
+                }
+                return (result);
+            }
+            // A BSS wpa_supplicant dropped while its table is being fetched, it should not come back with the
+            // table once the last page is in.
+            void Removed(const uint64_t bssid)
+            {
+                if (InProgress() == true) {
+                    _removed.insert(bssid);
+                }
             }
             inline void Event(const events value)
             {
@@ -421,63 +449,122 @@ namespace WPASupplicant {
             }
             virtual void Completed(const string& response, const bool abort) override
             {
-                if (abort == false) {
-                    Core::TextFragment data(response.c_str(), response.length());
-                    uint32_t marker = data.ForwardFind('\n');
-                    uint32_t markerEnd = data.ForwardFind('\n', marker + 1);
-
-                    while (marker != markerEnd) {
+                if ((abort == false) && (Parse(response) == true)) {
+                    // The reply of wpa_supplicant is limited to a single buffer, fetch the BSSes that did
+                    // not fit. This request stays "in progress", so a new scan result does not restart it.
+                    Page(_next);
+                    _parent.Submit(this);
+                } else {
+                    if (abort == false) {
+                        for (const uint64_t bssid : _removed) {
+                            _scanned.erase(bssid);
+                        }
+                        _parent.Scanned(_scanned);
+                    }
+                    _scanned.clear();
+                    _removed.clear();
 
-                        Core::TextFragment element(data, marker + 1, (markerEnd - marker - 1));
-                        marker = markerEnd;
-                        markerEnd = data.ForwardFind('\n', marker + 1);
-                        NetworkInfo newEntry;
-                        _parent.Add(Transform(element, newEntry), newEntry);
+                    if (_eventReporting != static_cast<uint32_t>(~0)) {
+                        _parent.Notify(static_cast<events>(_eventReporting));
+                        _eventReporting = static_cast<uint32_t>(~0);
                     }
+                    _scanning = false;
                 }
-                if (_eventReporting != static_cast<uint32_t>(~0)) {
-                    _parent.Notify(static_cast<events>(_eventReporting));
-                    _eventReporting = static_cast<uint32_t>(~0);
-                }
-                _scanning = false;
             }
 
         private:
-            uint64_t Transform(const Core::TextFragment& infoLine, NetworkInfo& source)
+            bool Page(const uint32_t first)
             {
-                // First thing we find will be 6 bytes...
-                uint64_t bssid = BSSID(infoLine.Text());
-
-                // Next is the frequency
-                uint16_t index = infoLine.ForwardSkip(_T(" \t"), 18);
-                uint16_t end = infoLine.ForwardFind(_T(" \t"), index);
-
-                uint32_t frequency = Core::NumberType<uint32_t>(Core::TextFragment(infoLine, index, end - index));
-
-                // Next we will find the Signal Strength
-                index = infoLine.ForwardSkip(_T(" \t"), end);
-                end = infoLine.ForwardFind(_T(" \t"), index);
+                // Mask: id, bssid, freq, level, age, flags, ssid, delimiter and est_throughput (WPA_BSS_MASK_*).
+                return (Request::Set(string(_TXT("BSS RANGE=")) + Core::NumberType<uint32_t>(first).Text() + _T("- MASK=0x121A87")));
+            }
+            // Collects all BSSes in the reply, every entry is closed by a "====" line, the last BSS wpa_supplicant
+            // knows of by "####". Returns true if there are more BSSes to fetch.
+            bool Parse(const string& response)
+            {
+                Core::TextFragment data(response);
 
-                int32_t signal = Core::NumberType<int32_t>(Core::TextFragment(infoLine, index, end - index));
+                uint64_t bssid = 0;
+                string ssid;
+                uint32_t id = static_cast<uint32_t>(~1);
+                uint32_t freq = 0;
+                int32_t signal = 0;
+                uint16_t pair = 0;
+                uint32_t keys = 0;
+                uint32_t throughput = 0;
+                uint32_t age = 0;
+                uint16_t entries = 0;
+                const uint64_t now = Core::Time::Now().Ticks();
+                bool last = false;
+                uint32_t marker = 0;
+                uint32_t markerEnd = data.ForwardFind('\n', marker);
+
+                while (marker != markerEnd) {
+
+                    if ((response[marker] == '=') || (response[marker] == '#')) {
+                        if (bssid != 0) {
+                            NetworkInfo& info(_scanned[bssid]);
+                            info = NetworkInfo(id, ssid, freq, signal, pair, keys, throughput);
+                            // The age is reported in whole seconds.
+                            info.Seen(now - (static_cast<uint64_t>(age) * 1000 * Core::Time::TicksPerMillisecond));
+                        }
+                        if (id != static_cast<uint32_t>(~1)) {
+                            _next = id + 1;
+                        }
+                        last = (response[marker] == '#');
+                        entries++;
+
+                        bssid = 0;
+                        ssid.clear();
+                        id = static_cast<uint32_t>(~1);
+                        freq = 0;
+                        signal = 0;
+                        pair = 0;
+                        keys = 0;
+                        throughput = 0;
+                        age = 0;
+                    } else {
+                        Core::TextSegmentIterator index(Core::TextFragment(data, marker, (markerEnd - marker)), false, '=');
 
-                // Extract the flags from the information
-                index = infoLine.ForwardSkip(_T(" \t"), end);
-                end = infoLine.ForwardFind(_T(" \t"), index);
+                        if (index.Next() == true) {
 
-                uint32_t keys = 0;
-                uint16_t pairs = KeyPair(Core::TextFragment(infoLine, index, end - index), keys);
+                            string name(index.Current().Text());
 
-                // And last but not least, we will find the SSID
-                index = infoLine.ForwardSkip(_T(" \t"), end);
-                source.Set(Core::TextFragment(infoLine, index, infoLine.Length() - index).Text(), frequency, signal, pairs, keys);
+                            if (index.Next() == true) {
+                                if (name == _T("id")) {
+                                    id = Core::NumberType<uint32_t>(index.Current());
+                                } else if (name == Config::BSSIDKEY) {
+                                    bssid = Controller::BSSID(index.Current().Text());
+                                } else if (name == _T("est_throughput")) {
+                                    throughput = Core::NumberType<uint32_t>(index.Current());
+                                } else if (name == _T("ssid")) {
+                                    ssid = index.Current().Text();
+                                } else if (name == _T("freq")) {
+                                    freq = Core::NumberType<uint32_t>(index.Current());
+                                } else if (name == _T("level")) {
+                                    signal = Core::NumberType<int32_t>(index.Current());
+                                } else if (name == _T("age")) {
+                                    age = Core::NumberType<uint32_t>(index.Current());
+                                } else if (name == _T("flags")) {
+                                    pair = KeyPair(index.Current(), keys);
+                                }
+                            }
+                        }
+                    }
+                    marker = (markerEnd < data.Length() ? markerEnd + 1 : markerEnd);
+                    markerEnd = data.ForwardFind('\n', marker);
+                }
 
-                return (bssid);
+                return ((last == false) && (entries > 0));
             }
 
         private:
             bool _scanning;
             Controller& _parent;
             uint32_t _eventReporting;
+            NetworkInfoContainer _scanned;
+            std::set<uint64_t> _removed;
+            uint32_t _next;
         };
         class StatusRequest : public Request {
         private:
@@ -608,84 +695,6 @@ namespace WPASupplicant {
             uint32_t _eventReporting;
             reasons _disconnectReason;
         };
-        class DetailRequest : public Request {
-        private:
-            DetailRequest() = delete;
-            DetailRequest(const DetailRequest&) = delete;
-            DetailRequest& operator=(const DetailRequest&) = delete;
-
-        public:
-            DetailRequest(Controller& parent)
-                : Request()
-                , _parent(parent)
-            {
-            }
-            virtual ~DetailRequest()
-            {
-            }
-
-        public:
-            bool Set(const uint64_t& bssid)
-            {
-                if (Request::Set(string(_TXT("BSS ")) + _parent.BSSID(bssid)) == true) {
-                    _bssid = bssid;
-                    return (true);
-                }
-                return (false);
-            }
-            virtual void Completed(const string& response, const bool abort) override
-            {
-                if (abort == false) {
-                    Core::TextFragment data(response);
-
-                    string ssid;
-                    uint32_t id = static_cast<uint32_t>(~1);
-                    uint32_t freq = 0;
-                    int32_t signal = 0;
-                    uint16_t pair = 0;
-                    uint32_t keys = 0;
-                    uint32_t throughput = 0;
-                    uint32_t marker = 0;
-                    uint32_t markerEnd = data.ForwardFind('\n', marker);
-
-                    while (marker != markerEnd) {
-
-                        Core::TextSegmentIterator index(Core::TextFragment(data, marker, (markerEnd - marker)), false, '=');
-
-                        if (index.Next() == true) {
-
-                            string name(index.Current().Text());
-
-                            if (index.Next() == true) {
-                                if (name == _T("id")) {
-                                    id = Core::NumberType<uint32_t>(index.Current());
-                                } else if (name == _T("est_throughput")) {
-                                    throughput = Core::NumberType<uint32_t>(index.Current());
-                                } else if (name == _T("ssid")) {
-                                    ssid = index.Current().Text();
-                                } else if (name == _T("freq")) {
-                                    freq = Core::NumberType<uint32_t>(index.Current());
-                                } else if (name == _T("level")) {
-                                    signal = Core::NumberType<int32_t>(index.Current());
-                                } else if (name == _T("level")) {
-                                    signal = Core::NumberType<int32_t>(index.Current());
-                                } else if (name == _T("flags")) {
-                                    pair = KeyPair(index.Current(), keys);
-                                }
-                            }
-                        }
-                        marker = (markerEnd < data.Length() ? markerEnd + 1 : markerEnd);
-                        markerEnd = data.ForwardFind('\n', marker);
-                    }
-
-                    _parent.Update(_bssid, ssid, id, freq, signal, pair, keys, throughput);
-                }
-            }
-
-        private:
-            Controller& _parent;
-            uint64_t _bssid;
-        };
         class NetworkRequest : public Request {
         private:
             NetworkRequest() = delete;
@@ -957,7 +966,6 @@ namespace WPASupplicant {
             string _response;
             uint32_t _result;
         };
-        typedef std::map<const uint64_t, NetworkInfo> NetworkInfoContainer;
         typedef std::map<const string, ConfigInfo> EnabledContainer;
         typedef Core::StreamType<Core::SocketDatagram> BaseClass;
 
@@ -971,7 +979,6 @@ namespace WPASupplicant {
             , _error(Core::ERROR_UNAVAILABLE)
             , _callback(nullptr)
             , _scanRequest(*this)
-            , _detailRequest(*this)
             , _networkRequest(*this)
             , _statusRequest(*this)
             , _connectRequest(*this)
@@ -1066,6 +1073,13 @@ namespace WPASupplicant {
             _adminLock.Unlock();
             return current;
         }
+        inline uint64_t CurrentBSSID() const
+        {
+            _adminLock.Lock();
+            const uint64_t bssid = _statusRequest.BSSID();
+            _adminLock.Unlock();
+            return bssid;
+        }
         inline const reasons DisconnectReason() const
         {
             _adminLock.Lock();
@@ -1077,7 +1091,8 @@ namespace WPASupplicant {
         {
             return (_error);
         }
-        inline uint32_t Scan()
+        // A frequency (in MHz) limits the scan to that single channel.
+        inline uint32_t Scan(const uint32_t frequency = 0)
         {
 
             uint32_t result = Core::ERROR_INPROGRESS;
@@ -1088,7 +1103,7 @@ namespace WPASupplicant {
             if (activated == true) {
                 result = Core::ERROR_NONE;
 
-                CustomRequest exchange(string(_TXT("SCAN")));
+                CustomRequest exchange(frequency == 0 ? string(_TXT("SCAN")) : string(_TXT("SCAN freq=")) + Core::NumberType<uint32_t>(frequency).Text());
 
                 Submit(&exchange);
 
@@ -1147,6 +1162,23 @@ namespace WPASupplicant {
             _callback = callback;
             _adminLock.Unlock();
         }
+        // Time (ticks) the BSS was last seen by a scan, 0 if it is not in the BSS table.
+        inline uint64_t Seen(const uint64_t& id) const
+        {
+            uint64_t result = 0;
+
+            _adminLock.Lock();
+
+            NetworkInfoContainer::const_iterator index(_networks.find(id));
+
+            if (index != _networks.end()) {
+                result = index->second.Seen();
+            }
+
+            _adminLock.Unlock();
+
+            return (result);
+        }
         inline Network Get(const uint64_t& id)
         {
 
@@ -1845,10 +1877,9 @@ namespace WPASupplicant {
         }
         // These methods (add/add/update) are assumed to be running in a locked context.
         // Completion of requests are running in a locked context, so oke to update maps/lists
-        void Add(const uint64_t& bssid, const NetworkInfo& entry);
+        void Scanned(NetworkInfoContainer& networks);
         void Add(const string& ssid, const bool current, const uint64_t& bssid);
         void Update(const string& status);
-        void Update(const uint64_t& bssid, const string& ssid, const uint32_t id, uint32_t frequency, const int32_t signal, const uint16_t pairs, const uint32_t keys, const uint32_t throughput);
         void Update(const uint64_t& bssid, const uint32_t id, const uint32_t throughput);
         void Update(const string& ssid, const uint32_t id, const bool succeeded);
         void Reevaluate();
@@ -1921,7 +1952,6 @@ namespace WPASupplicant {
         uint32_t _error;
         Core::IDispatchType<const events>* _callback;
         ScanRequest _scanRequest;
-        DetailRequest _detailRequest;
         NetworkRequest _networkRequest;
         StatusRequest _statusRequest;
         ConnectRequest _connectRequest;
@@ -64,9 +64,10 @@ namespace Plugin
         _skipURL = static_cast<uint8_t>(service->WebPrefix().length());
         _service = service;
 
-        if (Core::Directory(service->PersistentPath().c_str()).CreatePath())
+        if (Core::Directory(service->PersistentPath().c_str()).CreatePath()) {
             _configurationStore = service->PersistentPath() + "wpa_supplicant.conf";
-        else
+            _autoConnect.Load(service->PersistentPath() + "reconnect.json");
+        } else
             SYSLOG(Logging::Startup, ("Config directory %s doesn't exist and could not be created!\n", service->PersistentPath().c_str()));
 
         TRACE_L1("Starting the application for wifi called: [%s]", config.Application.Value().c_str());
@@ -151,8 +152,21 @@ namespace Plugin
 
     /* virtual */ string WifiControl::Information() const
     {
-        // No additional info to report.
-        return (string());
+        AutoConnect::Statistics statistics;
+        ReconnectInfo info;
+        string result;
+
+        _autoConnect.Get(statistics);
+
+        info.FastReconnects = statistics.Fast;
+        info.FastAverage = (statistics.Fast != 0 ? statistics.FastTime / statistics.Fast : 0);
+        info.FullReconnects = statistics.Full;
+        info.FullAverage = (statistics.Full != 0 ? statistics.FullTime / statistics.Full : 0);
+        info.LastReconnect = statistics.Last;
+
+        info.ToString(result);
+
+        return (result);
     }
 
     /* virtual */ void WifiControl::Inbound(Web::Request & request)
@@ -403,6 +417,8 @@ namespace Plugin
             break;
         }
         case WPASupplicant::Controller::CTRL_EVENT_CONNECTED: {
+            _autoConnect.Connected();
+
             string message("{ \"event\": \"Connected\", \"ssid\": \"" + _controller->Current() + "\" }");
             _service->Notify(message);
             event_connectionchange(_controller->Current());
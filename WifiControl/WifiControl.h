@@ -163,8 +163,100 @@ namespace Plugin {
                 uint64_t _bssid;
                 string _ssid;
             };
+            // Last access point we were connected to, per SSID, as persisted.
+            class CacheList : public Core::JSON::Container {
+            public:
+                class Entry : public Core::JSON::Container {
+                public:
+                    Entry()
+                        : Core::JSON::Container()
+                        , Ssid()
+                        , Bssid()
+                        , Frequency(0)
+                        , Signal(0)
+                    {
+                        Init();
+                    }
+                    Entry(const Entry& copy)
+                        : Core::JSON::Container()
+                        , Ssid(copy.Ssid)
+                        , Bssid(copy.Bssid)
+                        , Frequency(copy.Frequency)
+                        , Signal(copy.Signal)
+                    {
+                        Init();
+                    }
+                    ~Entry() override
+                    {
+                    }
+
+                    Entry& operator=(const Entry& rhs)
+                    {
+                        Ssid = rhs.Ssid;
+                        Bssid = rhs.Bssid;
+                        Frequency = rhs.Frequency;
+                        Signal = rhs.Signal;
+
+                        return (*this);
+                    }
+
+                private:
+                    void Init()
+                    {
+                        Add(_T("ssid"), &Ssid);
+                        Add(_T("bssid"), &Bssid);
+                        Add(_T("frequency"), &Frequency);
+                        Add(_T("signal"), &Signal);
+                    }
+
+                public:
+                    Core::JSON::String Ssid;
+                    Core::JSON::String Bssid;
+                    Core::JSON::DecUInt32 Frequency;
+                    Core::JSON::DecSInt32 Signal;
+                };
+
+            public:
+                CacheList(const CacheList&) = delete;
+                CacheList& operator=(const CacheList&) = delete;
+
+                CacheList()
+                    : Core::JSON::Container()
+                    , Networks()
+                {
+                    Add(_T("networks"), &Networks);
+                }
+                ~CacheList() override
+                {
+                }
+
+            public:
+                Core::JSON::ArrayType<Entry> Networks;
+            };
+            class CachedAccessPoint {
+            public:
+                CachedAccessPoint()
+                    : BSSID(0)
+                    , Frequency(0)
+                    , Signal(0)
+                {
+                }
+                CachedAccessPoint(const uint64_t& bssid, const uint32_t frequency, const int32_t signal)
+                    : BSSID(bssid)
+                    , Frequency(frequency)
+                    , Signal(signal)
+                {
+                }
+
+            public:
+                uint64_t BSSID;
+                uint32_t Frequency;
+                int32_t Signal;
+            };
+
             using Job = Core::WorkerPool::JobType<AutoConnect&>;
             using SSIDList = std::list<AccessPoint>;
+            using CacheMap = std::map<string, CachedAccessPoint>;
 
             enum class states : uint8_t
             {
@@ -175,6 +267,15 @@ namespace Plugin {
                 RETRY
             };
 
+        public:
+            struct Statistics {
+                uint32_t Fast; // Reconnects that succeeded on the cached access point
+                uint32_t FastTime; // Accumulated time of those reconnects, in ms
+                uint32_t Full; // Reconnects that needed a full scan
+                uint32_t FullTime; // Accumulated time of those reconnects, in ms
+                uint32_t Last; // Time of the last reconnect, in ms
+            };
+
         public:
             AutoConnect() = delete;
             AutoConnect(const AutoConnect&) = delete;
@@ -189,6 +290,12 @@ namespace Plugin {
                 , _interval(0)
                 , _attempts(0)
                 , _preferred()
+                , _cache()
+                , _storage()
+                , _current()
+                , _fast(false)
+                , _disconnected(0)
+                , _statistics()
             {
             }
             ~AutoConnect() override
@@ -196,6 +303,42 @@ namespace Plugin {
             }
 
         public:
+            void Load(const string& storage)
+            {
+                _adminLock.Lock();
+
+                _storage = storage;
+                _cache.clear();
+
+                Core::File cacheFile(_storage);
+
+                if (cacheFile.Open(true) == true) {
+                    CacheList list;
+                    Core::OptionalType<Core::JSON::Error> error;
+                    list.IElement::FromFile(cacheFile, error);
+                    if (error.IsSet() == true) {
+                        SYSLOG(Logging::ParsingError, (_T("Parsing failed with %s"), ErrorDisplayMessage(error.Value()).c_str()));
+                    }
+
+                    auto index(list.Networks.Elements());
+
+                    while (index.Next() == true) {
+                        uint64_t bssid = WPASupplicant::Controller::BSSID(index.Current().Bssid.Value());
+
+                        if ((index.Current().Ssid.Value().empty() == false) && (bssid != 0)) {
+                            _cache[index.Current().Ssid.Value()] = CachedAccessPoint(bssid, index.Current().Frequency.Value(), index.Current().Signal.Value());
+                        }
+                    }
+                }
+
+                _adminLock.Unlock();
+            }
+            void Get(Statistics& statistics) const
+            {
+                _adminLock.Lock();
+                statistics = _statistics;
+                _adminLock.Unlock();
+            }
             uint32_t Connect(const string& SSID, const uint8_t scheduleInterval, const uint32_t attempts) 
             {
                 uint32_t result = Core::ERROR_INPROGRESS;
@@ -209,6 +352,7 @@ namespace Plugin {
                     _preferred = SSID;
                     _attempts = attempts;
                     _interval = (scheduleInterval * 1000);
+                    _fast = false;
 
                     MoveState (states::SCANNING);
 
@@ -266,15 +410,63 @@ namespace Plugin {
                 if ((reason == WPASupplicant::Controller::WLAN_REASON_NOINFO_GIVEN)
                         && (_state == states::IDLE) && (_attempts > 0)) {
 
+                    CacheMap::const_iterator cached(_cache.find(_current.empty() == false ? _current : _preferred));
+
                     MoveState(states::SCANNING);
 
-                    _controller->Scan();
+                    _disconnected = Core::Time::Now().Ticks();
+
+                    // Try the access point we were last connected to first, only scanning its channel.
+                    _fast = ((cached != _cache.end()) && (cached->second.Frequency != 0));
+
+                    _controller->Scan(_fast == true ? cached->second.Frequency : 0);
 
                     _job.Schedule(Core::Time::Now().Add(_interval));
                 }
 
                 _adminLock.Unlock();
             }
+            void Connected()
+            {
+                const string ssid(_controller->Current());
+                const uint64_t bssid(_controller->CurrentBSSID());
+                WPASupplicant::Network network(_controller->Get(bssid));
+
+                _adminLock.Lock();
+
+                if (_disconnected != 0) {
+                    uint32_t duration = static_cast<uint32_t>((Core::Time::Now().Ticks() - _disconnected) / Core::Time::TicksPerMillisecond);
+
+                    if (_fast == true) {
+                        _statistics.Fast++;
+                        _statistics.FastTime += duration;
+                    } else {
+                        _statistics.Full++;
+                        _statistics.FullTime += duration;
+                    }
+                    _statistics.Last = duration;
+                    _disconnected = 0;
+
+                    TRACE(Trace::Information, (_T("Reconnected to [%s] in %d ms (%s)"), ssid.c_str(), duration, (_fast == true ? _T("cached") : _T("full scan"))));
+                }
+
+                _fast = false;
+                _current = ssid;
+
+                if ((ssid.empty() == false) && (bssid != 0) && (network.IsValid() == true)) {
+                    CachedAccessPoint& entry(_cache[ssid]);
+                    bool changed = ((entry.BSSID != bssid) || (entry.Frequency != network.Frequency()));
+
+                    entry = CachedAccessPoint(bssid, network.Frequency(), network.Signal());
+
+                    // Only a roam to another access point is worth a write to persistent storage.
+                    if (changed == true) {
+                        Store();
+                    }
+                }
+
+                _adminLock.Unlock();
+            }
 
             void Dispatch()
             {
@@ -286,6 +478,30 @@ namespace Plugin {
                     _state = states::RETRY;
                     _job.Schedule(Core::Time::Now().Add(_interval));
                 }
+                else if ((_state == states::SCANNED) && (_fast == true)) {
+                    CacheMap::const_iterator cached(_cache.find(_current.empty() == false ? _current : _preferred));
+                    WPASupplicant::Network net;
+
+                    // wpa_supplicant keeps a BSS in its table for a while after it was last seen, only trust
+                    // an entry the scan on its channel refreshed (the age has a resolution of a second).
+                    if ((cached != _cache.end()) &&
+                        ((_controller->Seen(cached->second.BSSID) + (1000 * Core::Time::TicksPerMillisecond)) >= _disconnected)) {
+                        net = _controller->Get(cached->second.BSSID);
+                    }
+
+                    _ssidList.clear();
+
+                    if ((net.IsValid() == true) && (_controller->Get(net.SSID()).IsValid() == true)) {
+                        _ssidList.emplace_back(net.Signal(), net.BSSID(), net.SSID());
+                        _state = states::CONNECTING;
+                        _controller->Connect(this, _ssidList.front().SSID(), _ssidList.front().BSSID());
+                    } else {
+                        // The cached access point is not around (anymore), fall back to a full scan.
+                        FullScan();
+                    }
+
+                    _job.Schedule(Core::Time::Now().Add(_interval));
+                }
                 else if (_state == states::SCANNED) {
 
                     // This is a transitional state due to the fact that the  call to
@@ -329,7 +545,10 @@ namespace Plugin {
                         _ssidList.pop_front();
                     }
 
-                    if (_ssidList.size() == 0) {
+                    if ((_ssidList.size() == 0) && (_fast == true)) {
+                        FullScan();
+                    }
+                    else if (_ssidList.size() == 0) {
                         _state = states::RETRY;
                     }
                     else {
@@ -345,8 +564,7 @@ namespace Plugin {
                         if (_attempts != static_cast<uint32_t>(~0)) {
                             --_attempts;
                         }
-                        _state = states::SCANNING;
-                        _controller->Scan();
+                        FullScan();
 
                         _job.Schedule(Core::Time::Now().Add(_interval));
                     }
@@ -356,6 +574,34 @@ namespace Plugin {
             }
 
         private:
+            void FullScan()
+            {
+                _fast = false;
+                _state = states::SCANNING;
+                _controller->Scan();
+            }
+            void Store() const
+            {
+                if (_storage.empty() == false) {
+                    Core::File cacheFile(_storage);
+
+                    if (cacheFile.Create() == true) {
+                        CacheList list;
+
+                        for (const auto& entry : _cache) {
+                            CacheList::Entry& element(list.Networks.Add());
+                            element.Ssid = entry.first;
+                            element.Bssid = WPASupplicant::Controller::BSSID(entry.second.BSSID);
+                            element.Frequency = entry.second.Frequency;
+                            element.Signal = entry.second.Signal;
+                        }
+
+                        list.IElement::ToFile(cacheFile);
+                    } else {
+                        TRACE(Trace::Error, (_T("Could not store the reconnect cache in %s"), _storage.c_str()));
+                    }
+                }
+            }
             void MoveState(const states newState) {
                 _state = states::IDLE;
 
@@ -388,7 +634,7 @@ namespace Plugin {
             }
 
         private:
-            Core::CriticalSection _adminLock;
+            mutable Core::CriticalSection _adminLock;
             Core::ProxyType<WPASupplicant::Controller>& _controller;
             Job _job;
             states _state;
@@ -396,6 +642,12 @@ namespace Plugin {
             uint32_t _interval;
             uint32_t _attempts;
             string _preferred;
+            CacheMap _cache;
+            string _storage;
+            string _current;
+            bool _fast;
+            uint64_t _disconnected;
+            Statistics _statistics;
         };
 
     public:
@@ -429,6 +681,36 @@ namespace Plugin {
             Core::JSON::Boolean AutoConnect;
         };
 
+        class ReconnectInfo : public Core::JSON::Container {
+        public:
+            ReconnectInfo(const ReconnectInfo&) = delete;
+            ReconnectInfo& operator=(const ReconnectInfo&) = delete;
+
+            ReconnectInfo()
+                : FastReconnects(0)
+                , FastAverage(0)
+                , FullReconnects(0)
+                , FullAverage(0)
+                , LastReconnect(0)
+            {
+                Add(_T("fastreconnects"), &FastReconnects);
+                Add(_T("fastaverage"), &FastAverage);
+                Add(_T("fullreconnects"), &FullReconnects);
+                Add(_T("fullaverage"), &FullAverage);
+                Add(_T("lastreconnect"), &LastReconnect);
+            }
+            virtual ~ReconnectInfo()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt32 FastReconnects;
+            Core::JSON::DecUInt32 FastAverage; // In ms
+            Core::JSON::DecUInt32 FullReconnects;
+            Core::JSON::DecUInt32 FullAverage; // In ms
+            Core::JSON::DecUInt32 LastReconnect; // In ms
+        };
+
         static void FillNetworkInfo(const WPASupplicant::Network& info, JsonData::WifiControl::NetworkInfo& net)
         {
             net.Bssid = std::to_string(info.BSSID());
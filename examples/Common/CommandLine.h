@@ -0,0 +1,154 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <core/core.h>
+
+#include <functional>
+
+namespace WPEFramework {
+
+namespace Tools {
+
+    // The options of the tools in the examples. An option is a name, the variable it sets and a line of help;
+    // -h shows the help of all of them, with the value the variable holds when it is added as the default.
+    // Options that are not known, or miss their value, are skipped.
+    class CommandLine {
+    private:
+        struct Option {
+            string Name;
+            string Help;
+            string Default;
+            bool HasValue;
+            std::function<void(const char[])> Set;
+        };
+
+    public:
+        CommandLine(const CommandLine&) = delete;
+        CommandLine& operator=(const CommandLine&) = delete;
+
+        CommandLine()
+            : _options()
+        {
+        }
+        ~CommandLine()
+        {
+        }
+
+    public:
+        // The default shown is the value the variable holds, unless defaultText is given. An empty default is
+        // not shown, so an empty defaultText hides it.
+        void Add(const TCHAR name[], string& value, const TCHAR help[], const TCHAR defaultText[] = nullptr)
+        {
+            Add(name, help, (defaultText != nullptr ? string(defaultText) : value), true, [&value](const char argument[]) { value = argument; });
+        }
+        template <typename NUMBER>
+        void Add(const TCHAR name[], NUMBER& value, const TCHAR help[], const TCHAR defaultText[] = nullptr)
+        {
+            static_assert(std::is_arithmetic<NUMBER>::value, "Options hold a string, a number or a switch");
+
+            Add(name, help, (defaultText != nullptr ? string(defaultText) : Text(value)), true, [&value](const char argument[]) { Convert(argument, value); });
+        }
+        // A switch, set to true if it is given.
+        void Add(const TCHAR name[], bool& value, const TCHAR help[])
+        {
+            Add(name, help, string(), false, [&value](const char[]) { value = true; });
+        }
+        // An option the tool interprets itself. A switch if hasValue is false, handler then gets nullptr.
+        void Add(const TCHAR name[], const bool hasValue, const std::function<void(const char[])>& handler, const TCHAR help[], const TCHAR defaultText[] = nullptr)
+        {
+            Add(name, help, (defaultText != nullptr ? string(defaultText) : string()), hasValue, handler);
+        }
+
+        void Parse(int argc, char** argv) const
+        {
+            int index = 1;
+
+            while (index < argc) {
+                if (strcmp(argv[index], _T("-h")) == 0) {
+                    Show();
+                } else {
+                    std::vector<Option>::const_iterator option(_options.begin());
+
+                    while ((option != _options.end()) && ((argv[index][0] != '-') || (option->Name != &(argv[index][1])))) {
+                        option++;
+                    }
+
+                    if (option != _options.end()) {
+                        if (option->HasValue == false) {
+                            option->Set(nullptr);
+                        } else if ((index + 1) < argc) {
+                            option->Set(argv[++index]);
+                        }
+                    }
+                }
+                index++;
+            }
+        }
+        void Show() const
+        {
+            printf(_T("Enter\n"));
+
+            for (const Option& option : _options) {
+                if ((option.HasValue == false) || (option.Default.empty() == true)) {
+                    printf(_T("\t-%s : %s\n"), option.Name.c_str(), option.Help.c_str());
+                } else {
+                    printf(_T("\t-%s : %s [default: %s]\n"), option.Name.c_str(), option.Help.c_str(), option.Default.c_str());
+                }
+            }
+
+            printf(_T("\t-h : Help\n"));
+        }
+
+    private:
+        void Add(const TCHAR name[], const TCHAR help[], const string& defaultText, const bool hasValue, const std::function<void(const char[])>& handler)
+        {
+            _options.push_back({ name, help, defaultText, hasValue, handler });
+        }
+        template <typename NUMBER>
+        static string Text(const NUMBER value)
+        {
+            string result;
+
+            if (std::is_floating_point<NUMBER>::value == true) {
+                TCHAR buffer[32];
+                ::snprintf(buffer, sizeof(buffer), _T("%g"), static_cast<double>(value));
+                result = buffer;
+            } else {
+                result = std::to_string(value);
+            }
+
+            return (result);
+        }
+        template <typename NUMBER>
+        static void Convert(const char argument[], NUMBER& value)
+        {
+            if (std::is_floating_point<NUMBER>::value == true) {
+                value = static_cast<NUMBER>(::atof(argument));
+            } else {
+                value = static_cast<NUMBER>(::atoll(argument));
+            }
+        }
+
+    private:
+        std::vector<Option> _options;
+    };
+
+} } // namespace WPEFramework::Tools
@@ -0,0 +1,330 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME DIALPoll
+#endif
+
+#include <core/core.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "CommandLine.h"
+
+#undef EXTERNAL
+
+using namespace WPEFramework;
+
+namespace WPEFramework {
+
+    // Polls the application state document of the DIALServer plugin the way DIAL clients do, over a kept
+    // alive connection, conditionally with the ETag of the last document in If-None-Match. It checks the
+    // cached rendering: as long as the tag does not change, the document must not change either, and an
+    // unchanged state must be answered with 304. Every -update polls additional data with characters that
+    // need escaping is posted to the Data URL of the app, the next poll must show a new document with that
+    // data, escaped.
+    class Poller {
+    public:
+        Poller() = delete;
+        Poller(const Poller&) = delete;
+        Poller& operator=(const Poller&) = delete;
+
+        struct Result {
+            uint32_t Requests;
+            uint32_t Failed;
+            uint32_t Revisions; // Number of different tags seen
+            uint32_t NotModified;
+            uint32_t Inconsistent; // Same tag, different document
+            uint32_t Updates;
+            uint32_t Missed; // Updates that did not show up in the next document
+            uint64_t Total; // uS
+            uint64_t Slowest; // uS
+        };
+
+    public:
+        Poller(const string& address, const uint16_t port, const string& path)
+            : _address(address)
+            , _port(port)
+            , _path(path)
+            , _socket(-1)
+            , _buffer()
+        {
+        }
+        ~Poller()
+        {
+            Close();
+        }
+
+    public:
+        void Run(const uint32_t polls, const uint32_t update, const string& version, Result& result)
+        {
+            const string query(version.empty() == true ? string() : _T("?clientDialVer=") + version);
+            string tag;
+            string document;
+            string expected;
+
+            ::memset(&result, 0, sizeof(result));
+
+            for (uint32_t poll = 0; poll < polls; poll++) {
+                if ((update != 0) && (poll != 0) && ((poll % update) == 0)) {
+                    const string marker(std::to_string(poll));
+
+                    // Decodes to: <poll & "N">
+                    if (Exchange(_T("POST"), _path + _T("/Data"), _T("poller=%3Cpoll%20%26%20%22") + marker + _T("%22%3E"), EMPTY_STRING, nullptr, nullptr) == 200) {
+                        expected = _T("<poller>&lt;poll &amp; &quot;") + marker + _T("&quot;&gt;</poller>");
+                        result.Updates++;
+                    }
+                }
+
+                string body;
+                string current;
+                const uint64_t start = Core::Time::Now().Ticks();
+                const uint32_t code = Exchange(_T("GET"), _path + query, EMPTY_STRING, tag, &body, &current);
+                const uint64_t duration = Core::Time::Now().Ticks() - start;
+
+                result.Requests++;
+                result.Total += duration;
+                result.Slowest = (duration > result.Slowest ? duration : result.Slowest);
+
+                if (code == 304) {
+                    result.NotModified++;
+
+                    if (expected.empty() == false) {
+                        printf(_T("Posted data, but the document was not modified\n"));
+                        result.Missed++;
+                        expected.clear();
+                    }
+                } else if ((code != 200) || (current.empty() == true)) {
+                    result.Failed++;
+                } else {
+                    if (current != tag) {
+                        tag = current;
+                        document = body;
+                        result.Revisions++;
+                    } else if (body != document) {
+                        printf(_T("Document %s changed without a new tag:\n%s\n%s\n"), tag.c_str(), document.c_str(), body.c_str());
+                        result.Inconsistent++;
+                    } else {
+                        // Nothing changed, yet the tag we sent did not match.
+                        printf(_T("Document %s sent again instead of a 304\n"), tag.c_str());
+                        result.Inconsistent++;
+                    }
+
+                    if (expected.empty() == false) {
+                        if (body.find(expected) == string::npos) {
+                            printf(_T("Posted data not in the document: %s\n"), body.c_str());
+                            result.Missed++;
+                        }
+                        expected.clear();
+                    }
+                }
+            }
+        }
+
+    private:
+        bool Connect()
+        {
+            struct sockaddr_in destination;
+
+            ::memset(&destination, 0, sizeof(destination));
+            destination.sin_family = AF_INET;
+            destination.sin_port = htons(_port);
+
+            if (::inet_pton(AF_INET, _address.c_str(), &destination.sin_addr) == 1) {
+                _socket = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+                if ((_socket != -1) && (::connect(_socket, reinterpret_cast<struct sockaddr*>(&destination), sizeof(destination)) != 0)) {
+                    Close();
+                }
+            }
+
+            return (_socket != -1);
+        }
+        void Close()
+        {
+            if (_socket != -1) {
+                ::close(_socket);
+                _socket = -1;
+            }
+            _buffer.clear();
+        }
+        // Returns the status code, 0 if there was no response. A connection that was closed by the server is
+        // opened again once.
+        uint32_t Exchange(const string& verb, const string& path, const string& body, const string& match, string* response, string* tag)
+        {
+            uint32_t result = 0;
+
+            for (uint8_t attempt = 0; (attempt < 2) && (result == 0); attempt++) {
+                if ((_socket != -1) || (Connect() == true)) {
+                    string request(verb + ' ' + path + _T(" HTTP/1.1\r\nHost: ") + _address + ':' + std::to_string(_port) + _T("\r\n"));
+
+                    if (body.empty() == false) {
+                        request += _T("Content-Type: text/plain\r\nContent-Length: ") + std::to_string(body.length()) + _T("\r\n");
+                    }
+                    if (match.empty() == false) {
+                        request += _T("If-None-Match: ") + match + _T("\r\n");
+                    }
+                    request += _T("\r\n") + body;
+
+                    if ((::send(_socket, request.c_str(), request.length(), MSG_NOSIGNAL) != static_cast<ssize_t>(request.length())) ||
+                        ((result = Receive(response, tag)) == 0)) {
+                        Close();
+                    }
+                }
+            }
+
+            return (result);
+        }
+        uint32_t Receive(string* body, string* tag)
+        {
+            uint32_t result = 0;
+            size_t header;
+
+            while (((header = _buffer.find(_T("\r\n\r\n"))) == string::npos) && (Fill() == true)) {
+            }
+
+            if ((header != string::npos) && (_buffer.compare(0, 9, _T("HTTP/1.1 ")) == 0)) {
+                const size_t field = Find(_buffer.substr(0, header), _T("\r\ncontent-length:"));
+                const size_t length = (field == string::npos ? 0 : static_cast<size_t>(::atoi(&(_buffer.c_str()[field + 17]))));
+                const size_t end = header + 4 + length;
+
+                while ((_buffer.length() < end) && (Fill() == true)) {
+                }
+
+                if (_buffer.length() >= end) {
+                    result = static_cast<uint32_t>(::atoi(&(_buffer.c_str()[9])));
+
+                    if (body != nullptr) {
+                        *body = _buffer.substr(header + 4, length);
+                    }
+                    if (tag != nullptr) {
+                        const size_t start = Find(_buffer.substr(0, header), _T("\r\netag:"));
+
+                        if (start != string::npos) {
+                            const size_t value = _buffer.find_first_not_of(' ', start + 7);
+                            *tag = _buffer.substr(value, _buffer.find(_T("\r\n"), value) - value);
+                        }
+                    }
+                    _buffer.erase(0, end);
+                }
+            }
+
+            return (result);
+        }
+        bool Fill()
+        {
+            char data[4096];
+            const ssize_t size = ::recv(_socket, data, sizeof(data), 0);
+
+            if (size > 0) {
+                _buffer.append(data, size);
+            }
+
+            return (size > 0);
+        }
+        static size_t Find(const string& text, const TCHAR key[])
+        {
+            string lower(text);
+
+            for (char& c : lower) {
+                c = static_cast<char>(::tolower(c));
+            }
+
+            return (lower.find(key));
+        }
+
+    private:
+        const string _address;
+        const uint16_t _port;
+        const string _path;
+        int _socket;
+        string _buffer;
+    };
+
+    class Config {
+    public:
+        Config(const Config&) = delete;
+        Config& operator=(const Config&) = delete;
+
+        Config()
+            : Address(_T("127.0.0.1"))
+            , Port(80)
+            , Path(_T("/Service/DIALServer/Apps/YouTube"))
+            , Version()
+            , Polls(10000)
+            , Update(1000)
+        {
+        }
+        ~Config()
+        {
+        }
+
+    public:
+        string Address;
+        uint16_t Port;
+        string Path;
+        string Version;
+        uint32_t Polls;
+        uint32_t Update;
+    };
+
+    void ParseOptions(int argc, char** argv, Config& config)
+    {
+        Tools::CommandLine options;
+
+        options.Add(_T("address"), config.Address, _T("Address of the Thunder web server"));
+        options.Add(_T("port"), config.Port, _T("Port of the Thunder web server"));
+        options.Add(_T("path"), config.Path, _T("Application URL of the app polled"));
+        options.Add(_T("version"), config.Version, _T("DIAL version of the client, e.g. 2.1"), _T("none"));
+        options.Add(_T("polls"), config.Polls, _T("Number of state requests"));
+        options.Add(_T("update"), config.Update, _T("Post new additional data every this many polls, 0 never"));
+
+        options.Parse(argc, argv);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    int result = 0;
+
+    ParseOptions(argc, argv, config);
+
+    {
+        Poller poller(config.Address, config.Port, config.Path);
+        Poller::Result outcome;
+
+        poller.Run(config.Polls, config.Update, config.Version, outcome);
+
+        printf(_T("%u requests, %u failed, %u not modified, %u documents seen, %u inconsistent\n"), outcome.Requests, outcome.Failed, outcome.NotModified, outcome.Revisions, outcome.Inconsistent);
+        printf(_T("%u updates posted, %u not in the next document\n"), outcome.Updates, outcome.Missed);
+
+        if (outcome.Requests > 0) {
+            printf(_T("latency: avg %.1f uS, max %.1f uS\n"), static_cast<double>(outcome.Total) / outcome.Requests, static_cast<double>(outcome.Slowest));
+        }
+
+        result = ((outcome.Failed == 0) && (outcome.Inconsistent == 0) && (outcome.Missed == 0) ? 0 : 1);
+    }
+
+    Core::Singleton::Dispose();
+
+    return (result);
+}
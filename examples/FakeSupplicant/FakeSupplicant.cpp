@@ -0,0 +1,438 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME FakeSupplicant
+#endif
+
+#include <core/core.h>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "CommandLine.h"
+
+#undef EXTERNAL
+
+using namespace WPEFramework;
+
+namespace WPEFramework {
+
+    // Stands in for the control interface of wpa_supplicant, so the WifiControl plugin can be run without a
+    // radio (set its "application" to "null" and point "connector" and "interface" to this socket). A scan
+    // replays a recorded BSS table, the output of "BSS RANGE=0- MASK=0x121A87", or a generated one, paged
+    // over replies of at most -reply bytes, like wpa_supplicant does. With -remove, BSSes that went out in the
+    // first page of a fetch are reported as removed before the next page is served, the plugin should not
+    // list them once the fetch completed.
+    class Supplicant {
+    public:
+        Supplicant() = delete;
+        Supplicant(const Supplicant&) = delete;
+        Supplicant& operator=(const Supplicant&) = delete;
+
+    private:
+        struct BSS {
+            uint32_t Id;
+            string BSSID;
+            string Text; // All fields, as wpa_supplicant reports them, without the delimiter.
+        };
+
+        using Table = std::vector<BSS>;
+        using Clients = std::vector<struct sockaddr_un>;
+
+    public:
+        Supplicant(const string& path, const uint16_t reply)
+            : _path(path)
+            , _reply(reply)
+            , _socket(-1)
+            , _table()
+            , _attached()
+            , _results(0)
+            , _remove(0)
+            , _removed(0)
+            , _pages(0)
+        {
+        }
+        ~Supplicant()
+        {
+            Close();
+        }
+
+    public:
+        uint32_t Open()
+        {
+            uint32_t result = Core::ERROR_OPENING_FAILED;
+            struct sockaddr_un local;
+
+            ::memset(&local, 0, sizeof(local));
+            local.sun_family = AF_UNIX;
+
+            if (_path.length() < sizeof(local.sun_path)) {
+                ::strncpy(local.sun_path, _path.c_str(), sizeof(local.sun_path) - 1);
+                ::unlink(_path.c_str());
+
+                _socket = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+                if ((_socket != -1) && (::bind(_socket, reinterpret_cast<struct sockaddr*>(&local), sizeof(local)) == 0)) {
+                    result = Core::ERROR_NONE;
+                } else {
+                    Close();
+                }
+            }
+
+            return (result);
+        }
+        void Close()
+        {
+            if (_socket != -1) {
+                ::close(_socket);
+                ::unlink(_path.c_str());
+                _socket = -1;
+            }
+        }
+        // A recorded "BSS RANGE" reply, entries are closed by a "====" line, the last one by "####".
+        uint32_t Load(const string& fileName)
+        {
+            uint32_t result = Core::ERROR_OPENING_FAILED;
+            Core::File file(fileName);
+
+            if (file.Open(true) == true) {
+                string data(static_cast<size_t>(file.Size()), '\0');
+
+                if (file.Read(reinterpret_cast<uint8_t*>(&data[0]), static_cast<uint32_t>(data.length())) == data.length()) {
+                    size_t start = 0;
+                    BSS entry;
+
+                    entry.Id = 0;
+
+                    while (start < data.length()) {
+                        size_t end = data.find('\n', start);
+                        end = (end == string::npos ? data.length() : end);
+                        const string line(data, start, end - start);
+
+                        if ((line == _T("====")) || (line == _T("####"))) {
+                            if (entry.BSSID.empty() == false) {
+                                _table.push_back(entry);
+                            }
+                            entry.Id = 0;
+                            entry.BSSID.clear();
+                            entry.Text.clear();
+                        } else if (line.empty() == false) {
+                            if (line.compare(0, 3, _T("id=")) == 0) {
+                                entry.Id = ::atoi(&(line.c_str()[3]));
+                            } else if (line.compare(0, 6, _T("bssid=")) == 0) {
+                                entry.BSSID = line.substr(6);
+                            }
+                            entry.Text += line + '\n';
+                        }
+                        start = end + 1;
+                    }
+                }
+                file.Close();
+
+                result = (_table.empty() == true ? Core::ERROR_INVALID_INPUT_LENGTH : Core::ERROR_NONE);
+            }
+
+            return (result);
+        }
+        void Generate(const uint32_t count)
+        {
+            for (uint32_t index = 0; index < count; index++) {
+                char bssid[18];
+                BSS entry;
+
+                ::snprintf(bssid, sizeof(bssid), "02:00:00:%02x:%02x:%02x", (index >> 16) & 0xFF, (index >> 8) & 0xFF, index & 0xFF);
+
+                entry.Id = index;
+                entry.BSSID = bssid;
+                entry.Text = _T("id=") + std::to_string(index) + _T("\n")
+                             _T("bssid=") + entry.BSSID + _T("\n")
+                             _T("freq=") + std::to_string((index % 2) == 0 ? 2412 + (5 * (index % 13)) : 5180 + (20 * (index % 8))) + _T("\n")
+                             _T("level=") + std::to_string(-30 - static_cast<int>(index % 60)) + _T("\n")
+                             _T("flags=") + ((index % 5) == 0 ? _T("[ESS]") : _T("[WPA2-PSK-CCMP][ESS]")) + _T("\n")
+                             _T("ssid=Network") + std::to_string(index) + _T("\n")
+                             _T("est_throughput=") + std::to_string(65000 - ((index % 60) * 1000)) + _T("\n");
+
+                _table.push_back(entry);
+            }
+        }
+        // Serves the control interface for the given time (s), 0 is forever. Every autoscan ms, if set, scan
+        // results are announced as if wpa_supplicant scanned on its own.
+        void Run(const uint32_t duration, const uint32_t autoscan, const uint32_t scanTime, const uint32_t remove)
+        {
+            const uint64_t never = ~static_cast<uint64_t>(0);
+            const uint64_t end = (duration == 0 ? never : Core::Time::Now().Ticks() + (static_cast<uint64_t>(duration) * 1000000));
+            uint64_t next = (autoscan == 0 ? never : Core::Time::Now().Ticks() + (static_cast<uint64_t>(autoscan) * 1000));
+
+            _remove = remove;
+
+            while (Core::Time::Now().Ticks() < end) {
+                const uint64_t now = Core::Time::Now().Ticks();
+
+                if ((_results != 0) && (now >= _results)) {
+                    _results = 0;
+                    Event(_T("CTRL-EVENT-SCAN-RESULTS "));
+                }
+                if (now >= next) {
+                    Event(_T("CTRL-EVENT-SCAN-STARTED "));
+                    _results = now + (static_cast<uint64_t>(scanTime) * 1000);
+                    next = now + (static_cast<uint64_t>(autoscan) * 1000);
+                }
+
+                const uint64_t wake = std::min(std::min(end, next), (_results == 0 ? never : _results));
+                const uint64_t wait = (wake > now ? (wake - now) / 1000 : 0);
+                struct pollfd descriptor;
+
+                descriptor.fd = _socket;
+                descriptor.events = POLLIN;
+                descriptor.revents = 0;
+
+                if (::poll(&descriptor, 1, static_cast<int>(wait > 100 ? 100 : wait)) > 0) {
+                    Receive(scanTime);
+                }
+            }
+
+            printf(_T("%u BSS pages served, %u BSSes reported removed during a fetch\n"), _pages, _removed);
+        }
+
+    private:
+        void Receive(const uint32_t scanTime)
+        {
+            char buffer[1024];
+            struct sockaddr_un from;
+            socklen_t length = sizeof(from);
+            const ssize_t size = ::recvfrom(_socket, buffer, sizeof(buffer) - 1, 0, reinterpret_cast<struct sockaddr*>(&from), &length);
+
+            if (size > 0) {
+                const string command(buffer, size);
+                string reply;
+
+                TRACE_L1("Command: %s", command.c_str());
+
+                if (command == _T("PING")) {
+                    reply = _T("PONG\n");
+                } else if (command == _T("ATTACH")) {
+                    _attached.push_back(from);
+                    reply = _T("OK\n");
+                } else if (command == _T("DETACH")) {
+                    Detach(from);
+                    reply = _T("OK\n");
+                } else if ((command == _T("SCAN")) || (command.compare(0, 5, _T("SCAN ")) == 0)) {
+                    reply = _T("OK\n");
+                    Send(from, reply);
+                    reply.clear();
+                    Event(_T("CTRL-EVENT-SCAN-STARTED "));
+                    _results = Core::Time::Now().Ticks() + (static_cast<uint64_t>(scanTime) * 1000);
+                } else if (command.compare(0, 10, _T("BSS RANGE=")) == 0) {
+                    reply = Page(static_cast<uint32_t>(::atoi(&(command.c_str()[10]))));
+                    Send(from, reply);
+                    reply.clear();
+                } else if (command == _T("STATUS")) {
+                    reply = _T("wpa_state=DISCONNECTED\naddress=02:00:00:ff:ff:ff\n");
+                } else if (command == _T("LIST_NETWORKS")) {
+                    reply = _T("network id / ssid / bssid / flags\n");
+                } else if ((command.compare(0, 4, _T("SET ")) == 0) || (command.compare(0, 6, _T("LEVEL ")) == 0) ||
+                           (command.compare(0, 15, _T("ENABLE_NETWORK ")) == 0) || (command.compare(0, 16, _T("DISABLE_NETWORK ")) == 0) ||
+                           (command == _T("DISCONNECT")) || (command == _T("RECONNECT"))) {
+                    reply = _T("OK\n");
+                } else {
+                    reply = _T("UNKNOWN COMMAND\n");
+                }
+
+                if (reply.empty() == false) {
+                    Send(from, reply);
+                }
+            }
+        }
+        // The BSSes from the given id on that fit in one reply, the last one of the table is marked.
+        string Page(const uint32_t first)
+        {
+            Table::const_iterator index(_table.begin());
+            std::vector<uint32_t> served;
+            string result;
+
+            while ((index != _table.end()) && (index->Id < first)) {
+                index++;
+            }
+
+            while (index != _table.end()) {
+                Table::const_iterator following(index + 1);
+                const string entry(index->Text + (following == _table.end() ? _T("####\n") : _T("====\n")));
+
+                if ((result.length() + entry.length()) > _reply) {
+                    break;
+                }
+                result += entry;
+                served.push_back(index->Id);
+                index = following;
+            }
+
+            _pages++;
+
+            // The first page of a fetch is out, drop some of it before the next page is asked for.
+            if ((first == 0) && (index != _table.end())) {
+                for (uint32_t count = 0; (count < _remove) && (served.empty() == false); count++) {
+                    Remove(served[served.size() / 2]);
+                    served.erase(served.begin() + (served.size() / 2));
+                }
+            }
+
+            return (result);
+        }
+        void Remove(const uint32_t id)
+        {
+            Table::iterator index(_table.begin());
+
+            while ((index != _table.end()) && (index->Id != id)) {
+                index++;
+            }
+
+            if (index != _table.end()) {
+                printf(_T("Removing BSS %u: %s\n"), index->Id, index->BSSID.c_str());
+                // Queued behind the reply with the page, so it arrives before the next page is asked for.
+                _pending.push_back(_T("CTRL-EVENT-BSS-REMOVED ") + std::to_string(index->Id) + ' ' + index->BSSID);
+                _table.erase(index);
+                _removed++;
+            }
+        }
+        void Detach(const struct sockaddr_un& client)
+        {
+            Clients::iterator index(_attached.begin());
+
+            while (index != _attached.end()) {
+                if (::strncmp(index->sun_path, client.sun_path, sizeof(client.sun_path)) == 0) {
+                    index = _attached.erase(index);
+                } else {
+                    index++;
+                }
+            }
+        }
+        void Event(const string& event)
+        {
+            for (const struct sockaddr_un& client : _attached) {
+                Send(client, _T("<3>") + event);
+            }
+        }
+        void Send(const struct sockaddr_un& client, const string& message)
+        {
+            ::sendto(_socket, message.c_str(), message.length(), 0, reinterpret_cast<const struct sockaddr*>(&client), sizeof(client));
+
+            if (_pending.empty() == false) {
+                std::vector<string> pending;
+                pending.swap(_pending);
+
+                for (const string& event : pending) {
+                    Event(event);
+                }
+            }
+        }
+
+    private:
+        const string _path;
+        const uint16_t _reply;
+        int _socket;
+        Table _table;
+        Clients _attached;
+        uint64_t _results;
+        uint32_t _remove;
+        uint32_t _removed;
+        uint32_t _pages;
+        std::vector<string> _pending;
+    };
+
+    class Config {
+    public:
+        Config(const Config&) = delete;
+        Config& operator=(const Config&) = delete;
+
+        Config()
+            : Socket(_T("/var/run/wpa_supplicant/wlan0"))
+            , Scan()
+            , Generate(100)
+            , Reply(4096)
+            , Duration(0)
+            , AutoScan(0)
+            , ScanTime(2000)
+            , Remove(0)
+        {
+        }
+        ~Config()
+        {
+        }
+
+    public:
+        string Socket;
+        string Scan;
+        uint32_t Generate;
+        uint16_t Reply;
+        uint32_t Duration;
+        uint32_t AutoScan;
+        uint32_t ScanTime;
+        uint32_t Remove;
+    };
+
+    void ParseOptions(int argc, char** argv, Config& config)
+    {
+        Tools::CommandLine options;
+
+        options.Add(_T("socket"), config.Socket, _T("Control socket to serve, <connector>/<interface> of WifiControl"));
+        options.Add(_T("scan"), config.Scan, _T("Recorded \"BSS RANGE=0- MASK=0x121A87\" reply to replay"), _T("generated"));
+        options.Add(_T("generate"), config.Generate, _T("Number of BSSes in the generated table"));
+        options.Add(_T("reply"), config.Reply, _T("Maximum size of a reply, in bytes"));
+        options.Add(_T("duration"), config.Duration, _T("Time to run, in s, 0 is forever"));
+        options.Add(_T("autoscan"), config.AutoScan, _T("Announce scan results every this many ms, 0 only after a SCAN"));
+        options.Add(_T("scantime"), config.ScanTime, _T("Time in ms between the start of a scan and its results"));
+        options.Add(_T("remove"), config.Remove, _T("BSSes of the first page of a fetch reported removed before the next page"));
+
+        options.Parse(argc, argv);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    int result = 0;
+
+    ParseOptions(argc, argv, config);
+
+    {
+        Supplicant supplicant(config.Socket, config.Reply);
+
+        if (config.Scan.empty() == true) {
+            supplicant.Generate(config.Generate);
+        } else if (supplicant.Load(config.Scan) != Core::ERROR_NONE) {
+            printf(_T("Could not find any BSS in: %s\n"), config.Scan.c_str());
+            result = 1;
+        }
+
+        if (result == 0) {
+            if (supplicant.Open() != Core::ERROR_NONE) {
+                printf(_T("Could not open the control socket: %s\n"), config.Socket.c_str());
+                result = 1;
+            } else {
+                supplicant.Run(config.Duration, config.AutoScan, config.ScanTime, config.Remove);
+            }
+        }
+    }
+
+    Core::Singleton::Dispose();
+
+    return (result);
+}
@@ -0,0 +1,409 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME GPIOSim
+#endif
+
+#include <core/core.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include "CommandLine.h"
+
+#undef EXTERNAL
+
+using namespace WPEFramework;
+
+namespace WPEFramework {
+
+    // A chip of the gpio-sim kernel module (5.17 or later), set up through configfs. The level of an input line
+    // follows the pull that is set on it, the level an output line is driven to can be read back.
+    class SimulatedChip {
+    public:
+        SimulatedChip() = delete;
+        SimulatedChip(const SimulatedChip&) = delete;
+        SimulatedChip& operator=(const SimulatedChip&) = delete;
+
+        SimulatedChip(const string& name)
+            : _config(_T("/sys/kernel/config/gpio-sim/") + name)
+            , _lines()
+            , _chip()
+        {
+        }
+        ~SimulatedChip()
+        {
+        }
+
+    public:
+        // Creates the chip, or takes over the one that is left from an earlier run.
+        bool Create(const uint16_t lines)
+        {
+            if (Read(_config + _T("/live")) != _T("1")) {
+                ::mkdir(_config.c_str(), 0755);
+                ::mkdir((_config + _T("/bank0")).c_str(), 0755);
+
+                if ((Write(_config + _T("/bank0/num_lines"), std::to_string(lines)) == false) || (Write(_config + _T("/live"), _T("1")) == false)) {
+                    printf(_T("Could not create the chip in %s, is gpio-sim loaded and configfs mounted?\n"), _config.c_str());
+                }
+            }
+
+            _chip = Read(_config + _T("/bank0/chip_name"));
+            _lines = _T("/sys/devices/platform/") + Read(_config + _T("/dev_name")) + '/' + _chip + _T("/sim_gpio");
+
+            return (_chip.empty() == false);
+        }
+        bool Destroy()
+        {
+            Write(_config + _T("/live"), _T("0"));
+            ::rmdir((_config + _T("/bank0")).c_str());
+
+            return (::rmdir(_config.c_str()) == 0);
+        }
+        const string& Name() const
+        {
+            return (_chip);
+        }
+        bool Pull(const uint16_t line, const bool high)
+        {
+            return (Write(_lines + std::to_string(line) + _T("/pull"), (high == true ? _T("pull-up") : _T("pull-down"))));
+        }
+        // Returns -1 if the line can not be read.
+        int Level(const uint16_t line) const
+        {
+            const string value(Read(_lines + std::to_string(line) + _T("/value")));
+
+            return (value.empty() == true ? -1 : (value == _T("1") ? 1 : 0));
+        }
+
+    private:
+        static bool Write(const string& file, const string& value)
+        {
+            bool result = false;
+            int fd = ::open(file.c_str(), O_WRONLY | O_CLOEXEC);
+
+            if (fd != -1) {
+                result = (::write(fd, value.c_str(), value.length()) == static_cast<ssize_t>(value.length()));
+                ::close(fd);
+            }
+
+            return (result);
+        }
+        static string Read(const string& file)
+        {
+            string result;
+            int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+
+            if (fd != -1) {
+                char buffer[64];
+                const ssize_t size = ::read(fd, buffer, sizeof(buffer));
+
+                if (size > 0) {
+                    result.assign(buffer, size);
+
+                    while ((result.empty() == false) && (::isspace(result.back()) != 0)) {
+                        result.pop_back();
+                    }
+                }
+                ::close(fd);
+            }
+
+            return (result);
+        }
+
+    private:
+        const string _config;
+        string _lines;
+        string _chip;
+    };
+
+    // Reads and sets pins through the web interface of the IOConnector plugin, one connection per request.
+    class Connector {
+    public:
+        Connector() = delete;
+        Connector(const Connector&) = delete;
+        Connector& operator=(const Connector&) = delete;
+
+        Connector(const string& address, const uint16_t port, const string& path)
+            : _address(address)
+            , _port(port)
+            , _path(path)
+        {
+        }
+        ~Connector()
+        {
+        }
+
+    public:
+        // Returns -1 if the pin could not be read.
+        int Get(const uint16_t pin) const
+        {
+            int result = -1;
+            string body;
+
+            if (Exchange(_T("GET"), _path + '/' + std::to_string(pin), body) == 200) {
+                const size_t value = body.find(_T("\"value\":"));
+
+                if (value != string::npos) {
+                    result = (::atoi(&(body.c_str()[value + 8])) != 0 ? 1 : 0);
+                }
+            }
+
+            return (result);
+        }
+        bool Set(const uint16_t pin, const bool value) const
+        {
+            string body;
+
+            return (Exchange(_T("POST"), _path + '/' + std::to_string(pin) + '/' + (value == true ? '1' : '0'), body) == 200);
+        }
+
+    private:
+        uint32_t Exchange(const string& verb, const string& path, string& body) const
+        {
+            uint32_t result = 0;
+            struct sockaddr_in destination;
+
+            ::memset(&destination, 0, sizeof(destination));
+            destination.sin_family = AF_INET;
+            destination.sin_port = htons(_port);
+
+            if (::inet_pton(AF_INET, _address.c_str(), &destination.sin_addr) == 1) {
+                int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+                if (fd != -1) {
+                    const string request(verb + ' ' + path + _T(" HTTP/1.1\r\nHost: ") + _address + _T("\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"));
+
+                    if ((::connect(fd, reinterpret_cast<struct sockaddr*>(&destination), sizeof(destination)) == 0) &&
+                        (::send(fd, request.c_str(), request.length(), MSG_NOSIGNAL) == static_cast<ssize_t>(request.length()))) {
+                        string response;
+                        char data[1024];
+                        ssize_t size;
+                        size_t header = string::npos;
+                        size_t end = string::npos;
+
+                        // Read until the body is complete, the connection might be kept open.
+                        while (((end == string::npos) || (response.length() < end)) && ((size = ::recv(fd, data, sizeof(data), 0)) > 0)) {
+                            response.append(data, size);
+
+                            if ((header == string::npos) && ((header = response.find(_T("\r\n\r\n"))) != string::npos)) {
+                                const size_t field = Find(response.substr(0, header), _T("\r\ncontent-length:"));
+
+                                end = header + 4 + (field == string::npos ? 0 : static_cast<size_t>(::atoi(&(response.c_str()[field + 17]))));
+                            }
+                        }
+
+                        if ((end != string::npos) && (response.length() >= end) && (response.compare(0, 9, _T("HTTP/1.1 ")) == 0)) {
+                            result = static_cast<uint32_t>(::atoi(&(response.c_str()[9])));
+                            body = response.substr(header + 4, end - header - 4);
+                        }
+                    }
+                    ::close(fd);
+                }
+            }
+
+            return (result);
+        }
+        static size_t Find(const string& text, const TCHAR key[])
+        {
+            string lower(text);
+
+            for (char& c : lower) {
+                c = static_cast<char>(::tolower(c));
+            }
+
+            return (lower.find(key));
+        }
+
+    private:
+        const string _address;
+        const uint16_t _port;
+        const string _path;
+    };
+
+    class Config {
+    public:
+        Config(const Config&) = delete;
+        Config& operator=(const Config&) = delete;
+
+        Config()
+            : Address(_T("127.0.0.1"))
+            , Port(80)
+            , Path(_T("/Service/IOConnector"))
+            , Name(_T("IOConnector"))
+            , Inputs(8)
+            , Outputs(2)
+            , First(100)
+            , Edges(400)
+            , Hold(20)
+            , Debounce(0)
+            , Setup(false)
+            , Remove(false)
+        {
+        }
+        ~Config()
+        {
+        }
+
+    public:
+        string Address;
+        uint16_t Port;
+        string Path;
+        string Name;
+        uint16_t Inputs;
+        uint16_t Outputs;
+        uint16_t First;
+        uint32_t Edges;
+        uint16_t Hold;
+        uint16_t Debounce;
+        bool Setup;
+        bool Remove;
+    };
+
+    // The pins the IOConnector plugin needs to be configured with to run the test on the simulated chip.
+    void ShowPins(const Config& config, const string& chip)
+    {
+        printf(_T("\"pins\": [\n"));
+
+        for (uint16_t line = 0; line < (config.Inputs + config.Outputs); line++) {
+            const bool input = (line < config.Inputs);
+
+            printf(_T("    { \"id\": %u, \"chip\": \"%s\", \"line\": %u, \"mode\": \"%s\""), config.First + line, chip.c_str(), line, (input == true ? _T("Both") : _T("Output")));
+            if ((input == true) && (config.Debounce != 0)) {
+                printf(_T(", \"debounce\": %u"), config.Debounce);
+            }
+            printf(_T(" }%s\n"), (line + 1) < (config.Inputs + config.Outputs) ? _T(",") : _T(""));
+        }
+
+        printf(_T("]\n"));
+    }
+
+    // Every edge is driven on the next input line and, after the hold time, read back through the plugin. With
+    // a debounce period, every edge is preceded by a glitch shorter than that period, the kernel should filter
+    // it out. Afterwards every output is set and cleared through the plugin and read back from the chip.
+    uint32_t Run(const Config& config, SimulatedChip& chip, const Connector& connector)
+    {
+        std::vector<bool> levels(config.Inputs, false);
+        uint32_t failures = 0;
+        uint32_t unread = 0;
+        uint64_t slowest = 0;
+
+        for (uint16_t line = 0; line < config.Inputs; line++) {
+            chip.Pull(line, false);
+        }
+        SleepMs(config.Hold + config.Debounce);
+
+        for (uint32_t edge = 0; (edge < config.Edges) && (config.Inputs > 0); edge++) {
+            const uint16_t line = static_cast<uint16_t>(edge % config.Inputs);
+            const bool level = !levels[line];
+
+            if (config.Debounce != 0) {
+                chip.Pull(line, level);
+                chip.Pull(line, !level);
+            }
+
+            const uint64_t start = Core::Time::Now().Ticks();
+            chip.Pull(line, level);
+            levels[line] = level;
+
+            SleepMs(config.Hold + config.Debounce);
+
+            const int value = connector.Get(config.First + line);
+            const uint64_t duration = Core::Time::Now().Ticks() - start;
+
+            slowest = std::max(slowest, duration);
+
+            if (value == -1) {
+                unread++;
+            } else if (value != (level == true ? 1 : 0)) {
+                printf(_T("Edge %u: pin %u reads %d, the line was driven to %d\n"), edge, config.First + line, value, (level == true ? 1 : 0));
+                failures++;
+            }
+        }
+
+        printf(_T("%u edges on %u inputs, %u read wrong, %u not read, slowest check %.1f ms\n"), config.Edges, config.Inputs, failures, unread, static_cast<double>(slowest) / 1000);
+
+        for (uint16_t line = config.Inputs; line < (config.Inputs + config.Outputs); line++) {
+            for (const bool level : { true, false }) {
+                const int value = (connector.Set(config.First + line, level) == true ? chip.Level(line) : -1);
+
+                if (value != (level == true ? 1 : 0)) {
+                    printf(_T("Output pin %u set to %d, the line is at %d\n"), config.First + line, (level == true ? 1 : 0), value);
+                    failures++;
+                }
+            }
+        }
+
+        return (failures + unread);
+    }
+
+    void ParseOptions(int argc, char** argv, Config& config)
+    {
+        Tools::CommandLine options;
+
+        options.Add(_T("address"), config.Address, _T("Address of the Thunder web server"));
+        options.Add(_T("port"), config.Port, _T("Port of the Thunder web server"));
+        options.Add(_T("path"), config.Path, _T("URL of the IOConnector plugin"));
+        options.Add(_T("name"), config.Name, _T("Name of the simulated chip in configfs"));
+        options.Add(_T("inputs"), config.Inputs, _T("Number of input lines"));
+        options.Add(_T("outputs"), config.Outputs, _T("Number of output lines, after the inputs"));
+        options.Add(_T("first"), config.First, _T("Pin id of the first line"));
+        options.Add(_T("edges"), config.Edges, _T("Number of edges to drive"));
+        options.Add(_T("hold"), config.Hold, _T("Time (ms) a level is held before it is checked"));
+        options.Add(_T("debounce"), config.Debounce, _T("Debounce period (ms) of the inputs, precede every edge by a glitch"));
+        options.Add(_T("setup"), config.Setup, _T("Only create the chip and show the pins to configure the plugin with"));
+        options.Add(_T("remove"), config.Remove, _T("Only remove the chip, the plugin must release its lines first"));
+
+        options.Parse(argc, argv);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    int result = 1;
+
+    ParseOptions(argc, argv, config);
+
+    {
+        SimulatedChip chip(config.Name);
+
+        if (config.Remove == true) {
+            result = (chip.Destroy() == true ? 0 : 1);
+        } else if (chip.Create(config.Inputs + config.Outputs) == true) {
+            printf(_T("Simulated chip: %s\n"), chip.Name().c_str());
+
+            if (config.Setup == true) {
+                ShowPins(config, chip.Name());
+                result = 0;
+            } else {
+                Connector connector(config.Address, config.Port, config.Path);
+
+                result = (Run(config, chip, connector) == 0 ? 0 : 1);
+            }
+        }
+    }
+
+    Core::Singleton::Dispose();
+
+    return (result);
+}
@@ -0,0 +1,842 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Non interactive counterpart of the performance menu in JSONRPCClient. It drives the Send, Receive and
+// Exchange methods of Exchange::IPerformance, implemented by the JSONRPCPlugin, over COMRPC, JSONRPC and
+// JSONRPC with MessagePack, from a configurable number of concurrent clients for a configurable time, and
+// reports the latency distribution and throughput of every run as JSON, so builds can be compared.
+
+#define MODULE_NAME JSONRPC_Benchmark
+
+#include <core/core.h>
+#include <websocket/websocket.h>
+#include <interfaces/IPerformance.h>
+
+#include "../JSONRPCPlugin/Data.h"
+
+using namespace WPEFramework;
+
+namespace Benchmark {
+
+typedef std::function<uint32_t(uint16_t& size, uint8_t buffer[])> PerformanceFunction;
+
+static uint8_t swapPattern[] = { 0x00, 0x55, 0xAA, 0xFF };
+
+// Latency histogram in microseconds, with log-linear buckets: every power of two is split in 2^SubBucketBits
+// buckets, so a reported percentile is never more than 1/2^SubBucketBits off, whatever the magnitude.
+class Histogram {
+private:
+    static constexpr uint8_t SubBucketBits = 4;
+    static constexpr uint8_t Ranges = 32 - SubBucketBits + 1;
+    static constexpr uint16_t Buckets = (Ranges << SubBucketBits);
+
+public:
+    Histogram()
+        : _count(0)
+        , _sum(0)
+        , _min(~0)
+        , _max(0)
+    {
+        ::memset(_buckets, 0, sizeof(_buckets));
+    }
+    ~Histogram()
+    {
+    }
+
+public:
+    inline uint64_t Count() const
+    {
+        return (_count);
+    }
+    inline uint32_t Min() const
+    {
+        return (_count == 0 ? 0 : _min);
+    }
+    inline uint32_t Max() const
+    {
+        return (_max);
+    }
+    inline uint32_t Mean() const
+    {
+        return (_count == 0 ? 0 : static_cast<uint32_t>(_sum / _count));
+    }
+    void Add(const uint64_t value)
+    {
+        uint32_t sample = (value > 0xFFFFFFFF ? 0xFFFFFFFF : static_cast<uint32_t>(value));
+
+        _buckets[Index(sample)]++;
+        _count++;
+        _sum += sample;
+
+        if (sample < _min) {
+            _min = sample;
+        }
+        if (sample > _max) {
+            _max = sample;
+        }
+    }
+    void Merge(const Histogram& other)
+    {
+        for (uint16_t index = 0; index < Buckets; index++) {
+            _buckets[index] += other._buckets[index];
+        }
+
+        _count += other._count;
+        _sum += other._sum;
+
+        if (other._min < _min) {
+            _min = other._min;
+        }
+        if (other._max > _max) {
+            _max = other._max;
+        }
+    }
+    // Upper bound of the bucket holding the given percentile, clipped to the largest sample seen.
+    uint32_t Percentile(const uint8_t percentile) const
+    {
+        uint32_t result = 0;
+
+        if (_count != 0) {
+            uint64_t target = ((_count * percentile) + 99) / 100;
+            uint64_t seen = 0;
+            uint16_t index = 0;
+
+            while ((index < Buckets) && ((seen += _buckets[index]) < target)) {
+                index++;
+            }
+
+            result = (index < Buckets ? UpperBound(index) : _max);
+
+            if (result > _max) {
+                result = _max;
+            }
+        }
+
+        return (result);
+    }
+
+private:
+    static uint16_t Index(const uint32_t value)
+    {
+        uint16_t result = static_cast<uint16_t>(value);
+
+        if (value >= (1u << SubBucketBits)) {
+            uint8_t msb = SubBucketBits;
+
+            while ((msb < 31) && ((value >> (msb + 1)) != 0)) {
+                msb++;
+            }
+
+            uint8_t range = msb - SubBucketBits + 1;
+            uint16_t sub = static_cast<uint16_t>((value >> (msb - SubBucketBits)) & ((1u << SubBucketBits) - 1));
+
+            result = (static_cast<uint16_t>(range) << SubBucketBits) | sub;
+        }
+
+        return (result);
+    }
+    static uint32_t UpperBound(const uint16_t index)
+    {
+        uint8_t range = static_cast<uint8_t>(index >> SubBucketBits);
+        uint32_t sub = (index & ((1u << SubBucketBits) - 1));
+        uint32_t result = sub;
+
+        if (range != 0) {
+            uint64_t lower = static_cast<uint64_t>((1u << SubBucketBits) + sub) << (range - 1);
+            uint64_t upper = lower + (static_cast<uint64_t>(1) << (range - 1)) - 1;
+
+            result = (upper > 0xFFFFFFFF ? 0xFFFFFFFF : static_cast<uint32_t>(upper));
+        }
+
+        return (result);
+    }
+
+private:
+    uint64_t _buckets[Buckets];
+    uint64_t _count;
+    uint64_t _sum;
+    uint32_t _min;
+    uint32_t _max;
+};
+
+class Latency : public Core::JSON::Container {
+public:
+    Latency()
+        : Core::JSON::Container()
+        , Min(0)
+        , Mean(0)
+        , P50(0)
+        , P90(0)
+        , P99(0)
+        , Max(0)
+    {
+        Init();
+    }
+    Latency(const Latency& copy)
+        : Core::JSON::Container()
+        , Min(copy.Min)
+        , Mean(copy.Mean)
+        , P50(copy.P50)
+        , P90(copy.P90)
+        , P99(copy.P99)
+        , Max(copy.Max)
+    {
+        Init();
+    }
+    Latency& operator=(const Latency& rhs)
+    {
+        Min = rhs.Min;
+        Mean = rhs.Mean;
+        P50 = rhs.P50;
+        P90 = rhs.P90;
+        P99 = rhs.P99;
+        Max = rhs.Max;
+
+        return (*this);
+    }
+    ~Latency()
+    {
+    }
+
+private:
+    void Init()
+    {
+        Add(_T("min"), &Min);
+        Add(_T("mean"), &Mean);
+        Add(_T("p50"), &P50);
+        Add(_T("p90"), &P90);
+        Add(_T("p99"), &P99);
+        Add(_T("max"), &Max);
+    }
+
+public:
+    // All in microseconds
+    Core::JSON::DecUInt32 Min;
+    Core::JSON::DecUInt32 Mean;
+    Core::JSON::DecUInt32 P50;
+    Core::JSON::DecUInt32 P90;
+    Core::JSON::DecUInt32 P99;
+    Core::JSON::DecUInt32 Max;
+};
+
+class Result : public Core::JSON::Container {
+public:
+    Result()
+        : Core::JSON::Container()
+        , Protocol()
+        , Method()
+        , Size(0)
+        , Clients(0)
+        , Duration(0)
+        , Calls(0)
+        , Errors(0)
+        , Throughput(0)
+        , Latencies()
+    {
+        Init();
+    }
+    Result(const Result& copy)
+        : Core::JSON::Container()
+        , Protocol(copy.Protocol)
+        , Method(copy.Method)
+        , Size(copy.Size)
+        , Clients(copy.Clients)
+        , Duration(copy.Duration)
+        , Calls(copy.Calls)
+        , Errors(copy.Errors)
+        , Throughput(copy.Throughput)
+        , Latencies(copy.Latencies)
+    {
+        Init();
+    }
+    Result& operator=(const Result& rhs)
+    {
+        Protocol = rhs.Protocol;
+        Method = rhs.Method;
+        Size = rhs.Size;
+        Clients = rhs.Clients;
+        Duration = rhs.Duration;
+        Calls = rhs.Calls;
+        Errors = rhs.Errors;
+        Throughput = rhs.Throughput;
+        Latencies = rhs.Latencies;
+
+        return (*this);
+    }
+    ~Result()
+    {
+    }
+
+private:
+    void Init()
+    {
+        Add(_T("protocol"), &Protocol);
+        Add(_T("method"), &Method);
+        Add(_T("size"), &Size);
+        Add(_T("clients"), &Clients);
+        Add(_T("duration"), &Duration);
+        Add(_T("calls"), &Calls);
+        Add(_T("errors"), &Errors);
+        Add(_T("throughput"), &Throughput);
+        Add(_T("latency"), &Latencies);
+    }
+
+public:
+    Core::JSON::String Protocol;
+    Core::JSON::String Method;
+    Core::JSON::DecUInt16 Size; // Payload in bytes
+    Core::JSON::DecUInt16 Clients;
+    Core::JSON::DecUInt32 Duration; // Measured time in mS, warm up excluded
+    Core::JSON::DecUInt64 Calls; // Successful calls
+    Core::JSON::DecUInt64 Errors;
+    Core::JSON::DecUInt64 Throughput; // Successful calls per second
+    Latency Latencies;
+};
+
+class Report : public Core::JSON::Container {
+private:
+    Report(const Report&) = delete;
+    Report& operator=(const Report&) = delete;
+
+public:
+    Report()
+        : Core::JSON::Container()
+        , Label()
+        , Duration(0)
+        , Warmup(0)
+        , Results()
+    {
+        Add(_T("label"), &Label);
+        Add(_T("duration"), &Duration);
+        Add(_T("warmup"), &Warmup);
+        Add(_T("results"), &Results);
+    }
+    ~Report()
+    {
+    }
+
+public:
+    Core::JSON::String Label;
+    Core::JSON::DecUInt32 Duration; // Per run, in seconds
+    Core::JSON::DecUInt32 Warmup; // Per run, in seconds
+    Core::JSON::ArrayType<Result> Results;
+};
+
+// A single client, calling the subject back to back on its own thread till the end of the run. Calls
+// completed before the end of the warm up are not accounted for.
+class Client : public Core::Thread {
+private:
+    Client() = delete;
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+public:
+    Client(const PerformanceFunction& subject, const uint16_t size)
+        : Core::Thread(Core::Thread::DefaultStackSize(), _T("BenchmarkClient"))
+        , _subject(subject)
+        , _size(size)
+        , _buffer(size == 0 ? 1 : size)
+        , _measure(0)
+        , _end(0)
+        , _errors(0)
+        , _latencies()
+        , _done(false, true)
+    {
+        uint8_t patternIndex = 0;
+
+        for (uint8_t& entry : _buffer) {
+            entry = swapPattern[patternIndex++];
+            patternIndex %= sizeof(swapPattern);
+        }
+    }
+    ~Client() override
+    {
+        Block();
+        Wait(Core::Thread::INITIALIZED | Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+    }
+
+public:
+    void Start(const uint64_t measure, const uint64_t end)
+    {
+        _measure = measure;
+        _end = end;
+        _done.ResetEvent();
+
+        Run();
+    }
+    void Join()
+    {
+        _done.Lock(Core::infinite);
+    }
+    inline const Histogram& Latencies() const
+    {
+        return (_latencies);
+    }
+    inline uint64_t Errors() const
+    {
+        return (_errors);
+    }
+
+private:
+    uint32_t Worker() override
+    {
+        uint32_t delay = 0;
+        uint64_t start = Core::Time::Now().Ticks();
+
+        if (start >= _end) {
+            Block();
+            _done.SetEvent();
+            delay = Core::infinite;
+        } else {
+            uint16_t length = _size;
+            uint32_t result = _subject(length, _buffer.data());
+            uint64_t stop = Core::Time::Now().Ticks();
+
+            if (start >= _measure) {
+                if (result == Core::ERROR_NONE) {
+                    _latencies.Add(stop - start);
+                } else {
+                    _errors++;
+                }
+            }
+        }
+
+        return (delay);
+    }
+
+private:
+    PerformanceFunction _subject;
+    const uint16_t _size;
+    std::vector<uint8_t> _buffer;
+    uint64_t _measure;
+    uint64_t _end;
+    uint64_t _errors;
+    Histogram _latencies;
+    Core::Event _done;
+};
+
+// A connection of one client to the JSONRPCPlugin, over a specific protocol.
+struct IChannel {
+    virtual ~IChannel() {}
+
+    virtual bool IsValid() const = 0;
+    virtual PerformanceFunction Function(const string& method) = 0;
+};
+
+class COMRPCChannel : public IChannel {
+private:
+    COMRPCChannel() = delete;
+    COMRPCChannel(const COMRPCChannel&) = delete;
+    COMRPCChannel& operator=(const COMRPCChannel&) = delete;
+
+public:
+    COMRPCChannel(const Core::NodeId& comChannel)
+        : _engine(Core::ProxyType<RPC::InvokeServerType<1, 0, 4>>::Create())
+        , _client(Core::ProxyType<RPC::CommunicatorClient>::Create(comChannel, Core::ProxyType<Core::IIPCServer>(_engine)))
+        , _performance(nullptr)
+    {
+        _engine->Announcements(_client->Announcement());
+
+        if (_client->Open(2000) == Core::ERROR_NONE) {
+            _performance = _client->Aquire<Exchange::IPerformance>(2000, _T("JSONRPCPlugin"), ~0);
+        }
+    }
+    ~COMRPCChannel() override
+    {
+        if (_performance != nullptr) {
+            _performance->Release();
+        }
+
+        _client->Close(Core::infinite);
+        _client.Release();
+    }
+
+public:
+    bool IsValid() const override
+    {
+        return (_performance != nullptr);
+    }
+    PerformanceFunction Function(const string& method) override
+    {
+        PerformanceFunction result;
+        Exchange::IPerformance* perf = _performance;
+
+        if (method == _T("send")) {
+            result = [perf](uint16_t& length, uint8_t buffer[]) -> uint32_t {
+                // Send reports the number of bytes that arrived.
+                return (perf->Send(length, buffer) == length ? Core::ERROR_NONE : Core::ERROR_GENERAL);
+            };
+        } else if (method == _T("receive")) {
+            result = [perf](uint16_t& length, uint8_t buffer[]) -> uint32_t {
+                return (perf->Receive(length, buffer));
+            };
+        } else if (method == _T("exchange")) {
+            result = [perf](uint16_t& length, uint8_t buffer[]) -> uint32_t {
+                const uint16_t maxBufferSize = length;
+                return (perf->Exchange(length, buffer, maxBufferSize));
+            };
+        }
+
+        return (result);
+    }
+
+private:
+    Core::ProxyType<RPC::InvokeServerType<1, 0, 4>> _engine;
+    Core::ProxyType<RPC::CommunicatorClient> _client;
+    Exchange::IPerformance* _performance;
+};
+
+template <typename INTERFACE>
+class JSONRPCChannel : public IChannel {
+private:
+    JSONRPCChannel() = delete;
+    JSONRPCChannel(const JSONRPCChannel<INTERFACE>&) = delete;
+    JSONRPCChannel<INTERFACE>& operator=(const JSONRPCChannel<INTERFACE>&) = delete;
+
+public:
+    JSONRPCChannel(const string& localCallsign)
+        : _remoteObject(_T("JSONRPCPlugin.2"), localCallsign.c_str())
+    {
+    }
+    ~JSONRPCChannel() override
+    {
+    }
+
+public:
+    bool IsValid() const override
+    {
+        return (true);
+    }
+    PerformanceFunction Function(const string& method) override
+    {
+        PerformanceFunction result;
+        JSONRPC::LinkType<INTERFACE>& remoteObject(_remoteObject);
+
+        if (method == _T("send")) {
+            result = [&remoteObject](uint16_t& length, uint8_t buffer[]) -> uint32_t {
+                string stringBuffer;
+                Data::JSONDataBuffer message;
+                Core::JSON::DecUInt32 response;
+                Core::ToString(buffer, length, false, stringBuffer);
+                message.Data = stringBuffer;
+                message.Length = static_cast<uint16_t>(stringBuffer.size());
+                message.Duration = static_cast<uint16_t>(stringBuffer.size() + 1);
+
+                return (remoteObject.template Invoke<Data::JSONDataBuffer, Core::JSON::DecUInt32>(10000, _T("send"), message, response));
+            };
+        } else if (method == _T("receive")) {
+            result = [&remoteObject](uint16_t& length, uint8_t buffer[]) -> uint32_t {
+                Data::JSONDataBuffer message;
+                Core::JSON::DecUInt16 maxSize = length;
+
+                uint32_t status = remoteObject.template Invoke<Core::JSON::DecUInt16, Data::JSONDataBuffer>(10000, _T("receive"), maxSize, message);
+
+                if (status == Core::ERROR_NONE) {
+                    Core::FromString(message.Data.Value(), buffer, length);
+                }
+                return (status);
+            };
+        } else if (method == _T("exchange")) {
+            result = [&remoteObject](uint16_t& length, uint8_t buffer[]) -> uint32_t {
+                string stringBuffer;
+                Data::JSONDataBuffer message;
+                Data::JSONDataBuffer response;
+                Core::ToString(buffer, length, false, stringBuffer);
+                message.Data = stringBuffer;
+                message.Length = length;
+
+                uint32_t status = remoteObject.template Invoke<Data::JSONDataBuffer, Data::JSONDataBuffer>(10000, _T("exchange"), message, response);
+
+                if (status == Core::ERROR_NONE) {
+                    Core::FromString(response.Data.Value(), buffer, length);
+                }
+                return (status);
+            };
+        }
+
+        return (result);
+    }
+
+private:
+    JSONRPC::LinkType<INTERFACE> _remoteObject;
+};
+
+class Options {
+private:
+    Options(const Options&) = delete;
+    Options& operator=(const Options&) = delete;
+
+public:
+    Options()
+        : ComChannel(_T("127.0.0.1:8899"))
+        , Access()
+        , Protocols({ _T("comrpc"), _T("jsonrpc"), _T("msgpack") })
+        , Methods({ _T("send"), _T("receive"), _T("exchange") })
+        , Sizes({ 0, 16, 128, 256, 512, 1024, 2048, 1024 * 32 })
+        , Clients(1)
+        , Duration(5)
+        , Warmup(1)
+        , Label()
+        , Output()
+    {
+    }
+    ~Options()
+    {
+    }
+
+public:
+    // Returns false if the help has to be shown.
+    bool Parse(int argc, char** argv)
+    {
+        int index = 1;
+        bool valid = true;
+
+        while ((index < argc) && (valid == true)) {
+            const bool hasValue = ((index + 1) < argc);
+
+            if ((strcmp(argv[index], "-remote") == 0) && (hasValue == true)) {
+                ComChannel = argv[++index];
+            } else if ((strcmp(argv[index], "-access") == 0) && (hasValue == true)) {
+                Access = argv[++index];
+            } else if ((strcmp(argv[index], "-protocols") == 0) && (hasValue == true)) {
+                Protocols = Split(argv[++index]);
+            } else if ((strcmp(argv[index], "-methods") == 0) && (hasValue == true)) {
+                Methods = Split(argv[++index]);
+            } else if ((strcmp(argv[index], "-sizes") == 0) && (hasValue == true)) {
+                Sizes.clear();
+                for (const string& size : Split(argv[++index])) {
+                    int value = atoi(size.c_str());
+                    Sizes.push_back(static_cast<uint16_t>(value < 0 ? 0 : (value > 0xFFFF ? 0xFFFF : value)));
+                }
+            } else if ((strcmp(argv[index], "-clients") == 0) && (hasValue == true)) {
+                int value = atoi(argv[++index]);
+                Clients = static_cast<uint16_t>(value < 1 ? 1 : (value > 0xFFFF ? 0xFFFF : value));
+            } else if ((strcmp(argv[index], "-duration") == 0) && (hasValue == true)) {
+                int value = atoi(argv[++index]);
+                Duration = static_cast<uint32_t>(value < 1 ? 1 : value);
+            } else if ((strcmp(argv[index], "-warmup") == 0) && (hasValue == true)) {
+                int value = atoi(argv[++index]);
+                Warmup = static_cast<uint32_t>(value < 0 ? 0 : value);
+            } else if ((strcmp(argv[index], "-label") == 0) && (hasValue == true)) {
+                Label = argv[++index];
+            } else if ((strcmp(argv[index], "-output") == 0) && (hasValue == true)) {
+                Output = argv[++index];
+            } else {
+                valid = false;
+            }
+            index++;
+        }
+
+        return (valid);
+    }
+
+    static void Usage(const char* name)
+    {
+        fprintf(stderr, "Usage: %s [options]\n"
+                        "\t-remote <host:port>      COMRPC channel of the server [127.0.0.1:8899]\n"
+                        "\t-access <host:port>      JSONRPC server, overrides THUNDER_ACCESS [127.0.0.1:80]\n"
+                        "\t-protocols <list>        Any of comrpc,jsonrpc,msgpack [all]\n"
+                        "\t-methods <list>          Any of send,receive,exchange [all]\n"
+                        "\t-sizes <list>            Payload sizes in bytes [0,16,128,256,512,1024,2048,32768]\n"
+                        "\t-clients <count>         Concurrent clients [1]\n"
+                        "\t-duration <seconds>      Measured time per run [5]\n"
+                        "\t-warmup <seconds>        Time per run before measuring starts [1]\n"
+                        "\t-label <text>            Label stored in the report, e.g. the build\n"
+                        "\t-output <file>           Write the JSON report to a file instead of stdout\n",
+            name);
+    }
+
+private:
+    static std::list<string> Split(const string& value)
+    {
+        std::list<string> result;
+        Core::TextSegmentIterator index(Core::TextFragment(value), true, ',');
+
+        while (index.Next() == true) {
+            result.push_back(index.Current().Text());
+        }
+
+        return (result);
+    }
+
+public:
+    string ComChannel;
+    string Access;
+    std::list<string> Protocols;
+    std::list<string> Methods;
+    std::list<uint16_t> Sizes;
+    uint16_t Clients;
+    uint32_t Duration;
+    uint32_t Warmup;
+    string Label;
+    string Output;
+};
+
+static IChannel* CreateChannel(const Options& options, const string& protocol, const uint16_t index)
+{
+    IChannel* result = nullptr;
+    const string localCallsign(_T("benchmark.") + Core::NumberType<uint16_t>(index).Text());
+
+    if (protocol == _T("comrpc")) {
+        result = new COMRPCChannel(Core::NodeId(options.ComChannel.c_str()));
+    } else if (protocol == _T("jsonrpc")) {
+        result = new JSONRPCChannel<Core::JSON::IElement>(localCallsign);
+    } else if (protocol == _T("msgpack")) {
+        result = new JSONRPCChannel<Core::JSON::IMessagePack>(localCallsign);
+    }
+
+    return (result);
+}
+
+static void Run(const Options& options, const string& protocol, const string& method, const uint16_t size, std::list<IChannel*>& channels, Report& report)
+{
+    std::list<Client*> clients;
+
+    for (IChannel* channel : channels) {
+        clients.push_back(new Client(channel->Function(method), size));
+    }
+
+    const uint64_t start = Core::Time::Now().Ticks();
+    const uint64_t measure = start + (static_cast<uint64_t>(options.Warmup) * 1000 * Core::Time::TicksPerMillisecond);
+    const uint64_t end = measure + (static_cast<uint64_t>(options.Duration) * 1000 * Core::Time::TicksPerMillisecond);
+
+    for (Client* client : clients) {
+        client->Start(measure, end);
+    }
+
+    Histogram latencies;
+    uint64_t errors = 0;
+
+    for (Client* client : clients) {
+        client->Join();
+        latencies.Merge(client->Latencies());
+        errors += client->Errors();
+        delete client;
+    }
+
+    const uint32_t duration = static_cast<uint32_t>((end - measure) / Core::Time::TicksPerMillisecond);
+
+    Result& result(report.Results.Add());
+    result.Protocol = protocol;
+    result.Method = method;
+    result.Size = size;
+    result.Clients = static_cast<uint16_t>(channels.size());
+    result.Duration = duration;
+    result.Calls = latencies.Count();
+    result.Errors = errors;
+    result.Throughput = (latencies.Count() * 1000) / duration;
+    result.Latencies.Min = latencies.Min();
+    result.Latencies.Mean = latencies.Mean();
+    result.Latencies.P50 = latencies.Percentile(50);
+    result.Latencies.P90 = latencies.Percentile(90);
+    result.Latencies.P99 = latencies.Percentile(99);
+    result.Latencies.Max = latencies.Max();
+
+    fprintf(stderr, "%-8s %-9s %6d bytes, %d clients: %llu calls/s, p50: %u uS, p99: %u uS, errors: %llu\n",
+        protocol.c_str(), method.c_str(), size, result.Clients.Value(),
+        static_cast<unsigned long long>(result.Throughput.Value()), result.Latencies.P50.Value(), result.Latencies.P99.Value(),
+        static_cast<unsigned long long>(errors));
+}
+
+} // namespace Benchmark
+
+int main(int argc, char** argv)
+{
+    int exitCode = 0;
+
+    {
+        Benchmark::Options options;
+
+        if (options.Parse(argc, argv) == false) {
+            Benchmark::Options::Usage(argv[0]);
+            exitCode = 1;
+        } else {
+            Benchmark::Report report;
+            report.Label = options.Label;
+            report.Duration = options.Duration;
+            report.Warmup = options.Warmup;
+
+            if (options.Access.empty() == false) {
+                Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), options.Access);
+            } else {
+                string access;
+                if (Core::SystemInfo::GetEnvironment(_T("THUNDER_ACCESS"), access) == false) {
+                    Core::SystemInfo::SetEnvironment(_T("THUNDER_ACCESS"), (_T("127.0.0.1:80")));
+                }
+            }
+
+            for (const string& protocol : options.Protocols) {
+                std::list<Benchmark::IChannel*> channels;
+                bool valid = true;
+
+                // Every client gets its own connection, so the clients only contend where the protocol does.
+                for (uint16_t index = 0; (index < options.Clients) && (valid == true); index++) {
+                    Benchmark::IChannel* channel = Benchmark::CreateChannel(options, protocol, index);
+
+                    if (channel != nullptr) {
+                        channels.push_back(channel);
+                        valid = channel->IsValid();
+                    } else {
+                        valid = false;
+                    }
+                }
+
+                if (valid == false) {
+                    fprintf(stderr, "Could not set up %d client(s) for [%s], skipping it.\n", options.Clients, protocol.c_str());
+                    exitCode = 1;
+                } else {
+                    for (const string& method : options.Methods) {
+                        if (channels.front()->Function(method) == nullptr) {
+                            fprintf(stderr, "Method [%s] is not supported, skipping it.\n", method.c_str());
+                            exitCode = 1;
+                        } else {
+                            for (const uint16_t size : options.Sizes) {
+                                Benchmark::Run(options, protocol, method, size, channels, report);
+                            }
+                        }
+                    }
+                }
+
+                for (Benchmark::IChannel* channel : channels) {
+                    delete channel;
+                }
+            }
+
+            string text;
+            report.ToString(text);
+
+            if (options.Output.empty() == true) {
+                printf("%s\n", text.c_str());
+            } else {
+                Core::File file(options.Output);
+
+                if (file.Create() == true) {
+                    report.IElement::ToFile(file);
+                } else {
+                    fprintf(stderr, "Could not write the report to %s\n", options.Output.c_str());
+                    exitCode = 1;
+                }
+            }
+        }
+    }
+
+    Core::Singleton::Dispose();
+
+    return (exitCode);
+}
@@ -0,0 +1,342 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME LocationStandIn
+#endif
+
+#include <core/core.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include "CommandLine.h"
+
+#undef EXTERNAL
+
+using namespace WPEFramework;
+
+namespace WPEFramework {
+
+    // Local stand-in for the geo-location endpoint LocationSync probes. It answers on IPv6 and IPv4 with its
+    // own delay per family, or not at all on a family, so the race between the two can be steered. The
+    // plugin only accepts its known domains, so map one of them to the loopback addresses in /etc/hosts:
+    //     ::1 ip-api.com
+    //     127.0.0.1 ip-api.com
+    // and set its "source" to http://ip-api.com:<port>/json (or jsonip.metrological.com with -format jsonip).
+    class Endpoint {
+    public:
+        Endpoint() = delete;
+        Endpoint(const Endpoint&) = delete;
+        Endpoint& operator=(const Endpoint&) = delete;
+
+    private:
+        struct Client {
+            int Socket;
+            bool IPV6;
+            string Address;
+            string Request;
+            uint64_t Due; // 0 till the request is complete.
+        };
+
+        using Clients = std::vector<Client>;
+
+    public:
+        Endpoint(const uint16_t port, const bool jsonip)
+            : _port(port)
+            , _jsonip(jsonip)
+            , _delay{ 0, 0 }
+            , _ipv6(-1)
+            , _ipv4(-1)
+            , _clients()
+            , _served{ 0, 0 }
+        {
+        }
+        ~Endpoint()
+        {
+            for (Client& client : _clients) {
+                ::close(client.Socket);
+            }
+            if (_ipv6 != -1) {
+                ::close(_ipv6);
+            }
+            if (_ipv4 != -1) {
+                ::close(_ipv4);
+            }
+        }
+
+    public:
+        // A negative delay keeps the family closed, connections to it are refused.
+        uint32_t Open(const int32_t delay6, const int32_t delay4)
+        {
+            uint32_t result = Core::ERROR_NONE;
+
+            _delay[0] = delay6;
+            _delay[1] = delay4;
+
+            if (delay6 >= 0) {
+                struct sockaddr_in6 address;
+                ::memset(&address, 0, sizeof(address));
+                address.sin6_family = AF_INET6;
+                address.sin6_port = htons(_port);
+                address.sin6_addr = in6addr_loopback;
+
+                _ipv6 = Listen(AF_INET6, reinterpret_cast<struct sockaddr*>(&address), sizeof(address));
+                result = (_ipv6 == -1 ? Core::ERROR_OPENING_FAILED : result);
+            }
+            if ((result == Core::ERROR_NONE) && (delay4 >= 0)) {
+                struct sockaddr_in address;
+                ::memset(&address, 0, sizeof(address));
+                address.sin_family = AF_INET;
+                address.sin_port = htons(_port);
+                address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+                _ipv4 = Listen(AF_INET, reinterpret_cast<struct sockaddr*>(&address), sizeof(address));
+                result = (_ipv4 == -1 ? Core::ERROR_OPENING_FAILED : result);
+            }
+
+            return (result);
+        }
+        void Run(const uint32_t duration)
+        {
+            const uint64_t never = ~static_cast<uint64_t>(0);
+            const uint64_t end = (duration == 0 ? never : Core::Time::Now().Ticks() + (static_cast<uint64_t>(duration) * 1000000));
+
+            while (Core::Time::Now().Ticks() < end) {
+                std::vector<struct pollfd> descriptors;
+                uint64_t wake = end;
+
+                Add(descriptors, _ipv6);
+                Add(descriptors, _ipv4);
+                for (const Client& client : _clients) {
+                    if (client.Due == 0) {
+                        Add(descriptors, client.Socket);
+                    } else {
+                        wake = std::min(wake, client.Due);
+                    }
+                }
+
+                const uint64_t now = Core::Time::Now().Ticks();
+                const uint64_t wait = (wake > now ? (wake - now) / 1000 : 0);
+
+                if (::poll(descriptors.data(), descriptors.size(), static_cast<int>(wait > 100 ? 100 : wait)) > 0) {
+                    for (const struct pollfd& descriptor : descriptors) {
+                        if ((descriptor.revents & POLLIN) != 0) {
+                            if ((descriptor.fd == _ipv6) || (descriptor.fd == _ipv4)) {
+                                Accept(descriptor.fd);
+                            } else {
+                                Receive(descriptor.fd);
+                            }
+                        }
+                    }
+                }
+
+                Answer();
+            }
+
+            printf(_T("Answered %u probes over IPv6, %u over IPv4\n"), _served[0], _served[1]);
+        }
+
+    private:
+        int Listen(const int family, const struct sockaddr* address, const socklen_t length)
+        {
+            int result = ::socket(family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            int enable = 1;
+
+            if (result != -1) {
+                ::setsockopt(result, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+                if (family == AF_INET6) {
+                    ::setsockopt(result, IPPROTO_IPV6, IPV6_V6ONLY, &enable, sizeof(enable));
+                }
+                if ((::bind(result, address, length) != 0) || (::listen(result, 16) != 0)) {
+                    ::close(result);
+                    result = -1;
+                }
+            }
+
+            return (result);
+        }
+        static void Add(std::vector<struct pollfd>& descriptors, const int socket)
+        {
+            if (socket != -1) {
+                struct pollfd descriptor;
+                descriptor.fd = socket;
+                descriptor.events = POLLIN;
+                descriptor.revents = 0;
+                descriptors.push_back(descriptor);
+            }
+        }
+        void Accept(const int listener)
+        {
+            struct sockaddr_storage address;
+            socklen_t length = sizeof(address);
+            const int socket = ::accept4(listener, reinterpret_cast<struct sockaddr*>(&address), &length, SOCK_CLOEXEC);
+
+            if (socket != -1) {
+                char text[INET6_ADDRSTRLEN];
+                Client client;
+
+                client.Socket = socket;
+                client.IPV6 = (listener == _ipv6);
+                client.Address = (client.IPV6 == true
+                        ? ::inet_ntop(AF_INET6, &(reinterpret_cast<struct sockaddr_in6*>(&address)->sin6_addr), text, sizeof(text))
+                        : ::inet_ntop(AF_INET, &(reinterpret_cast<struct sockaddr_in*>(&address)->sin_addr), text, sizeof(text)));
+                client.Due = 0;
+
+                _clients.push_back(client);
+            }
+        }
+        void Receive(const int socket)
+        {
+            Clients::iterator index(_clients.begin());
+
+            while ((index != _clients.end()) && (index->Socket != socket)) {
+                index++;
+            }
+
+            if (index != _clients.end()) {
+                char buffer[1024];
+                const ssize_t size = ::recv(socket, buffer, sizeof(buffer), 0);
+
+                if (size <= 0) {
+                    ::close(socket);
+                    _clients.erase(index);
+                } else {
+                    index->Request.append(buffer, size);
+
+                    if (index->Request.find(_T("\r\n\r\n")) != string::npos) {
+                        // The probe is in, hold the answer back for the delay of its family.
+                        index->Due = Core::Time::Now().Ticks() + (static_cast<uint64_t>(_delay[index->IPV6 == true ? 0 : 1]) * 1000);
+                    }
+                }
+            }
+        }
+        void Answer()
+        {
+            const uint64_t now = Core::Time::Now().Ticks();
+            Clients::iterator index(_clients.begin());
+
+            while (index != _clients.end()) {
+                if ((index->Due != 0) && (index->Due <= now)) {
+                    const string body(Body(index->Address));
+                    const string response(_T("HTTP/1.1 200 OK\r\n")
+                                          _T("Content-Type: application/json\r\n")
+                                          _T("Content-Length: ") + std::to_string(body.length()) + _T("\r\n")
+                                          _T("Connection: close\r\n\r\n") + body);
+
+                    ::send(index->Socket, response.c_str(), response.length(), MSG_NOSIGNAL);
+                    ::close(index->Socket);
+
+                    printf(_T("Answered the probe of %s over %s\n"), index->Address.c_str(), (index->IPV6 == true ? _T("IPv6") : _T("IPv4")));
+                    _served[index->IPV6 == true ? 0 : 1]++;
+
+                    index = _clients.erase(index);
+                } else {
+                    index++;
+                }
+            }
+        }
+        string Body(const string& address) const
+        {
+            string result;
+
+            if (_jsonip == true) {
+                result = _T("{\"ip\":\"") + address + _T("\",\"ping\":true,\"geo\":{\"country\":\"NL\",\"city\":\"Eindhoven\",")
+                         _T("\"region\":\"NB\",\"tz\":\"Europe/Amsterdam\",\"ll\":[51.44,5.47]}}");
+            } else {
+                result = _T("{\"country\":\"Netherlands\",\"city\":\"Eindhoven\",\"region\":\"NB\",\"timezone\":\"Europe/Amsterdam\",")
+                         _T("\"query\":\"") + address + _T("\",\"lat\":51.44,\"lon\":5.47}");
+            }
+
+            return (result);
+        }
+
+    private:
+        const uint16_t _port;
+        const bool _jsonip;
+        int32_t _delay[2];
+        int _ipv6;
+        int _ipv4;
+        Clients _clients;
+        uint32_t _served[2];
+    };
+
+    class Config {
+    public:
+        Config(const Config&) = delete;
+        Config& operator=(const Config&) = delete;
+
+        Config()
+            : Port(8080)
+            , JSONIP(false)
+            , DelayIPV6(0)
+            , DelayIPV4(0)
+            , Duration(0)
+        {
+        }
+        ~Config()
+        {
+        }
+
+    public:
+        uint16_t Port;
+        bool JSONIP;
+        int32_t DelayIPV6;
+        int32_t DelayIPV4;
+        uint32_t Duration;
+    };
+
+    void ParseOptions(int argc, char** argv, Config& config)
+    {
+        Tools::CommandLine options;
+
+        options.Add(_T("port"), config.Port, _T("Port to listen on, on ::1 and 127.0.0.1"));
+        options.Add(_T("format"), true, [&config](const char value[]) { config.JSONIP = (strcmp(value, "jsonip") == 0); }, _T("Answer as ip-api or as jsonip"), _T("ip-api"));
+        options.Add(_T("delay6"), config.DelayIPV6, _T("Time in ms to hold back an answer over IPv6, -1 refuses IPv6"));
+        options.Add(_T("delay4"), config.DelayIPV4, _T("Time in ms to hold back an answer over IPv4, -1 refuses IPv4"));
+        options.Add(_T("duration"), config.Duration, _T("Time to run, in s, 0 is forever"));
+
+        options.Parse(argc, argv);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    int result = 0;
+
+    ParseOptions(argc, argv, config);
+
+    {
+        Endpoint endpoint(config.Port, config.JSONIP);
+
+        if (endpoint.Open(config.DelayIPV6, config.DelayIPV4) != Core::ERROR_NONE) {
+            printf(_T("Could not listen on port: %u\n"), config.Port);
+            result = 1;
+        } else {
+            endpoint.Run(config.Duration);
+        }
+    }
+
+    Core::Singleton::Dispose();
+
+    return (result);
+}
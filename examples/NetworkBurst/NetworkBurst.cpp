@@ -0,0 +1,303 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME NetworkBurst
+#endif
+
+#include <core/core.h>
+
+#include <sys/stat.h>
+
+#include "CommandLine.h"
+
+using namespace WPEFramework;
+
+namespace WPEFramework {
+
+    // Drives the NetworkControl plugin with bursts of link flaps and address changes, the way a DHCP renewal
+    // on a flaky link does. A veth pair is created, the host side is the interface NetworkControl manages (add
+    // it to the "interfaces" of its config), the peer lives in its own network namespace, optionally with a
+    // dnsmasq handing out leases and a DNS server. During every burst and its settle time the DNS file is
+    // watched: NetworkControl should write it at most once per burst. With -tamper the section of
+    // NetworkControl is removed from the file before every burst, the DHCP renewal of the burst should put it back.
+    // Needs root and the ip tool.
+    class Harness {
+    public:
+        Harness(const Harness&) = delete;
+        Harness& operator=(const Harness&) = delete;
+
+        Harness(const string& interface, const string& nameSpace, const string& dnsFile)
+            : _interface(interface)
+            , _peer(interface + _T("p"))
+            , _nameSpace(nameSpace)
+            , _dnsFile(dnsFile)
+            , _dhcp(false)
+        {
+        }
+        ~Harness()
+        {
+            Close();
+        }
+
+    public:
+        uint32_t Open(const bool dhcp)
+        {
+            uint32_t result = Core::ERROR_NONE;
+
+            Close();
+
+            if ((Run(_T("ip netns add ") + _nameSpace) != 0) ||
+                (Run(_T("ip link add ") + _interface + _T(" type veth peer name ") + _peer) != 0) ||
+                (Run(_T("ip link set ") + _peer + _T(" netns ") + _nameSpace) != 0) ||
+                (Run(InNameSpace(_T("ip addr add ") + string(PeerAddress) + _T("/24 dev ") + _peer)) != 0) ||
+                (Run(InNameSpace(_T("ip link set ") + _peer + _T(" up"))) != 0) ||
+                (Run(_T("ip link set ") + _interface + _T(" up")) != 0)) {
+                result = Core::ERROR_OPENING_FAILED;
+            } else if (dhcp == true) {
+                // The peer is the DHCP server and announces itself as the DNS server.
+                if (Run(InNameSpace(_T("dnsmasq --interface=") + _peer + _T(" --bind-interfaces --port=0 --dhcp-range=10.254.0.10,10.254.0.20,60s --dhcp-option=6,") + PeerAddress + _T(" --pid-file=") + PidFile())) != 0) {
+                    result = Core::ERROR_OPENING_FAILED;
+                } else {
+                    _dhcp = true;
+                }
+            }
+
+            return (result);
+        }
+        void Close()
+        {
+            if (_dhcp == true) {
+                Run(_T("kill $(cat ") + PidFile() + _T(")"));
+                _dhcp = false;
+            }
+            // Removing the namespace removes the peer, and with it the pair.
+            Run(_T("ip link del ") + _interface + _T(" 2>/dev/null"));
+            Run(_T("ip netns del ") + _nameSpace + _T(" 2>/dev/null"));
+        }
+        // Returns the number of times the DNS file was written during the burst and the settle time after it.
+        uint32_t Burst(const uint32_t flaps, const uint32_t gap, const uint32_t settle, const uint32_t sequence)
+        {
+            const string address(_T("10.254.1.") + std::to_string(1 + (sequence % 250)) + _T("/24"));
+            Watcher watcher(_dnsFile);
+
+            for (uint32_t flap = 0; flap < flaps; flap++) {
+                Run(_T("ip link set ") + _interface + _T(" down"));
+                watcher.Poll(gap / 2);
+                Run(_T("ip link set ") + _interface + _T(" up"));
+                // An extra address comes and goes, like a lease being replaced.
+                Run(_T("ip addr add ") + address + _T(" dev ") + _interface);
+                watcher.Poll(gap / 2);
+                Run(_T("ip addr del ") + address + _T(" dev ") + _interface);
+            }
+
+            watcher.Poll(settle);
+
+            return (watcher.Changes());
+        }
+        // Removes the section NetworkControl keeps in the DNS file, as a DHCP client of another process would.
+        bool Tamper()
+        {
+            return (Run(_T("sed -i '/^#++SECTION: /,/^#--SECTION: /d' ") + _dnsFile) == 0);
+        }
+        bool HasSection() const
+        {
+            return (Run(_T("grep -q '^#++SECTION: ' ") + _dnsFile) == 0);
+        }
+
+    private:
+        class Watcher {
+        public:
+            Watcher(const Watcher&) = delete;
+            Watcher& operator=(const Watcher&) = delete;
+
+            Watcher(const string& fileName)
+                : _fileName(fileName)
+                , _stamp(Stamp())
+                , _changes(0)
+            {
+            }
+            ~Watcher()
+            {
+            }
+
+        public:
+            void Poll(const uint32_t duration)
+            {
+                const uint64_t end = Core::Time::Now().Ticks() + (static_cast<uint64_t>(duration) * Core::Time::TicksPerMillisecond);
+
+                do {
+                    const uint64_t stamp = Stamp();
+
+                    if (stamp != _stamp) {
+                        _stamp = stamp;
+                        _changes++;
+                    }
+                    SleepMs(PollInterval);
+                } while (Core::Time::Now().Ticks() < end);
+            }
+            uint32_t Changes() const
+            {
+                return (_changes);
+            }
+
+        private:
+            static constexpr uint32_t PollInterval = 5;
+
+            uint64_t Stamp() const
+            {
+                struct stat info;
+                uint64_t result = 0;
+
+                if (stat(_fileName.c_str(), &info) == 0) {
+                    result = (static_cast<uint64_t>(info.st_mtim.tv_sec) * 1000000000) + info.st_mtim.tv_nsec;
+                }
+                return (result);
+            }
+
+        private:
+            const string _fileName;
+            uint64_t _stamp;
+            uint32_t _changes;
+        };
+
+        string InNameSpace(const string& command) const
+        {
+            return (_T("ip netns exec ") + _nameSpace + _T(" ") + command);
+        }
+        string PidFile() const
+        {
+            return (_T("/tmp/") + _nameSpace + _T(".dnsmasq.pid"));
+        }
+        static int Run(const string& command)
+        {
+            TRACE_L1("%s", command.c_str());
+            return (system(command.c_str()));
+        }
+
+    private:
+        static constexpr const TCHAR* PeerAddress = _T("10.254.0.1");
+
+        const string _interface;
+        const string _peer;
+        const string _nameSpace;
+        const string _dnsFile;
+        bool _dhcp;
+    };
+
+    class Config {
+    public:
+        Config(const Config&) = delete;
+        Config& operator=(const Config&) = delete;
+
+        Config()
+            : Interface(_T("veth0"))
+            , NameSpace(_T("networkburst"))
+            , DNSFile(_T("/etc/resolv.conf"))
+            , Bursts(10)
+            , Flaps(5)
+            , Gap(50)
+            , Settle(2000)
+            , DHCP(false)
+            , Tamper(false)
+        {
+        }
+        ~Config()
+        {
+        }
+
+    public:
+        string Interface;
+        string NameSpace;
+        string DNSFile;
+        uint32_t Bursts;
+        uint32_t Flaps;
+        uint32_t Gap;
+        uint32_t Settle;
+        bool DHCP;
+        bool Tamper;
+    };
+
+    void ParseOptions(int argc, char** argv, Config& config)
+    {
+        Tools::CommandLine options;
+
+        options.Add(_T("interface"), config.Interface, _T("Host side of the veth pair, the interface NetworkControl manages"));
+        options.Add(_T("namespace"), config.NameSpace, _T("Network namespace the peer is moved to"));
+        options.Add(_T("dnsfile"), config.DNSFile, _T("DNS file NetworkControl writes, see \"dnsfile\""));
+        options.Add(_T("bursts"), config.Bursts, _T("Number of bursts"));
+        options.Add(_T("flaps"), config.Flaps, _T("Link flaps per burst"));
+        options.Add(_T("gap"), config.Gap, _T("Time in ms between two flaps"));
+        options.Add(_T("settle"), config.Settle, _T("Time in ms the DNS file is watched after a burst"));
+        options.Add(_T("dhcp"), config.DHCP, _T("Run dnsmasq on the peer, handing out leases and a DNS server"));
+        options.Add(_T("tamper"), config.Tamper, _T("Remove the NetworkControl section from the DNS file before every burst, use with -dhcp"));
+
+        options.Parse(argc, argv);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    int result = 0;
+
+    ParseOptions(argc, argv, config);
+
+    {
+        Harness harness(config.Interface, config.NameSpace, config.DNSFile);
+
+        if (harness.Open(config.DHCP) != Core::ERROR_NONE) {
+            printf(_T("Could not set up %s in namespace %s, are we root?\n"), config.Interface.c_str(), config.NameSpace.c_str());
+            result = 1;
+        } else {
+            uint32_t overwritten = 0;
+            uint32_t restored = 0;
+            uint32_t excess = 0;
+
+            // Let NetworkControl pick up the new interface first.
+            SleepMs(config.Settle);
+
+            for (uint32_t burst = 0; burst < config.Bursts; burst++) {
+                if ((config.Tamper == true) && (harness.Tamper() == true)) {
+                    overwritten++;
+                }
+
+                // The watch starts after the tampering, only the writes of NetworkControl are counted.
+                const uint32_t writes = harness.Burst(config.Flaps, config.Gap, config.Settle, burst);
+                const bool section = harness.HasSection();
+
+                restored += ((config.Tamper == true) && (section == true) ? 1 : 0);
+                excess += (writes > 1 ? writes - 1 : 0);
+
+                printf(_T("Burst %u: %u flaps, DNS file written %u times, section %s\n"), burst, config.Flaps, writes, (section == true ? _T("present") : _T("missing")));
+            }
+
+            printf(_T("%u bursts, %u extra DNS writes\n"), config.Bursts, excess);
+            if (config.Tamper == true) {
+                printf(_T("%u of %u removed sections restored\n"), restored, overwritten);
+            }
+
+            result = ((excess == 0) && (restored == overwritten) ? 0 : 1);
+        }
+    }
+
+    Core::Singleton::Dispose();
+
+    return (result);
+}
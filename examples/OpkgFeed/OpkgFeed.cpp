@@ -0,0 +1,237 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME OpkgFeed
+#endif
+
+#include <core/core.h>
+
+#include <fstream>
+#include <sys/stat.h>
+
+#include "CommandLine.h"
+
+using namespace WPEFramework;
+
+namespace WPEFramework {
+
+    // Writes a local opkg feed to install from with the Packager plugin: a number of applications that share
+    // a few libraries, so a batch of installs resolves and fetches the shared dependencies once. Point a
+    // "src/gz" line of opkg.conf to the printed file:// url. With -touch the index of an existing feed is
+    // rewritten, so the next forced sync sees the feed changed, without it a sync should be skipped.
+    class Feed {
+    public:
+        Feed() = delete;
+        Feed(const Feed&) = delete;
+        Feed& operator=(const Feed&) = delete;
+
+        Feed(const string& directory, const string& architecture)
+            : _directory(directory)
+            , _architecture(architecture)
+            , _index()
+        {
+        }
+        ~Feed()
+        {
+        }
+
+    public:
+        uint32_t Create(const uint32_t applications, const uint32_t libraries, const uint32_t size)
+        {
+            uint32_t result = (Run(_T("mkdir -p ") + _directory) == 0 ? Core::ERROR_NONE : Core::ERROR_OPENING_FAILED);
+
+            _index.clear();
+
+            for (uint32_t index = 0; (index < libraries) && (result == Core::ERROR_NONE); index++) {
+                result = Package(_T("test-lib-") + std::to_string(index), string(), size);
+            }
+            for (uint32_t index = 0; (index < applications) && (result == Core::ERROR_NONE); index++) {
+                result = Package(_T("test-app-") + std::to_string(index),
+                    (libraries == 0 ? string() : _T("test-lib-") + std::to_string(index % libraries)), size);
+            }
+
+            if (result == Core::ERROR_NONE) {
+                result = Index();
+            }
+
+            return (result);
+        }
+        // Same content, new modification time of the index.
+        uint32_t Touch()
+        {
+            return (Run(_T("gunzip -c ") + _directory + _T("/Packages.gz > ") + _directory + _T("/Packages && ") +
+                           _T("gzip -9 -n -f -k ") + _directory + _T("/Packages")) == 0
+                    ? Core::ERROR_NONE
+                    : Core::ERROR_OPENING_FAILED);
+        }
+        string URL() const
+        {
+            return (_T("file://") + _directory);
+        }
+
+    private:
+        // An .ipk is an ar archive of debian-binary, control.tar.gz and data.tar.gz, the payload is random so
+        // it does not compress away and every download costs its size.
+        uint32_t Package(const string& name, const string& depends, const uint32_t size)
+        {
+            const string work(_directory + _T("/.") + name);
+            const string ipk(name + _T("_1.0_") + _architecture + _T(".ipk"));
+            string control(_T("Package: ") + name + _T("\n")
+                           _T("Version: 1.0\n")
+                           _T("Architecture: ") + _architecture + _T("\n")
+                           _T("Maintainer: OpkgFeed\n")
+                           _T("Description: Generated test package\n"));
+            uint32_t result = Core::ERROR_OPENING_FAILED;
+
+            if (depends.empty() == false) {
+                control += _T("Depends: ") + depends + _T("\n");
+            }
+
+            if (Run(_T("rm -rf ") + work + _T(" && mkdir -p ") + work + _T("/control ") + work + _T("/data/usr/share/") + name) == 0) {
+                std::ofstream(work + _T("/control/control")) << control;
+                std::ofstream(work + _T("/debian-binary")) << _T("2.0\n");
+
+                if (Run(_T("head -c ") + std::to_string(size) + _T(" /dev/urandom > ") + work + _T("/data/usr/share/") + name + _T("/payload && ") +
+                        _T("tar -C ") + work + _T("/control -czf ") + work + _T("/control.tar.gz ./control && ") +
+                        _T("tar -C ") + work + _T("/data -czf ") + work + _T("/data.tar.gz . && ") +
+                        _T("rm -f ") + _directory + _T("/") + ipk + _T(" && ") +
+                        _T("cd ") + work + _T(" && ar rc ../") + ipk + _T(" debian-binary control.tar.gz data.tar.gz && ") +
+                        _T("rm -rf ") + work) == 0) {
+
+                    struct stat info;
+                    const string file(_directory + _T("/") + ipk);
+
+                    if (::stat(file.c_str(), &info) == 0) {
+                        _index += control + _T("Filename: ") + ipk + _T("\n") +
+                            _T("Size: ") + std::to_string(info.st_size) + _T("\n") +
+                            _T("SHA256sum: ") + Checksum(file) + _T("\n\n");
+                        result = Core::ERROR_NONE;
+                    }
+                }
+            }
+
+            return (result);
+        }
+        uint32_t Index()
+        {
+            std::ofstream(_directory + _T("/Packages")) << _index;
+
+            return (Run(_T("gzip -9 -n -f -k ") + _directory + _T("/Packages")) == 0 ? Core::ERROR_NONE : Core::ERROR_OPENING_FAILED);
+        }
+        static string Checksum(const string& file)
+        {
+            string result;
+            FILE* output = popen((_T("sha256sum ") + file).c_str(), "r");
+
+            if (output != nullptr) {
+                char buffer[65];
+
+                if (fgets(buffer, sizeof(buffer), output) != nullptr) {
+                    result = buffer;
+                }
+                pclose(output);
+            }
+
+            return (result);
+        }
+        static int Run(const string& command)
+        {
+            TRACE_L1("%s", command.c_str());
+            return (system(command.c_str()));
+        }
+
+    private:
+        const string _directory;
+        const string _architecture;
+        string _index;
+    };
+
+    class Config {
+    public:
+        Config(const Config&) = delete;
+        Config& operator=(const Config&) = delete;
+
+        Config()
+            : Directory(_T("/tmp/opkgfeed"))
+            , Architecture(_T("all"))
+            , Applications(5)
+            , Libraries(2)
+            , Size(1024 * 1024)
+            , Touch(false)
+        {
+        }
+        ~Config()
+        {
+        }
+
+    public:
+        string Directory;
+        string Architecture;
+        uint32_t Applications;
+        uint32_t Libraries;
+        uint32_t Size;
+        bool Touch;
+    };
+
+    void ParseOptions(int argc, char** argv, Config& config)
+    {
+        Tools::CommandLine options;
+
+        options.Add(_T("dir"), config.Directory, _T("Directory to write the feed to"));
+        options.Add(_T("arch"), config.Architecture, _T("Architecture of the packages"));
+        options.Add(_T("apps"), config.Applications, _T("Number of applications, test-app-<n>"));
+        options.Add(_T("libs"), config.Libraries, _T("Number of libraries the applications depend on, test-lib-<n>"));
+        options.Add(_T("size"), config.Size, _T("Payload of every package, in bytes"));
+        options.Add(_T("touch"), config.Touch, _T("Only rewrite the index of an existing feed, to make it look changed"));
+
+        options.Parse(argc, argv);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    int result = 0;
+
+    ParseOptions(argc, argv, config);
+
+    {
+        Feed feed(config.Directory, config.Architecture);
+
+        if (config.Touch == true) {
+            if (feed.Touch() != Core::ERROR_NONE) {
+                printf(_T("Could not rewrite the index in: %s\n"), config.Directory.c_str());
+                result = 1;
+            } else {
+                printf(_T("Index rewritten, the next forced sync of %s should run\n"), feed.URL().c_str());
+            }
+        } else if (feed.Create(config.Applications, config.Libraries, config.Size) != Core::ERROR_NONE) {
+            printf(_T("Could not write the feed to: %s\n"), config.Directory.c_str());
+            result = 1;
+        } else {
+            printf(_T("Feed with %u applications and %u libraries written, add to opkg.conf:\n"), config.Applications, config.Libraries);
+            printf(_T("src/gz test %s\n"), feed.URL().c_str());
+        }
+    }
+
+    Core::Singleton::Dispose();
+
+    return (result);
+}
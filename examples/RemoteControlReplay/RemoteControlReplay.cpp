@@ -0,0 +1,270 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME RemoteControlReplay
+#endif
+
+#include <core/core.h>
+
+#include <fcntl.h>
+#include <linux/uinput.h>
+
+#include "CommandLine.h"
+
+#undef EXTERNAL
+
+using namespace WPEFramework;
+
+namespace WPEFramework {
+
+    // Replays a recorded evdev key sequence (raw struct input_event records, as captured with
+    // "cat /dev/input/eventX > capture") through a uinput keyboard, to benchmark the key path of the
+    // RemoteControl plugin (LinuxDevice producer) end to end. Check the result with RemoteControl.1.latency.
+    class Replay {
+    public:
+        Replay() = delete;
+        Replay(const Replay&) = delete;
+        Replay& operator=(const Replay&) = delete;
+
+        Replay(const string& name)
+            : _name(name)
+            , _fd(-1)
+            , _events()
+        {
+        }
+        ~Replay()
+        {
+            Close();
+        }
+
+    public:
+        uint32_t Load(const string& fileName)
+        {
+            uint32_t result = Core::ERROR_OPENING_FAILED;
+            int fd = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+
+            if (fd != -1) {
+                struct input_event event;
+
+                while (::read(fd, &event, sizeof(event)) == static_cast<ssize_t>(sizeof(event))) {
+                    // Only key presses/releases, autorepeat is generated by the plugin itself.
+                    if ((event.type == EV_KEY) && (event.value != 2)) {
+                        _events.push_back(event);
+                    }
+                }
+
+                ::close(fd);
+                result = (_events.empty() == true ? Core::ERROR_INVALID_INPUT_LENGTH : Core::ERROR_NONE);
+            }
+
+            return (result);
+        }
+        uint32_t Open()
+        {
+            uint32_t result = Core::ERROR_OPENING_FAILED;
+
+            _fd = ::open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+
+            if (_fd != -1) {
+                struct uinput_user_dev device;
+                ::memset(&device, 0, sizeof(device));
+
+                // LinuxDevice recognises a keyboard by its name.
+                ::strncpy(device.name, _name.c_str(), UINPUT_MAX_NAME_SIZE - 1);
+                device.id.bustype = BUS_VIRTUAL;
+                device.id.vendor = 0x1;
+                device.id.product = 0x1;
+                device.id.version = 1;
+
+                ::ioctl(_fd, UI_SET_EVBIT, EV_KEY);
+                ::ioctl(_fd, UI_SET_EVBIT, EV_SYN);
+                for (uint16_t code = 1; code < KEY_MAX; code++) {
+                    ::ioctl(_fd, UI_SET_KEYBIT, code);
+                }
+
+                if ((::write(_fd, &device, sizeof(device)) == static_cast<ssize_t>(sizeof(device))) && (::ioctl(_fd, UI_DEV_CREATE) >= 0)) {
+                    result = Core::ERROR_NONE;
+                } else {
+                    ::close(_fd);
+                    _fd = -1;
+                }
+            }
+
+            return (result);
+        }
+        void Close()
+        {
+            if (_fd != -1) {
+                ::ioctl(_fd, UI_DEV_DESTROY);
+                ::close(_fd);
+                _fd = -1;
+            }
+        }
+        uint32_t Events() const
+        {
+            return (static_cast<uint32_t>(_events.size()));
+        }
+        // A rate of 0 replays with the recorded timing, multiplied by speed. Otherwise events are sent at
+        // the given number of events per second. Returns the time it took, in microseconds.
+        uint64_t Run(const uint32_t rate, const float speed, const uint32_t loops)
+        {
+            const uint64_t start = Core::Time::Now().Ticks();
+            uint64_t next = start;
+
+            for (uint32_t loop = 0; loop < loops; loop++) {
+                std::vector<struct input_event>::const_iterator index(_events.begin());
+                uint64_t previous = Timestamp(*index);
+
+                while (index != _events.end()) {
+                    if (rate != 0) {
+                        next += (1000000 / rate);
+                    } else {
+                        const uint64_t recorded = Timestamp(*index);
+                        next += static_cast<uint64_t>((recorded > previous ? (recorded - previous) : 0) / speed);
+                        previous = recorded;
+                    }
+
+                    const uint64_t now = Core::Time::Now().Ticks();
+                    if (next > now) {
+                        ::usleep(static_cast<useconds_t>(next - now));
+                    }
+
+                    Send(EV_KEY, index->code, index->value);
+                    Send(EV_SYN, SYN_REPORT, 0);
+                    index++;
+                }
+            }
+
+            return (Core::Time::Now().Ticks() - start);
+        }
+
+    private:
+        static uint64_t Timestamp(const struct input_event& event)
+        {
+#ifdef input_event_sec
+            return ((static_cast<uint64_t>(event.input_event_sec) * 1000000) + event.input_event_usec);
+#else
+            return ((static_cast<uint64_t>(event.time.tv_sec) * 1000000) + event.time.tv_usec);
+#endif
+        }
+        void Send(const uint16_t type, const uint16_t code, const int32_t value)
+        {
+            struct input_event event;
+            ::memset(&event, 0, sizeof(event));
+            event.type = type;
+            event.code = code;
+            event.value = value;
+
+            if (::write(_fd, &event, sizeof(event)) != static_cast<ssize_t>(sizeof(event))) {
+                printf("Failed to send event, error: %d\n", errno);
+            }
+        }
+
+    private:
+        const string _name;
+        int _fd;
+        std::vector<struct input_event> _events;
+    };
+
+    class Config {
+    public:
+        Config(const Config&) = delete;
+        Config& operator=(const Config&) = delete;
+
+        Config()
+            : Capture()
+            , Name(_T("Replay keyboard"))
+            , Rate(0)
+            , Speed(1.0)
+            , Loops(1)
+            , Settle(1000)
+        {
+        }
+        ~Config()
+        {
+        }
+
+    public:
+        string Capture;
+        string Name;
+        uint32_t Rate;
+        float Speed;
+        uint32_t Loops;
+        uint32_t Settle;
+    };
+
+    void ParseOptions(int argc, char** argv, Config& config)
+    {
+        Tools::CommandLine options;
+
+        options.Add(_T("capture"), config.Capture, _T("File with the recorded input_event records, obligatory"));
+        options.Add(_T("name"), config.Name, _T("Name of the uinput device, should contain \"keyboard\""));
+        options.Add(_T("rate"), config.Rate, _T("Events per second, 0 replays with the recorded timing"));
+        options.Add(_T("speed"), config.Speed, _T("Speed factor for the recorded timing"));
+        options.Add(_T("loops"), config.Loops, _T("Number of times the capture is replayed"));
+        options.Add(_T("settle"), config.Settle, _T("Time in ms to wait for the device to be picked up"));
+
+        options.Parse(argc, argv);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    ParseOptions(argc, argv, config);
+
+    if ((config.Capture.empty() == true) || (config.Speed <= 0) || (config.Loops == 0)) {
+        printf(_T("Wrong parameter, use option -h to check required input arguments\n"));
+        return (1);
+    }
+
+    Replay replay(config.Name);
+
+    if (replay.Load(config.Capture) != Core::ERROR_NONE) {
+        printf(_T("Could not load any key events from: %s\n"), config.Capture.c_str());
+        return (1);
+    }
+
+    if (replay.Open() != Core::ERROR_NONE) {
+        printf(_T("Could not create the uinput device, error: %d\n"), errno);
+        return (1);
+    }
+
+    // Give udev and the RemoteControl plugin the time to open the new device.
+    SleepMs(config.Settle);
+
+    printf(_T("Replaying %d events, %d time(s)\n"), replay.Events(), config.Loops);
+
+    uint64_t duration = replay.Run(config.Rate, config.Speed, config.Loops);
+    uint64_t total = static_cast<uint64_t>(replay.Events()) * config.Loops;
+
+    printf(_T("Sent %llu events in %llu ms, %.1f events/s\n"),
+        static_cast<unsigned long long>(total),
+        static_cast<unsigned long long>(duration / 1000),
+        (duration == 0 ? 0.0 : ((total * 1000000.0) / duration)));
+
+    // Let the last keys drain before the device disappears.
+    SleepMs(config.Settle);
+
+    replay.Close();
+    Core::Singleton::Dispose();
+
+    return (0);
+}
@@ -0,0 +1,401 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MODULE_NAME
+#define MODULE_NAME RtpSender
+#endif
+
+#include <core/core.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "CommandLine.h"
+
+#undef EXTERNAL
+
+using namespace WPEFramework;
+
+namespace WPEFramework {
+
+    // Sends an MPEG-TS over RTP stream to the receiver of the RtspClient plugin (see "rtpport"), with a
+    // configurable amount of loss, reordering, duplication and jitter. The RTCP receiver reports of the
+    // plugin are collected on the port following the sending port and compared with what was injected.
+    class Sender {
+    public:
+        Sender() = delete;
+        Sender(const Sender&) = delete;
+        Sender& operator=(const Sender&) = delete;
+
+        struct Impairments {
+            uint8_t Loss; // Percentage
+            uint8_t Reorder; // Percentage
+            uint8_t Duplicate; // Percentage
+            uint32_t Jitter; // Maximum extra delay, in mS
+        };
+
+        struct Counters {
+            uint32_t Sent;
+            uint32_t Dropped;
+            uint32_t Reordered;
+            uint32_t Duplicated;
+            uint32_t Reports;
+            uint8_t FractionLost; // Of the last report, in 1/256
+            int32_t CumulativeLost; // Of the last report
+            uint32_t Jitter; // Of the last report, in RTP timestamp units
+        };
+
+    private:
+        static constexpr uint32_t ClockRate = 90000;
+        static constexpr uint8_t PayloadType = 33; // MP2T
+        static constexpr uint8_t RtcpSenderReport = 200;
+        static constexpr uint8_t RtcpReceiverReport = 201;
+        static constexpr uint16_t TSPacketSize = 188;
+
+    public:
+        Sender(const uint16_t localPort)
+            : _localPort(localPort)
+            , _rtp(-1)
+            , _rtcp(-1)
+            , _destination()
+            , _ssrc(static_cast<uint32_t>(Core::Time::Now().Ticks()))
+            , _sequence(0)
+            , _state(_ssrc | 1)
+            , _octets(0)
+            , _counters()
+        {
+            ::memset(&_counters, 0, sizeof(_counters));
+        }
+        ~Sender()
+        {
+            Close();
+        }
+
+    public:
+        uint32_t Open(const string& address, const uint16_t port)
+        {
+            uint32_t result = Core::ERROR_OPENING_FAILED;
+            struct sockaddr_in local;
+
+            ::memset(&_destination, 0, sizeof(_destination));
+            _destination.sin_family = AF_INET;
+            _destination.sin_port = htons(port);
+
+            ::memset(&local, 0, sizeof(local));
+            local.sin_family = AF_INET;
+            local.sin_addr.s_addr = htonl(INADDR_ANY);
+
+            if (::inet_pton(AF_INET, address.c_str(), &_destination.sin_addr) == 1) {
+                _rtp = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+                _rtcp = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+
+                local.sin_port = htons(_localPort);
+                bool bound = (_rtp != -1) && (::bind(_rtp, reinterpret_cast<struct sockaddr*>(&local), sizeof(local)) == 0);
+                local.sin_port = htons(_localPort + 1);
+                bound = bound && (_rtcp != -1) && (::bind(_rtcp, reinterpret_cast<struct sockaddr*>(&local), sizeof(local)) == 0);
+
+                if (bound == true) {
+                    result = Core::ERROR_NONE;
+                } else {
+                    Close();
+                }
+            }
+
+            return (result);
+        }
+        void Close()
+        {
+            if (_rtp != -1) {
+                ::close(_rtp);
+                _rtp = -1;
+            }
+            if (_rtcp != -1) {
+                ::close(_rtcp);
+                _rtcp = -1;
+            }
+        }
+        // Sends packets with the given payload size at the given bitrate, for the given time.
+        void Run(const uint32_t bitrate, const uint16_t payload, const uint32_t duration, const Impairments& impairments)
+        {
+            const uint16_t packets = payload / TSPacketSize;
+            const uint16_t size = (packets == 0 ? 1 : packets) * TSPacketSize;
+            const uint64_t interval = (static_cast<uint64_t>(size) * 8 * 1000) / std::max(bitrate, static_cast<uint32_t>(1)); // uS, bitrate in kbit/s
+            const uint64_t start = Core::Time::Now().Ticks();
+            const uint64_t end = start + (static_cast<uint64_t>(duration) * 1000000);
+            uint64_t next = start;
+            uint64_t report = start;
+            std::vector<uint8_t> held;
+
+            while (next < end) {
+                std::vector<uint8_t> packet;
+
+                Build(packet, size, next - start);
+                _sequence++;
+
+                if (Chance(impairments.Loss) == true) {
+                    _counters.Dropped++;
+                } else if ((held.empty() == true) && (Chance(impairments.Reorder) == true)) {
+                    // Keep it, it goes out right after the next one.
+                    held.swap(packet);
+                    _counters.Reordered++;
+                } else {
+                    Wait(next + (impairments.Jitter == 0 ? 0 : ((Next() % impairments.Jitter) * 1000)));
+                    Send(packet);
+
+                    if (Chance(impairments.Duplicate) == true) {
+                        Send(packet);
+                        _counters.Duplicated++;
+                    }
+                    if (held.empty() == false) {
+                        Send(held);
+                        held.clear();
+                    }
+                }
+
+                if (next >= report) {
+                    SenderReport(next - start);
+                    report = next + 1000000;
+                }
+                Collect();
+
+                next += interval;
+            }
+
+            if (held.empty() == false) {
+                Send(held);
+            }
+
+            // Give the receiver the time to send a last report.
+            const uint64_t drain = Core::Time::Now().Ticks() + 6000000;
+            while (Core::Time::Now().Ticks() < drain) {
+                Collect();
+                SleepMs(100);
+            }
+        }
+        const Counters& Get() const
+        {
+            return (_counters);
+        }
+
+    private:
+        bool Chance(const uint8_t percentage)
+        {
+            return ((percentage != 0) && ((Next() % 100) < percentage));
+        }
+        uint32_t Next()
+        {
+            _state ^= (_state << 13);
+            _state ^= (_state >> 17);
+            _state ^= (_state << 5);
+            return (_state);
+        }
+        static void Wait(const uint64_t until)
+        {
+            const uint64_t now = Core::Time::Now().Ticks();
+
+            if (until > now) {
+                ::usleep(static_cast<useconds_t>(until - now));
+            }
+        }
+        static void Write16(uint8_t data[], const uint16_t value)
+        {
+            data[0] = static_cast<uint8_t>(value >> 8);
+            data[1] = static_cast<uint8_t>(value);
+        }
+        static void Write32(uint8_t data[], const uint32_t value)
+        {
+            data[0] = static_cast<uint8_t>(value >> 24);
+            data[1] = static_cast<uint8_t>(value >> 16);
+            data[2] = static_cast<uint8_t>(value >> 8);
+            data[3] = static_cast<uint8_t>(value);
+        }
+        static uint32_t Read32(const uint8_t data[])
+        {
+            return ((static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) | (static_cast<uint32_t>(data[2]) << 8) | data[3]);
+        }
+        uint32_t Timestamp(const uint64_t elapsed) const
+        {
+            return (static_cast<uint32_t>((elapsed * ClockRate) / 1000000));
+        }
+        void Build(std::vector<uint8_t>& packet, const uint16_t size, const uint64_t elapsed)
+        {
+            packet.assign(12 + size, 0xFF);
+
+            packet[0] = 0x80; // V=2
+            packet[1] = PayloadType;
+            Write16(&packet[2], _sequence);
+            Write32(&packet[4], Timestamp(elapsed));
+            Write32(&packet[8], _ssrc);
+
+            // Null packets, the player has nothing to decode but the stream is valid MPEG-TS.
+            for (uint16_t offset = 0; offset < size; offset += TSPacketSize) {
+                packet[12 + offset] = 0x47;
+                packet[12 + offset + 1] = 0x1F;
+                packet[12 + offset + 2] = 0xFF;
+                packet[12 + offset + 3] = 0x10;
+            }
+        }
+        void Send(const std::vector<uint8_t>& packet)
+        {
+            if (::sendto(_rtp, packet.data(), packet.size(), 0, reinterpret_cast<const struct sockaddr*>(&_destination), sizeof(_destination)) == static_cast<ssize_t>(packet.size())) {
+                _counters.Sent++;
+                _octets += static_cast<uint32_t>(packet.size() - 12);
+            }
+        }
+        void SenderReport(const uint64_t elapsed)
+        {
+            // RFC 3550, 6.4.1: sender report without report blocks.
+            uint8_t report[28];
+            struct sockaddr_in destination(_destination);
+            const uint64_t now = Core::Time::Now().Ticks();
+            const uint64_t seconds = (now / 1000000) + 2208988800ULL; // NTP epoch is 1900
+            const uint64_t fraction = ((now % 1000000) << 32) / 1000000;
+
+            report[0] = 0x80;
+            report[1] = RtcpSenderReport;
+            Write16(&report[2], 6);
+            Write32(&report[4], _ssrc);
+            Write32(&report[8], static_cast<uint32_t>(seconds));
+            Write32(&report[12], static_cast<uint32_t>(fraction));
+            Write32(&report[16], Timestamp(elapsed));
+            Write32(&report[20], _counters.Sent);
+            Write32(&report[24], _octets);
+
+            destination.sin_port = htons(ntohs(_destination.sin_port) + 1);
+            ::sendto(_rtcp, report, sizeof(report), 0, reinterpret_cast<const struct sockaddr*>(&destination), sizeof(destination));
+        }
+        void Collect()
+        {
+            uint8_t data[1536];
+            ssize_t length;
+
+            while ((length = ::recv(_rtcp, data, sizeof(data), MSG_DONTWAIT)) >= 32) {
+                if ((data[1] == RtcpReceiverReport) && ((data[0] & 0x1F) >= 1) && (Read32(&data[8]) == _ssrc)) {
+                    const uint32_t lost = Read32(&data[12]);
+
+                    _counters.Reports++;
+                    _counters.FractionLost = static_cast<uint8_t>(lost >> 24);
+                    // 24 bit signed.
+                    _counters.CumulativeLost = static_cast<int32_t>((lost & 0xFFFFFF) ^ 0x800000) - 0x800000;
+                    _counters.Jitter = Read32(&data[20]);
+                }
+            }
+        }
+
+    private:
+        const uint16_t _localPort;
+        int _rtp;
+        int _rtcp;
+        struct sockaddr_in _destination;
+        const uint32_t _ssrc;
+        uint16_t _sequence;
+        uint32_t _state;
+        uint32_t _octets;
+        Counters _counters;
+    };
+
+    class Config {
+    public:
+        Config(const Config&) = delete;
+        Config& operator=(const Config&) = delete;
+
+        Config()
+            : Address(_T("127.0.0.1"))
+            , Port(0)
+            , Local(6970)
+            , Bitrate(8000)
+            , Payload(1316)
+            , Duration(10)
+            , Impairments()
+        {
+            ::memset(&Impairments, 0, sizeof(Impairments));
+        }
+        ~Config()
+        {
+        }
+
+    public:
+        string Address;
+        uint16_t Port;
+        uint16_t Local;
+        uint32_t Bitrate;
+        uint16_t Payload;
+        uint32_t Duration;
+        Sender::Impairments Impairments;
+    };
+
+    void ParseOptions(int argc, char** argv, Config& config)
+    {
+        Tools::CommandLine options;
+
+        options.Add(_T("address"), config.Address, _T("Address of the receiver"));
+        options.Add(_T("port"), config.Port, _T("RTP port of the receiver, the \"rtpport\" of RtspClient, obligatory"), _T(""));
+        options.Add(_T("local"), config.Local, _T("Local RTP port, RTCP uses the next one"));
+        options.Add(_T("bitrate"), config.Bitrate, _T("Stream bitrate in kbit/s"));
+        options.Add(_T("payload"), config.Payload, _T("RTP payload size in bytes, rounded to TS packets"));
+        options.Add(_T("duration"), config.Duration, _T("Time in seconds to send"));
+        options.Add(_T("loss"), config.Impairments.Loss, _T("Percentage of packets not sent"));
+        options.Add(_T("reorder"), config.Impairments.Reorder, _T("Percentage of packets sent after their successor"));
+        options.Add(_T("duplicate"), config.Impairments.Duplicate, _T("Percentage of packets sent twice"));
+        options.Add(_T("jitter"), config.Impairments.Jitter, _T("Maximum random delay of a packet in ms"));
+
+        options.Parse(argc, argv);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    ParseOptions(argc, argv, config);
+
+    if ((config.Port == 0) || (config.Duration == 0) || (config.Payload > 1460)) {
+        printf(_T("Wrong parameter, use option -h to check required input arguments\n"));
+        return (1);
+    }
+
+    Sender sender(config.Local);
+
+    if (sender.Open(config.Address, config.Port) != Core::ERROR_NONE) {
+        printf(_T("Could not open ports %d-%d towards %s, error: %d\n"), config.Local, config.Local + 1, config.Address.c_str(), errno);
+        return (1);
+    }
+
+    printf(_T("Sending to %s:%d for %d s\n"), config.Address.c_str(), config.Port, config.Duration);
+
+    sender.Run(config.Bitrate, config.Payload, config.Duration, config.Impairments);
+
+    const Sender::Counters& counters(sender.Get());
+
+    printf(_T("Sent %u packets, dropped %u, reordered %u, duplicated %u\n"), counters.Sent, counters.Dropped, counters.Reordered, counters.Duplicated);
+
+    if (counters.Reports == 0) {
+        printf(_T("No receiver report received\n"));
+    } else {
+        printf(_T("Last of %u receiver reports: %d lost (%.1f%% in the last interval), jitter %u uS\n"),
+            counters.Reports, counters.CumulativeLost, (counters.FractionLost * 100.0) / 256,
+            static_cast<uint32_t>((static_cast<uint64_t>(counters.Jitter) * 1000000) / 90000));
+    }
+
+    sender.Close();
+    Core::Singleton::Dispose();
+
+    return (0);
+}
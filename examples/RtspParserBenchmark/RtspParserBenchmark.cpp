@@ -0,0 +1,464 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MODULE_NAME
+#define MODULE_NAME RtspParserBenchmark
+#endif
+
+#include <core/core.h>
+
+#include "CommandLine.h"
+#include "RtspParser.h"
+
+using namespace WPEFramework;
+
+namespace WPEFramework {
+
+    // Runs the framing (RtspParser::Frames) and the response parsing of the RtspClient plugin outside of
+    // the plugin. The benchmark feeds a stream of typical SRM/pump messages in segments, like TCP delivers
+    // them, and reports the cost per message. The fuzzer mutates those messages, checks that the framing
+    // does not depend on how the stream is segmented and runs every frame through the parser; build it with
+    // -fsanitize=address to catch out of bounds reads.
+    class Stream {
+    public:
+        Stream(const Stream&) = delete;
+        Stream& operator=(const Stream&) = delete;
+
+        Stream()
+            : _buffer()
+            , _dropped(0)
+        {
+        }
+        ~Stream()
+        {
+        }
+
+    public:
+        // Framed by RtspParser::Frames, like RtspSession::ProcessFrames does.
+        void Feed(const char data[], const uint32_t length, std::vector<string>& frames)
+        {
+            _buffer.append(data, length);
+
+            if (Plugin::RtspParser::Frames(_buffer, frames) == false) {
+                _dropped++;
+            }
+        }
+        uint32_t Dropped() const
+        {
+            return (_dropped);
+        }
+
+    private:
+        string _buffer;
+        uint32_t _dropped;
+    };
+
+    class Corpus {
+    public:
+        Corpus(const Corpus&) = delete;
+        Corpus& operator=(const Corpus&) = delete;
+
+        Corpus()
+            : _messages()
+        {
+        }
+        ~Corpus()
+        {
+        }
+
+    public:
+        void Default()
+        {
+            Add("RTSP/1.0 200 OK\r\n"
+                "CSeq: 1\r\n"
+                "Session: 2709130937-52547519;timeout=60\r\n"
+                "ControlSession: 2709130937-52547519;timeout=60\r\n"
+                "Tuning: frequency=5910000;modulation=16;symbol_rate=5361\r\n"
+                "Channel: Svcid=1;Tsid=10\r\n"
+                "Bookmark: 12.5\r\n"
+                "Duration: 5400\r\n"
+                "Transport: RTP/AVP;unicast;client_port=5000-5001\r\n", "");
+            Add("RTSP/1.0 200 OK\r\n"
+                "CSeq: 2\r\n"
+                "Session: 2709130937-52547519\r\n"
+                "Scale: 1.000000\r\n"
+                "Range: npt=12.500-\r\n", "");
+            Add("RTSP/1.0 200 OK\r\n"
+                "CSeq: 3\r\n"
+                "Session: 2709130937-52547519\r\n"
+                "Content-Type: text/parameters\r\n", "position: 60.0\r\nscale: 1\r\n");
+            Add("ANNOUNCE rtsp://10.0.0.1:8060 RTSP/1.0\r\n"
+                "CSeq: 6\r\n"
+                "Notice: 2104 \"Start-of-Stream Reached\" event-date=20160623T231007Z\r\n"
+                "Session: 2709130937-52547519\r\n", "");
+            Add("RTSP/1.0 454 Session Not Found\r\n"
+                "CSeq: 5\r\n", "");
+            Add("RTSP/1.0 200 OK\r\n"
+                "CSeq: 4\r\n"
+                "Session: 2709130937-52547519\r\n", "");
+
+            // An interleaved data frame.
+            string frame("$\x00\x00\x10", 4);
+            frame.append(16, '\x47');
+            _messages.push_back(frame);
+        }
+        // A raw capture of the RTSP connection, split in the frames it holds.
+        uint32_t Load(const string& fileName)
+        {
+            uint32_t result = Core::ERROR_OPENING_FAILED;
+            Core::File file(fileName);
+
+            if (file.Open(true) == true) {
+                string data(static_cast<size_t>(file.Size()), '\0');
+                Stream stream;
+
+                if (file.Read(reinterpret_cast<uint8_t*>(&data[0]), static_cast<uint32_t>(data.length())) == data.length()) {
+                    stream.Feed(data.c_str(), static_cast<uint32_t>(data.length()), _messages);
+                }
+                file.Close();
+
+                result = (_messages.empty() == true ? Core::ERROR_INVALID_INPUT_LENGTH : Core::ERROR_NONE);
+            }
+
+            return (result);
+        }
+        const std::vector<string>& Messages() const
+        {
+            return (_messages);
+        }
+
+    private:
+        void Add(const char header[], const char body[])
+        {
+            string message(header);
+            const uint32_t length = static_cast<uint32_t>(strlen(body));
+
+            if (length > 0) {
+                message += "Content-Length: " + std::to_string(length) + "\r\n";
+            }
+            message += "\r\n";
+            message += body;
+
+            _messages.push_back(message);
+        }
+
+    private:
+        std::vector<string> _messages;
+    };
+
+    // What the session does with a frame.
+    void Process(Plugin::RtspParser& parser, const string& frame)
+    {
+        if ((frame.empty() == false) && (frame[0] != '$')) {
+            Plugin::RtspMessagePtr message = parser.ParseResponse(frame);
+
+            if ((message) && (message->getType() == Plugin::RtspMessage::RTSP_RESPONSE)) {
+                parser.ProcessSetupResponse(message->message);
+                parser.ProcessPlayResponse(message->message);
+            }
+        }
+    }
+
+    class Benchmark {
+    public:
+        Benchmark(const Benchmark&) = delete;
+        Benchmark& operator=(const Benchmark&) = delete;
+
+        Benchmark(const Corpus& corpus)
+            : _stream()
+        {
+            for (const string& message : corpus.Messages()) {
+                _stream += message;
+            }
+        }
+        ~Benchmark()
+        {
+        }
+
+    public:
+        void Run(const uint32_t iterations, const uint32_t chunk)
+        {
+            Plugin::RtspSessionInfo info;
+            Plugin::RtspParser parser(info);
+            std::vector<string> frames;
+            uint64_t framing = 0;
+            uint64_t parsing = 0;
+            uint64_t count = 0;
+            const uint32_t segment = ((chunk == 0) || (chunk > _stream.length()) ? static_cast<uint32_t>(_stream.length()) : chunk);
+
+            for (uint32_t iteration = 0; iteration < iterations; iteration++) {
+                Stream stream;
+                uint32_t offset = 0;
+
+                frames.clear();
+
+                const uint64_t start = Core::Time::Now().Ticks();
+
+                while (offset < _stream.length()) {
+                    const uint32_t length = std::min(segment, static_cast<uint32_t>(_stream.length() - offset));
+                    stream.Feed(&_stream[offset], length, frames);
+                    offset += length;
+                }
+
+                const uint64_t framed = Core::Time::Now().Ticks();
+
+                for (const string& frame : frames) {
+                    Process(parser, frame);
+                }
+
+                const uint64_t parsed = Core::Time::Now().Ticks();
+
+                framing += (framed - start);
+                parsing += (parsed - framed);
+                count += frames.size();
+            }
+
+            printf(_T("%llu frames, %u bytes per pass in segments of %u bytes\n"), static_cast<unsigned long long>(count), static_cast<uint32_t>(_stream.length()), segment);
+
+            if (count > 0) {
+                printf(_T("framing: %.1f nS per frame\n"), (framing * 1000.0) / count);
+                printf(_T("parsing: %.1f nS per frame\n"), (parsing * 1000.0) / count);
+                printf(_T("total:   %.0f frames/s\n"), (count * 1000000.0) / std::max(framing + parsing, static_cast<uint64_t>(1)));
+            }
+        }
+
+    private:
+        string _stream;
+    };
+
+    class Fuzzer {
+    public:
+        Fuzzer(const Fuzzer&) = delete;
+        Fuzzer& operator=(const Fuzzer&) = delete;
+
+        Fuzzer(const Corpus& corpus, const uint32_t seed)
+            : _corpus(corpus)
+            , _state(seed == 0 ? 1 : seed)
+        {
+        }
+        ~Fuzzer()
+        {
+        }
+
+    public:
+        // Returns the number of cases that broke an invariant.
+        uint32_t Run(const uint32_t cases)
+        {
+            Plugin::RtspSessionInfo info;
+            Plugin::RtspParser parser(info);
+            uint32_t failures = 0;
+
+            for (uint32_t index = 0; index < cases; index++) {
+                const string input(Mutate());
+                std::vector<string> whole;
+                std::vector<string> segmented;
+                Stream first;
+                Stream second;
+                uint32_t offset = 0;
+
+                first.Feed(input.c_str(), static_cast<uint32_t>(input.length()), whole);
+
+                while (offset < input.length()) {
+                    const uint32_t length = std::min(1 + (Next() % 64), static_cast<uint32_t>(input.length() - offset));
+                    second.Feed(&input[offset], length, segmented);
+                    offset += length;
+                }
+
+                if ((whole != segmented) || (Valid(whole, static_cast<uint32_t>(input.length())) == false)) {
+                    printf(_T("Case %u: framing invariant broken, %u vs %u frames\n"), index, static_cast<uint32_t>(whole.size()), static_cast<uint32_t>(segmented.size()));
+                    Dump(input);
+                    failures++;
+                }
+
+                for (const string& frame : whole) {
+                    Process(parser, frame);
+                }
+
+                // And the garbage straight into the header parsers.
+                parser.ProcessSetupResponse(input);
+                parser.ProcessPlayResponse(input);
+                parser.ParseAnnouncement(input, true);
+            }
+
+            return (failures);
+        }
+
+    private:
+        uint32_t Next()
+        {
+            // xorshift32, so a failing case can be reproduced with the same seed.
+            _state ^= (_state << 13);
+            _state ^= (_state >> 17);
+            _state ^= (_state << 5);
+            return (_state);
+        }
+        string Mutate()
+        {
+            const std::vector<string>& messages(_corpus.Messages());
+            const uint32_t count = 1 + (Next() % 4);
+            string result;
+
+            for (uint32_t index = 0; index < count; index++) {
+                result += messages[Next() % messages.size()];
+            }
+
+            const uint32_t mutations = Next() % 8;
+
+            for (uint32_t index = 0; (index < mutations) && (result.empty() == false); index++) {
+                const uint32_t position = Next() % result.length();
+
+                switch (Next() % 7) {
+                case 0:
+                    result[position] = static_cast<char>(Next());
+                    break;
+                case 1:
+                    result.insert(position, 1, static_cast<char>(Next()));
+                    break;
+                case 2:
+                    result.erase(position, 1 + (Next() % 16));
+                    break;
+                case 3:
+                    result.resize(position);
+                    break;
+                case 4: {
+                    const string part(result.substr(Next() % result.length(), Next() % 64));
+                    result.insert(position, part);
+                    break;
+                }
+                case 5: {
+                    // Small bodies, sizes on the edge of overflowing the frame size, or beyond 32 bits.
+                    const uint32_t kind = Next() % 3;
+                    const uint64_t size = (kind == 0 ? (Next() % 1024) : (kind == 1 ? (~0u - (Next() % 1024)) : ((1ULL << 32) + (Next() % 1024))));
+                    result.insert(position, "\r\nContent-Length: " + std::to_string(size) + "\r\n");
+                    break;
+                }
+                default:
+                    result.insert(position, (Next() & 1) != 0 ? "\r\n\r\n" : "$");
+                    break;
+                }
+            }
+
+            return (result);
+        }
+        static bool Valid(const std::vector<string>& frames, const uint32_t length)
+        {
+            uint64_t total = 0;
+            bool result = true;
+
+            for (const string& frame : frames) {
+                total += frame.length();
+
+                if (frame[0] == '$') {
+                    result = result && (frame.length() == (4 + ((static_cast<uint8_t>(frame[2]) << 8) | static_cast<uint8_t>(frame[3]))));
+                } else {
+                    // A text frame holds at least its complete header.
+                    result = result && (frame.find("\r\n\r\n") != string::npos);
+                }
+            }
+
+            return (result && (total <= length));
+        }
+        static void Dump(const string& input)
+        {
+            for (uint32_t index = 0; index < input.length(); index++) {
+                const uint8_t value = static_cast<uint8_t>(input[index]);
+                if ((value >= 32) && (value < 127)) {
+                    printf("%c", value);
+                } else {
+                    printf("\\x%02X", value);
+                }
+            }
+            printf("\n");
+        }
+
+    private:
+        const Corpus& _corpus;
+        uint32_t _state;
+    };
+
+    class Config {
+    public:
+        Config(const Config&) = delete;
+        Config& operator=(const Config&) = delete;
+
+        Config()
+            : Capture()
+            , Iterations(10000)
+            , Chunk(1460)
+            , Fuzz(0)
+            , Seed(1)
+        {
+        }
+        ~Config()
+        {
+        }
+
+    public:
+        string Capture;
+        uint32_t Iterations;
+        uint32_t Chunk;
+        uint32_t Fuzz;
+        uint32_t Seed;
+    };
+
+    void ParseOptions(int argc, char** argv, Config& config)
+    {
+        Tools::CommandLine options;
+
+        options.Add(_T("capture"), config.Capture, _T("Raw capture of an RTSP connection, used instead of the built in messages"));
+        options.Add(_T("iterations"), config.Iterations, _T("Number of passes over the messages"));
+        options.Add(_T("chunk"), config.Chunk, _T("Segment size in bytes the stream is fed in, 0 feeds it at once"));
+        options.Add(_T("fuzz"), config.Fuzz, _T("Number of mutated cases to run, instead of the benchmark"));
+        options.Add(_T("seed"), config.Seed, _T("Seed of the mutations"));
+
+        options.Parse(argc, argv);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    Corpus corpus;
+    int result = 0;
+
+    ParseOptions(argc, argv, config);
+
+    if (config.Capture.empty() == true) {
+        corpus.Default();
+    } else if (corpus.Load(config.Capture) != Core::ERROR_NONE) {
+        printf(_T("Could not find any RTSP frames in: %s\n"), config.Capture.c_str());
+        return (1);
+    }
+
+    if (config.Fuzz != 0) {
+        Fuzzer fuzzer(corpus, config.Seed);
+        uint32_t failures = fuzzer.Run(config.Fuzz);
+
+        printf(_T("%u cases, %u failures\n"), config.Fuzz, failures);
+        result = (failures == 0 ? 0 : 1);
+    } else {
+        Benchmark benchmark(corpus);
+        benchmark.Run(config.Iterations, config.Chunk);
+    }
+
+    Core::Singleton::Dispose();
+
+    return (result);
+}
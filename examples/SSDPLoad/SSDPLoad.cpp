@@ -0,0 +1,303 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME SSDPLoad
+#endif
+
+#include <core/core.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include "CommandLine.h"
+
+#undef EXTERNAL
+
+using namespace WPEFramework;
+
+namespace WPEFramework {
+
+    // A crowd of control points looking for a DIAL server, to load the SSDP responder of the DIALServer plugin.
+    // Every client has its own socket, so its own source port, sends an M-SEARCH and retransmits it a few
+    // times, as control points do. The responder should answer every client once per MX window, spread over
+    // that window. The tool reports the clients that got no answer, the ones that got more than one and
+    // how the first answers are spread over the MX window.
+    class Crowd {
+    public:
+        Crowd() = delete;
+        Crowd(const Crowd&) = delete;
+        Crowd& operator=(const Crowd&) = delete;
+
+        struct Result {
+            uint32_t Clients;
+            uint32_t Answered;
+            uint32_t Answers;
+            uint32_t Repeated; // Clients with more than one answer
+            uint64_t Fastest; // uS
+            uint64_t Slowest; // uS
+            uint64_t Total; // uS, of the first answers
+            uint32_t Spread[4]; // First answers per quarter of the MX window, the last one includes the late ones.
+        };
+
+    private:
+        static constexpr const TCHAR* SearchTarget = _T("urn:dial-multiscreen-org:service:dial:1");
+
+        struct Client {
+            int Socket;
+            uint64_t First; // uS, moment of the first answer
+            uint32_t Answers;
+        };
+
+    public:
+        Crowd(const uint32_t clients)
+            : _clients(clients)
+            , _destination()
+            , _request()
+        {
+            for (Client& client : _clients) {
+                client.Socket = -1;
+                client.First = 0;
+                client.Answers = 0;
+            }
+        }
+        ~Crowd()
+        {
+            Close();
+        }
+
+    public:
+        uint32_t Open(const string& address, const uint16_t port, const uint8_t mx)
+        {
+            uint32_t result = Core::ERROR_NONE;
+
+            ::memset(&_destination, 0, sizeof(_destination));
+            _destination.sin_family = AF_INET;
+            _destination.sin_port = htons(port);
+
+            if (::inet_pton(AF_INET, address.c_str(), &_destination.sin_addr) != 1) {
+                result = Core::ERROR_INVALID_DESIGNATOR;
+            } else {
+                _request = _T("M-SEARCH * HTTP/1.1\r\n")
+                           _T("HOST: ") + address + ':' + std::to_string(port) + _T("\r\n")
+                           _T("MAN: \"ssdp:discover\"\r\n")
+                           _T("MX: ") + std::to_string(mx) + _T("\r\n")
+                           _T("ST: ") + string(SearchTarget) + _T("\r\n")
+                           _T("USER-AGENT: Linux/1.0 UPnP/1.1 SSDPLoad/1.0\r\n")
+                           _T("\r\n");
+
+                for (Client& client : _clients) {
+                    client.Socket = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+
+                    if (client.Socket == -1) {
+                        result = Core::ERROR_OPENING_FAILED;
+                        break;
+                    }
+                }
+            }
+
+            if (result != Core::ERROR_NONE) {
+                Close();
+            }
+
+            return (result);
+        }
+        void Close()
+        {
+            for (Client& client : _clients) {
+                if (client.Socket != -1) {
+                    ::close(client.Socket);
+                    client.Socket = -1;
+                }
+            }
+        }
+        // All clients search at once, retransmit every interval ms and then listen for the rest of the wait.
+        void Run(const uint8_t retries, const uint32_t interval, const uint32_t wait, const uint8_t mx, Result& result)
+        {
+            const uint64_t start = Core::Time::Now().Ticks();
+            const uint64_t end = start + (static_cast<uint64_t>(wait) * 1000);
+            uint64_t next = start;
+            uint8_t sent = 0;
+
+            while (Core::Time::Now().Ticks() < end) {
+                const uint64_t now = Core::Time::Now().Ticks();
+
+                if ((sent <= retries) && (now >= next)) {
+                    for (const Client& client : _clients) {
+                        ::sendto(client.Socket, _request.c_str(), _request.length(), 0, reinterpret_cast<const struct sockaddr*>(&_destination), sizeof(_destination));
+                    }
+                    sent++;
+                    next += static_cast<uint64_t>(interval) * 1000;
+                }
+
+                const uint64_t until = ((sent <= retries) && (next < end) ? next : end);
+                Receive(start, static_cast<int>((until > now ? until - now : 0) / 1000));
+            }
+
+            Evaluate(static_cast<uint64_t>(mx) * 1000000, result);
+        }
+
+    private:
+        void Receive(const uint64_t start, const int timeout)
+        {
+            std::vector<struct pollfd> descriptors(_clients.size());
+
+            for (uint32_t index = 0; index < _clients.size(); index++) {
+                descriptors[index].fd = _clients[index].Socket;
+                descriptors[index].events = POLLIN;
+                descriptors[index].revents = 0;
+            }
+
+            if (::poll(descriptors.data(), descriptors.size(), timeout) > 0) {
+                const uint64_t now = Core::Time::Now().Ticks();
+
+                for (uint32_t index = 0; index < _clients.size(); index++) {
+                    if ((descriptors[index].revents & POLLIN) != 0) {
+                        char buffer[1500];
+                        ssize_t size;
+
+                        while ((size = ::recv(_clients[index].Socket, buffer, sizeof(buffer) - 1, 0)) > 0) {
+                            buffer[size] = '\0';
+
+                            // Only count the answers to our search, others might be listening too.
+                            if ((::strncmp(buffer, "HTTP/1.1 200", 12) == 0) && (::strstr(buffer, SearchTarget) != nullptr)) {
+                                if (_clients[index].Answers == 0) {
+                                    _clients[index].First = now - start;
+                                }
+                                _clients[index].Answers++;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        void Evaluate(const uint64_t window, Result& result) const
+        {
+            ::memset(&result, 0, sizeof(result));
+            result.Clients = static_cast<uint32_t>(_clients.size());
+            result.Fastest = ~0ULL;
+
+            for (const Client& client : _clients) {
+                if (client.Answers > 0) {
+                    const uint64_t quarter = (window == 0 ? 0 : (client.First * 4) / window);
+
+                    result.Answered++;
+                    result.Answers += client.Answers;
+                    result.Repeated += (client.Answers > 1 ? 1 : 0);
+                    result.Total += client.First;
+                    result.Fastest = (client.First < result.Fastest ? client.First : result.Fastest);
+                    result.Slowest = (client.First > result.Slowest ? client.First : result.Slowest);
+                    result.Spread[quarter < 3 ? quarter : 3]++;
+                }
+            }
+
+            if (result.Answered == 0) {
+                result.Fastest = 0;
+            }
+        }
+
+    private:
+        std::vector<Client> _clients;
+        struct sockaddr_in _destination;
+        string _request;
+    };
+
+    class Config {
+    public:
+        Config(const Config&) = delete;
+        Config& operator=(const Config&) = delete;
+
+        Config()
+            : Address(_T("239.255.255.250"))
+            , Port(1900)
+            , Clients(100)
+            , MX(1)
+            , Retries(2)
+            , Interval(200)
+            , Wait(3000)
+        {
+        }
+        ~Config()
+        {
+        }
+
+    public:
+        string Address;
+        uint16_t Port;
+        uint32_t Clients;
+        uint8_t MX;
+        uint8_t Retries;
+        uint32_t Interval;
+        uint32_t Wait;
+    };
+
+    void ParseOptions(int argc, char** argv, Config& config)
+    {
+        Tools::CommandLine options;
+
+        options.Add(_T("address"), config.Address, _T("Address the M-SEARCH is sent to, the SSDP group or the DIAL server"));
+        options.Add(_T("port"), config.Port, _T("Port the M-SEARCH is sent to"));
+        options.Add(_T("clients"), config.Clients, _T("Number of control points, each with its own source port"));
+        options.Add(_T("mx"), config.MX, _T("MX of the M-SEARCH, in seconds"));
+        options.Add(_T("retries"), config.Retries, _T("Retransmissions of the M-SEARCH by every client"));
+        options.Add(_T("interval"), config.Interval, _T("Time in ms between two transmissions"));
+        options.Add(_T("wait"), config.Wait, _T("Time in ms the clients listen for answers"));
+
+        options.Parse(argc, argv);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    int result = 0;
+
+    ParseOptions(argc, argv, config);
+
+    {
+        Crowd crowd(config.Clients);
+
+        if (crowd.Open(config.Address, config.Port, config.MX) != Core::ERROR_NONE) {
+            printf(_T("Could not open %u clients towards %s:%u\n"), config.Clients, config.Address.c_str(), config.Port);
+            result = 1;
+        } else {
+            Crowd::Result outcome;
+
+            crowd.Run(config.Retries, config.Interval, config.Wait, config.MX, outcome);
+
+            printf(_T("%u clients, %u answered, %u answers, %u answered more than once\n"), outcome.Clients, outcome.Answered, outcome.Answers, outcome.Repeated);
+
+            if (outcome.Answered > 0) {
+                printf(_T("first answer after: min %.1f mS, avg %.1f mS, max %.1f mS\n"), outcome.Fastest / 1000.0, (outcome.Total / 1000.0) / outcome.Answered, outcome.Slowest / 1000.0);
+                printf(_T("spread over the MX window: %u | %u | %u | %u\n"), outcome.Spread[0], outcome.Spread[1], outcome.Spread[2], outcome.Spread[3]);
+            }
+
+            // Retransmissions within the MX window must not be answered again. The window is at least 1 s, a
+            // responder is not required to use a larger MX for it.
+            const bool windowed = ((static_cast<uint64_t>(config.Retries) * config.Interval) < 1000);
+            result = ((outcome.Answered == outcome.Clients) && ((windowed == false) || (outcome.Repeated == 0)) ? 0 : 1);
+        }
+    }
+
+    Core::Singleton::Dispose();
+
+    return (result);
+}
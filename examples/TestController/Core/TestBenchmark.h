@@ -0,0 +1,300 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../Module.h"
+#include "TestBase.h"
+#include "Trace.h"
+
+#include <cmath>
+#include <time.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace WPEFramework {
+
+// Base for tests that measure instead of verify. The derived class implements Iteration(), the base runs
+// it for a number of warm up iterations, sizes batches so a single sample is long enough to be timed
+// accurately, and keeps on sampling until the 95% confidence interval of the mean is within the requested
+// precision (or the sample/time limits are reached). The statistics are reported in the "benchmark"
+// section of the test result.
+class BenchmarkBase : public TestBase {
+public:
+    BenchmarkBase(const BenchmarkBase&) = delete;
+    BenchmarkBase& operator=(const BenchmarkBase&) = delete;
+
+    // Can be overruled per run, through the arguments passed to the test.
+    class Settings : public Core::JSON::Container {
+    public:
+        Settings(const Settings&) = delete;
+        Settings& operator=(const Settings&) = delete;
+
+        Settings()
+            : Core::JSON::Container()
+            , Warmup(10)
+            , MinSamples(10)
+            , MaxSamples(200)
+            , Precision(2)
+            , SampleTime(10)
+            , Budget(10000)
+        {
+            Add(_T("warmup"), &Warmup);
+            Add(_T("minsamples"), &MinSamples);
+            Add(_T("maxsamples"), &MaxSamples);
+            Add(_T("precision"), &Precision);
+            Add(_T("sampletime"), &SampleTime);
+            Add(_T("budget"), &Budget);
+        }
+
+        ~Settings() = default;
+
+    public:
+        Core::JSON::DecUInt32 Warmup; // Iterations
+        Core::JSON::DecUInt32 MinSamples;
+        Core::JSON::DecUInt32 MaxSamples;
+        Core::JSON::DecUInt8 Precision; // Percentage of the mean
+        Core::JSON::DecUInt32 SampleTime; // mS
+        Core::JSON::DecUInt32 Budget; // mS
+    };
+
+    explicit BenchmarkBase(const DescriptionBuilder& description)
+        : TestBase(description)
+    {
+    }
+
+    virtual ~BenchmarkBase() = default;
+
+public:
+    // ICommand methods
+    string Execute(const string& params) final
+    {
+        TestCore::TestResult jsonResult;
+        Settings settings;
+        string result;
+
+        TRACE(TestCore::TestStart, (_T("Start benchmark: %s"), Name().c_str()));
+
+        if (params.empty() == false) {
+            settings.FromString(params);
+        }
+
+        jsonResult.Name = Name();
+
+        if (Prepare(params) == false) {
+            // An empty benchmark section still marks this as a benchmark, so the failure shows up in a comparison.
+            jsonResult.Benchmark.Samples = 0;
+            jsonResult.OverallStatus = _T("Failed");
+        } else {
+            Measure(settings, jsonResult.Benchmark);
+            Cleanup();
+
+            jsonResult.OverallStatus = _T("Success");
+        }
+
+        TRACE(TestCore::TestEnd, (_T("End benchmark: %s, %llu nS per iteration"), Name().c_str(), jsonResult.Benchmark.Wall.Value()));
+
+        jsonResult.ToString(result);
+        return result;
+    }
+
+protected:
+    // Called once before and after the measurement, outside of the timing.
+    virtual bool Prepare(const string& /* params */)
+    {
+        return (true);
+    }
+    virtual void Cleanup()
+    {
+    }
+
+    // The code under measurement.
+    virtual void Iteration() = 0;
+
+private:
+    struct Sample {
+        double Wall;
+        double Cpu;
+    };
+
+    static uint64_t Now(const clockid_t clock)
+    {
+        struct timespec time;
+        clock_gettime(clock, &time);
+        return ((static_cast<uint64_t>(time.tv_sec) * 1000000000) + time.tv_nsec);
+    }
+
+    // Heap in use by the process. The C library offers no allocation count to a library, so what is reported
+    // is the net growth of the heap around a batch: memory allocated and released within an iteration does
+    // not show up. It is process wide, other threads may add noise.
+    static int64_t HeapInUse()
+    {
+        int64_t result = 0;
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+        struct mallinfo2 info = mallinfo2();
+        result = static_cast<int64_t>(info.uordblks + info.hblkhd);
+#else
+        struct mallinfo info = mallinfo();
+        result = static_cast<int64_t>(static_cast<uint32_t>(info.uordblks)) + static_cast<int64_t>(static_cast<uint32_t>(info.hblkhd));
+#endif
+#endif
+        return (result);
+    }
+
+    // Two sided 95% quantile of the Student t distribution. Exact up to 30 degrees of freedom, beyond that
+    // interpolated linearly in 1/df between the tabulated 30, 40, 60, 120 and the normal quantile.
+    static double Student(const uint32_t degreesOfFreedom)
+    {
+        static const double table[] = {
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+        };
+        static const struct {
+            uint32_t DegreesOfFreedom;
+            double Quantile;
+        } tail[] = {
+            { 30, 2.042 }, { 40, 2.021 }, { 60, 2.000 }, { 120, 1.980 }, { ~0u, 1.960 }
+        };
+
+        double result = 0.0;
+
+        if ((degreesOfFreedom > 0) && (degreesOfFreedom <= (sizeof(table) / sizeof(double)))) {
+            result = table[degreesOfFreedom - 1];
+        } else if (degreesOfFreedom > 0) {
+            uint8_t index = 1;
+
+            while (degreesOfFreedom > tail[index].DegreesOfFreedom) {
+                index++;
+            }
+
+            // The last entry is infinity, 1/df of 0.
+            const double from = 1.0 / tail[index - 1].DegreesOfFreedom;
+            const double to = (tail[index].DegreesOfFreedom == ~0u ? 0.0 : 1.0 / tail[index].DegreesOfFreedom);
+
+            result = tail[index].Quantile + ((tail[index - 1].Quantile - tail[index].Quantile) * ((1.0 / degreesOfFreedom) - to) / (from - to));
+        }
+
+        return (result);
+    }
+
+    void Measure(const Settings& settings, TestCore::BenchmarkData& result)
+    {
+        const uint32_t minSamples = std::max(settings.MinSamples.Value(), static_cast<uint32_t>(2));
+        const uint32_t maxSamples = std::max(settings.MaxSamples.Value(), minSamples);
+        const double precision = static_cast<double>(settings.Precision.Value()) / 100.0;
+        const uint64_t budgetEnd = Now(CLOCK_MONOTONIC) + (static_cast<uint64_t>(settings.Budget.Value()) * 1000000);
+
+        // Warm up, and get a first idea of the cost of a single iteration.
+        uint32_t warmup = std::max(settings.Warmup.Value(), static_cast<uint32_t>(1));
+        uint64_t start = Now(CLOCK_MONOTONIC);
+
+        for (uint32_t index = 0; index < warmup; index++) {
+            Iteration();
+        }
+
+        uint64_t single = std::max((Now(CLOCK_MONOTONIC) - start) / warmup, static_cast<uint64_t>(1));
+        uint64_t batch = std::max((static_cast<uint64_t>(settings.SampleTime.Value()) * 1000000) / single, static_cast<uint64_t>(1));
+
+        TRACE(TestCore::TestStep, (_T("Warm up done, %llu nS per iteration, %llu iterations per sample"), single, batch));
+
+        std::vector<Sample> samples;
+        int64_t heapGrowth = 0;
+        double mean = 0;
+        double deviation = 0;
+        double confidence = 0;
+        bool stable = false;
+
+        samples.reserve(maxSamples);
+
+        while ((samples.size() < maxSamples) && (stable == false) && ((samples.size() < minSamples) || (Now(CLOCK_MONOTONIC) < budgetEnd))) {
+            const int64_t heapStart = HeapInUse();
+            const uint64_t cpuStart = Now(CLOCK_THREAD_CPUTIME_ID);
+            const uint64_t wallStart = Now(CLOCK_MONOTONIC);
+
+            for (uint64_t index = 0; index < batch; index++) {
+                Iteration();
+            }
+
+            const uint64_t wallEnd = Now(CLOCK_MONOTONIC);
+            const uint64_t cpuEnd = Now(CLOCK_THREAD_CPUTIME_ID);
+
+            heapGrowth += (HeapInUse() - heapStart);
+            samples.push_back({ static_cast<double>(wallEnd - wallStart) / batch, static_cast<double>(cpuEnd - cpuStart) / batch });
+
+            if (samples.size() >= minSamples) {
+                Statistics(samples, mean, deviation, confidence);
+                stable = (confidence <= (mean * precision));
+            }
+        }
+
+        Statistics(samples, mean, deviation, confidence);
+
+        double cpu = 0;
+        std::vector<double> ordered;
+        ordered.reserve(samples.size());
+
+        for (const Sample& sample : samples) {
+            cpu += sample.Cpu;
+            ordered.push_back(sample.Wall);
+        }
+        std::sort(ordered.begin(), ordered.end());
+
+        const size_t middle = ordered.size() / 2;
+        const double median = ((ordered.size() % 2) == 1 ? ordered[middle] : (ordered[middle - 1] + ordered[middle]) / 2);
+
+        result.Samples = static_cast<uint32_t>(samples.size());
+        result.Iterations = static_cast<uint64_t>(samples.size()) * batch;
+        result.Wall = static_cast<uint64_t>(mean + 0.5);
+        result.Median = static_cast<uint64_t>(median + 0.5);
+        result.Deviation = static_cast<uint64_t>(deviation + 0.5);
+        result.Confidence = static_cast<uint64_t>(confidence + 0.5);
+        result.Cpu = static_cast<uint64_t>((cpu / samples.size()) + 0.5);
+        result.HeapGrowth = heapGrowth / static_cast<int64_t>(samples.size() * batch);
+        result.Stable = stable;
+
+        if (stable == false) {
+            TRACE(TestCore::TestStep, (_T("Precision of %d%% not reached in %d samples, confidence: %llu nS"), settings.Precision.Value(), static_cast<uint32_t>(samples.size()), result.Confidence.Value()));
+        }
+    }
+
+    static void Statistics(const std::vector<Sample>& samples, double& mean, double& deviation, double& confidence)
+    {
+        const size_t count = samples.size();
+        double sum = 0;
+        double squares = 0;
+
+        for (const Sample& sample : samples) {
+            sum += sample.Wall;
+        }
+
+        mean = sum / count;
+
+        for (const Sample& sample : samples) {
+            squares += (sample.Wall - mean) * (sample.Wall - mean);
+        }
+
+        deviation = (count > 1 ? std::sqrt(squares / (count - 1)) : 0.0);
+        confidence = Student(static_cast<uint32_t>(count - 1)) * deviation / std::sqrt(static_cast<double>(count));
+    }
+};
+} // namespace WPEFramework
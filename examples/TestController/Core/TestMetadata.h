@@ -42,6 +42,82 @@ namespace TestCore {
         Core::JSON::String Description;
     };
 
+    class BenchmarkData : public Core::JSON::Container {
+    public:
+        BenchmarkData()
+            : Core::JSON::Container()
+            , Samples()
+            , Iterations()
+            , Wall()
+            , Median()
+            , Deviation()
+            , Confidence()
+            , Cpu()
+            , HeapGrowth()
+            , Stable()
+        {
+            Init();
+        }
+
+        BenchmarkData(const BenchmarkData& copy)
+            : Core::JSON::Container()
+            , Samples(copy.Samples)
+            , Iterations(copy.Iterations)
+            , Wall(copy.Wall)
+            , Median(copy.Median)
+            , Deviation(copy.Deviation)
+            , Confidence(copy.Confidence)
+            , Cpu(copy.Cpu)
+            , HeapGrowth(copy.HeapGrowth)
+            , Stable(copy.Stable)
+        {
+            Init();
+        }
+
+        BenchmarkData& operator=(const BenchmarkData& rhs)
+        {
+            this->Samples = rhs.Samples;
+            this->Iterations = rhs.Iterations;
+            this->Wall = rhs.Wall;
+            this->Median = rhs.Median;
+            this->Deviation = rhs.Deviation;
+            this->Confidence = rhs.Confidence;
+            this->Cpu = rhs.Cpu;
+            this->HeapGrowth = rhs.HeapGrowth;
+            this->Stable = rhs.Stable;
+
+            return *this;
+        }
+
+        ~BenchmarkData() = default;
+
+    private:
+        void Init()
+        {
+            Add(_T("samples"), &Samples);
+            Add(_T("iterations"), &Iterations);
+            Add(_T("wall"), &Wall);
+            Add(_T("median"), &Median);
+            Add(_T("deviation"), &Deviation);
+            Add(_T("confidence"), &Confidence);
+            Add(_T("cpu"), &Cpu);
+            Add(_T("heapgrowth"), &HeapGrowth);
+            Add(_T("stable"), &Stable);
+        }
+
+    public:
+        // Times are per iteration, in nanoseconds.
+        Core::JSON::DecUInt32 Samples;
+        Core::JSON::DecUInt64 Iterations;
+        Core::JSON::DecUInt64 Wall; // Mean
+        Core::JSON::DecUInt64 Median;
+        Core::JSON::DecUInt64 Deviation;
+        Core::JSON::DecUInt64 Confidence; // Half width of the 95% confidence interval of the mean
+        Core::JSON::DecUInt64 Cpu; // Mean thread CPU time
+        Core::JSON::DecSInt64 HeapGrowth; // Mean net growth of the heap, in bytes, not what got allocated
+        Core::JSON::Boolean Stable; // Requested precision was reached
+    };
+
     class TestResult : public Core::JSON::Container {
     public:
         class TestStep : public Core::JSON::Container {
@@ -88,10 +164,12 @@ namespace TestCore {
             , Steps()
             , OverallStatus()
             , Name()
+            , Benchmark()
         {
             Add(_T("test"), &Name);
             Add(_T("status"), &OverallStatus);
             Add(_T("steps"), &Steps);
+            Add(_T("benchmark"), &Benchmark);
         }
 
         TestResult(const TestResult& copy)
@@ -99,10 +177,12 @@ namespace TestCore {
             this->Name = copy.Name;
             this->OverallStatus = copy.OverallStatus;
             this->Steps = copy.Steps;
+            this->Benchmark = copy.Benchmark;
 
             Add(_T("test"), &Name);
             Add(_T("status"), &OverallStatus);
             Add(_T("steps"), &Steps);
+            Add(_T("benchmark"), &Benchmark);
         }
 
         TestResult& operator=(const TestResult& rhs)
@@ -110,6 +190,7 @@ namespace TestCore {
             this->Name = rhs.Name;
             this->OverallStatus = rhs.OverallStatus;
             this->Steps = rhs.Steps;
+            this->Benchmark = rhs.Benchmark;
 
             return *this;
         }
@@ -120,6 +201,7 @@ namespace TestCore {
         Core::JSON::ArrayType<TestStep> Steps;
         Core::JSON::String OverallStatus;
         Core::JSON::String Name;
+        BenchmarkData Benchmark; // Only set by benchmark tests
     };
 } // namespace TestCore
 } // namespace WPEFramework
@@ -0,0 +1,88 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+ 
+#include "../Module.h"
+
+#include "../Core/TestBenchmark.h"
+#include "BenchmarkCategory.h"
+#include <interfaces/ITestController.h>
+
+namespace WPEFramework {
+
+// Measures the serialization of a test result, as done for every test that is run.
+class Benchmark1 : public BenchmarkBase {
+public:
+    Benchmark1(const Benchmark1&) = delete;
+    Benchmark1& operator=(const Benchmark1&) = delete;
+
+    Benchmark1()
+        : BenchmarkBase(TestBase::DescriptionBuilder("Benchmark 1 description, JSON serialization of a test result"))
+        , _result()
+        , _serialized()
+    {
+        TestCore::BenchmarkCategory::Instance().Register(this);
+    }
+
+    virtual ~Benchmark1()
+    {
+        TestCore::BenchmarkCategory::Instance().Unregister(this);
+    }
+
+public:
+    string Name() const final
+    {
+        return _name;
+    }
+
+protected:
+    bool Prepare(const string& /* params */) override
+    {
+        _result.Name = _name;
+        _result.OverallStatus = _T("Success");
+
+        for (uint8_t index = 0; index < 8; index++) {
+            TestCore::TestResult::TestStep step;
+            step.Description = _T("Step ") + Core::NumberType<uint8_t>(index).Text();
+            step.Status = _T("Success");
+            _result.Steps.Add(step);
+        }
+
+        return (true);
+    }
+
+    void Cleanup() override
+    {
+        _result.Steps.Clear();
+        _serialized.clear();
+    }
+
+    void Iteration() override
+    {
+        _serialized.clear();
+        _result.ToString(_serialized);
+    }
+
+private:
+    const string _name = _T("Benchmark1");
+    TestCore::TestResult _result;
+    string _serialized;
+};
+
+static Exchange::ITestController::ITest* _singleton(Core::Service<Benchmark1>::Create<Exchange::ITestController::ITest>());
+} // namespace WPEFramework
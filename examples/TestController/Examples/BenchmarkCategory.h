@@ -0,0 +1,72 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+ 
+#pragma once
+
+#include "../Module.h"
+
+#include "../Core/TestAdministrator.h"
+#include "../Core/TestCategoryBase.h"
+#include <interfaces/ITestController.h>
+
+namespace WPEFramework {
+namespace TestCore {
+
+    class BenchmarkCategory : TestCore::TestCategoryBase {
+    protected:
+        BenchmarkCategory()
+            : TestCategoryBase()
+        {
+            TestCore::TestAdministrator::Instance().Announce(this);
+        }
+
+    public:
+        BenchmarkCategory(const BenchmarkCategory&) = delete;
+        BenchmarkCategory& operator=(const BenchmarkCategory&) = delete;
+        virtual ~BenchmarkCategory() = default;
+
+        static Exchange::ITestController::ICategory& Instance()
+        {
+            static Exchange::ITestController::ICategory* _singleton(Core::Service<BenchmarkCategory>::Create<Exchange::ITestController::ICategory>());
+            return (*_singleton);
+        }
+
+        // ITestCategory methods
+        string Name() const override
+        {
+            return _name;
+        };
+
+        void Setup() override{
+            /*Benchmarks prepare their own environment, see BenchmarkBase::Prepare */
+        };
+
+        void TearDown() override{
+            /*Benchmarks clean up their own environment, see BenchmarkBase::Cleanup */
+        };
+
+        BEGIN_INTERFACE_MAP(BenchmarkCategory)
+        INTERFACE_ENTRY(Exchange::ITestController::ICategory)
+        END_INTERFACE_MAP
+
+    private:
+        const string _name = _T("BenchmarkCategory");
+    };
+} // namespace TestCore
+} // namespace WPEFramework
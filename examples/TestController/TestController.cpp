@@ -59,6 +59,16 @@ namespace TestController {
     }
 } // namespace TestController
 
+ENUM_CONVERSION_BEGIN(Plugin::TestController::Comparison::status)
+
+    { Plugin::TestController::Comparison::UNCHANGED, _TXT("Unchanged") },
+    { Plugin::TestController::Comparison::REGRESSION, _TXT("Regression") },
+    { Plugin::TestController::Comparison::IMPROVEMENT, _TXT("Improvement") },
+    { Plugin::TestController::Comparison::BASELINE, _TXT("Baseline") },
+    { Plugin::TestController::Comparison::FAILED, _TXT("Failed") },
+
+ENUM_CONVERSION_END(Plugin::TestController::Comparison::status)
+
 namespace Plugin {
     SERVICE_REGISTRATION(TestController, 1, 0);
 
@@ -75,6 +85,7 @@ namespace Plugin {
 
         _service = service;
         _skipURL = static_cast<uint8_t>(_service->WebPrefix().length());
+        _baselines = _service->PersistentPath() + _T("baselines.json");
         _service->Register(&_notification);
         _testControllerImp = _service->Root<Exchange::ITestController>(_connection, ImplWaitTime, _T("TestControllerImp"));
 
@@ -298,6 +309,144 @@ namespace Plugin {
         return response;
     }
 
+    void TestController::Benchmarks(Exchange::ITestController::ICategory* category, const string& testName, const string& body, std::list<std::pair<string, TestCore::TestResult>>& results)
+    {
+        const string categoryName(category->Name());
+
+        TestPreparation(category, categoryName);
+
+        auto tests = category->Tests();
+        while (tests->Next()) {
+            if ((testName.empty() == true) || (tests->Test()->Name() == testName)) {
+                TestCore::TestResult ret;
+
+                // Only benchmark tests report a benchmark section, also when they failed, the others are skipped.
+                if ((ret.FromString(tests->Test()->Execute(body)) == true) && (ret.Benchmark.IsSet() == true)) {
+                    results.emplace_back(categoryName, ret);
+                }
+            }
+        }
+    }
+
+    uint32_t TestController::Compare(const CompareParams& params, Core::JSON::ArrayType<Comparison>& response)
+    {
+        uint32_t result = Core::ERROR_NONE;
+        std::list<std::pair<string, TestCore::TestResult>> results;
+
+        if ((params.Category.IsSet() == false) && (params.Test.IsSet() == true)) {
+            result = Core::ERROR_BAD_REQUEST;
+        } else if (params.Category.IsSet() == false) {
+            Exchange::ITestController::ICategory::IIterator* categories = _testControllerImp->Categories();
+
+            if (categories != nullptr) {
+                while (categories->Next()) {
+                    Benchmarks(categories->Category(), EMPTY_STRING, params.Args.Value(), results);
+                }
+            }
+        } else {
+            Exchange::ITestController::ICategory* category = _testControllerImp->Category(params.Category.Value());
+
+            if (category != nullptr) {
+                Benchmarks(category, params.Test.Value(), params.Args.Value(), results);
+            }
+        }
+
+        if ((result == Core::ERROR_NONE) && (results.empty() == true)) {
+            result = Core::ERROR_UNAVAILABLE;
+        } else if (result == Core::ERROR_NONE) {
+            std::map<string, Baseline> baselines;
+            bool modified = false;
+
+            Core::File file(_baselines);
+
+            if (file.Open(true) == true) {
+                Baselines stored;
+                Core::OptionalType<Core::JSON::Error> error;
+                stored.IElement::FromFile(file, error);
+
+                if (error.IsSet() == true) {
+                    SYSLOG(Logging::ParsingError, (_T("Parsing failed with %s"), ErrorDisplayMessage(error.Value()).c_str()));
+                }
+
+                auto index = stored.Benchmarks.Elements();
+                while (index.Next() == true) {
+                    baselines[index.Current().Category.Value() + '/' + index.Current().Test.Value()] = index.Current();
+                }
+
+                file.Close();
+            }
+
+            const int32_t threshold = params.Threshold.Value();
+
+            for (const std::pair<string, TestCore::TestResult>& entry : results) {
+                const TestCore::BenchmarkData& benchmark(entry.second.Benchmark);
+                const string key(entry.first + '/' + entry.second.Name.Value());
+                auto found = baselines.find(key);
+
+                Comparison& comparison(response.Add());
+                comparison.Category = entry.first;
+                comparison.Test = entry.second.Name.Value();
+                comparison.Current = benchmark.Wall.Value();
+
+                if ((entry.second.OverallStatus.Value() != _T("Success")) || (benchmark.Samples.Value() == 0)) {
+                    comparison.Status = Comparison::FAILED;
+                } else {
+                    if (found == baselines.end()) {
+                        comparison.Status = Comparison::BASELINE;
+                    } else {
+                        const int64_t reference = static_cast<int64_t>(found->second.Wall.Value());
+                        const int64_t current = static_cast<int64_t>(benchmark.Wall.Value());
+                        const int64_t referenceMargin = static_cast<int64_t>(found->second.Confidence.Value());
+                        const int64_t currentMargin = static_cast<int64_t>(benchmark.Confidence.Value());
+                        const int32_t change = (reference == 0 ? 0 : static_cast<int32_t>(((current - reference) * 100) / reference));
+
+                        comparison.Baseline = found->second.Wall.Value();
+                        comparison.Change = change;
+
+                        // Only flag a difference if it exceeds the threshold and the confidence intervals do not overlap.
+                        if ((change > threshold) && ((current - currentMargin) > (reference + referenceMargin))) {
+                            comparison.Status = Comparison::REGRESSION;
+                        } else if ((change < -threshold) && ((current + currentMargin) < (reference - referenceMargin))) {
+                            comparison.Status = Comparison::IMPROVEMENT;
+                        } else {
+                            comparison.Status = Comparison::UNCHANGED;
+                        }
+                    }
+
+                    if ((found == baselines.end()) || (params.Update.Value() == true)) {
+                        Baseline& baseline(baselines[key]);
+                        baseline.Category = entry.first;
+                        baseline.Test = entry.second.Name.Value();
+                        baseline.Wall = benchmark.Wall.Value();
+                        baseline.Confidence = benchmark.Confidence.Value();
+                        baseline.Cpu = benchmark.Cpu.Value();
+                        modified = true;
+                    }
+                }
+
+                if (comparison.Status.Value() == Comparison::REGRESSION) {
+                    TRACE(Trace::Warning, (_T("Benchmark %s regressed by %d%%"), key.c_str(), comparison.Change.Value()));
+                }
+            }
+
+            if (modified == true) {
+                if ((Core::Directory(_service->PersistentPath().c_str()).CreatePath() == true) && (file.Create() == true)) {
+                    Baselines stored;
+
+                    for (const auto& baseline : baselines) {
+                        stored.Benchmarks.Add(baseline.second);
+                    }
+
+                    stored.IElement::ToFile(file);
+                } else {
+                    TRACE(Trace::Error, (_T("Could not store the benchmark baselines in %s"), _baselines.c_str()));
+                }
+            }
+        }
+
+        return result;
+    }
+
     void TestController::TestPreparation(Exchange::ITestController::ICategory* const category, const string& categoryName)
     {
         if (_prevCategory != categoryName) {
@@ -97,6 +97,182 @@ namespace Plugin {
             Core::JSON::ArrayType<TestCore::TestResult> Results;
         };
 
+    public:
+        // Stored benchmark result, the reference for later comparisons.
+        class Baseline : public Core::JSON::Container {
+        public:
+            Baseline()
+                : Core::JSON::Container()
+                , Category()
+                , Test()
+                , Wall()
+                , Confidence()
+                , Cpu()
+            {
+                Init();
+            }
+
+            Baseline(const Baseline& copy)
+                : Core::JSON::Container()
+                , Category(copy.Category)
+                , Test(copy.Test)
+                , Wall(copy.Wall)
+                , Confidence(copy.Confidence)
+                , Cpu(copy.Cpu)
+            {
+                Init();
+            }
+
+            Baseline& operator=(const Baseline& rhs)
+            {
+                this->Category = rhs.Category;
+                this->Test = rhs.Test;
+                this->Wall = rhs.Wall;
+                this->Confidence = rhs.Confidence;
+                this->Cpu = rhs.Cpu;
+
+                return *this;
+            }
+
+            ~Baseline() = default;
+
+        private:
+            void Init()
+            {
+                Add(_T("category"), &Category);
+                Add(_T("test"), &Test);
+                Add(_T("wall"), &Wall);
+                Add(_T("confidence"), &Confidence);
+                Add(_T("cpu"), &Cpu);
+            }
+
+        public:
+            Core::JSON::String Category;
+            Core::JSON::String Test;
+            Core::JSON::DecUInt64 Wall; // nS per iteration
+            Core::JSON::DecUInt64 Confidence; // nS per iteration
+            Core::JSON::DecUInt64 Cpu; // nS per iteration
+        };
+
+        class Baselines : public Core::JSON::Container {
+        private:
+            Baselines(const Baselines&) = delete;
+            Baselines& operator=(const Baselines&) = delete;
+
+        public:
+            Baselines()
+                : Core::JSON::Container()
+                , Benchmarks()
+            {
+                Add(_T("benchmarks"), &Benchmarks);
+            }
+
+            ~Baselines() = default;
+
+        public:
+            Core::JSON::ArrayType<Baseline> Benchmarks;
+        };
+
+        class CompareParams : public Core::JSON::Container {
+        private:
+            CompareParams(const CompareParams&) = delete;
+            CompareParams& operator=(const CompareParams&) = delete;
+
+        public:
+            CompareParams()
+                : Core::JSON::Container()
+                , Category()
+                , Test()
+                , Args()
+                , Threshold(10)
+                , Update(false)
+            {
+                Add(_T("category"), &Category);
+                Add(_T("test"), &Test);
+                Add(_T("args"), &Args);
+                Add(_T("threshold"), &Threshold);
+                Add(_T("update"), &Update);
+            }
+
+            ~CompareParams() = default;
+
+        public:
+            Core::JSON::String Category;
+            Core::JSON::String Test;
+            Core::JSON::String Args;
+            Core::JSON::DecUInt16 Threshold; // Percentage
+            Core::JSON::Boolean Update; // Store the results as the new baselines
+        };
+
+        class Comparison : public Core::JSON::Container {
+        public:
+            enum status {
+                UNCHANGED,
+                REGRESSION,
+                IMPROVEMENT,
+                BASELINE,
+                FAILED
+            };
+
+        public:
+            Comparison()
+                : Core::JSON::Container()
+                , Category()
+                , Test()
+                , Status()
+                , Baseline()
+                , Current()
+                , Change()
+            {
+                Init();
+            }
+
+            Comparison(const Comparison& copy)
+                : Core::JSON::Container()
+                , Category(copy.Category)
+                , Test(copy.Test)
+                , Status(copy.Status)
+                , Baseline(copy.Baseline)
+                , Current(copy.Current)
+                , Change(copy.Change)
+            {
+                Init();
+            }
+
+            Comparison& operator=(const Comparison& rhs)
+            {
+                this->Category = rhs.Category;
+                this->Test = rhs.Test;
+                this->Status = rhs.Status;
+                this->Baseline = rhs.Baseline;
+                this->Current = rhs.Current;
+                this->Change = rhs.Change;
+
+                return *this;
+            }
+
+            ~Comparison() = default;
+
+        private:
+            void Init()
+            {
+                Add(_T("category"), &Category);
+                Add(_T("test"), &Test);
+                Add(_T("status"), &Status);
+                Add(_T("baseline"), &Baseline);
+                Add(_T("current"), &Current);
+                Add(_T("change"), &Change);
+            }
+
+        public:
+            Core::JSON::String Category;
+            Core::JSON::String Test;
+            Core::JSON::EnumType<status> Status;
+            Core::JSON::DecUInt64 Baseline; // nS per iteration
+            Core::JSON::DecUInt64 Current; // nS per iteration
+            Core::JSON::DecSInt32 Change; // Percentage
+        };
+
     public:
         TestController()
             : _service(nullptr)
@@ -106,6 +282,7 @@ namespace Plugin {
             , _skipURL(0)
             , _connection(0)
             , _prevCategory(EMPTY_STRING)
+            , _baselines()
         {
             RegisterAll();
         }
@@ -149,11 +326,14 @@ namespace Plugin {
         Core::JSON::ArrayType<Core::JSON::String> /*JSON*/ Tests(Exchange::ITestController::ITest::IIterator* tests) const;
         string /*JSON*/ RunAll(const string& body, const string& categoryName = EMPTY_STRING);
         string /*JSON*/ RunTest(const string& body, const string& categoryName, const string& testName);
+        void Benchmarks(Exchange::ITestController::ICategory* category, const string& testName, const string& body, std::list<std::pair<string, TestCore::TestResult>>& results);
+        uint32_t Compare(const CompareParams& params, Core::JSON::ArrayType<Comparison>& response);
 
         void RegisterAll();
         void UnregisterAll();
         Core::JSON::ArrayType<JsonData::TestController::RunResultData> TestResults(const string& results);
         uint32_t endpoint_run(const JsonData::TestController::RunParamsData& params, Core::JSON::ArrayType<JsonData::TestController::RunResultData>& response);
+        uint32_t endpoint_compare(const CompareParams& params, Core::JSON::ArrayType<Comparison>& response);
         uint32_t get_categories(Core::JSON::ArrayType<Core::JSON::String>& response) const;
         uint32_t get_tests(const string& index, Core::JSON::ArrayType<Core::JSON::String>& response) const;
         uint32_t get_description(const string& index, JsonData::TestController::DescriptionData& response) const;
@@ -165,6 +345,7 @@ namespace Plugin {
         uint8_t _skipURL;
         uint32_t _connection;
         string _prevCategory;
+        string _baselines;
     };
 
 } // namespace Plugin
@@ -33,6 +33,7 @@ namespace Plugin {
     void TestController::RegisterAll()
     {
         Register<RunParamsData,Core::JSON::ArrayType<RunResultData>>(_T("run"), &TestController::endpoint_run, this);
+        Register<CompareParams,Core::JSON::ArrayType<Comparison>>(_T("compare"), &TestController::endpoint_compare, this);
         Property<Core::JSON::ArrayType<Core::JSON::String>>(_T("categories"), &TestController::get_categories, nullptr, this);
         Property<Core::JSON::ArrayType<Core::JSON::String>>(_T("tests"), &TestController::get_tests, nullptr, this);
         Property<DescriptionData>(_T("description"), &TestController::get_description, nullptr, this);
@@ -41,6 +42,7 @@ namespace Plugin {
     void TestController::UnregisterAll()
     {
         Unregister(_T("run"));
+        Unregister(_T("compare"));
         Unregister(_T("description"));
         Unregister(_T("tests"));
         Unregister(_T("categories"));
@@ -107,6 +109,20 @@ namespace Plugin {
         return result;
     }
 
+    // Method: compare - Run the benchmarks, all of them - no arguments;
+    // The benchmarks of a selected category - specify category;
+    // A selected benchmark - specify category and test name;
+    // and compare the results against the stored baselines. Benchmarks without a baseline
+    // get their result stored as baseline, specify update to replace existing baselines.
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNAVAILABLE: Unknown category/test or no benchmarks found
+    //  - ERROR_BAD_REQUEST: Bad json param data format
+    uint32_t TestController::endpoint_compare(const CompareParams& params, Core::JSON::ArrayType<Comparison>& response)
+    {
+        return (Compare(params, response));
+    }
+
     // Property: categories - List of test categories
     // Return codes:
     //  - ERROR_NONE: Success
@@ -0,0 +1,288 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../CommandCore/TestCommandBase.h"
+#include "../CommandCore/TestCommandController.h"
+
+#include <time.h>
+
+namespace WPEFramework {
+
+// Keeps a core busy for a duty cycle of every period. One is started per core to load.
+class CpuBurner : public Core::Thread {
+public:
+    CpuBurner() = delete;
+    CpuBurner(const CpuBurner&) = delete;
+    CpuBurner& operator=(const CpuBurner&) = delete;
+
+    CpuBurner(const uint8_t duty, const uint32_t period)
+        : Core::Thread(Core::Thread::DefaultStackSize(), _T("CpuBurner"))
+        , _busy((static_cast<uint64_t>(period) * 1000 * duty) / 100)
+        , _idle(static_cast<uint32_t>(period - (_busy / 1000)))
+        , _cpu(0)
+        , _cycles(0)
+    {
+        Run();
+    }
+    ~CpuBurner() override
+    {
+        Block();
+        Wait(Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+    }
+
+public:
+    // Consumed by the thread, in mS.
+    uint32_t Cpu() const
+    {
+        return (_cpu.load());
+    }
+    uint32_t Cycles() const
+    {
+        return (_cycles.load());
+    }
+
+private:
+    uint32_t Worker() override
+    {
+        const uint64_t end = Core::Time::Now().Ticks() + _busy;
+        volatile uint32_t value = 0;
+
+        while (Core::Time::Now().Ticks() < end) {
+            value = (value * 1103515245) + 12345;
+        }
+
+        struct timespec time;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+
+        _cpu.store(static_cast<uint32_t>((static_cast<uint64_t>(time.tv_sec) * 1000) + (time.tv_nsec / 1000000)));
+        _cycles++;
+
+        return (_idle);
+    }
+
+private:
+    const uint64_t _busy; // uS
+    const uint32_t _idle; // mS
+    std::atomic<uint32_t> _cpu;
+    std::atomic<uint32_t> _cycles;
+};
+
+class CpuLoad : public TestCommandBase {
+public:
+    CpuLoad(const CpuLoad&) = delete;
+    CpuLoad& operator=(const CpuLoad&) = delete;
+
+public:
+    enum action {
+        START,
+        STOP,
+        STATUS
+    };
+
+    class Parameters : public Core::JSON::Container {
+    public:
+        Parameters(const Parameters&) = delete;
+        Parameters& operator=(const Parameters&) = delete;
+
+        Parameters()
+            : Core::JSON::Container()
+            , Command()
+            , Action(STATUS)
+            , Cores(1)
+            , Duty(100)
+            , Period(100)
+        {
+            Add(_T("command"), &Command);
+            Add(_T("action"), &Action);
+            Add(_T("cores"), &Cores);
+            Add(_T("duty"), &Duty);
+            Add(_T("period"), &Period);
+        }
+        ~Parameters() = default;
+
+    public:
+        Core::JSON::String Command;
+        Core::JSON::EnumType<action> Action;
+        Core::JSON::DecUInt8 Cores;
+        Core::JSON::DecUInt8 Duty; // Percentage
+        Core::JSON::DecUInt32 Period; // mS
+    };
+
+    class Response : public Core::JSON::Container {
+    public:
+        Response(const Response&) = delete;
+        Response& operator=(const Response&) = delete;
+
+        Response()
+            : Core::JSON::Container()
+            , Running(false)
+            , Cores(0)
+            , Duty(0)
+            , Elapsed(0)
+            , Cpu(0)
+            , Load(0)
+            , Cycles(0)
+        {
+            Add(_T("running"), &Running);
+            Add(_T("cores"), &Cores);
+            Add(_T("duty"), &Duty);
+            Add(_T("elapsed"), &Elapsed);
+            Add(_T("cpu"), &Cpu);
+            Add(_T("load"), &Load);
+            Add(_T("cycles"), &Cycles);
+        }
+        ~Response() = default;
+
+    public:
+        Core::JSON::Boolean Running;
+        Core::JSON::DecUInt8 Cores;
+        Core::JSON::DecUInt8 Duty; // Percentage, requested
+        Core::JSON::DecUInt32 Elapsed; // mS
+        Core::JSON::DecUInt32 Cpu; // mS, consumed by all burners
+        Core::JSON::DecUInt8 Load; // Percentage, achieved per core
+        Core::JSON::DecUInt32 Cycles;
+    };
+
+public:
+    CpuLoad()
+        : TestCommandBase(TestCommandBase::DescriptionBuilder("Keeps a number of cores busy in the background at a duty cycle"),
+              TestCommandBase::SignatureBuilder("statistics", JsonData::TestUtility::TypeType::OBJECT, "requested and achieved load")
+                  .InputParameter("action", JsonData::TestUtility::TypeType::STRING, "start, stop or status")
+                  .InputParameter("cores", JsonData::TestUtility::TypeType::NUMBER, "number of cores to load")
+                  .InputParameter("duty", JsonData::TestUtility::TypeType::NUMBER, "percentage of the period a core is busy")
+                  .InputParameter("period", JsonData::TestUtility::TypeType::NUMBER, "duty cycle period in mS"))
+        , _adminLock()
+        , _burners()
+        , _duty(0)
+        , _start(0)
+    {
+        TestCore::TestCommandController::Instance().Announce(this);
+    }
+
+    virtual ~CpuLoad()
+    {
+        TestCore::TestCommandController::Instance().Revoke(this);
+        Stop();
+    }
+
+public:
+    // ICommand methods
+    string Execute(const string& params) final
+    {
+        Parameters input;
+
+        if (input.FromString(params) == true) {
+            if (input.Action == START) {
+                if ((input.Cores.Value() > 0) && (input.Duty.Value() <= 100) && (input.Period.Value() > 0)) {
+                    Start(input.Cores.Value(), input.Duty.Value(), input.Period.Value());
+                } else {
+                    SYSLOG(Trace::Error, (_T("*** Invalid cpu load settings ***")));
+                }
+            } else if (input.Action == STOP) {
+                Stop();
+            }
+        }
+
+        return CreateResponse();
+    }
+
+    string Name() const final
+    {
+        return _name;
+    }
+
+private:
+    void Start(const uint8_t cores, const uint8_t duty, const uint32_t period)
+    {
+        Stop();
+
+        _adminLock.Lock();
+        _duty = duty;
+        _start = Core::Time::Now().Ticks();
+        for (uint8_t index = 0; index < cores; index++) {
+            _burners.push_back(new CpuBurner(duty, period));
+        }
+        _adminLock.Unlock();
+    }
+    void Stop()
+    {
+        _adminLock.Lock();
+        for (CpuBurner* burner : _burners) {
+            delete burner;
+        }
+        _burners.clear();
+        _adminLock.Unlock();
+    }
+
+    string /*JSON*/ CreateResponse() const
+    {
+        string jsonResponse;
+        Response response;
+
+        _adminLock.Lock();
+
+        if (_burners.empty() == false) {
+            const uint64_t elapsed = (Core::Time::Now().Ticks() - _start) / 1000;
+            uint64_t cpu = 0;
+            uint32_t cycles = 0;
+
+            for (const CpuBurner* burner : _burners) {
+                cpu += burner->Cpu();
+                cycles += burner->Cycles();
+            }
+
+            response.Running = true;
+            response.Cores = static_cast<uint8_t>(_burners.size());
+            response.Duty = _duty;
+            response.Elapsed = static_cast<uint32_t>(elapsed);
+            response.Cpu = static_cast<uint32_t>(cpu);
+            response.Load = static_cast<uint8_t>(elapsed > 0 ? std::min((cpu * 100) / (elapsed * _burners.size()), static_cast<uint64_t>(100)) : 0);
+            response.Cycles = cycles;
+        }
+
+        _adminLock.Unlock();
+
+        response.ToString(jsonResponse);
+
+        return jsonResponse;
+    }
+
+    BEGIN_INTERFACE_MAP(CpuLoad)
+    INTERFACE_ENTRY(Exchange::ITestUtility::ICommand)
+    END_INTERFACE_MAP
+
+private:
+    mutable Core::CriticalSection _adminLock;
+    std::list<CpuBurner*> _burners;
+    uint8_t _duty;
+    uint64_t _start;
+    const string _name = _T("CpuLoad");
+};
+
+static CpuLoad* _singleton(Core::Service<CpuLoad>::Create<CpuLoad>());
+
+ENUM_CONVERSION_BEGIN(CpuLoad::action)
+
+    { CpuLoad::START, _TXT("start") },
+    { CpuLoad::STOP, _TXT("stop") },
+    { CpuLoad::STATUS, _TXT("status") },
+
+ENUM_CONVERSION_END(CpuLoad::action)
+
+} // namespace WPEFramework
@@ -0,0 +1,461 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../CommandCore/TestCommandBase.h"
+#include "../CommandCore/TestCommandController.h"
+
+#include <sys/mman.h>
+
+namespace WPEFramework {
+
+// Grows the memory footprint of the process along a profile, in the background. The memory is mapped
+// anonymously, so it only counts for the virtual size until a page is touched. Touching a percentage of
+// the pages, at a limited rate, controls how far the resident size trails the virtual size.
+class MemoryPressure : public Core::Thread {
+public:
+    MemoryPressure(const MemoryPressure&) = delete;
+    MemoryPressure& operator=(const MemoryPressure&) = delete;
+
+    enum profile {
+        LINEAR, // Grow at rate up to the target and hold
+        SAWTOOTH, // Grow at rate up to the target, hold for period, release all and start over
+        STEP // Grow by step every period up to the target and hold
+    };
+
+    struct Settings {
+        profile Profile;
+        uint32_t Target; // kB
+        uint32_t Rate; // kB/S
+        uint32_t Step; // kB
+        uint32_t Period; // mS
+        uint8_t Resident; // Percentage of the allocated pages that is touched
+        uint32_t TouchRate; // Pages/S, 0 touches as fast as possible
+    };
+
+    struct Statistics {
+        bool Running;
+        uint32_t Elapsed; // mS
+        uint32_t Allocated; // kB
+        uint32_t Touched; // kB
+        uint32_t Cycles;
+    };
+
+private:
+    static constexpr uint32_t Interval = 100; // mS
+    static constexpr uint32_t ChunkPages = 256;
+
+    struct Chunk {
+        uint8_t* Address;
+        uint32_t Pages;
+        uint32_t Touched;
+    };
+
+public:
+    MemoryPressure()
+        : Core::Thread(Core::Thread::DefaultStackSize(), _T("MemoryPressure"))
+        , _adminLock()
+        , _pageSize(static_cast<uint32_t>(getpagesize()))
+        , _settings()
+        , _chunks()
+        , _allocated(0)
+        , _touched(0)
+        , _cycles(0)
+        , _start(0)
+        , _cycleStart(0)
+        , _lastTouch(0)
+        , _touchCredit(0)
+        , _running(false)
+    {
+    }
+    ~MemoryPressure() override
+    {
+        Stop();
+    }
+
+public:
+    uint32_t Start(const Settings& settings)
+    {
+        uint32_t result = Core::ERROR_BAD_REQUEST;
+
+        if ((settings.Target > 0) && (settings.Resident <= 100)
+            && ((settings.Profile == STEP) ? ((settings.Step > 0) && (settings.Period > 0)) : (settings.Rate > 0))) {
+
+            Stop();
+
+            _adminLock.Lock();
+            _settings = settings;
+            _cycles = 0;
+            _start = Core::Time::Now().Ticks();
+            _cycleStart = _start;
+            _lastTouch = _start;
+            _touchCredit = 0;
+            _running = true;
+            _adminLock.Unlock();
+
+            Run();
+            result = Core::ERROR_NONE;
+        }
+
+        return (result);
+    }
+    void Stop()
+    {
+        Block();
+        Wait(Core::Thread::INITIALIZED | Core::Thread::BLOCKED | Core::Thread::STOPPED, Core::infinite);
+
+        _adminLock.Lock();
+        Release(0);
+        _running = false;
+        _adminLock.Unlock();
+    }
+    void Get(Statistics& statistics) const
+    {
+        _adminLock.Lock();
+        statistics.Running = _running;
+        statistics.Elapsed = (_running == true ? static_cast<uint32_t>((Core::Time::Now().Ticks() - _start) / 1000) : 0);
+        statistics.Allocated = static_cast<uint32_t>((static_cast<uint64_t>(_allocated) * _pageSize) >> 10);
+        statistics.Touched = static_cast<uint32_t>((static_cast<uint64_t>(_touched) * _pageSize) >> 10);
+        statistics.Cycles = _cycles;
+        _adminLock.Unlock();
+    }
+
+private:
+    uint32_t Worker() override
+    {
+        const uint64_t now = Core::Time::Now().Ticks();
+
+        _adminLock.Lock();
+
+        uint32_t elapsed = static_cast<uint32_t>((now - _cycleStart) / 1000);
+
+        if (_settings.Profile == SAWTOOTH) {
+            const uint32_t ramp = static_cast<uint32_t>((static_cast<uint64_t>(_settings.Target) * 1000) / _settings.Rate);
+
+            if (elapsed >= (ramp + _settings.Period)) {
+                Release(0);
+                _cycles++;
+                _cycleStart = now;
+                elapsed = 0;
+            }
+        }
+
+        Allocate(Desired(elapsed));
+        Touch(now);
+
+        _adminLock.Unlock();
+
+        return (Interval);
+    }
+
+    // In kB, for the time (mS) spend in the current cycle.
+    uint32_t Desired(const uint32_t elapsed) const
+    {
+        uint64_t result;
+
+        if (_settings.Profile == STEP) {
+            result = static_cast<uint64_t>(_settings.Step) * ((elapsed / _settings.Period) + 1);
+        } else {
+            result = (static_cast<uint64_t>(_settings.Rate) * elapsed) / 1000;
+        }
+
+        return (result < _settings.Target ? static_cast<uint32_t>(result) : _settings.Target);
+    }
+
+    // Should be called with the lock taken.
+    void Allocate(const uint32_t size)
+    {
+        const uint32_t pages = static_cast<uint32_t>((static_cast<uint64_t>(size) << 10) / _pageSize);
+
+        while (_allocated < pages) {
+            uint32_t count = pages - _allocated;
+
+            if (count > ChunkPages) {
+                count = ChunkPages;
+            }
+
+            void* address = mmap(nullptr, static_cast<size_t>(count) * _pageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if (address == MAP_FAILED) {
+                SYSLOG(Trace::Fatal, (_T("*** Failed mapping of %u pages !!! ***"), count));
+                break;
+            }
+
+            _chunks.push_back({ static_cast<uint8_t*>(address), count, 0 });
+            _allocated += count;
+        }
+
+        if (_allocated > pages) {
+            Release(pages);
+        }
+    }
+
+    // Should be called with the lock taken.
+    void Release(const uint32_t pages)
+    {
+        while ((_allocated > pages) && (_chunks.empty() == false)) {
+            Chunk& chunk(_chunks.back());
+
+            munmap(chunk.Address, static_cast<size_t>(chunk.Pages) * _pageSize);
+            _allocated -= chunk.Pages;
+            _touched -= chunk.Touched;
+            _chunks.pop_back();
+        }
+    }
+
+    // Should be called with the lock taken.
+    void Touch(const uint64_t now)
+    {
+        const uint32_t required = static_cast<uint32_t>((static_cast<uint64_t>(_allocated) * _settings.Resident) / 100);
+        uint32_t budget = ~0;
+
+        if (_settings.TouchRate != 0) {
+            _touchCredit += static_cast<uint64_t>(_settings.TouchRate) * (now - _lastTouch);
+            budget = static_cast<uint32_t>(std::min(_touchCredit / 1000000, static_cast<uint64_t>(~0u)));
+        }
+        _lastTouch = now;
+
+        std::list<Chunk>::iterator index(_chunks.begin());
+
+        while ((_touched < required) && (budget > 0) && (index != _chunks.end())) {
+            while ((index->Touched < index->Pages) && (_touched < required) && (budget > 0)) {
+                // Not a zero, the kernel may share zero filled pages.
+                index->Address[static_cast<size_t>(index->Touched) * _pageSize] = static_cast<uint8_t>(index->Touched | 1);
+                index->Touched++;
+                _touched++;
+                budget--;
+            }
+            index++;
+        }
+
+        if (_settings.TouchRate != 0) {
+            // Do not save up for a burst while there is nothing to touch.
+            _touchCredit = (_touched < required ? ((static_cast<uint64_t>(budget) * 1000000) + (_touchCredit % 1000000)) : 0);
+        }
+    }
+
+private:
+    mutable Core::CriticalSection _adminLock;
+    const uint32_t _pageSize;
+    Settings _settings;
+    std::list<Chunk> _chunks;
+    uint32_t _allocated; // Pages
+    uint32_t _touched; // Pages
+    uint32_t _cycles;
+    uint64_t _start;
+    uint64_t _cycleStart;
+    uint64_t _lastTouch;
+    uint64_t _touchCredit; // Pages, in millionths
+    bool _running;
+};
+
+class MemoryLoad : public TestCommandBase {
+public:
+    MemoryLoad(const MemoryLoad&) = delete;
+    MemoryLoad& operator=(const MemoryLoad&) = delete;
+
+public:
+    enum action {
+        START,
+        STOP,
+        STATUS
+    };
+
+    class Parameters : public Core::JSON::Container {
+    public:
+        Parameters(const Parameters&) = delete;
+        Parameters& operator=(const Parameters&) = delete;
+
+        Parameters()
+            : Core::JSON::Container()
+            , Command()
+            , Action(STATUS)
+            , Profile(MemoryPressure::LINEAR)
+            , Target(0)
+            , Rate(1024)
+            , Step(1024)
+            , Period(1000)
+            , Resident(100)
+            , TouchRate(0)
+        {
+            Add(_T("command"), &Command);
+            Add(_T("action"), &Action);
+            Add(_T("profile"), &Profile);
+            Add(_T("target"), &Target);
+            Add(_T("rate"), &Rate);
+            Add(_T("step"), &Step);
+            Add(_T("period"), &Period);
+            Add(_T("resident"), &Resident);
+            Add(_T("touchrate"), &TouchRate);
+        }
+        ~Parameters() = default;
+
+    public:
+        Core::JSON::String Command;
+        Core::JSON::EnumType<action> Action;
+        Core::JSON::EnumType<MemoryPressure::profile> Profile;
+        Core::JSON::DecUInt32 Target; // kB
+        Core::JSON::DecUInt32 Rate; // kB/S
+        Core::JSON::DecUInt32 Step; // kB
+        Core::JSON::DecUInt32 Period; // mS
+        Core::JSON::DecUInt8 Resident; // Percentage
+        Core::JSON::DecUInt32 TouchRate; // Pages/S
+    };
+
+    class Response : public Core::JSON::Container {
+    public:
+        Response(const Response&) = delete;
+        Response& operator=(const Response&) = delete;
+
+        Response()
+            : Core::JSON::Container()
+            , Running(false)
+            , Elapsed(0)
+            , Allocated(0)
+            , Touched(0)
+            , Cycles(0)
+            , Size(0)
+            , Resident(0)
+        {
+            Add(_T("running"), &Running);
+            Add(_T("elapsed"), &Elapsed);
+            Add(_T("allocated"), &Allocated);
+            Add(_T("touched"), &Touched);
+            Add(_T("cycles"), &Cycles);
+            Add(_T("size"), &Size);
+            Add(_T("resident"), &Resident);
+        }
+        ~Response() = default;
+
+    public:
+        Core::JSON::Boolean Running;
+        Core::JSON::DecUInt32 Elapsed; // mS
+        Core::JSON::DecUInt32 Allocated; // kB, mapped by the generator
+        Core::JSON::DecUInt32 Touched; // kB, made resident by the generator
+        Core::JSON::DecUInt32 Cycles;
+        Core::JSON::DecUInt32 Size; // kB, of the process
+        Core::JSON::DecUInt32 Resident; // kB, of the process
+    };
+
+public:
+    MemoryLoad()
+        : TestCommandBase(TestCommandBase::DescriptionBuilder("Grows memory in the background along a linear, sawtooth or step profile"),
+              TestCommandBase::SignatureBuilder("statistics", JsonData::TestUtility::TypeType::OBJECT, "generator and process memory statistics")
+                  .InputParameter("action", JsonData::TestUtility::TypeType::STRING, "start, stop or status")
+                  .InputParameter("profile", JsonData::TestUtility::TypeType::STRING, "linear, sawtooth or step")
+                  .InputParameter("target", JsonData::TestUtility::TypeType::NUMBER, "memory in kB to grow to")
+                  .InputParameter("rate", JsonData::TestUtility::TypeType::NUMBER, "growth in kB per second (linear, sawtooth)")
+                  .InputParameter("step", JsonData::TestUtility::TypeType::NUMBER, "growth in kB per period (step)")
+                  .InputParameter("period", JsonData::TestUtility::TypeType::NUMBER, "time in mS between steps (step) or at the top (sawtooth)")
+                  .InputParameter("resident", JsonData::TestUtility::TypeType::NUMBER, "percentage of the memory to make resident")
+                  .InputParameter("touchrate", JsonData::TestUtility::TypeType::NUMBER, "pages per second made resident, 0 is unlimited"))
+        , _process()
+        , _generator()
+    {
+        TestCore::TestCommandController::Instance().Announce(this);
+    }
+
+    virtual ~MemoryLoad()
+    {
+        TestCore::TestCommandController::Instance().Revoke(this);
+    }
+
+public:
+    // ICommand methods
+    string Execute(const string& params) final
+    {
+        Parameters input;
+
+        if (input.FromString(params) == true) {
+            if (input.Action == START) {
+                MemoryPressure::Settings settings;
+
+                settings.Profile = input.Profile.Value();
+                settings.Target = input.Target.Value();
+                settings.Rate = input.Rate.Value();
+                settings.Step = input.Step.Value();
+                settings.Period = input.Period.Value();
+                settings.Resident = input.Resident.Value();
+                settings.TouchRate = input.TouchRate.Value();
+
+                if (_generator.Start(settings) != Core::ERROR_NONE) {
+                    SYSLOG(Trace::Error, (_T("*** Invalid memory load settings ***")));
+                }
+            } else if (input.Action == STOP) {
+                _generator.Stop();
+            }
+        }
+
+        return CreateResponse();
+    }
+
+    string Name() const final
+    {
+        return _name;
+    }
+
+private:
+    string /*JSON*/ CreateResponse() const
+    {
+        string jsonResponse;
+        Response response;
+        MemoryPressure::Statistics statistics;
+
+        _generator.Get(statistics);
+
+        response.Running = statistics.Running;
+        response.Elapsed = statistics.Elapsed;
+        response.Allocated = statistics.Allocated;
+        response.Touched = statistics.Touched;
+        response.Cycles = statistics.Cycles;
+        response.Size = static_cast<uint32_t>(_process.Allocated() >> 10);
+        response.Resident = static_cast<uint32_t>(_process.Resident() >> 10);
+        response.ToString(jsonResponse);
+
+        return jsonResponse;
+    }
+
+    BEGIN_INTERFACE_MAP(MemoryLoad)
+    INTERFACE_ENTRY(Exchange::ITestUtility::ICommand)
+    END_INTERFACE_MAP
+
+private:
+    Core::ProcessInfo _process;
+    MemoryPressure _generator;
+    const string _name = _T("MemoryLoad");
+};
+
+static MemoryLoad* _singleton(Core::Service<MemoryLoad>::Create<MemoryLoad>());
+
+ENUM_CONVERSION_BEGIN(MemoryPressure::profile)
+
+    { MemoryPressure::LINEAR, _TXT("linear") },
+    { MemoryPressure::SAWTOOTH, _TXT("sawtooth") },
+    { MemoryPressure::STEP, _TXT("step") },
+
+ENUM_CONVERSION_END(MemoryPressure::profile)
+
+ENUM_CONVERSION_BEGIN(MemoryLoad::action)
+
+    { MemoryLoad::START, _TXT("start") },
+    { MemoryLoad::STOP, _TXT("stop") },
+    { MemoryLoad::STATUS, _TXT("status") },
+
+ENUM_CONVERSION_END(MemoryLoad::action)
+
+} // namespace WPEFramework
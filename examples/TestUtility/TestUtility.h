@@ -130,6 +130,10 @@ namespace Plugin {
         void UnregisterAll();
         uint32_t endpoint_runmemory(const JsonData::TestUtility::RunmemoryParamsData& params, JsonData::TestUtility::RunmemoryResultData& response);
         uint32_t endpoint_runcrash(const JsonData::TestUtility::RuncrashParamsData& params);
+        uint32_t endpoint_startload(const JsonObject& params, JsonObject& response);
+        uint32_t endpoint_stopload(const JsonObject& params, JsonObject& response);
+        uint32_t endpoint_loadstatus(const JsonObject& params, JsonObject& response);
+        uint32_t RunLoad(const JsonObject& params, const TCHAR action[], JsonObject& response);
         uint32_t get_commands(Core::JSON::ArrayType<Core::JSON::String>& response) const;
         uint32_t get_description(const string& index, JsonData::TestUtility::DescriptionData& response) const;
         uint32_t get_parameters(const string& index, JsonData::TestUtility::ParametersData& response) const;
@@ -34,6 +34,9 @@ namespace Plugin {
     {
         Register<RunmemoryParamsData,RunmemoryResultData>(_T("runmemory"), &TestUtility::endpoint_runmemory, this);
         Register<RuncrashParamsData,void>(_T("runcrash"), &TestUtility::endpoint_runcrash, this);
+        Register<JsonObject,JsonObject>(_T("startload"), &TestUtility::endpoint_startload, this);
+        Register<JsonObject,JsonObject>(_T("stopload"), &TestUtility::endpoint_stopload, this);
+        Register<JsonObject,JsonObject>(_T("loadstatus"), &TestUtility::endpoint_loadstatus, this);
         Property<Core::JSON::ArrayType<Core::JSON::String>>(_T("commands"), &TestUtility::get_commands, nullptr, this);
         Property<DescriptionData>(_T("description"), &TestUtility::get_description, nullptr, this);
         Property<ParametersData>(_T("parameters"), &TestUtility::get_parameters, nullptr, this);
@@ -44,6 +47,9 @@ namespace Plugin {
     {
         Unregister(_T("runcrash"));
         Unregister(_T("runmemory"));
+        Unregister(_T("loadstatus"));
+        Unregister(_T("stopload"));
+        Unregister(_T("startload"));
         Unregister(_T("parameters"));
         Unregister(_T("description"));
         Unregister(_T("commands"));
@@ -114,6 +120,69 @@ namespace Plugin {
         return result;
     }
 
+    // Method: startload - Starts a load generator command in the background
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNAVAILABLE: Unknown category
+    //  - ERROR_BAD_REQUEST: Bad JSON param data format
+    uint32_t TestUtility::endpoint_startload(const JsonObject& params, JsonObject& response)
+    {
+        TRACE_L1("*** Call endpoint_startload ***");
+
+        return RunLoad(params, _T("start"), response);
+    }
+
+    // Method: stopload - Stops a load generator command and releases what it holds
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNAVAILABLE: Unknown category
+    //  - ERROR_BAD_REQUEST: Bad JSON param data format
+    uint32_t TestUtility::endpoint_stopload(const JsonObject& params, JsonObject& response)
+    {
+        TRACE_L1("*** Call endpoint_stopload ***");
+
+        return RunLoad(params, _T("stop"), response);
+    }
+
+    // Method: loadstatus - Retrieves the live statistics of a load generator command
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNAVAILABLE: Unknown category
+    //  - ERROR_BAD_REQUEST: Bad JSON param data format
+    uint32_t TestUtility::endpoint_loadstatus(const JsonObject& params, JsonObject& response)
+    {
+        TRACE_L1("*** Call endpoint_loadstatus ***");
+
+        return RunLoad(params, _T("status"), response);
+    }
+
+    // The settings differ per generator, so they are passed on to the command as they came in.
+    uint32_t TestUtility::RunLoad(const JsonObject& params, const TCHAR action[], JsonObject& response)
+    {
+        uint32_t result = Core::ERROR_BAD_REQUEST;
+        const Core::JSON::Variant name(params.Get(_T("command")));
+
+        if (name.Content() == Core::JSON::Variant::type::STRING)
+        {
+            Exchange::ITestUtility::ICommand* command = _testUtilityImp->Command(name.String());
+
+            if (command) {
+                JsonObject request(params);
+                string tmpParams, tmpResponse;
+
+                request[_T("action")] = action;
+                request.ToString(tmpParams);
+                tmpResponse = command->Execute(tmpParams);
+                if (response.FromString(tmpResponse) == true) {
+                    result = Core::ERROR_NONE;
+                }
+            } else {
+                result = Core::ERROR_UNAVAILABLE;
+            }
+        }
+        return result;
+    }
+
     // Property: commands - Retrieves the list of test commands
     // Return codes:
     //  - ERROR_NONE: Success
@@ -0,0 +1,371 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MODULE_NAME
+#define MODULE_NAME VoiceDecoderBenchmark
+#endif
+
+#include <core/core.h>
+
+#include <math.h>
+
+#include "Administrator.h"
+#include "CommandLine.h"
+
+using namespace WPEFramework;
+
+namespace WPEFramework {
+
+    // Runs the voice decoders of the BluetoothRemoteControl plugin outside of the plugin. A capture is the
+    // sequence of voice notifications as the remote sends them: a 5 byte header (sequence, step index,
+    // predictor and compression), the ADPCM data and a 1 byte footer. On file every notification is
+    // preceded by its length, 16 bits little endian. Without a capture, a tone is encoded and framed the
+    // same way, optionally dropping frames to measure the loss concealment as well.
+    class Capture {
+    private:
+        static constexpr uint8_t WindowSize = 32;
+        static constexpr uint8_t Steps = 89;
+
+    public:
+        Capture(const Capture&) = delete;
+        Capture& operator=(const Capture&) = delete;
+
+        Capture()
+            : _notifications()
+            , _samples(0)
+        {
+        }
+        ~Capture()
+        {
+        }
+
+    public:
+        uint32_t Load(const string& fileName)
+        {
+            uint32_t result = Core::ERROR_OPENING_FAILED;
+            Core::File file(fileName);
+
+            if (file.Open(true) == true) {
+                std::vector<uint8_t> data(static_cast<size_t>(file.Size()));
+                uint32_t offset = 0;
+
+                result = Core::ERROR_INVALID_INPUT_LENGTH;
+
+                if ((data.empty() == false) && (file.Read(data.data(), static_cast<uint32_t>(data.size())) == data.size())) {
+                    while ((offset + 2) <= data.size()) {
+                        const uint16_t length = (data[offset] | (data[offset + 1] << 8));
+
+                        offset += 2;
+
+                        if ((length == 0) || ((offset + length) > data.size())) {
+                            break;
+                        }
+
+                        Add(&(data[offset]), length);
+                        offset += length;
+                    }
+
+                    if ((offset == data.size()) && (_notifications.empty() == false)) {
+                        result = Core::ERROR_NONE;
+                    }
+                }
+                file.Close();
+            }
+
+            return (result);
+        }
+        uint32_t Save(const string& fileName) const
+        {
+            uint32_t result = Core::ERROR_OPENING_FAILED;
+            Core::File file(fileName);
+
+            if (file.Create() == true) {
+                result = Core::ERROR_NONE;
+
+                for (const string& notification : _notifications) {
+                    const uint8_t length[2] = { static_cast<uint8_t>(notification.length() & 0xFF), static_cast<uint8_t>(notification.length() >> 8) };
+
+                    if ((file.Write(length, sizeof(length)) != sizeof(length)) || (file.Write(reinterpret_cast<const uint8_t*>(notification.c_str()), static_cast<uint32_t>(notification.length())) != notification.length())) {
+                        result = Core::ERROR_WRITE_ERROR;
+                        break;
+                    }
+                }
+                file.Close();
+            }
+
+            return (result);
+        }
+        // A tone of the given duration, in frames of frameSize bytes (two samples a byte). Every lossth frame
+        // does not make it, if loss is not 0.
+        void Generate(const uint32_t sampleRate, const uint32_t duration, const uint16_t frameSize, const uint32_t loss)
+        {
+            const uint32_t frames = static_cast<uint32_t>((static_cast<uint64_t>(sampleRate) * duration) / (frameSize * 2));
+            int32_t predictor = 0;
+            uint8_t index = 0;
+            uint32_t sample = 0;
+
+            for (uint32_t frame = 0; frame < frames; frame++) {
+                uint8_t header[5];
+                string data(frameSize, '\0');
+
+                header[0] = static_cast<uint8_t>(frame % WindowSize);
+                header[1] = index;
+                header[2] = static_cast<uint8_t>(predictor & 0xFF);
+                header[3] = static_cast<uint8_t>((predictor >> 8) & 0xFF);
+                header[4] = 0;
+
+                for (uint16_t loop = 0; loop < frameSize; loop++) {
+                    const uint8_t low = Encode(Tone(sample++, sampleRate), predictor, index);
+                    const uint8_t high = Encode(Tone(sample++, sampleRate), predictor, index);
+                    data[loop] = static_cast<char>(low | (high << 4));
+                }
+
+                if ((loss == 0) || (((frame + 1) % loss) != 0)) {
+                    const uint8_t footer = 0;
+
+                    Add(header, sizeof(header));
+                    Add(reinterpret_cast<const uint8_t*>(data.c_str()), frameSize);
+                    Add(&footer, sizeof(footer));
+                }
+            }
+        }
+        const std::vector<string>& Notifications() const
+        {
+            return (_notifications);
+        }
+        // Samples carried by the ADPCM data, not counting the concealed ones.
+        uint64_t Samples() const
+        {
+            return (_samples);
+        }
+
+    private:
+        void Add(const uint8_t data[], const uint16_t length)
+        {
+            _notifications.emplace_back(reinterpret_cast<const char*>(data), length);
+
+            if ((length != 5) && (length != 1)) {
+                _samples += (length * 2);
+            }
+        }
+        static int16_t Tone(const uint32_t sample, const uint32_t sampleRate)
+        {
+            // Two tones, so the step index moves around instead of settling.
+            const double time = static_cast<double>(sample) / sampleRate;
+            return (static_cast<int16_t>((12000.0 * sin(2.0 * M_PI * 440.0 * time)) + (4000.0 * sin(2.0 * M_PI * 3150.0 * time))));
+        }
+        // Reference IMA ADPCM encoder, the decoders under test only implement the other direction.
+        static uint8_t Encode(const int16_t sample, int32_t& predictor, uint8_t& index)
+        {
+            static const int8_t IndexLUT[] = {
+                -1, -1, -1, -1, 2, 4, 6, 8
+            };
+            static const uint16_t StepSizeLUT[] = {
+                7,     8,     9,     10,    11,    12,    13,    14,
+                16,    17,    19,    21,    23,    25,    28,    31,
+                34,    37,    41,    45,    50,    55,    60,    66,
+                73,    80,    88,    97,    107,   118,   130,   143,
+                157,   173,   190,   209,   230,   253,   279,   307,
+                337,   371,   408,   449,   494,   544,   598,   658,
+                724,   796,   876,   963,   1060,  1166,  1282,  1411,
+                1552,  1707,  1878,  2066,  2272,  2499,  2749,  3024,
+                3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,
+                7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+                15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+                32767
+            };
+
+            const int32_t step = StepSizeLUT[index];
+            int32_t difference = sample - predictor;
+            int32_t delta = (step >> 3);
+            uint8_t nibble = 0;
+
+            if (difference < 0) {
+                nibble = 8;
+                difference = -difference;
+            }
+            if (difference >= step) {
+                nibble |= 4;
+                difference -= step;
+                delta += step;
+            }
+            if (difference >= (step >> 1)) {
+                nibble |= 2;
+                difference -= (step >> 1);
+                delta += (step >> 1);
+            }
+            if (difference >= (step >> 2)) {
+                nibble |= 1;
+                delta += (step >> 2);
+            }
+
+            predictor += ((nibble & 8) != 0 ? -delta : delta);
+            predictor = std::max(static_cast<int32_t>(-32768), std::min(predictor, static_cast<int32_t>(32767)));
+
+            const int32_t next = index + IndexLUT[nibble & 7];
+            index = static_cast<uint8_t>(next < 0 ? 0 : (next >= Steps ? (Steps - 1) : next));
+
+            return (nibble);
+        }
+
+    private:
+        std::vector<string> _notifications;
+        uint64_t _samples;
+    };
+
+    class Benchmark {
+    private:
+        // Room for the concealment of the lost frames in front of the decoded frame.
+        static constexpr uint16_t MaxOutput = 8192;
+
+    public:
+        Benchmark(const Benchmark&) = delete;
+        Benchmark& operator=(const Benchmark&) = delete;
+
+        Benchmark(const Capture& capture)
+            : _capture(capture)
+        {
+        }
+        ~Benchmark()
+        {
+        }
+
+    public:
+        uint32_t Run(const Exchange::IVoiceProducer::IProfile::codec codec, const uint32_t iterations)
+        {
+            uint32_t result = Core::ERROR_UNAVAILABLE;
+            Decoders::IDecoder* decoder = Decoders::IDecoder::Instance(codec, string());
+
+            if (decoder != nullptr) {
+                uint8_t output[MaxOutput];
+                uint64_t produced = 0;
+                uint64_t duration = 0;
+
+                for (uint32_t iteration = 0; iteration < iterations; iteration++) {
+                    decoder->Reset();
+
+                    const uint64_t start = Core::Time::Now().Ticks();
+
+                    for (const string& notification : _capture.Notifications()) {
+                        produced += decoder->Decode(static_cast<uint16_t>(notification.length()), reinterpret_cast<const uint8_t*>(notification.c_str()), sizeof(output), output);
+                    }
+
+                    duration += (Core::Time::Now().Ticks() - start);
+                }
+
+                const uint64_t samples = _capture.Samples() * iterations;
+
+                printf(_T("%u notifications, %llu samples per pass\n"), static_cast<uint32_t>(_capture.Notifications().size()), static_cast<unsigned long long>(_capture.Samples()));
+                printf(_T("frames:  %u, dropped: %u\n"), decoder->Frames() + 1, decoder->Dropped());
+
+                if (samples > 0) {
+                    printf(_T("decode:  %.2f nS per sample\n"), (duration * 1000.0) / samples);
+                    printf(_T("total:   %.1f Msamples/s, %.1f MB/s of output\n"), static_cast<double>(samples) / std::max(duration, static_cast<uint64_t>(1)), static_cast<double>(produced) / std::max(duration, static_cast<uint64_t>(1)));
+                }
+
+                delete decoder;
+                result = Core::ERROR_NONE;
+            }
+
+            return (result);
+        }
+
+    private:
+        const Capture& _capture;
+    };
+
+    class Config {
+    public:
+        Config(const Config&) = delete;
+        Config& operator=(const Config&) = delete;
+
+        Config()
+            : Capture()
+            , Save()
+            , Codec(Exchange::IVoiceProducer::IProfile::codec::PCM)
+            , Iterations(1000)
+            , SampleRate(16000)
+            , Duration(10)
+            , Frame(128)
+            , Loss(0)
+        {
+        }
+        ~Config()
+        {
+        }
+
+    public:
+        string Capture;
+        string Save;
+        Exchange::IVoiceProducer::IProfile::codec Codec;
+        uint32_t Iterations;
+        uint32_t SampleRate;
+        uint32_t Duration;
+        uint16_t Frame;
+        uint32_t Loss;
+    };
+
+    void ParseOptions(int argc, char** argv, Config& config)
+    {
+        Tools::CommandLine options;
+
+        options.Add(_T("capture"), config.Capture, _T("Recorded voice notifications, used instead of the generated tone"));
+        options.Add(_T("save"), config.Save, _T("Write the generated notifications to this file, in the capture format"));
+        options.Add(_T("adpcm"), false, [&config](const char[]) { config.Codec = Exchange::IVoiceProducer::IProfile::codec::ADPCM; }, _T("Run the ADPCM pass through instead of the PCM decoder"));
+        options.Add(_T("iterations"), config.Iterations, _T("Number of passes over the notifications"));
+        options.Add(_T("rate"), config.SampleRate, _T("Sample rate of the generated tone"));
+        options.Add(_T("duration"), config.Duration, _T("Seconds of generated tone"));
+        options.Add(_T("frame"), true, [&config](const char value[]) { config.Frame = static_cast<uint16_t>(std::max(1, std::min(atoi(value), 1024))); }, _T("Bytes of ADPCM data in a generated frame"), _T("128"));
+        options.Add(_T("loss"), config.Loss, _T("Drop every n-th generated frame, 0 drops none"));
+
+        options.Parse(argc, argv);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    Capture capture;
+    int result = 0;
+
+    ParseOptions(argc, argv, config);
+
+    if (config.Capture.empty() == true) {
+        capture.Generate(config.SampleRate, config.Duration, config.Frame, config.Loss);
+
+        if ((config.Save.empty() == false) && (capture.Save(config.Save) != Core::ERROR_NONE)) {
+            printf(_T("Could not write the notifications to: %s\n"), config.Save.c_str());
+        }
+    } else if (capture.Load(config.Capture) != Core::ERROR_NONE) {
+        printf(_T("Could not read the voice notifications of: %s\n"), config.Capture.c_str());
+        return (1);
+    }
+
+    Benchmark benchmark(capture);
+
+    if (benchmark.Run(config.Codec, config.Iterations) != Core::ERROR_NONE) {
+        printf(_T("No decoder available for this codec\n"));
+        result = 1;
+    }
+
+    Core::Singleton::Dispose();
+
+    return (result);
+}
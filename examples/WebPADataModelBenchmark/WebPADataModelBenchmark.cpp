@@ -0,0 +1,277 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME WebPADataModelBenchmark
+#endif
+
+#include "CommandLine.h"
+#include "DataModel.h"
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+
+namespace WPEFramework {
+
+    // Runs the data model trie of the WebPA GenericAdapter outside of the adapter, over the data-model.xml
+    // it ships with. It times compiling the document, validating every parameter of the model (and as many
+    // names that are not in it) and expanding every object without instance numbers as a wildcard. No
+    // profiles are loaded, so multi instance objects report no instances.
+    class Names {
+    public:
+        Names(const Names&) = delete;
+        Names& operator=(const Names&) = delete;
+
+        Names()
+            : _parameters()
+            , _objects()
+        {
+        }
+        ~Names()
+        {
+        }
+
+    public:
+        void Load(const DataModel& model)
+        {
+            const DataModel::Node* root = model.Find(Root);
+
+            _parameters.clear();
+            _objects.clear();
+
+            if (root != nullptr) {
+                string path(Root);
+                Collect(*root, path, false);
+            }
+        }
+        // Concrete parameter names, instance 1 of every multi instance object.
+        const std::vector<string>& Parameters() const
+        {
+            return (_parameters);
+        }
+        // Objects that can be expanded without knowing the number of instances.
+        const std::vector<string>& Objects() const
+        {
+            return (_objects);
+        }
+
+    private:
+        void Collect(const DataModel::Node& node, string& path, const bool instance)
+        {
+            const std::size_t length = path.length();
+
+            if (instance == false) {
+                _objects.push_back(path);
+            }
+
+            for (const DataModel::Node* child : node.Children()) {
+                path.append(child->Name());
+
+                if (child->IsParameter() == true) {
+                    _parameters.push_back(path);
+                } else {
+                    path.append(1, '.');
+                    Collect(*child, path, instance);
+                }
+                path.resize(length);
+            }
+
+            if (node.Instance() != nullptr) {
+                path.append("1.");
+                Collect(*(node.Instance()), path, true);
+                path.resize(length);
+            }
+        }
+
+    private:
+        static constexpr const TCHAR* Root = _T("Device.");
+
+        std::vector<string> _parameters;
+        std::vector<string> _objects;
+    };
+
+    class Benchmark {
+    public:
+        Benchmark(const Benchmark&) = delete;
+        Benchmark& operator=(const Benchmark&) = delete;
+
+        Benchmark(const string& fileName)
+            : _fileName(fileName)
+            , _handler()
+            , _model(&_handler)
+            , _names()
+        {
+        }
+        ~Benchmark()
+        {
+        }
+
+    public:
+        uint32_t Load(const uint32_t iterations)
+        {
+            uint32_t result = Core::ERROR_NONE;
+            const uint64_t start = Core::Time::Now().Ticks();
+
+            for (uint32_t iteration = 0; (iteration < iterations) && (result == Core::ERROR_NONE); iteration++) {
+                if (_model.LoadDM(_fileName) != DM_SUCCESS) {
+                    result = Core::ERROR_OPENING_FAILED;
+                }
+            }
+
+            const uint64_t duration = Core::Time::Now().Ticks() - start;
+
+            if (result == Core::ERROR_NONE) {
+                _names.Load(_model);
+
+                printf(_T("%s: %u parameters, %u expandable objects\n"), _fileName.c_str(),
+                    static_cast<uint32_t>(_names.Parameters().size()), static_cast<uint32_t>(_names.Objects().size()));
+
+                if (iterations > 0) {
+                    printf(_T("load:     %.1f uS per document\n"), static_cast<double>(duration) / iterations);
+                }
+            }
+
+            return (result);
+        }
+        void Validate(const uint32_t iterations)
+        {
+            const std::vector<string>& names(_names.Parameters());
+            std::vector<string> unknown;
+            string dataType;
+            uint32_t found = 0;
+            uint32_t missed = 0;
+
+            // Same names with a last segment that is not in the model, the lookup fails as late as it can.
+            for (const string& name : names) {
+                unknown.push_back(name + _T("X"));
+            }
+
+            const uint64_t start = Core::Time::Now().Ticks();
+
+            for (uint32_t iteration = 0; iteration < iterations; iteration++) {
+                for (const string& name : names) {
+                    found += (_model.IsValidParameter(name, dataType) == true ? 1 : 0);
+                }
+            }
+
+            const uint64_t valid = Core::Time::Now().Ticks();
+
+            for (uint32_t iteration = 0; iteration < iterations; iteration++) {
+                for (const string& name : unknown) {
+                    missed += (_model.IsValidParameter(name, dataType) == false ? 1 : 0);
+                }
+            }
+
+            const uint64_t invalid = Core::Time::Now().Ticks();
+            const uint64_t count = static_cast<uint64_t>(iterations) * names.size();
+
+            if (count > 0) {
+                printf(_T("valid:    %.1f nS per lookup, %u of %u found\n"), ((valid - start) * 1000.0) / count, found / iterations, static_cast<uint32_t>(names.size()));
+                printf(_T("invalid:  %.1f nS per lookup, %u of %u rejected\n"), ((invalid - valid) * 1000.0) / count, missed / iterations, static_cast<uint32_t>(unknown.size()));
+            }
+        }
+        void Expand(const uint32_t iterations)
+        {
+            const std::vector<string>& objects(_names.Objects());
+            DataModel::ParameterList parameters;
+            uint64_t expanded = 0;
+
+            const uint64_t start = Core::Time::Now().Ticks();
+
+            for (uint32_t iteration = 0; iteration < iterations; iteration++) {
+                for (const string& object : objects) {
+                    parameters.clear();
+                    _model.Parameters(object, parameters);
+                    expanded += parameters.size();
+                }
+            }
+
+            const uint64_t duration = Core::Time::Now().Ticks() - start;
+            const uint64_t count = static_cast<uint64_t>(iterations) * objects.size();
+
+            if (count > 0) {
+                printf(_T("wildcard: %.1f uS per expansion, %.1f parameters per expansion\n"), static_cast<double>(duration) / count, static_cast<double>(expanded) / count);
+            }
+        }
+
+    private:
+        const string _fileName;
+        Handler _handler;
+        DataModel _model;
+        Names _names;
+    };
+
+    class Config {
+    public:
+        Config(const Config&) = delete;
+        Config& operator=(const Config&) = delete;
+
+        Config()
+            : DataModelFile(_T(DATA_MODEL_FILE))
+            , Loads(10)
+            , Iterations(1000)
+        {
+        }
+        ~Config()
+        {
+        }
+
+    public:
+        string DataModelFile;
+        uint32_t Loads;
+        uint32_t Iterations;
+    };
+
+    void ParseOptions(int argc, char** argv, Config& config)
+    {
+        Tools::CommandLine options;
+
+        options.Add(_T("datamodel"), config.DataModelFile, _T("Data model document"), _T("the data-model.xml of the GenericAdapter"));
+        options.Add(_T("loads"), config.Loads, _T("Number of times the document is compiled"));
+        options.Add(_T("iterations"), config.Iterations, _T("Number of passes over the parameters and objects"));
+
+        options.Parse(argc, argv);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    int result = 0;
+
+    ParseOptions(argc, argv, config);
+
+    {
+        Benchmark benchmark(config.DataModelFile);
+
+        // At least one load, the other passes run over the compiled model.
+        if (benchmark.Load(config.Loads == 0 ? 1 : config.Loads) != Core::ERROR_NONE) {
+            printf(_T("Could not load the data model: %s\n"), config.DataModelFile.c_str());
+            result = 1;
+        } else if (config.Iterations > 0) {
+            benchmark.Validate(config.Iterations);
+            benchmark.Expand(config.Iterations);
+        }
+    }
+
+    Core::Singleton::Dispose();
+
+    return (result);
+}
@@ -0,0 +1,408 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME WebShellBenchmark
+#endif
+
+#include <core/core.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include "CommandLine.h"
+
+#undef EXTERNAL
+
+using namespace WPEFramework;
+
+namespace WPEFramework {
+
+    // A WebSocket connection to the shell the WebShell plugin runs for it. Everything sent is typed into the
+    // shell, everything the shell prints comes back. A run ends when the shell printed the marker; the
+    // commands print it with quotes in between, so it never shows up by accident.
+    class Shell {
+    private:
+        static constexpr TCHAR Marker[] = _T("webshell-benchmark-done\n");
+
+    public:
+        Shell(const Shell&) = delete;
+        Shell& operator=(const Shell&) = delete;
+
+        Shell(const uint16_t frameSize)
+            : _fd(-1)
+            , _frameSize(frameSize)
+            , _inbound()
+        {
+        }
+        ~Shell()
+        {
+            if (_fd != -1) {
+                ::close(_fd);
+            }
+        }
+
+    public:
+        bool Open(const string& address, const uint16_t port, const string& path, const string& token)
+        {
+            struct sockaddr_in destination;
+            bool result = false;
+
+            ::memset(&destination, 0, sizeof(destination));
+            destination.sin_family = AF_INET;
+            destination.sin_port = htons(port);
+
+            if ((::inet_pton(AF_INET, address.c_str(), &destination.sin_addr) == 1) && ((_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)) != -1)) {
+                const string request(_T("GET ") + path + (token.empty() == true ? string() : _T("?token=") + token) + _T(" HTTP/1.1\r\n"
+                    "Host: ") + address + _T("\r\n"
+                    "Upgrade: websocket\r\n"
+                    "Connection: Upgrade\r\n"
+                    "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                    "Sec-WebSocket-Version: 13\r\n\r\n"));
+
+                if ((::connect(_fd, reinterpret_cast<struct sockaddr*>(&destination), sizeof(destination)) == 0) && (Send(request.c_str(), request.length()) == true)) {
+                    size_t header = string::npos;
+                    char data[1024];
+                    ssize_t size;
+
+                    while ((header == string::npos) && ((size = ::recv(_fd, data, sizeof(data), 0)) > 0)) {
+                        _inbound.append(data, size);
+                        header = _inbound.find(_T("\r\n\r\n"));
+                    }
+
+                    if ((header != string::npos) && (_inbound.compare(0, 13, _T("HTTP/1.1 101 ")) == 0)) {
+                        // Whatever followed the upgrade response is the start of the first frame.
+                        _inbound.erase(0, header + 4);
+                        result = true;
+                    }
+                }
+            }
+
+            return (result);
+        }
+        // Types the input and waits for the marker. Returns the number of bytes the shell printed, without
+        // the marker, or -1 if the connection failed or the marker did not show up in time.
+        int64_t Run(const string& input, const uint32_t waitTime)
+        {
+            const uint64_t end = Core::Time::Now().Ticks() + (static_cast<uint64_t>(waitTime) * Core::Time::TicksPerMillisecond);
+            const size_t markerLength = ::strlen(Marker);
+            string tail;
+            size_t offset = 0;
+            int64_t printed = 0;
+            bool done = false;
+
+            while (done == false) {
+                struct pollfd slot = { _fd, static_cast<short>(POLLIN | (offset < input.length() ? POLLOUT : 0)), 0 };
+                const uint64_t now = Core::Time::Now().Ticks();
+
+                if ((now >= end) || (::poll(&slot, 1, static_cast<int>((end - now) / Core::Time::TicksPerMillisecond) + 1) < 0)) {
+                    break;
+                }
+                if ((slot.revents & (POLLERR | POLLHUP)) != 0) {
+                    break;
+                }
+
+                if ((slot.revents & POLLOUT) != 0) {
+                    const size_t length = std::min(static_cast<size_t>(_frameSize), input.length() - offset);
+
+                    if (Frame(&(input[offset]), length) == false) {
+                        break;
+                    }
+                    offset += length;
+                }
+
+                if ((slot.revents & POLLIN) != 0) {
+                    char data[16 * 1024];
+                    const ssize_t size = ::recv(_fd, data, sizeof(data), 0);
+
+                    if (size <= 0) {
+                        break;
+                    }
+
+                    _inbound.append(data, size);
+
+                    string payload;
+                    bool closed = false;
+
+                    while (Payload(payload, closed) == true) {
+                        printed += payload.length();
+                        tail += payload;
+
+                        if ((tail.length() >= markerLength) && (tail.compare(tail.length() - markerLength, markerLength, Marker) == 0)) {
+                            done = true;
+                        } else if (tail.length() > markerLength) {
+                            tail.erase(0, tail.length() - markerLength);
+                        }
+                    }
+
+                    if (closed == true) {
+                        break;
+                    }
+                }
+            }
+
+            return (done == true ? (printed - static_cast<int64_t>(markerLength)) : -1);
+        }
+        static string Done()
+        {
+            return (_T("echo webshell-benchmark-'done'\n"));
+        }
+
+    private:
+        bool Send(const char data[], const size_t length)
+        {
+            size_t offset = 0;
+            ssize_t size = 0;
+
+            while ((offset < length) && ((size = ::send(_fd, &(data[offset]), length - offset, MSG_NOSIGNAL)) > 0)) {
+                offset += size;
+            }
+
+            return (offset == length);
+        }
+        // A masked text frame, as a client has to send them.
+        bool Frame(const char data[], const size_t length)
+        {
+            static const uint8_t Mask[] = { 0x12, 0x34, 0x56, 0x78 };
+            string frame;
+
+            frame.reserve(length + 14);
+            frame += static_cast<char>(0x81);
+
+            if (length < 126) {
+                frame += static_cast<char>(0x80 | length);
+            } else {
+                frame += static_cast<char>(0x80 | 126);
+                frame += static_cast<char>((length >> 8) & 0xFF);
+                frame += static_cast<char>(length & 0xFF);
+            }
+
+            frame.append(reinterpret_cast<const char*>(Mask), sizeof(Mask));
+
+            for (size_t index = 0; index < length; index++) {
+                frame += static_cast<char>(data[index] ^ Mask[index & 0x3]);
+            }
+
+            return (Send(frame.c_str(), frame.length()));
+        }
+        // Takes the next complete data frame from what got received. Control frames are skipped, a close
+        // frame ends the connection.
+        bool Payload(string& payload, bool& closed)
+        {
+            bool result = false;
+
+            while ((result == false) && (closed == false) && (_inbound.length() >= 2)) {
+                const uint8_t opcode = (static_cast<uint8_t>(_inbound[0]) & 0x0F);
+                const bool masked = ((static_cast<uint8_t>(_inbound[1]) & 0x80) != 0);
+                uint64_t length = (static_cast<uint8_t>(_inbound[1]) & 0x7F);
+                size_t header = 2;
+
+                if (length == 126) {
+                    header = 4;
+                } else if (length == 127) {
+                    header = 10;
+                }
+                if (masked == true) {
+                    header += 4;
+                }
+                if (_inbound.length() < header) {
+                    break;
+                }
+                if (length >= 126) {
+                    const uint8_t bytes = (length == 126 ? 2 : 8);
+
+                    length = 0;
+                    for (uint8_t index = 0; index < bytes; index++) {
+                        length = (length << 8) | static_cast<uint8_t>(_inbound[2 + index]);
+                    }
+                }
+                if ((_inbound.length() - header) < length) {
+                    break;
+                }
+
+                if (opcode == 0x8) {
+                    closed = true;
+                } else if ((opcode & 0x08) == 0) {
+                    // Text, binary or a continuation, all of it is shell output.
+                    payload.assign(_inbound, header, static_cast<size_t>(length));
+
+                    if (masked == true) {
+                        for (size_t index = 0; index < payload.length(); index++) {
+                            payload[index] ^= _inbound[header - 4 + (index & 0x3)];
+                        }
+                    }
+                    result = true;
+                }
+
+                _inbound.erase(0, header + static_cast<size_t>(length));
+            }
+
+            return (result);
+        }
+
+    private:
+        int _fd;
+        uint16_t _frameSize;
+        string _inbound;
+    };
+
+    constexpr TCHAR Shell::Marker[];
+
+    class Config {
+    public:
+        Config(const Config&) = delete;
+        Config& operator=(const Config&) = delete;
+
+        Config()
+            : Address(_T("127.0.0.1"))
+            , Port(80)
+            , Path(_T("/Service/WebShell"))
+            , Token()
+            , Output(64 * 1024 * 1024)
+            , Input(16 * 1024 * 1024)
+            , Echoes(100)
+            , Frame(16 * 1024)
+            , Timeout(60000)
+        {
+        }
+        ~Config()
+        {
+        }
+
+    public:
+        string Address;
+        uint16_t Port;
+        string Path;
+        string Token;
+        uint32_t Output;
+        uint32_t Input;
+        uint32_t Echoes;
+        uint16_t Frame;
+        uint32_t Timeout;
+    };
+
+    void ParseOptions(int argc, char** argv, Config& config)
+    {
+        Tools::CommandLine options;
+
+        options.Add(_T("address"), config.Address, _T("IPv4 address of the framework"));
+        options.Add(_T("port"), config.Port, _T("Port of the framework"));
+        options.Add(_T("path"), config.Path, _T("WebSocket path of the WebShell plugin"));
+        options.Add(_T("token"), config.Token, _T("Security token, if the framework asks for one"));
+        options.Add(_T("output"), config.Output, _T("Bytes the shell prints, 0 skips the output run"));
+        options.Add(_T("input"), config.Input, _T("Bytes typed into the shell, 0 skips the input run"));
+        options.Add(_T("echoes"), config.Echoes, _T("Number of round trips of a single command, 0 skips them"));
+        options.Add(_T("frame"), true, [&config](const char value[]) { config.Frame = static_cast<uint16_t>(std::max(1, std::min(atoi(value), 65535))); }, _T("Largest WebSocket frame sent, in bytes"), _T("16384"));
+        options.Add(_T("timeout"), config.Timeout, _T("Time a run may take, in ms"));
+
+        options.Parse(argc, argv);
+    }
+
+    void Report(const TCHAR name[], const uint64_t bytes, const uint64_t duration)
+    {
+        printf(_T("%s: %llu bytes in %.1f mS, %.1f MB/s\n"), name, static_cast<unsigned long long>(bytes), duration / 1000.0, static_cast<double>(bytes) / std::max(duration, static_cast<uint64_t>(1)));
+    }
+
+    // Returns the number of runs that failed.
+    uint32_t Run(const Config& config, Shell& shell)
+    {
+        uint32_t failures = 0;
+
+        if (config.Echoes > 0) {
+            const uint64_t start = Core::Time::Now().Ticks();
+            uint32_t echo = 0;
+
+            while ((echo < config.Echoes) && (shell.Run(Shell::Done(), config.Timeout) == 0)) {
+                echo++;
+            }
+
+            const uint64_t duration = Core::Time::Now().Ticks() - start;
+
+            if (echo == config.Echoes) {
+                printf(_T("echo: %u round trips, %.1f uS per round trip\n"), echo, static_cast<double>(duration) / echo);
+            } else {
+                printf(_T("echo: failed after %u round trips\n"), echo);
+                failures++;
+            }
+        }
+
+        if (config.Output > 0) {
+            const string command(_T("head -c ") + std::to_string(config.Output) + _T(" /dev/zero | tr '\\000' x; echo; ") + Shell::Done());
+            const uint64_t start = Core::Time::Now().Ticks();
+            const int64_t printed = shell.Run(command, config.Timeout);
+            const uint64_t duration = Core::Time::Now().Ticks() - start;
+
+            if (printed == (static_cast<int64_t>(config.Output) + 1)) {
+                Report(_T("output"), config.Output, duration);
+            } else {
+                printf(_T("output: failed, got %lld of %u bytes\n"), static_cast<long long>(printed), config.Output);
+                failures++;
+            }
+        }
+
+        if (config.Input > 0) {
+            // Pasted into a here document, so the shell has to take in all of it before it prints the marker.
+            const string line(string(79, 'x') + '\n');
+            string paste(_T("cat > /dev/null << 'WEBSHELL_BENCHMARK_EOF'\n"));
+
+            paste.reserve(paste.length() + config.Input + line.length() + 64);
+            for (uint32_t size = 0; size < config.Input; size += static_cast<uint32_t>(line.length())) {
+                paste += line;
+            }
+            paste += _T("WEBSHELL_BENCHMARK_EOF\n") + Shell::Done();
+
+            const uint64_t start = Core::Time::Now().Ticks();
+            const int64_t printed = shell.Run(paste, config.Timeout);
+            const uint64_t duration = Core::Time::Now().Ticks() - start;
+
+            if (printed == 0) {
+                Report(_T("input"), paste.length(), duration);
+            } else {
+                printf(_T("input: failed\n"));
+                failures++;
+            }
+        }
+
+        return (failures);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Config config;
+    int result = 1;
+
+    ParseOptions(argc, argv, config);
+
+    {
+        Shell shell(config.Frame);
+
+        if (shell.Open(config.Address, config.Port, config.Path, config.Token) == false) {
+            printf(_T("Could not open a WebShell session on %s:%u%s\n"), config.Address.c_str(), config.Port, config.Path.c_str());
+        } else {
+            result = (Run(config, shell) == 0 ? 0 : 1);
+        }
+    }
+
+    Core::Singleton::Dispose();
+
+    return (result);
+}